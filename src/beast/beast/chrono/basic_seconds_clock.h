@@ -21,6 +21,7 @@
 #define BEAST_CHRONO_BASIC_SECONDS_CLOCK_H_INCLUDED
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <vector>
 
@@ -191,11 +192,8 @@ public:
 
         struct worker : detail::seconds_clock_worker
         {
-            typedef std::mutex mutex;
-            typedef std::lock_guard <mutex> lock_guard;
-
-            time_point m_now;
-            mutex m_mutex;
+            // Read on every call to now(), so it must not take a lock
+            std::atomic <rep> m_now;
 
             static time_point get_now ()
             {
@@ -204,7 +202,7 @@ public:
             }
 
             worker ()
-                : m_now (get_now ())
+                : m_now (get_now ().time_since_epoch ().count ())
             {
                 detail::seconds_clock_thread::instance().add (*this);
             }
@@ -216,14 +214,14 @@ public:
 
             time_point now()
             {
-                lock_guard lock (m_mutex);
-                return m_now;
+                return time_point (duration (
+                    m_now.load (std::memory_order_relaxed)));
             }
 
             void sample ()
             {
-                lock_guard lock (m_mutex);
-                m_now = get_now ();
+                m_now.store (get_now ().time_since_epoch ().count (),
+                    std::memory_order_relaxed);
             }
         };
 
@@ -20,6 +20,9 @@
 #ifndef RIPPLE_ALGORITHM_DECAYINGSAMPLE_H_INCLUDED
 #define RIPPLE_ALGORITHM_DECAYINGSAMPLE_H_INCLUDED
 
+#include <atomic>
+#include <cstdint>
+
 namespace ripple {
 
 /** Sampling function using exponential decay to provide a continuous value. */
@@ -91,6 +94,92 @@ private:
     elapsed_type m_when;
 };
 
+//------------------------------------------------------------------------------
+
+/** A DecayingSample that may be used concurrently without a lock.
+    The value and the time it was last aged are packed into a single atomic
+    word, so adding a sample is one compare-and-swap and reading the value
+    writes nothing. Values age the same way as in DecayingSample, one step
+    per elapsed unit of time.
+*/
+template <int Window>
+class AtomicDecayingSample
+{
+public:
+    /** Create a default constructed sample. */
+    AtomicDecayingSample ()
+        : m_state (0)
+    {
+    }
+
+    /** Add a new sample.
+        The value is first aged according to the specified time.
+    */
+    int add (int value, std::int64_t now)
+    {
+        std::uint64_t state (m_state.load ());
+        for (;;)
+        {
+            std::uint32_t when (whenOf (state));
+            std::int32_t const next (decay (state, now, when) + value);
+            if (m_state.compare_exchange_weak (state, pack (next, when)))
+                return next / Window;
+        }
+    }
+
+    /** Retrieve the current value in normalized units.
+        The samples are aged according to the specified time.
+    */
+    int value (std::int64_t now) const
+    {
+        std::uint64_t const state (m_state.load ());
+        std::uint32_t when (whenOf (state));
+        return decay (state, now, when) / Window;
+    }
+
+private:
+    static std::uint64_t pack (std::int32_t value, std::uint32_t when)
+    {
+        return (std::uint64_t (when) << 32) | std::uint32_t (value);
+    }
+
+    static std::uint32_t whenOf (std::uint64_t state)
+    {
+        return std::uint32_t (state >> 32);
+    }
+
+    // Returns the value in exponential units aged to now, and sets when
+    // to the time the returned value corresponds to. A caller with a
+    // clock reading older than the stored time sees no aging at all.
+    static std::int32_t decay (std::uint64_t state,
+        std::int64_t now, std::uint32_t& when)
+    {
+        std::int32_t value (static_cast <std::int32_t> (
+            static_cast <std::uint32_t> (state)));
+        std::int32_t n (std::int32_t (std::uint32_t (now) - when));
+        if (n <= 0)
+            return value;
+
+        when = std::uint32_t (now);
+
+        if (value == 0)
+            return value;
+
+        // A span larger than four times the window decays the
+        // value to an insignificant amount so just reset it.
+        //
+        if (n > 4 * Window)
+            return 0;
+
+        while (n--)
+            value -= (value + Window - 1) / Window;
+
+        return value;
+    }
+
+    std::atomic <std::uint64_t> m_state;
+};
+
 }
 
 #endif
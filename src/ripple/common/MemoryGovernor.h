@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_MEMORYGOVERNOR_H_INCLUDED
+#define RIPPLE_MEMORYGOVERNOR_H_INCLUDED
+
+#include "TaggedCache.h"
+
+#include "../json/ripple_json.h"
+
+#include "../../beast/beast/utility/Journal.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** Divides one memory budget among several caches.
+
+    Each cache is given a share of the budget in proportion to the value of
+    its hits, where a hit is worth the relative cost of the miss it avoided.
+    Every cache keeps a minimum share so that it can show its value again
+    after a quiet period. The shares are recalculated by @ref rebalance.
+
+    The caches are swept incrementally. Each call to @ref sweep visits the
+    caches in turn, a few objects at a time, until the time slice runs out.
+    No cache lock is held for longer than one small batch, so the caches
+    remain usable while a pass is in progress.
+*/
+class MemoryGovernor
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    /** A cache whose memory is managed by the governor. */
+    class Cache
+    {
+    public:
+        virtual ~Cache () { }
+
+        /** Return the estimated memory used by the cached objects. */
+        virtual std::size_t getCacheBytes () = 0;
+
+        /** Return the number of hits since the cache was created. */
+        virtual std::uint64_t getHits () = 0;
+
+        /** Set the memory the cached objects may use. */
+        virtual void setTargetBytes (std::size_t bytes) = 0;
+
+        /** Sweep some objects, resuming where the previous call stopped.
+            @return `true` if this call completed a pass over the cache.
+        */
+        virtual bool sweep (std::size_t limit) = 0;
+    };
+
+    explicit MemoryGovernor (beast::Journal journal);
+
+    /** Set the memory shared by all the caches, in bytes. */
+    void setBudget (std::size_t bytes);
+
+    std::size_t getBudget ();
+
+    /** Add a cache to the governor.
+        This must be called during startup, before the first sweep.
+        @param weight The relative cost of a miss in this cache.
+    */
+    void add (std::string const& name, std::unique_ptr <Cache> cache,
+        int weight = 1);
+
+    /** Add a TaggedCache, limited by the estimate of the given weigher. */
+    template <class Key, class T, class Hash, class KeyEqual, class Mutex>
+    void add (std::string const& name,
+        TaggedCache <Key, T, Hash, KeyEqual, Mutex>& cache,
+            typename TaggedCache <Key, T, Hash, KeyEqual, Mutex>::weigher_type weigher,
+                int weight = 1);
+
+    /** Divide the budget using the hits since the last call.
+        This also starts a new sweep pass over every cache.
+    */
+    void rebalance ();
+
+    /** Sweep the caches until the time slice runs out.
+        @return `true` if the current pass is complete.
+    */
+    bool sweep (std::chrono::milliseconds slice);
+
+    /** Return the memory used and allowed for each cache. */
+    Json::Value getJson ();
+
+private:
+    struct Item
+    {
+        Item (std::string const& name_, std::unique_ptr <Cache> cache_,
+            int weight_);
+
+        std::string name;
+        std::unique_ptr <Cache> cache;
+        int weight;
+
+        // Hits seen at the last rebalance
+        std::uint64_t hits;
+
+        // Smoothed weighted hits between rebalances
+        double value;
+
+        std::size_t targetBytes;
+        std::uint64_t passes;
+        bool swept;
+    };
+
+    enum
+    {
+        // Objects examined per cache lock
+        sweepBatch = 256,
+
+        // Each cache keeps at least this fraction of an equal split
+        minimumShareDivider = 4,
+
+        // Weight of the newest interval in the smoothed value
+        valueSmoothing = 4
+    };
+
+    beast::Journal m_journal;
+    std::mutex m_mutex;
+    std::size_t m_budget;
+    std::vector <std::unique_ptr <Item>> m_items;
+};
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+template <class Key, class T, class Hash, class KeyEqual, class Mutex>
+class GovernedTaggedCache : public MemoryGovernor::Cache
+{
+public:
+    typedef TaggedCache <Key, T, Hash, KeyEqual, Mutex> cache_type;
+    typedef typename cache_type::weigher_type weigher_type;
+
+    GovernedTaggedCache (cache_type& cache, weigher_type weigher)
+        : m_cache (cache)
+        , m_weigher (weigher)
+    {
+    }
+
+    std::size_t getCacheBytes ()
+    {
+        return m_cache.getCacheBytes ();
+    }
+
+    std::uint64_t getHits ()
+    {
+        return m_cache.getHits ();
+    }
+
+    void setTargetBytes (std::size_t bytes)
+    {
+        m_cache.setTargetBytes (bytes, m_weigher);
+    }
+
+    bool sweep (std::size_t limit)
+    {
+        return m_cache.sweep (limit);
+    }
+
+private:
+    cache_type& m_cache;
+    weigher_type m_weigher;
+};
+
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Mutex>
+void MemoryGovernor::add (std::string const& name,
+    TaggedCache <Key, T, Hash, KeyEqual, Mutex>& cache,
+        typename TaggedCache <Key, T, Hash, KeyEqual, Mutex>::weigher_type weigher,
+            int weight)
+{
+    add (name, std::unique_ptr <Cache> (
+        new detail::GovernedTaggedCache <Key, T, Hash, KeyEqual, Mutex> (
+            cache, weigher)), weight);
+}
+
+}
+
+#endif
@@ -27,6 +27,8 @@
 
 #include <boost/smart_ptr.hpp>
 
+#include <algorithm>
+#include <deque>
 #include <functional>
 #include <mutex>
 #include <unordered_map>
@@ -46,6 +48,13 @@ struct TaggedCacheLog;
     If it stays in memory even after it is ejected from the cache,
     the map will track it.
 
+    The cache can optionally be limited by an estimate of the memory its
+    objects use instead of by their number. In that case objects are first
+    admitted on probation and only become protected once they are accessed
+    a second time. Probationary objects are the first to be evicted, so a
+    single pass over many objects (such as a ledger walk) cannot push the
+    frequently used ones out of the cache.
+
     @note Callers must not modify data objects that are stored in the cache
           unless they hold their own lock over all cache operations.
 */
@@ -71,6 +80,7 @@ public:
     typedef boost::weak_ptr <mapped_type> weak_mapped_ptr;
     typedef boost::shared_ptr <mapped_type> mapped_ptr;
     typedef beast::abstract_clock <std::chrono::seconds> clock_type;
+    typedef std::function <std::size_t (mapped_type const&)> weigher_type;
 
 public:
     // VFALCO TODO Change expiration_seconds to clock_type::duration
@@ -85,9 +95,18 @@ public:
         , m_name (name)
         , m_target_size (size)
         , m_target_age (std::chrono::seconds (expiration_seconds))
+        , m_target_bytes (0)
         , m_cache_count (0)
+        , m_bytes (0)
+        , m_probation_bytes (0)
+        , m_serial (0)
+        , m_sweep_bucket (0)
         , m_hits (0)
         , m_misses (0)
+        , m_evictions (0)
+        , m_reported_hits (0)
+        , m_reported_misses (0)
+        , m_reported_evictions (0)
     {
     }
 
@@ -116,6 +135,50 @@ public:
             m_name << " target size set to " << s;
     }
 
+    std::size_t getTargetBytes () const
+    {
+        lock_guard lock (m_mutex);
+        return m_target_bytes;
+    }
+
+    /** Limit the cache by the memory used by its objects.
+        When set, this takes the place of the target size when sweeping.
+        @param bytes The budget in bytes, or zero for no limit.
+        @param weigher Estimates the memory used by one object.
+    */
+    void setTargetBytes (std::size_t bytes, weigher_type weigher)
+    {
+        std::vector <mapped_ptr> evicted;
+
+        lock_guard lock (m_mutex);
+        m_target_bytes = bytes;
+
+        if (weigher && !m_weigher)
+        {
+            // Objects cached so far were not weighed.
+            m_weigher = weigher;
+
+            for (auto& item : m_cache)
+            {
+                if (item.second.isCached ())
+                    charge (item.second);
+            }
+        }
+
+        evict (evicted);
+
+        if (m_journal.debug) m_journal.debug <<
+            m_name << " target bytes set to " << bytes;
+    }
+
+    /** Report metrics to a different collector. */
+    void setCollector (beast::insight::Collector::ptr const& collector)
+    {
+        m_stats = Stats (m_name,
+            std::bind (&TaggedCache::collect_metrics, this),
+                collector);
+    }
+
     clock_type::rep getTargetAge () const
     {
         lock_guard lock (m_mutex);
@@ -142,6 +205,26 @@ public:
         return m_cache.size ();
     }
 
+    /** Return the estimated memory used by the cached objects. */
+    std::size_t getCacheBytes ()
+    {
+        lock_guard lock (m_mutex);
+        return m_bytes;
+    }
+
+    std::uint64_t getEvictions ()
+    {
+        lock_guard lock (m_mutex);
+        return m_evictions;
+    }
+
+    /** Return the number of successful fetches since the cache was created. */
+    std::uint64_t getHits ()
+    {
+        lock_guard lock (m_mutex);
+        return m_hits;
+    }
+
     float getHitRate ()
     {
         lock_guard lock (m_mutex);
@@ -159,14 +242,16 @@ public:
     {
         lock_guard lock (m_mutex);
         m_cache.clear ();
+        m_probation.clear ();
         m_cache_count = 0;
+        m_bytes = 0;
+        m_probation_bytes = 0;
     }
 
     void sweep ()
     {
         int cacheRemovals = 0;
         int mapRemovals = 0;
-        int cc = 0;
 
         // Keep references to all the stuff we sweep
         // so that we can destroy them outside the lock.
@@ -175,74 +260,22 @@ public:
     
         {
             clock_type::time_point const now (m_clock.now());
-            clock_type::time_point when_expire;
 
             lock_guard lock (m_mutex);
 
-            if (m_target_size == 0 ||
-                (static_cast<int> (m_cache.size ()) <= m_target_size))
-            {
-                when_expire = now - m_target_age;
-            }
-            else
-            {
-                when_expire = now - clock_type::duration (
-                    m_target_age.count() * m_target_size / m_cache.size ());
-
-                clock_type::duration const minimumAge (
-                    std::chrono::seconds (1));
-                if (when_expire > (now - minimumAge))
-                    when_expire = now - minimumAge;
-
-                if (m_journal.trace) m_journal.trace <<
-                    m_name << " is growing fast " << m_cache.size () << " of " << m_target_size <<
-                        " aging at " << (now - when_expire) << " of " << m_target_age;
-            }
+            clock_type::time_point const when_expire (expiration (now));
 
             stuffToSweep.reserve (m_cache.size ());
 
             cache_iterator cit = m_cache.begin ();
 
             while (cit != m_cache.end ())
-            {
-                if (cit->second.isWeak ())
-                {
-                    // weak
-                    if (cit->second.isExpired ())
-                    {
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        ++cit;
-                    }
-                }
-                else if (cit->second.last_access <= when_expire)
-                {
-                    // strong, expired
-                    --m_cache_count;
-                    ++cacheRemovals;
-                    if (cit->second.ptr.unique ())
-                    {
-                        stuffToSweep.push_back (cit->second.ptr);
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        // remains weakly cached
-                        cit->second.ptr.reset ();
-                        ++cit;
-                    }
-                }
-                else
-                {
-                    // strong, not expired
-                    ++cc;
-                    ++cit;
-                }
-            }
+                cit = sweepEntry (cit, now, when_expire,
+                    stuffToSweep, cacheRemovals, mapRemovals);
+
+            // A full sweep also completes any partial pass
+            m_sweep_bucket = 0;
+            pruneProbation ();
         }
 
         if (m_journal.trace && (mapRemovals || cacheRemovals)) m_journal.trace <<
@@ -253,6 +286,65 @@ public:
         // and decrement the reference count on each strong pointer.
     }
 
+    /** Sweep part of the cache.
+        Each call resumes where the previous one stopped, so a series of
+        calls covers the whole cache while holding the lock only briefly.
+        Objects moved by a rehash during a pass may wait for the next pass.
+        @param limit The number of objects to examine, at least one bucket
+                     is always visited.
+        @return `true` if this call completed a pass over the cache.
+    */
+    bool sweep (std::size_t limit)
+    {
+        int cacheRemovals = 0;
+        int mapRemovals = 0;
+        bool done;
+
+        std::vector <mapped_ptr> stuffToSweep;
+        std::vector <key_type> keys;
+
+        {
+            clock_type::time_point const now (m_clock.now());
+
+            lock_guard lock (m_mutex);
+
+            clock_type::time_point const when_expire (expiration (now));
+            std::size_t const buckets (m_cache.bucket_count ());
+            std::size_t examined (0);
+
+            while ((m_sweep_bucket < buckets) && (examined < limit))
+            {
+                // Erasing invalidates the bucket iterators, so visit by key
+                keys.clear ();
+                for (auto iter = m_cache.begin (m_sweep_bucket);
+                    iter != m_cache.end (m_sweep_bucket); ++iter)
+                    keys.push_back (iter->first);
+                ++m_sweep_bucket;
+
+                for (auto const& key : keys)
+                    sweepEntry (m_cache.find (key), now, when_expire,
+                        stuffToSweep, cacheRemovals, mapRemovals);
+
+                // Empty buckets count so that sparse tables make progress
+                examined += keys.size () + 1;
+            }
+
+            done = (m_sweep_bucket >= buckets);
+
+            if (done)
+            {
+                m_sweep_bucket = 0;
+                pruneProbation ();
+            }
+        }
+
+        if (m_journal.trace && (mapRemovals || cacheRemovals)) m_journal.trace <<
+            m_name << ": partial sweep cache-=" << cacheRemovals <<
+                ", map-=" << mapRemovals;
+
+        return done;
+    }
+
     bool del (const key_type& key, bool valid)
     {
         // Remove from cache, if !valid, remove from map too. Returns true if removed from cache
@@ -269,6 +361,7 @@ public:
 
         if (entry.isCached ())
         {
+            discharge (entry);
             --m_cache_count;
             entry.ptr.reset ();
             ret = true;
@@ -297,14 +390,20 @@ public:
     {
         // Return canonical value, store if needed, refresh in cache
         // Return values: true=we had the data already
+
+        // Objects evicted to make room are released outside the lock.
+        std::vector <mapped_ptr> evicted;
+
         lock_guard lock (m_mutex);
 
         cache_iterator cit = m_cache.find (key);
 
         if (cit == m_cache.end ())
         {
-            m_cache.insert (cache_pair (key, Entry (m_clock.now(), data)));
+            cit = m_cache.insert (cache_pair (key, Entry (m_clock.now(), data))).first;
             ++m_cache_count;
+            admit (cit);
+            evict (evicted);
             return false;
         }
 
@@ -313,10 +412,15 @@ public:
 
         if (entry.isCached ())
         {
+            promote (entry);
+
             if (replace)
             {
+                discharge (entry);
                 entry.ptr = data;
                 entry.weak_ptr = data;
+                charge (entry);
+                evict (evicted);
             }
             else
             {
@@ -342,12 +446,17 @@ public:
             }
 
             ++m_cache_count;
+            entry.probation = false;
+            charge (entry);
+            evict (evicted);
             return true;
         }
 
         entry.ptr = data;
         entry.weak_ptr = data;
         ++m_cache_count;
+        admit (cit);
+        evict (evicted);
 
         return false;
     }
@@ -371,6 +480,7 @@ public:
         if (entry.isCached ())
         {
             ++m_hits;
+            promote (entry);
             return entry.ptr;
         }
 
@@ -380,6 +490,8 @@ public:
         {
             // independent of cache size, so not counted as a hit
             ++m_cache_count;
+            entry.probation = false;
+            charge (entry);
             return entry.ptr;
         }
 
@@ -443,6 +555,8 @@ public:
                 {
                     // We just put the object back in cache
                     ++m_cache_count;
+                    entry.probation = false;
+                    charge (entry);
                     entry.touch (m_clock.now());
                     found = true;
                 }
@@ -456,6 +570,7 @@ public:
             else
             {
                 // It's cached so update the timer
+                promote (entry);
                 entry.touch (m_clock.now());
                 found = true;
             }
@@ -473,10 +588,73 @@ public:
         return m_mutex;
     }
 
+    /** Return the keys of the most recently used objects.
+        Objects still on probation, which were not used again since they
+        were admitted, are left out.
+        @param limit The largest number of keys to return.
+        @param predicate Called with the lock held to choose the objects.
+    */
+    template <class Predicate>
+    std::vector <key_type> getHotKeys (std::size_t limit, Predicate predicate) const
+    {
+        typedef std::pair <clock_type::time_point, key_type> hot_entry;
+        std::vector <hot_entry> entries;
+
+        {
+            lock_guard lock (m_mutex);
+            entries.reserve (m_cache_count);
+
+            for (auto const& item : m_cache)
+            {
+                Entry const& entry (item.second);
+                if (entry.isCached () && ! entry.probation && predicate (*entry.ptr))
+                    entries.push_back (hot_entry (entry.last_access, item.first));
+            }
+        }
+
+        if (entries.size () > limit)
+        {
+            std::nth_element (entries.begin (), entries.begin () + limit,
+                entries.end (), [] (hot_entry const& lhs, hot_entry const& rhs)
+                {
+                    return lhs.first > rhs.first;
+                });
+            entries.resize (limit);
+        }
+
+        std::vector <key_type> keys;
+        keys.reserve (entries.size ());
+        for (auto const& entry : entries)
+            keys.push_back (entry.second);
+        return keys;
+    }
+
+    std::vector <key_type> getHotKeys (std::size_t limit) const
+    {
+        return getHotKeys (limit, [] (mapped_type const&) { return true; });
+    }
+
 private:
     void collect_metrics ()
     {
         m_stats.size.set (getCacheSize ());
+        m_stats.bytes.set (getCacheBytes ());
+
+        {
+            std::uint64_t hits, misses, evictions;
+            {
+                lock_guard lock (m_mutex);
+                hits = m_hits - m_reported_hits;
+                misses = m_misses - m_reported_misses;
+                evictions = m_evictions - m_reported_evictions;
+                m_reported_hits = m_hits;
+                m_reported_misses = m_misses;
+                m_reported_evictions = m_evictions;
+            }
+            m_stats.hits.increment (hits);
+            m_stats.misses.increment (misses);
+            m_stats.evictions.increment (evictions);
+        }
 
         {
             beast::insight::Gauge::value_type hit_rate (0);
@@ -498,12 +676,20 @@ private:
             beast::insight::Collector::ptr const& collector)
             : hook (collector->make_hook (handler))
             , size (collector->make_gauge (prefix, "size"))
+            , bytes (collector->make_gauge (prefix, "bytes"))
             , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            , hits (collector->make_counter (prefix, "hits"))
+            , misses (collector->make_counter (prefix, "misses"))
+            , evictions (collector->make_counter (prefix, "evictions"))
             { }
 
         beast::insight::Hook hook;
         beast::insight::Gauge size;
+        beast::insight::Gauge bytes;
         beast::insight::Gauge hit_rate;
+        beast::insight::Counter hits;
+        beast::insight::Counter misses;
+        beast::insight::Counter evictions;
     };
 
     class Entry
@@ -513,11 +699,21 @@ private:
         weak_mapped_ptr weak_ptr;
         clock_type::time_point last_access;
 
+        // Estimated memory charged to the cache while strongly cached
+        std::size_t bytes;
+
+        // Not yet accessed since it was admitted
+        bool probation;
+        std::uint64_t serial;
+
         Entry (clock_type::time_point const& last_access_,
             mapped_ptr const& ptr_)
             : ptr (ptr_)
             , weak_ptr (ptr_)
             , last_access (last_access_)
+            , bytes (0)
+            , probation (false)
+            , serial (0)
         {
         }
 
@@ -531,6 +727,195 @@ private:
     typedef std::pair <key_type, Entry> cache_pair;
     typedef ripple::unordered_map <key_type, Entry, Hash, KeyEqual> cache_type;
     typedef typename cache_type::iterator cache_iterator;
+    typedef std::pair <key_type, std::uint64_t> probation_entry;
+
+    enum
+    {
+        // Fraction of the byte budget that probationary objects may use
+        probationDivider = 4,
+
+        // Probationary objects expire this much sooner when sweeping
+        probationAgeDivider = 4
+    };
+
+    // Add the weight of a newly cached object to the totals.
+    void charge (Entry& entry)
+    {
+        entry.bytes = m_weigher ? m_weigher (*entry.ptr) : 0;
+        m_bytes += entry.bytes;
+        if (entry.probation)
+            m_probation_bytes += entry.bytes;
+    }
+
+    // Remove the weight of an object that is leaving the cache.
+    void discharge (Entry& entry)
+    {
+        m_bytes -= entry.bytes;
+        if (entry.probation)
+            m_probation_bytes -= entry.bytes;
+        entry.bytes = 0;
+        entry.probation = false;
+    }
+
+    // A newly cached object starts on probation when there is a budget.
+    void admit (cache_iterator cit)
+    {
+        Entry& entry (cit->second);
+        entry.probation = (m_target_bytes != 0);
+        charge (entry);
+
+        if (entry.probation)
+        {
+            entry.serial = ++m_serial;
+            m_probation.push_back (probation_entry (cit->first, entry.serial));
+        }
+    }
+
+    // A second access moves an object out of probation.
+    void promote (Entry& entry)
+    {
+        if (entry.probation)
+        {
+            m_probation_bytes -= entry.bytes;
+            entry.probation = false;
+        }
+    }
+
+    // The last access time before which objects are swept. This shortens
+    // the target age when the cache is over its budget.
+    clock_type::time_point expiration (clock_type::time_point const& now)
+    {
+        clock_type::time_point when_expire;
+
+        if (m_target_bytes != 0)
+        {
+            if (m_bytes <= m_target_bytes)
+            {
+                when_expire = now - m_target_age;
+            }
+            else
+            {
+                when_expire = now - clock_type::duration (static_cast <clock_type::rep> (
+                    m_target_age.count() * (static_cast <double> (m_target_bytes) / m_bytes)));
+
+                clock_type::duration const minimumAge (
+                    std::chrono::seconds (1));
+                if (when_expire > (now - minimumAge))
+                    when_expire = now - minimumAge;
+
+                if (m_journal.trace) m_journal.trace <<
+                    m_name << " is over budget " << m_bytes << " of " << m_target_bytes <<
+                        " bytes aging at " << (now - when_expire) << " of " << m_target_age;
+            }
+        }
+        else if (m_target_size == 0 ||
+            (static_cast<int> (m_cache.size ()) <= m_target_size))
+        {
+            when_expire = now - m_target_age;
+        }
+        else
+        {
+            when_expire = now - clock_type::duration (
+                m_target_age.count() * m_target_size / m_cache.size ());
+
+            clock_type::duration const minimumAge (
+                std::chrono::seconds (1));
+            if (when_expire > (now - minimumAge))
+                when_expire = now - minimumAge;
+
+            if (m_journal.trace) m_journal.trace <<
+                m_name << " is growing fast " << m_cache.size () << " of " << m_target_size <<
+                    " aging at " << (now - when_expire) << " of " << m_target_age;
+        }
+
+        return when_expire;
+    }
+
+    // Expire one object, returning the position after it.
+    cache_iterator sweepEntry (cache_iterator cit,
+        clock_type::time_point const& now, clock_type::time_point const& when_expire,
+            std::vector <mapped_ptr>& stuffToSweep, int& cacheRemovals, int& mapRemovals)
+    {
+        if (cit->second.isWeak ())
+        {
+            // weak
+            if (cit->second.isExpired ())
+            {
+                ++mapRemovals;
+                return m_cache.erase (cit);
+            }
+        }
+        else if ((cit->second.last_access <= when_expire) ||
+            (cit->second.probation && (cit->second.last_access <=
+                now - (now - when_expire) / probationAgeDivider)))
+        {
+            // strong, expired
+            discharge (cit->second);
+            --m_cache_count;
+            ++cacheRemovals;
+            if (cit->second.ptr.unique ())
+            {
+                stuffToSweep.push_back (cit->second.ptr);
+                ++mapRemovals;
+                return m_cache.erase (cit);
+            }
+
+            // remains weakly cached
+            cit->second.ptr.reset ();
+        }
+
+        return ++cit;
+    }
+
+    // Forget probationary entries that were promoted or removed.
+    void pruneProbation ()
+    {
+        m_probation.erase (std::remove_if (m_probation.begin (), m_probation.end (),
+            [this] (probation_entry const& p)
+            {
+                return findProbationary (p) == m_cache.end ();
+            }), m_probation.end ());
+    }
+
+    cache_iterator findProbationary (probation_entry const& p)
+    {
+        cache_iterator cit = m_cache.find (p.first);
+
+        if ((cit != m_cache.end ()) && cit->second.isCached () &&
+            cit->second.probation && (cit->second.serial == p.second))
+            return cit;
+
+        return m_cache.end ();
+    }
+
+    // Drop the oldest probationary objects while over budget. The strong
+    // pointers are handed back so the caller can release them unlocked.
+    void evict (std::vector <mapped_ptr>& evicted)
+    {
+        if (m_target_bytes == 0)
+            return;
+
+        while (!m_probation.empty () &&
+            ((m_bytes > m_target_bytes) ||
+                (m_probation_bytes > (m_target_bytes / probationDivider))))
+        {
+            cache_iterator cit = findProbationary (m_probation.front ());
+            m_probation.pop_front ();
+
+            if (cit != m_cache.end ())
+            {
+                Entry& entry = cit->second;
+                discharge (entry);
+                --m_cache_count;
+                ++m_evictions;
+                evicted.push_back (entry.ptr);
+                entry.ptr.reset ();
+
+                if (evicted.back ().unique ())
+                    m_cache.erase (cit);
+            }
+        }
+    }
 
     beast::Journal m_journal;
     clock_type& m_clock;
@@ -547,11 +932,32 @@ private:
     // Desired maximum cache age
     clock_type::duration m_target_age;
 
+    // Desired memory used by cached objects (0 = ignore)
+    std::size_t m_target_bytes;
+    weigher_type m_weigher;
+
     // Number of items cached
     int m_cache_count;
     cache_type m_cache;  // Hold strong reference to recent objects
+
+    // Estimated memory used by all cached and by probationary objects
+    std::size_t m_bytes;
+    std::size_t m_probation_bytes;
+
+    // Probationary objects in the order they were admitted. Entries that
+    // were promoted or removed since are skipped using the serial number.
+    std::deque <probation_entry> m_probation;
+    std::uint64_t m_serial;
+
+    // The next bucket to visit in a partial sweep
+    std::size_t m_sweep_bucket;
+
     std::uint64_t m_hits;
     std::uint64_t m_misses;
+    std::uint64_t m_evictions;
+    std::uint64_t m_reported_hits;
+    std::uint64_t m_reported_misses;
+    std::uint64_t m_reported_evictions;
 };
 
 }
@@ -0,0 +1,279 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../MemoryGovernor.h"
+
+#include "../../../beast/beast/unit_test/suite.h"
+#include "../../../beast/beast/chrono/manual_clock.h"
+
+namespace ripple {
+
+MemoryGovernor::Item::Item (std::string const& name_,
+    std::unique_ptr <Cache> cache_, int weight_)
+    : name (name_)
+    , cache (std::move (cache_))
+    , weight (weight_)
+    , hits (0)
+    , value (0)
+    , targetBytes (0)
+    , passes (0)
+    , swept (true)
+{
+}
+
+MemoryGovernor::MemoryGovernor (beast::Journal journal)
+    : m_journal (journal)
+    , m_budget (0)
+{
+}
+
+void MemoryGovernor::setBudget (std::size_t bytes)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    m_budget = bytes;
+}
+
+std::size_t MemoryGovernor::getBudget ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    return m_budget;
+}
+
+void MemoryGovernor::add (std::string const& name,
+    std::unique_ptr <Cache> cache, int weight)
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    std::unique_ptr <Item> item (new Item (name, std::move (cache),
+        std::max (weight, 1)));
+    item->hits = item->cache->getHits ();
+    m_items.push_back (std::move (item));
+}
+
+void MemoryGovernor::rebalance ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    if (m_items.empty ())
+        return;
+
+    double totalValue (0);
+
+    for (auto const& item : m_items)
+    {
+        std::uint64_t const hits (item->cache->getHits ());
+        double const value (static_cast <double> (
+            item->weight) * (hits - item->hits));
+        item->hits = hits;
+        item->value += (value - item->value) / valueSmoothing;
+        totalValue += item->value;
+        item->swept = false;
+    }
+
+    // A zero budget leaves the caches limited by their target size
+    if (m_budget == 0)
+        return;
+
+    std::size_t const count (m_items.size ());
+    std::size_t const minimum (m_budget / (minimumShareDivider * count));
+    std::size_t const shared (m_budget - (minimum * count));
+
+    for (auto const& item : m_items)
+    {
+        std::size_t share;
+
+        if (totalValue > 0)
+            share = static_cast <std::size_t> (
+                shared * (item->value / totalValue));
+        else
+            share = shared / count;
+
+        item->targetBytes = minimum + share;
+        item->cache->setTargetBytes (item->targetBytes);
+
+        if (m_journal.debug) m_journal.debug <<
+            item->name << " given " << item->targetBytes << " of " <<
+                m_budget << " bytes using " << item->cache->getCacheBytes ();
+    }
+}
+
+bool MemoryGovernor::sweep (std::chrono::milliseconds slice)
+{
+    clock_type::time_point const deadline (clock_type::now () + slice);
+
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    for (;;)
+    {
+        bool pending (false);
+
+        // Visit the caches in turn so that each one makes progress
+        for (auto const& item : m_items)
+        {
+            if (item->swept)
+                continue;
+
+            if (item->cache->sweep (sweepBatch))
+            {
+                item->swept = true;
+                ++item->passes;
+            }
+            else
+            {
+                pending = true;
+            }
+
+            if (pending && (clock_type::now () >= deadline))
+                return false;
+        }
+
+        if (! pending)
+            return true;
+    }
+}
+
+Json::Value MemoryGovernor::getJson ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    Json::Value ret (Json::objectValue);
+    std::size_t total (0);
+
+    for (auto const& item : m_items)
+    {
+        std::size_t const bytes (item->cache->getCacheBytes ());
+        Json::Value& entry (ret["caches"][item->name]);
+        entry["bytes"] = static_cast <Json::UInt> (bytes);
+        entry["target_bytes"] = static_cast <Json::UInt> (item->targetBytes);
+        entry["hit_value"] = item->value;
+        entry["passes"] = static_cast <Json::UInt> (item->passes);
+        total += bytes;
+    }
+
+    ret["bytes"] = static_cast <Json::UInt> (total);
+    ret["budget"] = static_cast <Json::UInt> (m_budget);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+
+class MemoryGovernor_test : public beast::unit_test::suite
+{
+public:
+    typedef std::string Value;
+    typedef TaggedCache <int, Value> Cache;
+
+    static std::size_t weigh (Value const& v)
+    {
+        return v.size ();
+    }
+
+    void testRebalance ()
+    {
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        Cache busy ("busy", 0, 60, clock, j);
+        Cache idle ("idle", 0, 60, clock, j);
+
+        MemoryGovernor governor (j);
+        governor.setBudget (8000);
+        governor.add ("busy", busy, &weigh);
+        governor.add ("idle", idle, &weigh);
+
+        // Without any hits the budget is split evenly
+        governor.rebalance ();
+        expect (busy.getTargetBytes () == 4000);
+        expect (idle.getTargetBytes () == 4000);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            busy.insert (i, Value (10, 'b'));
+            idle.insert (i, Value (10, 'i'));
+        }
+
+        for (int n = 0; n < 10; ++n)
+            for (int i = 0; i < 10; ++i)
+                busy.fetch (i);
+
+        // The cache with the hits gets all but the minimum share
+        governor.rebalance ();
+        expect (busy.getTargetBytes () == 7000);
+        expect (idle.getTargetBytes () == 1000);
+
+        Json::Value const json (governor.getJson ());
+        expect (json["budget"].asUInt () == 8000);
+        expect (json["bytes"].asUInt () == 200);
+        expect (json["caches"]["busy"]["target_bytes"].asUInt () == 7000);
+    }
+
+    void testSweep ()
+    {
+        beast::Journal const j;
+        beast::manual_clock <std::chrono::seconds> clock;
+        clock.set (0);
+
+        Cache a ("a", 0, 60, clock, j);
+        Cache b ("b", 0, 60, clock, j);
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            a.insert (i, Value (1, 'a'));
+            b.insert (i, Value (1, 'b'));
+        }
+
+        // Partial sweeps of one cache cover it in several calls
+        {
+            ++clock;
+            int calls (1);
+            while (! a.sweep (100))
+                ++calls;
+            expect (calls > 10);
+            expect (a.getCacheSize () == 2000);
+        }
+
+        MemoryGovernor governor (j);
+        governor.add ("a", a, &weigh);
+        governor.add ("b", b, &weigh);
+
+        // Nothing to do until a pass is started
+        expect (governor.sweep (std::chrono::milliseconds (0)));
+
+        clock.set (120);
+        governor.rebalance ();
+        while (! governor.sweep (std::chrono::milliseconds (0)))
+            ;
+        expect (a.getCacheSize () == 0);
+        expect (b.getCacheSize () == 0);
+        expect (a.getTrackSize () == 0);
+        expect (b.getTrackSize () == 0);
+        expect (governor.getJson ()["caches"]["a"]["passes"].asUInt () == 1);
+    }
+
+    void run ()
+    {
+        testRebalance ();
+        testSweep ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MemoryGovernor,common,ripple);
+
+}
@@ -143,6 +143,59 @@ public:
             expect (c.getCacheSize() == 0);
             expect (c.getTrackSize() == 0);
         }
+
+        // With a byte budget, objects seen only once are evicted before
+        // objects that were used again, so a scan keeps the working set.
+        {
+            Cache b ("bytes", 0, 60, clock, j);
+            b.setTargetBytes (400, [](Value const& v) { return v.size (); });
+
+            // A working set of ten objects, each used twice
+            for (int i = 0; i < 10; ++i)
+            {
+                expect (! b.insert (i, std::string (10, 'w')));
+                expect (b.fetch (i) != nullptr);
+            }
+            expect (b.getCacheBytes () == 100);
+
+            // A scan over a hundred objects, each used once
+            for (int i = 100; i < 200; ++i)
+                expect (! b.insert (i, std::string (10, 's')));
+
+            // Only a quarter of the budget is left to probation
+            expect (b.getCacheBytes () == 200);
+            expect (b.getEvictions () == 90);
+            expect (b.getCacheSize () == 20);
+
+            for (int i = 0; i < 10; ++i)
+                expect (b.fetch (i) != nullptr);
+            expect (b.fetch (100) == nullptr);
+            expect (b.fetch (199) != nullptr);
+        }
+
+        // The hot keys are those of the objects used most recently,
+        // leaving out objects used only once.
+        {
+            Cache h ("hot", 0, 60, clock, j);
+            h.setTargetBytes (400, [](Value const& v) { return v.size (); });
+
+            for (int i = 0; i < 5; ++i)
+            {
+                expect (! h.insert (i, std::string (i + 1, 'h')));
+                ++clock;
+                expect (h.fetch (i) != nullptr);
+            }
+            expect (! h.insert (10, "once"));
+
+            std::vector <Key> keys (h.getHotKeys (3));
+            std::sort (keys.begin (), keys.end ());
+            expect (keys == std::vector <Key> ({2, 3, 4}));
+            expect (h.getHotKeys (100).size () == 5);
+
+            keys = h.getHotKeys (100, [](Value const& v) { return v.size () < 3; });
+            std::sort (keys.begin (), keys.end ());
+            expect (keys == std::vector <Key> ({0, 1}));
+        }
     }
 };
 
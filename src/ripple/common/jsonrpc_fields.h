@@ -27,10 +27,12 @@ namespace jss {
 
 // JSON static strings
 
-#define JSS(x) const Json::StaticString x ( #x )
+#define JSS(x) const Json::StaticString x ( Json::internMemberName ( #x ) )
 
 /* The "StaticString" field names are used instead of string literals to
    optimize the performance of accessing members of Json::Value objects.
+   They are also interned, so members with these names given as ordinary
+   strings, for example by the reader, don't hold copies of them.
 */
 // VFALCO NOTE Some of these are part of the JSON-RPC API and some aren't
 //        TODO Move the string not part of the JSON-RPC API into another file
@@ -115,6 +117,7 @@ JSS ( peer );
 JSS ( peer_authorized );
 JSS ( peer_index );
 JSS ( peers );
+JSS ( pending );
 JSS ( proposed );
 JSS ( proposers );
 JSS ( pubkey_node );
@@ -123,6 +126,7 @@ JSS ( published_ledger );
 JSS ( quality );
 JSS ( quality_in );
 JSS ( quality_out );
+JSS ( queued );
 JSS ( random );
 JSS ( raw_meta );
 JSS ( request );
@@ -162,6 +166,7 @@ JSS ( validated_ledgers );
 JSS ( validation_quorum );
 JSS ( value );
 JSS ( waiting );
+JSS ( warm_up );
 JSS ( warning );
 
 #undef JSS
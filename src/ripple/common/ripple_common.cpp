@@ -21,6 +21,7 @@
 
 #include "impl/KeyCache.cpp"
 #include "impl/TaggedCache.cpp"
+#include "impl/MemoryGovernor.cpp"
 #include "impl/ResolverAsio.cpp"
 #include "impl/MultiSocket.cpp"
 #include "impl/RippleSSLContext.cpp"
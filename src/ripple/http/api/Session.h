@@ -20,6 +20,7 @@
 #ifndef RIPPLE_HTTP_SESSION_H_INCLUDED
 #define RIPPLE_HTTP_SESSION_H_INCLUDED
 
+#include <chrono>
 #include <ostream>
 
 namespace ripple {
@@ -82,6 +83,14 @@ public:
     virtual void write (void const* buffer, std::size_t bytes) = 0;
     /** @} */
 
+    /** Wait until at most the given amount of written data remains unsent.
+        This lets a large response be produced in pieces without queueing
+        all of it. It must not be called from an io_service thread.
+        @return `false` if the data was not sent within the timeout.
+    */
+    virtual bool waitForWrites (std::size_t bytes,
+        std::chrono::milliseconds timeout) = 0;
+
     /** Output support using ostream. */
     /** @{ */
     ScopedStream operator<< (std::ostream& manip (std::ostream&))
@@ -20,7 +20,9 @@
 #ifndef RIPPLE_HTTP_PEER_H_INCLUDED
 #define RIPPLE_HTTP_PEER_H_INCLUDED
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
 #include "../../ripple/common/MultiSocket.h"
 
@@ -65,6 +67,9 @@ public:
     beast::MemoryBlock m_buffer;
     beast::HTTPRequestParser m_parser;
     int m_writesPending;
+    std::mutex m_queuedMutex;
+    std::condition_variable m_queuedCond;
+    std::size_t m_bytesQueued;
     bool m_closed;
     bool m_callClose;
     beast::SharedPtr <Peer> m_detach_ref;
@@ -81,6 +86,7 @@ public:
         , m_request_timer (m_impl.get_io_service())
         , m_buffer (bufferSize)
         , m_writesPending (0)
+        , m_bytesQueued (0)
         , m_closed (false)
         , m_callClose (false)
         , m_errorCode (0)
@@ -159,6 +165,11 @@ public:
     // Send a copy of the data.
     void write (void const* buffer, std::size_t bytes)
     {
+        {
+            std::lock_guard <std::mutex> lock (m_queuedMutex);
+            m_bytesQueued += bytes;
+        }
+
         // Make sure this happens on an io_service thread.
         m_impl.get_io_service().dispatch (m_strand.wrap (
             boost::bind (&Peer::handle_write, Ptr (this),
@@ -166,6 +177,13 @@ public:
                     CompletionCounter (this))));
     }
 
+    bool waitForWrites (std::size_t bytes, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock <std::mutex> lock (m_queuedMutex);
+        return m_queuedCond.wait_for (lock, timeout,
+            [&] { return m_bytesQueued <= bytes; });
+    }
+
     // Make the Session asynchronous
     void detach ()
     {
@@ -306,6 +324,12 @@ public:
     void handle_write (error_code ec, std::size_t bytes_transferred,
         SharedBuffer buf, CompletionCounter)
     {
+        {
+            std::lock_guard <std::mutex> lock (m_queuedMutex);
+            m_bytesQueued -= buf->size ();
+        }
+        m_queuedCond.notify_all ();
+
         if (ec == boost::asio::error::operation_aborted)
             return;
 
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_JSON_JSONPARSER_H_INCLUDED
+#define RIPPLE_JSON_JSONPARSER_H_INCLUDED
+
+namespace Json {
+
+/** Parses JSON text directly into a Value.
+
+    This is the parser for requests arriving over RPC and websockets. It
+    makes one pass over the caller's buffer without copying it, and builds
+    the Value in place instead of through a stack of tokens. Member names
+    that are interned resolve without allocating.
+
+    Only standard JSON is accepted: no comments, and nothing but white
+    space after the root value. A member name may not appear twice in
+    the same object. Documents that are larger or more deeply nested than
+    the limits are refused before any work is done on the excess.
+*/
+class Parser
+{
+public:
+    /** The defaults suit RPC requests. */
+    explicit Parser (std::size_t maxSize = 1000000, int maxDepth = 64);
+
+    /** Parse a complete document.
+        @return `true` on success. On failure the contents of root are
+                unspecified and error() describes the problem.
+    */
+    /** @{ */
+    bool parse (char const* begin, char const* end, Value& root);
+
+    bool parse (std::string const& document, Value& root)
+    {
+        return parse (document.data (),
+            document.data () + document.size (), root);
+    }
+    /** @} */
+
+    /** Describes why the last parse failed, or is empty if it did not. */
+    std::string const& error () const
+    {
+        return m_error;
+    }
+
+private:
+    bool fail (char const* message);
+    void skipSpaces ();
+    bool readValue (Value& value);
+    bool readObject (Value& value);
+    bool readArray (Value& value);
+    bool readString (Value& value);
+    bool readName ();
+    bool readNumber (Value& value);
+    bool match (char const* literal, std::size_t length);
+    bool decodeString (char const* first, char const* last, std::string& out);
+
+    std::size_t const m_maxSize;
+    int const m_maxDepth;
+    char const* m_begin;
+    char const* m_end;
+    char const* m_current;
+    int m_depth;
+    std::string m_name;         // member name or escaped string being read
+    std::string m_error;
+};
+
+} // Json
+
+#endif
@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_JSON_JSONSTREAM_H_INCLUDED
+#define RIPPLE_JSON_JSONSTREAM_H_INCLUDED
+
+namespace Json {
+
+/** Writes JSON text incrementally.
+
+    Producers emit a document piece by piece instead of building a Value
+    tree for all of it. The text is collected in a buffer of bounded size
+    which is handed to a Sink whenever it fills, so neither the tree nor
+    the complete text needs to exist in memory. For the same document the
+    text is identical to what FastWriter produces, without the trailing
+    newline.
+
+    Members of an object are written in the order given. Value subtrees
+    written with set or append are serialized like FastWriter does.
+*/
+class Stream
+{
+public:
+    /** Receives the text. */
+    class Sink
+    {
+    public:
+        virtual ~Sink () { }
+        virtual void write (char const* data, std::size_t bytes) = 0;
+    };
+
+    explicit Stream (Sink& sink, std::size_t bufferSize = 64 * 1024);
+
+    /** Flushes the buffered text, unless an exception is propagating. */
+    ~Stream ();
+
+    /** Begin an object or array.
+        Without a key the new container is the root, or an element of the
+        enclosing array. With a key it is a member of the enclosing object.
+    */
+    /** @{ */
+    void startObject ();
+    void startObject (char const* key);
+    void startArray ();
+    void startArray (char const* key);
+    /** @} */
+
+    /** End the innermost object or array. */
+    void end ();
+
+    /** Write a member of the enclosing object. */
+    void set (char const* key, Value const& value);
+
+    void set (std::string const& key, Value const& value)
+    {
+        set (key.c_str (), value);
+    }
+
+    /** Write an element of the enclosing array, or the root value. */
+    void append (Value const& value);
+
+    /** Pass all buffered text to the sink. */
+    void flush ();
+
+    /** Returns the number of bytes written so far. */
+    std::uint64_t size () const
+    {
+        return m_size;
+    }
+
+private:
+    void separator ();
+    void name (char const* key);
+    void start (char open);
+    void put (char c);
+    void put (char const* data, std::size_t bytes);
+    void put (std::string const& s);
+    void putValue (Value const& value);
+
+    Sink& m_sink;
+    std::size_t const m_bufferSize;
+    std::string m_buffer;
+    std::uint64_t m_size;
+
+    // For each open container, whether it is an object and whether
+    // anything has been written into it yet.
+    struct Level
+    {
+        bool object;
+        bool empty;
+    };
+    std::vector <Level> m_levels;
+};
+
+//------------------------------------------------------------------------------
+
+/** A Stream::Sink that appends to a string. */
+class StringSink : public Stream::Sink
+{
+public:
+    explicit StringSink (std::string& s)
+        : m_string (s)
+    {
+    }
+
+    void write (char const* data, std::size_t bytes)
+    {
+        m_string.append (data, bytes);
+    }
+
+private:
+    std::string& m_string;
+};
+
+} // Json
+
+#endif
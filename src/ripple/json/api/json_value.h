@@ -88,6 +88,18 @@ private:
     const char* str_;
 };
 
+/** Register a member name which is used often.
+
+    Object members whose name equals a registered string refer to it
+    instead of holding their own copy of the name. The string must remain
+    valid for the rest of the program, a string literal for example.
+    Registering is thread safe; once the table is full further names are
+    ignored.
+
+    @return The string passed in, so it can initialize a StaticString.
+*/
+const char* internMemberName ( const char* name );
+
 /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
  *
  * This class is a discriminated union wrapper that can represents a:
@@ -150,8 +162,10 @@ private:
         CZString ( int index );
         CZString ( const char* cstr, DuplicationPolicy allocate );
         CZString ( const CZString& other );
+        CZString ( CZString&& other ) noexcept;
         ~CZString ();
         CZString& operator = ( const CZString& other );
+        CZString& operator = ( CZString&& other );
         bool operator< ( const CZString& other ) const;
         bool operator== ( const CZString& other ) const;
         int index () const;
@@ -164,11 +178,87 @@ private:
     };
 
 public:
-#  ifndef JSON_USE_CPPTL_SMALLMAP
-    typedef std::map<CZString, Value> ObjectValues;
-#  else
-    typedef CppTL::SmallMap<CZString, Value> ObjectValues;
-#  endif // ifndef JSON_USE_CPPTL_SMALLMAP
+    /** The elements of an array or the members of an object.
+
+        Entries are kept sorted by key in a vector, which is searched by
+        bisection. The values are allocated from blocks that never move,
+        so a reference to an element stays valid while others are added
+        or removed, as it did when this was a std::map.
+    */
+    class ObjectValues
+    {
+    public:
+        struct Entry
+        {
+            CZString key;
+            Value* value;
+        };
+
+        typedef std::vector<Entry> Entries;
+        typedef Entries::iterator iterator;
+        typedef Entries::const_iterator const_iterator;
+
+        ObjectValues ();
+        ObjectValues ( const ObjectValues& other );
+        ObjectValues& operator= ( const ObjectValues& other ) = delete;
+        ~ObjectValues ();
+
+        iterator begin ()
+        {
+            return entries_.begin ();
+        }
+
+        iterator end ()
+        {
+            return entries_.end ();
+        }
+
+        const_iterator begin () const
+        {
+            return entries_.begin ();
+        }
+
+        const_iterator end () const
+        {
+            return entries_.end ();
+        }
+
+        std::size_t size () const
+        {
+            return entries_.size ();
+        }
+
+        bool empty () const
+        {
+            return entries_.empty ();
+        }
+
+        void clear ();
+
+        iterator lower_bound ( const CZString& key );
+        iterator find ( const CZString& key );
+        const_iterator find ( const CZString& key ) const;
+
+        /// Insert a null value with the given key before position.
+        iterator insert ( iterator position, const CZString& key );
+
+        void erase ( iterator position );
+        void erase ( const CZString& key );
+
+        bool operator== ( const ObjectValues& other ) const;
+        bool operator< ( const ObjectValues& other ) const;
+
+    private:
+        struct Block;
+
+        void* allocate ();
+        void release ( Value* value );
+        void addBlock ( unsigned int size );
+
+        Entries entries_;
+        Block* blocks_;
+        void* free_;        // released values, linked through their storage
+    };
 # endif // ifndef JSON_VALUE_USE_INTERNAL_MAP
 #endif // ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
 
@@ -392,6 +482,10 @@ private:
     Value& resolveReference ( const char* key,
                               bool isStatic );
 
+    // Store a copy of a string, inside the Value when it is short enough.
+    void setString ( const char* value, unsigned int length );
+    const char* stringData () const;
+
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     inline bool isItemAvailable () const
     {
@@ -441,6 +535,7 @@ private:
         double real_;
         bool bool_;
         char* string_;
+        char chars_[sizeof (double)];   // a short string stored inline
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
         ValueInternalArray* array_;
         ValueInternalMap* map_;
@@ -450,6 +545,7 @@ private:
     } value_;
     ValueType type_ : 8;
     int allocated_ : 1;     // Notes: if declared as bool, bitfield is useless.
+    int inline_ : 1;        // the string is held in value_.chars_
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     unsigned int itemIsUsed_ : 1;      // used by the ValueInternalMap container.
     int memberNameIsStatic_ : 1;       // used by the ValueInternalMap container.
@@ -0,0 +1,498 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace Json {
+
+// Returns the first quote or backslash in [p, end), or end. Eight bytes
+// are tested at a time by looking for a zero byte in the word xor'ed
+// with each of the two characters.
+static char const* findStringDelimiter (char const* p, char const* end)
+{
+    std::uint64_t const ones (0x0101010101010101ULL);
+    std::uint64_t const highs (0x8080808080808080ULL);
+
+    while (end - p >= 8)
+    {
+        std::uint64_t word;
+        std::memcpy (&word, p, sizeof (word));
+
+        std::uint64_t const quote (word ^ (ones * '"'));
+        std::uint64_t const backslash (word ^ (ones * '\\'));
+
+        if ((((quote - ones) & ~quote) | ((backslash - ones) & ~backslash)) & highs)
+            break;
+
+        p += 8;
+    }
+
+    while (p != end && *p != '"' && *p != '\\')
+        ++p;
+
+    return p;
+}
+
+static int hexDigit (char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+
+Parser::Parser (std::size_t maxSize, int maxDepth)
+    : m_maxSize (maxSize)
+    , m_maxDepth (maxDepth)
+    , m_begin (nullptr)
+    , m_end (nullptr)
+    , m_current (nullptr)
+    , m_depth (0)
+{
+}
+
+bool Parser::parse (char const* begin, char const* end, Value& root)
+{
+    m_begin = begin;
+    m_end = end;
+    m_current = begin;
+    m_depth = 0;
+    m_error.clear ();
+
+    root = Value ();
+
+    if (std::size_t (end - begin) > m_maxSize)
+    {
+        m_current = begin + m_maxSize;
+        return fail ("Document too large");
+    }
+
+    if (! readValue (root))
+        return false;
+
+    skipSpaces ();
+
+    if (m_current != m_end)
+        return fail ("Unexpected text after the document");
+
+    return true;
+}
+
+bool Parser::fail (char const* message)
+{
+    std::stringstream ss;
+    ss << message << " at offset " << (m_current - m_begin);
+    m_error = ss.str ();
+    return false;
+}
+
+void Parser::skipSpaces ()
+{
+    while (m_current != m_end)
+    {
+        char const c (*m_current);
+
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            break;
+
+        ++m_current;
+    }
+}
+
+bool Parser::match (char const* literal, std::size_t length)
+{
+    if (std::size_t (m_end - m_current) < length ||
+        std::memcmp (m_current, literal, length) != 0)
+        return fail ("Invalid value");
+
+    m_current += length;
+    return true;
+}
+
+bool Parser::readValue (Value& value)
+{
+    skipSpaces ();
+
+    if (m_current == m_end)
+        return fail ("Value expected");
+
+    switch (*m_current)
+    {
+    case '{':
+        return readObject (value);
+
+    case '[':
+        return readArray (value);
+
+    case '"':
+        return readString (value);
+
+    case 't':
+        if (! match ("true", 4))
+            return false;
+        value = true;
+        return true;
+
+    case 'f':
+        if (! match ("false", 5))
+            return false;
+        value = false;
+        return true;
+
+    case 'n':
+        return match ("null", 4);
+
+    default:
+        return readNumber (value);
+    }
+}
+
+bool Parser::readObject (Value& value)
+{
+    if (++m_depth > m_maxDepth)
+        return fail ("Nesting too deep");
+
+    ++m_current;
+    value = Value (objectValue);
+    skipSpaces ();
+
+    if (m_current != m_end && *m_current == '}')
+    {
+        ++m_current;
+        --m_depth;
+        return true;
+    }
+
+    for (;;)
+    {
+        skipSpaces ();
+
+        if (m_current == m_end || *m_current != '"')
+            return fail ("Member name expected");
+
+        char const* const nameStart (m_current);
+
+        if (! readName ())
+            return false;
+
+        skipSpaces ();
+
+        if (m_current == m_end || *m_current != ':')
+            return fail ("Missing ':' after object member name");
+
+        ++m_current;
+
+        Value::UInt const size (value.size ());
+        Value& member (value[m_name]);
+
+        if (value.size () == size)
+        {
+            m_current = nameStart;
+            return fail ("Duplicate member name");
+        }
+
+        if (! readValue (member))
+            return false;
+
+        skipSpaces ();
+
+        if (m_current == m_end)
+            return fail ("Missing ',' or '}' in object");
+
+        char const c (*m_current++);
+
+        if (c == '}')
+            break;
+
+        if (c != ',')
+        {
+            --m_current;
+            return fail ("Missing ',' or '}' in object");
+        }
+    }
+
+    --m_depth;
+    return true;
+}
+
+bool Parser::readArray (Value& value)
+{
+    if (++m_depth > m_maxDepth)
+        return fail ("Nesting too deep");
+
+    ++m_current;
+    value = Value (arrayValue);
+    skipSpaces ();
+
+    if (m_current != m_end && *m_current == ']')
+    {
+        ++m_current;
+        --m_depth;
+        return true;
+    }
+
+    for (Value::UInt index = 0;; ++index)
+    {
+        if (! readValue (value[index]))
+            return false;
+
+        skipSpaces ();
+
+        if (m_current == m_end)
+            return fail ("Missing ',' or ']' in array");
+
+        char const c (*m_current++);
+
+        if (c == ']')
+            break;
+
+        if (c != ',')
+        {
+            --m_current;
+            return fail ("Missing ',' or ']' in array");
+        }
+    }
+
+    --m_depth;
+    return true;
+}
+
+bool Parser::readString (Value& value)
+{
+    char const* const first (++m_current);
+    char const* const last (findStringDelimiter (first, m_end));
+
+    if (last == m_end)
+        return fail ("Unterminated string");
+
+    if (*last == '"')
+    {
+        // No escapes, the text is used as it stands
+        Value (first, last).swap (value);
+        m_current = last + 1;
+        return true;
+    }
+
+    m_current = last;
+
+    if (! decodeString (first, last, m_name))
+        return false;
+
+    Value (m_name.data (), m_name.data () + m_name.size ()).swap (value);
+    return true;
+}
+
+bool Parser::readName ()
+{
+    char const* const first (++m_current);
+    char const* const last (findStringDelimiter (first, m_end));
+
+    if (last == m_end)
+        return fail ("Unterminated string");
+
+    if (*last == '"')
+    {
+        m_name.assign (first, last);
+        m_current = last + 1;
+        return true;
+    }
+
+    m_current = last;
+    return decodeString (first, last, m_name);
+}
+
+// Called with m_current on the first backslash; [first, last) holds the
+// text before it. Leaves m_current after the closing quote.
+bool Parser::decodeString (char const* first, char const* last,
+    std::string& out)
+{
+    out.assign (first, last);
+
+    for (;;)
+    {
+        if (m_current == m_end)
+            return fail ("Unterminated string");
+
+        char const c (*m_current);
+
+        if (c == '"')
+        {
+            ++m_current;
+            return true;
+        }
+
+        if (c != '\\')
+        {
+            char const* const next (findStringDelimiter (m_current, m_end));
+            out.append (m_current, next);
+            m_current = next;
+            continue;
+        }
+
+        if (++m_current == m_end)
+            return fail ("Unterminated string");
+
+        switch (*m_current++)
+        {
+        case '"':  out += '"';  break;
+        case '/':  out += '/';  break;
+        case '\\': out += '\\'; break;
+        case 'b':  out += '\b'; break;
+        case 'f':  out += '\f'; break;
+        case 'n':  out += '\n'; break;
+        case 'r':  out += '\r'; break;
+        case 't':  out += '\t'; break;
+
+        case 'u':
+        {
+            unsigned int unicode (0);
+
+            for (int pair = 0; pair < 2; ++pair)
+            {
+                if (m_end - m_current < 4)
+                    return fail ("Bad unicode escape sequence");
+
+                unsigned int code (0);
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    int const digit (hexDigit (*m_current++));
+
+                    if (digit < 0)
+                        return fail ("Bad unicode escape sequence");
+
+                    code = code * 16 + digit;
+                }
+
+                if (pair == 1)
+                {
+                    unicode = 0x10000 + ((unicode & 0x3FF) << 10) + (code & 0x3FF);
+                    break;
+                }
+
+                unicode = code;
+
+                if (unicode < 0xD800 || unicode > 0xDBFF)
+                    break;
+
+                // The first half of a surrogate pair, the second must follow
+                if (m_end - m_current < 2 ||
+                    m_current[0] != '\\' || m_current[1] != 'u')
+                    return fail ("Missing second half of surrogate pair");
+
+                m_current += 2;
+            }
+
+            out += codePointToUTF8 (unicode);
+        }
+        break;
+
+        default:
+            --m_current;
+            return fail ("Bad escape sequence in string");
+        }
+    }
+}
+
+bool Parser::readNumber (Value& value)
+{
+    char const* const start (m_current);
+    bool const negative (*m_current == '-');
+
+    if (negative)
+        ++m_current;
+
+    if (m_current == m_end || *m_current < '0' || *m_current > '9')
+        return fail ("Invalid value");
+
+    // Up to 19 digits cannot overflow
+    std::uint64_t mantissa (0);
+    int digits (0);
+
+    if (*m_current == '0')
+    {
+        ++m_current;
+    }
+    else
+    {
+        while (m_current != m_end && *m_current >= '0' && *m_current <= '9')
+        {
+            mantissa = mantissa * 10 + (*m_current++ - '0');
+            ++digits;
+        }
+    }
+
+    bool integer (digits <= 19);
+
+    if (m_current != m_end && *m_current == '.')
+    {
+        integer = false;
+
+        if (++m_current == m_end || *m_current < '0' || *m_current > '9')
+            return fail ("Invalid number");
+
+        while (m_current != m_end && *m_current >= '0' && *m_current <= '9')
+            ++m_current;
+    }
+
+    if (m_current != m_end && (*m_current == 'e' || *m_current == 'E'))
+    {
+        integer = false;
+
+        if (++m_current != m_end && (*m_current == '+' || *m_current == '-'))
+            ++m_current;
+
+        if (m_current == m_end || *m_current < '0' || *m_current > '9')
+            return fail ("Invalid number");
+
+        while (m_current != m_end && *m_current >= '0' && *m_current <= '9')
+            ++m_current;
+    }
+
+    if (integer)
+    {
+        if (negative && mantissa <= std::uint64_t (Value::maxInt) + 1)
+        {
+            value = Value::Int (-std::int64_t (mantissa));
+            return true;
+        }
+
+        if (! negative && mantissa <= std::uint64_t (Value::maxInt))
+        {
+            value = Value::Int (mantissa);
+            return true;
+        }
+
+        if (! negative && mantissa <= std::uint64_t (Value::maxUInt))
+        {
+            value = Value::UInt (mantissa);
+            return true;
+        }
+    }
+
+    // The text is not necessarily terminated, so strtod needs a copy
+    std::string const text (start, m_current);
+    value = std::strtod (text.c_str (), nullptr);
+    return true;
+}
+
+} // Json
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace Json {
+
+Stream::Stream (Sink& sink, std::size_t bufferSize)
+    : m_sink (sink)
+    , m_bufferSize (bufferSize)
+    , m_size (0)
+{
+    m_buffer.reserve (m_bufferSize);
+}
+
+Stream::~Stream ()
+{
+    // A sink may throw to abandon the document, don't write any more of it.
+    if (! std::uncaught_exception ())
+        flush ();
+}
+
+void Stream::startObject ()
+{
+    separator ();
+    start ('{');
+    m_levels.back ().object = true;
+}
+
+void Stream::startObject (char const* key)
+{
+    name (key);
+    start ('{');
+    m_levels.back ().object = true;
+}
+
+void Stream::startArray ()
+{
+    separator ();
+    start ('[');
+}
+
+void Stream::startArray (char const* key)
+{
+    name (key);
+    start ('[');
+}
+
+void Stream::end ()
+{
+    assert (! m_levels.empty ());
+    put (m_levels.back ().object ? '}' : ']');
+    m_levels.pop_back ();
+}
+
+void Stream::set (char const* key, Value const& value)
+{
+    name (key);
+    putValue (value);
+}
+
+void Stream::append (Value const& value)
+{
+    separator ();
+    putValue (value);
+}
+
+void Stream::flush ()
+{
+    if (! m_buffer.empty ())
+    {
+        m_sink.write (m_buffer.data (), m_buffer.size ());
+        m_buffer.clear ();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void Stream::separator ()
+{
+    if (m_levels.empty ())
+        return;
+
+    Level& level (m_levels.back ());
+    assert (! level.object);
+
+    if (! level.empty)
+        put (',');
+
+    level.empty = false;
+}
+
+void Stream::name (char const* key)
+{
+    assert (! m_levels.empty () && m_levels.back ().object);
+    Level& level (m_levels.back ());
+
+    if (! level.empty)
+        put (',');
+
+    level.empty = false;
+    put (valueToQuotedString (key));
+    put (':');
+}
+
+void Stream::start (char open)
+{
+    put (open);
+    Level const level = { false, true };
+    m_levels.push_back (level);
+}
+
+void Stream::put (char c)
+{
+    m_buffer.push_back (c);
+    ++m_size;
+
+    if (m_buffer.size () >= m_bufferSize)
+        flush ();
+}
+
+void Stream::put (char const* data, std::size_t bytes)
+{
+    m_size += bytes;
+
+    while (bytes > 0)
+    {
+        std::size_t const n (std::min (bytes, m_bufferSize - m_buffer.size ()));
+        m_buffer.append (data, n);
+        data += n;
+        bytes -= n;
+
+        if (m_buffer.size () >= m_bufferSize)
+            flush ();
+    }
+}
+
+void Stream::put (std::string const& s)
+{
+    put (s.data (), s.size ());
+}
+
+void Stream::putValue (Value const& value)
+{
+    switch (value.type ())
+    {
+    case nullValue:
+        put ("null", 4);
+        break;
+
+    case intValue:
+        put (valueToString (value.asInt ()));
+        break;
+
+    case uintValue:
+        put (valueToString (value.asUInt ()));
+        break;
+
+    case realValue:
+        put (valueToString (value.asDouble ()));
+        break;
+
+    case stringValue:
+        put (valueToQuotedString (value.asCString ()));
+        break;
+
+    case booleanValue:
+        put (valueToString (value.asBool ()));
+        break;
+
+    case arrayValue:
+    {
+        put ('[');
+
+        for (Value::UInt i = 0; i < value.size (); ++i)
+        {
+            if (i > 0)
+                put (',');
+
+            putValue (value [i]);
+        }
+
+        put (']');
+    }
+    break;
+
+    case objectValue:
+    {
+        put ('{');
+        bool first (true);
+
+        for (Value::const_iterator it (value.begin ()); it != value.end (); ++it)
+        {
+            if (! first)
+                put (',');
+
+            first = false;
+            put (valueToQuotedString (it.memberName ()));
+            put (':');
+            putValue (*it);
+        }
+
+        put ('}');
+    }
+    break;
+    }
+}
+
+} // Json
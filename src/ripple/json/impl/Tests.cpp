@@ -20,6 +20,11 @@
 #include "../../../beast/beast/unit_test/suite.h"
 #include "../../../beast/beast/utility/type_name.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
 namespace ripple {
 
 class JsonCpp_test : public beast::unit_test::suite
@@ -84,14 +89,572 @@ public:
         pass ();
     }
 
+    void
+    test_stream ()
+    {
+        Json::Value v (Json::objectValue);
+        v["null"] = Json::Value ();
+        v["int"] = -7;
+        v["uint"] = 42u;
+        v["real"] = 2.5;
+        v["bool"] = true;
+        v["string"] = "quote\" tab\t";
+        v["array"].append (1);
+        v["array"].append ("two");
+        v["array"].append (Json::Value (Json::objectValue));
+        v["object"]["nested"] = Json::Value (Json::arrayValue);
+
+        std::string expected (Json::FastWriter ().write (v));
+        expected.resize (expected.size () - 1);
+
+        {
+            // A whole tree, through a buffer smaller than most tokens
+            std::string s;
+            Json::StringSink sink (s);
+            {
+                Json::Stream stream (sink, 3);
+                stream.append (v);
+            }
+            expect (s == expected, "Stream should match FastWriter");
+        }
+
+        {
+            // The same document, written piece by piece
+            std::string s;
+            Json::StringSink sink (s);
+            Json::Stream stream (sink);
+            stream.startObject ();
+            stream.startArray ("array");
+            stream.append (1);
+            stream.append ("two");
+            stream.startObject ();
+            stream.end ();
+            stream.end ();
+            stream.set ("bool", true);
+            stream.set ("int", -7);
+            stream.set ("null", Json::Value ());
+            stream.startObject ("object");
+            stream.startArray ("nested");
+            stream.end ();
+            stream.end ();
+            stream.set ("real", 2.5);
+            stream.set ("string", "quote\" tab\t");
+            stream.set ("uint", 42u);
+            stream.end ();
+            stream.flush ();
+            expect (s == expected, "Pieces should match FastWriter");
+            expect (stream.size () == expected.size ());
+        }
+    }
+
+    void
+    test_strings ()
+    {
+        // Short strings are held inline, long ones are allocated
+        Json::Value s1 ("short");
+        Json::Value s2 ("a string too long to be held inline");
+        Json::Value s3 (Json::StaticString ("static"));
+        expect (s1.asString () == "short");
+        expect (s2.asString () == "a string too long to be held inline");
+        expect (s3.asString () == "static");
+
+        Json::Value c1 (s1);
+        Json::Value c2 (s2);
+        Json::Value c3 (s3);
+        expect (c1 == s1 && c2 == s2 && c3 == s3);
+        expect (c1.asCString () != s1.asCString ());
+        expect (c2.asCString () != s2.asCString ());
+        expect (c3.asCString () == s3.asCString ());
+        expect (s2 < s1 && s1 < s3);
+
+        c1.swap (c2);
+        expect (c1.asString () == "a string too long to be held inline");
+        expect (c2.asString () == "short");
+
+        Json::Value m (std::move (c2));
+        expect (m.asString () == "short");
+        expect (c2.isNull ());
+
+        expect (Json::Value ("").asString ().empty ());
+        expect (Json::Value ("1234567").asInt () == 1234567);
+        expect (Json::Value ("12345678").asUInt () == 12345678);
+    }
+
+    void
+    test_objects ()
+    {
+        Json::Value v (Json::objectValue);
+        Json::Value& first = v["m"];
+        first = 1;
+
+        // Members are ordered by name and references stay valid
+        for (int i = 0; i < 100; ++i)
+            v[std::to_string (99 - i)] = i;
+
+        expect (first == 1);
+        first = 2;
+        expect (v["m"] == 2);
+        expect (v.size () == 101);
+
+        Json::Value::Members const names (v.getMemberNames ());
+        expect (std::is_sorted (names.begin (), names.end ()));
+        expect (names.back () == "m");
+
+        Json::Value copy (v);
+        expect (copy == v);
+        copy["m"] = 3;
+        expect (copy != v && v < copy);
+
+        expect (v.removeMember ("m") == 2);
+        expect (! v.isMember ("m"));
+        expect (v.size () == 100);
+
+        // A name which has been interned is not copied
+        static char const interned[] = "interned_name";
+        Json::internMemberName (interned);
+        Json::Value o;
+        o[std::string ("interned_name")] = true;
+        o["not_interned_name"] = true;
+        expect (o.begin ().memberName () == interned);
+        expect (std::strcmp ((++o.begin ()).memberName (), "not_interned_name") == 0);
+
+        // Arrays
+        Json::Value a;
+        a[2u] = "two";
+        expect (a.size () == 3 && a[0u].isNull ());
+        a.resize (1);
+        expect (a.size () == 1);
+        a.append (5);
+        expect (a[1u] == 5);
+    }
+
     void run ()
     {
         testBadJson ();
         test_copy ();
         test_move ();
+        test_stream ();
+        test_strings ();
+        test_objects ();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(JsonCpp,json,ripple);
 
+//------------------------------------------------------------------------------
+
+// Times building, writing and reading a payment with metadata, the most
+// common object the server produces.
+class JsonCpp_timing_test : public beast::unit_test::suite
+{
+public:
+    // The names used are interned, as SField and jss names are
+    struct Names
+    {
+        Names ()
+            : Account (Json::internMemberName ("Account"))
+            , AffectedNodes (Json::internMemberName ("AffectedNodes"))
+            , Amount (Json::internMemberName ("Amount"))
+            , Balance (Json::internMemberName ("Balance"))
+            , Destination (Json::internMemberName ("Destination"))
+            , Fee (Json::internMemberName ("Fee"))
+            , FinalFields (Json::internMemberName ("FinalFields"))
+            , Flags (Json::internMemberName ("Flags"))
+            , LedgerEntryType (Json::internMemberName ("LedgerEntryType"))
+            , LedgerIndex (Json::internMemberName ("LedgerIndex"))
+            , ModifiedNode (Json::internMemberName ("ModifiedNode"))
+            , OwnerCount (Json::internMemberName ("OwnerCount"))
+            , PreviousFields (Json::internMemberName ("PreviousFields"))
+            , PreviousTxnID (Json::internMemberName ("PreviousTxnID"))
+            , PreviousTxnLgrSeq (Json::internMemberName ("PreviousTxnLgrSeq"))
+            , Sequence (Json::internMemberName ("Sequence"))
+            , SigningPubKey (Json::internMemberName ("SigningPubKey"))
+            , TransactionIndex (Json::internMemberName ("TransactionIndex"))
+            , TransactionResult (Json::internMemberName ("TransactionResult"))
+            , TransactionType (Json::internMemberName ("TransactionType"))
+            , TxnSignature (Json::internMemberName ("TxnSignature"))
+            , currency (Json::internMemberName ("currency"))
+            , hash (Json::internMemberName ("hash"))
+            , issuer (Json::internMemberName ("issuer"))
+            , meta (Json::internMemberName ("meta"))
+            , value (Json::internMemberName ("value"))
+        {
+        }
+
+        Json::StaticString const Account;
+        Json::StaticString const AffectedNodes;
+        Json::StaticString const Amount;
+        Json::StaticString const Balance;
+        Json::StaticString const Destination;
+        Json::StaticString const Fee;
+        Json::StaticString const FinalFields;
+        Json::StaticString const Flags;
+        Json::StaticString const LedgerEntryType;
+        Json::StaticString const LedgerIndex;
+        Json::StaticString const ModifiedNode;
+        Json::StaticString const OwnerCount;
+        Json::StaticString const PreviousFields;
+        Json::StaticString const PreviousTxnID;
+        Json::StaticString const PreviousTxnLgrSeq;
+        Json::StaticString const Sequence;
+        Json::StaticString const SigningPubKey;
+        Json::StaticString const TransactionIndex;
+        Json::StaticString const TransactionResult;
+        Json::StaticString const TransactionType;
+        Json::StaticString const TxnSignature;
+        Json::StaticString const currency;
+        Json::StaticString const hash;
+        Json::StaticString const issuer;
+        Json::StaticString const meta;
+        Json::StaticString const value;
+    };
+
+    static Json::Value build (Names const& n)
+    {
+        std::string const account ("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh");
+        std::string const hash (
+            "E08D6E9754025BA2534A78707605E0601F03ACE063687A0CA1BDDACFCD1698C7");
+
+        Json::Value tx (Json::objectValue);
+        tx[n.Account] = account;
+        tx[n.Amount][n.currency] = "USD";
+        tx[n.Amount][n.issuer] = account;
+        tx[n.Amount][n.value] = "1.5";
+        tx[n.Destination] = account;
+        tx[n.Fee] = "10";
+        tx[n.Flags] = 2147483648u;
+        tx[n.Sequence] = 42;
+        tx[n.SigningPubKey] = hash;
+        tx[n.TransactionType] = "Payment";
+        tx[n.TxnSignature] = hash + hash;
+        tx[n.hash] = hash;
+
+        Json::Value& meta (tx[n.meta]);
+        Json::Value& nodes (meta[n.AffectedNodes]);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            Json::Value& node (nodes.append (Json::objectValue)[n.ModifiedNode]);
+            Json::Value& fields (node[n.FinalFields]);
+            fields[n.Account] = account;
+            fields[n.Balance] = "199999990";
+            fields[n.Flags] = 0;
+            fields[n.OwnerCount] = 3;
+            fields[n.Sequence] = 43;
+            node[n.LedgerEntryType] = "AccountRoot";
+            node[n.LedgerIndex] = hash;
+            node[n.PreviousFields][n.Balance] = "200000000";
+            node[n.PreviousFields][n.Sequence] = 42;
+            node[n.PreviousTxnID] = hash;
+            node[n.PreviousTxnLgrSeq] = 5000000;
+        }
+
+        meta[n.TransactionIndex] = 3;
+        meta[n.TransactionResult] = "tesSUCCESS";
+
+        return tx;
+    }
+
+    template <class Function>
+    void measure (std::string const& what, int iterations, Function f)
+    {
+        typedef std::chrono::steady_clock clock_type;
+        clock_type::time_point const start (clock_type::now ());
+
+        for (int i = 0; i < iterations; ++i)
+            f ();
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::nanoseconds> (clock_type::now () - start));
+
+        log << what << ": " << (elapsed.count () / iterations / 1000.0) << " us";
+    }
+
+    void run ()
+    {
+        int const iterations (20000);
+        Names const names;
+        std::string const text (Json::FastWriter ().write (build (names)));
+
+        measure ("build", iterations, [&]
+        {
+            build (names);
+        });
+
+        measure ("build and write", iterations, [&]
+        {
+            Json::FastWriter ().write (build (names));
+        });
+
+        measure ("read", iterations, [&]
+        {
+            Json::Value v;
+            Json::Reader ().parse (text, v);
+        });
+
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JsonCpp_timing,json,ripple);
+
+//------------------------------------------------------------------------------
+
+// Requests in the shapes clients send most often over websockets and HTTP.
+static std::vector <std::string> requestCorpus ()
+{
+    std::string const account ("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh");
+    std::string const issuer ("rvYAfWj5gh67oV6fW32ZzP3Aw4Eubs59B");
+    std::string const hash (
+        "E08D6E9754025BA2534A78707605E0601F03ACE063687A0CA1BDDACFCD1698C7");
+    std::string blob;
+    for (int i = 0; i < 6; ++i)
+        blob += hash;
+
+    std::vector <std::string> corpus;
+
+    corpus.push_back ("{\"command\":\"submit\",\"id\":7,\"tx_blob\":\"" +
+        blob + "\"}");
+    corpus.push_back ("{\"command\":\"sign\",\"id\":8,\"secret\":"
+        "\"snoPBrXtMeMyMHUVTgbuqAfg1SUTb\",\"tx_json\":{\"Account\":\"" +
+        account + "\",\"Amount\":{\"currency\":\"USD\",\"issuer\":\"" +
+        issuer + "\",\"value\":\"1.5\"},\"Destination\":\"" + issuer +
+        "\",\"Fee\":\"10\",\"Flags\":2147483648,\"Sequence\":42,"
+        "\"TransactionType\":\"Payment\",\"Paths\":[[{\"account\":\"" +
+        issuer + "\",\"type\":1,\"type_hex\":\"0000000000000001\"},"
+        "{\"currency\":\"XRP\",\"type\":16}]],\"Memos\":[{\"Memo\":"
+        "{\"MemoType\":\"74657874\",\"MemoData\":\"48656C6C6F\"}}]}}");
+    corpus.push_back ("{\"method\":\"submit\",\"params\":[{\"secret\":"
+        "\"snoPBrXtMeMyMHUVTgbuqAfg1SUTb\",\"offline\":false,\"tx_json\":"
+        "{\"TransactionType\":\"OfferCreate\",\"Account\":\"" + account +
+        "\",\"TakerGets\":\"1000000\",\"TakerPays\":{\"currency\":\"BTC\","
+        "\"issuer\":\"" + issuer + "\",\"value\":\"0.0001\"},"
+        "\"Expiration\":472772652,\"Sequence\":1023}}]}");
+    corpus.push_back ("{\"command\":\"account_info\",\"id\":1,\"account\":\"" +
+        account + "\",\"ledger_index\":\"validated\",\"strict\":true}");
+    corpus.push_back ("{\"command\":\"account_lines\",\"id\":2,\"account\":\"" +
+        account + "\",\"ledger_index\":\"current\"}");
+    corpus.push_back ("{\"command\":\"account_tx\",\"id\":3,\"account\":\"" +
+        account + "\",\"ledger_index_min\":-1,\"ledger_index_max\":-1,"
+        "\"binary\":false,\"forward\":false,\"limit\":200,\"marker\":"
+        "{\"ledger\":5000000,\"seq\":12}}");
+    corpus.push_back ("{\"command\":\"subscribe\",\"id\":4,\"streams\":"
+        "[\"ledger\",\"server\",\"transactions\"],\"accounts\":[\"" +
+        account + "\",\"" + issuer + "\"]}");
+    corpus.push_back ("{\"command\":\"book_offers\",\"id\":5,\"taker_gets\":"
+        "{\"currency\":\"XRP\"},\"taker_pays\":{\"currency\":\"USD\","
+        "\"issuer\":\"" + issuer + "\"},\"limit\":10}");
+    corpus.push_back ("{\"command\":\"ripple_path_find\",\"id\":6,"
+        "\"source_account\":\"" + account + "\",\"destination_account\":\"" +
+        issuer + "\",\"destination_amount\":{\"currency\":\"USD\",\"issuer\":\"" +
+        issuer + "\",\"value\":\"0.001\"},\"source_currencies\":"
+        "[{\"currency\":\"XRP\"},{\"currency\":\"USD\"}]}");
+    corpus.push_back ("{\"method\":\"ledger\",\"params\":[{\"ledger_hash\":\"" +
+        hash + "\",\"transactions\":true,\"expand\":false}]}");
+    corpus.push_back ("{\"command\":\"server_info\",\"id\":9}");
+    corpus.push_back ("{\"command\":\"tx\",\"id\":10,\"transaction\":\"" +
+        hash + "\",\"binary\":false}");
+
+    return corpus;
+}
+
+class JsonParser_test : public beast::unit_test::suite
+{
+public:
+    bool parses (std::string const& text)
+    {
+        Json::Value v;
+        return Json::Parser ().parse (text, v);
+    }
+
+    void test_corpus ()
+    {
+        std::vector <std::string> const corpus (requestCorpus ());
+
+        for (auto const& text : corpus)
+        {
+            Json::Value expected;
+            Json::Reader ().parse (text, expected);
+
+            Json::Value v;
+            expect (Json::Parser ().parse (text, v), text);
+            expect (v == expected, text);
+            expect (Json::FastWriter ().write (v) ==
+                Json::FastWriter ().write (expected));
+        }
+    }
+
+    void test_values ()
+    {
+        Json::Parser p;
+        Json::Value v;
+
+        expect (p.parse (" [ 0, -1, 2147483647, -2147483648, 4294967295,"
+            " 4294967296, 1.5, -2e3, 1E+2, true, false, null, \"\", {} ] ", v));
+        expect (p.error ().empty ());
+        expect (v.size () == 14);
+        expect (v[0u].isInt () && v[0u].asInt () == 0);
+        expect (v[1u].isInt () && v[1u].asInt () == -1);
+        expect (v[2u].isInt () && v[2u].asInt () == 2147483647);
+        expect (v[3u].isInt () && v[3u].asInt () == -2147483647 - 1);
+        expect (v[4u].isUInt () && v[4u].asUInt () == 4294967295u);
+        expect (v[5u].isDouble () && v[5u].asDouble () == 4294967296.0);
+        expect (v[6u].isDouble () && v[6u].asDouble () == 1.5);
+        expect (v[7u].isDouble () && v[7u].asDouble () == -2000);
+        expect (v[8u].isDouble () && v[8u].asDouble () == 100);
+        expect (v[9u].isBool () && v[9u].asBool ());
+        expect (v[10u].isBool () && ! v[10u].asBool ());
+        expect (v[11u].isNull ());
+        expect (v[12u].isString () && v[12u].asString ().empty ());
+        expect (v[13u].isObject () && v[13u].empty ());
+
+        expect (p.parse ("\"scalar\"", v) && v.asString () == "scalar");
+        expect (p.parse ("{\"a\":{\"b\":[[]]}}", v) && v["a"]["b"][0u].isArray ());
+    }
+
+    void test_strings ()
+    {
+        Json::Parser p;
+        Json::Value v;
+
+        expect (p.parse ("[\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\"]", v));
+        expect (v[0u].asString () == "a\"b\\c/d\b\f\n\r\t");
+
+        expect (p.parse ("{\"k\\u0065y\":\"\\u00e9\\u20AC\\ud83d\\ude00\"}", v));
+        expect (v["key"].asString () == "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+
+        // Long enough to take the word at a time scan, with the escape late
+        std::string const text ("[\"0123456789abcdef0123456789\\n0123456789\"]");
+        expect (p.parse (text, v));
+        expect (v[0u].asString () == "0123456789abcdef0123456789\n0123456789");
+    }
+
+    void test_errors ()
+    {
+        expect (! parses (""));
+        expect (! parses ("{"));
+        expect (! parses ("{\"a\" 1}"));
+        expect (! parses ("{\"a\":1,}"));
+        expect (! parses ("[1 2]"));
+        expect (! parses ("[1,]"));
+        expect (! parses ("{\"a\":1} x"));
+        expect (! parses ("// comment\n{}"));
+        expect (! parses ("{a:1}"));
+        expect (! parses ("[01]"));
+        expect (! parses ("[1.]"));
+        expect (! parses ("[-]"));
+        expect (! parses ("[1e]"));
+        expect (! parses ("[tru]"));
+        expect (! parses ("[\"abc]"));
+        expect (! parses ("[\"\\x\"]"));
+        expect (! parses ("[\"\\u12G4\"]"));
+        expect (! parses ("[\"\\ud83d\"]"));
+
+        Json::Parser p;
+        Json::Value v;
+        expect (! p.parse ("{\"a\":1,\"a\":2}", v));
+        expect (p.error () == "Duplicate member name at offset 7", p.error ());
+        expect (p.parse ("{}", v) && p.error ().empty ());
+    }
+
+    void test_limits ()
+    {
+        Json::Parser p (64, 3);
+        Json::Value v;
+
+        expect (p.parse ("[[[1]]]", v));
+        expect (! p.parse ("[[[[1]]]]", v));
+        expect (! p.parse ("{\"a\":{\"b\":{\"c\":{}}}}", v));
+        expect (p.error () == "Nesting too deep at offset 15", p.error ());
+
+        expect (p.parse ("[\"" + std::string (60, 'x') + "\"]", v));
+        expect (! p.parse ("[\"" + std::string (61, 'x') + "\"]", v));
+
+        // Nothing past the end of the range is read
+        char const text[] = "[1]]";
+        expect (p.parse (text, text + 3, v));
+        expect (v[0u].asInt () == 1);
+    }
+
+    void run ()
+    {
+        test_corpus ();
+        test_values ();
+        test_strings ();
+        test_errors ();
+        test_limits ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JsonParser,json,ripple);
+
+//------------------------------------------------------------------------------
+
+// Times Reader against Parser over the request corpus.
+class JsonParser_timing_test : public beast::unit_test::suite
+{
+public:
+    template <class Function>
+    void measure (std::string const& what, int iterations,
+        std::vector <std::string> const& corpus, Function f)
+    {
+        typedef std::chrono::steady_clock clock_type;
+        std::size_t bytes (0);
+        for (auto const& text : corpus)
+            bytes += text.size ();
+
+        clock_type::time_point const start (clock_type::now ());
+
+        for (int i = 0; i < iterations; ++i)
+            for (auto const& text : corpus)
+                f (text);
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::nanoseconds> (clock_type::now () - start));
+
+        log << what << ": " <<
+            (elapsed.count () / (iterations * corpus.size ()) / 1000.0) <<
+            " us per request, " <<
+            (bytes * iterations * 1000.0 / elapsed.count ()) << " MB/s";
+    }
+
+    void run ()
+    {
+        int const iterations (20000);
+        std::vector <std::string> const corpus (requestCorpus ());
+
+        // In the server these are all jss or SField names, which are interned
+        char const* const names[] = { "Account", "Amount", "Destination",
+            "Expiration", "Fee", "Flags", "Memo", "MemoData", "MemoType",
+            "Memos", "Paths", "Sequence", "TakerGets", "TakerPays",
+            "TransactionType", "account", "accounts", "binary", "command",
+            "currency", "destination_account", "destination_amount",
+            "expand", "forward", "id", "issuer", "ledger", "ledger_hash",
+            "ledger_index", "ledger_index_max", "ledger_index_min", "limit",
+            "marker", "method", "offline", "params", "secret", "seq",
+            "source_account", "source_currencies", "streams", "strict",
+            "taker_gets", "taker_pays", "transaction", "transactions",
+            "tx_blob", "tx_json", "type", "type_hex", "value" };
+        for (auto name : names)
+            Json::internMemberName (name);
+
+        measure ("Reader", iterations, corpus, [] (std::string const& text)
+        {
+            Json::Value v;
+            Json::Reader ().parse (text, v);
+        });
+
+        Json::Parser parser;
+        measure ("Parser", iterations, corpus, [&] (std::string const& text)
+        {
+            Json::Value v;
+            parser.parse (text, v);
+        });
+
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JsonParser_timing,json,ripple);
+
 } // ripple
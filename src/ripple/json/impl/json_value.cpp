@@ -112,6 +112,70 @@ static struct DummyValueAllocatorInitializer
     }
 } dummyValueAllocatorInitializer;
 
+// //////////////////////////////////////////////////////////////////
+// Interned member names
+//
+// An open addressed hash table of string pointers which is only ever
+// added to. Slots are claimed with compare and swap, so lookups take no
+// lock. The table is zero initialized before any constructors run, which
+// lets static StaticStrings register themselves.
+// //////////////////////////////////////////////////////////////////
+
+static const unsigned int internedNameSlots = 4096;
+static const unsigned int internedNameLimit = internedNameSlots / 2;
+
+static std::atomic<const char*> internedNames[internedNameSlots];
+static std::atomic<unsigned int> internedNameCount;
+
+static unsigned int hashMemberName ( const char* name )
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+
+    for ( ; *name; ++name )
+        hash = ( hash ^ static_cast<unsigned char> ( *name ) ) * 16777619u;
+
+    return hash;
+}
+
+// Returns the registered string equal to name, or null.
+static const char* findMemberName ( const char* name )
+{
+    for ( unsigned int slot = hashMemberName ( name ) % internedNameSlots;;
+            slot = ( slot + 1 ) % internedNameSlots )
+    {
+        const char* const interned = internedNames[slot].load ( std::memory_order_acquire );
+
+        if ( interned == 0 )
+            return 0;
+
+        if ( strcmp ( interned, name ) == 0 )
+            return interned;
+    }
+}
+
+const char* internMemberName ( const char* name )
+{
+    if ( internedNameCount.load ( std::memory_order_relaxed ) >= internedNameLimit )
+        return name;
+
+    for ( unsigned int slot = hashMemberName ( name ) % internedNameSlots;;
+            slot = ( slot + 1 ) % internedNameSlots )
+    {
+        const char* interned = 0;
+
+        if ( internedNames[slot].compare_exchange_strong ( interned, name,
+                std::memory_order_acq_rel ) )
+        {
+            ++internedNameCount;
+            return name;
+        }
+
+        if ( strcmp ( interned, name ) == 0 )
+            return name;
+    }
+}
+
 
 
 // //////////////////////////////////////////////////////////////////
@@ -182,19 +246,49 @@ Value::CZString::CZString ( int index )
 }
 
 Value::CZString::CZString ( const char* cstr, DuplicationPolicy allocate )
-    : cstr_ ( allocate == duplicate ? valueAllocator ()->makeMemberName (cstr)
-              : cstr )
+    : cstr_ ( cstr )
     , index_ ( allocate )
 {
+    if ( allocate == duplicate )
+    {
+        cstr_ = findMemberName ( cstr );
+
+        if ( cstr_ )
+            index_ = noDuplication;
+        else
+            cstr_ = valueAllocator ()->makeMemberName ( cstr );
+    }
 }
 
+// A name which may be copied is stored as the interned string when
+// there is one, otherwise it is duplicated.
 Value::CZString::CZString ( const CZString& other )
-    : cstr_ ( other.index_ != noDuplication&&   other.cstr_ != 0
-              ?  valueAllocator ()->makeMemberName ( other.cstr_ )
-              : other.cstr_ )
-    , index_ ( other.cstr_ ? (other.index_ == noDuplication ? noDuplication : duplicate)
-               : other.index_ )
+    : cstr_ ( other.cstr_ )
+    , index_ ( other.index_ )
+{
+    if ( cstr_ != 0  &&  index_ != noDuplication )
+    {
+        const char* const interned = index_ == duplicateOnCopy
+                                     ? findMemberName ( cstr_ ) : 0;
+
+        if ( interned )
+        {
+            cstr_ = interned;
+            index_ = noDuplication;
+        }
+        else
+        {
+            cstr_ = valueAllocator ()->makeMemberName ( cstr_ );
+            index_ = duplicate;
+        }
+    }
+}
+
+Value::CZString::CZString ( CZString&& other ) noexcept
+    : cstr_ ( other.cstr_ )
+    , index_ ( other.index_ )
 {
+    other.cstr_ = 0;
 }
 
 Value::CZString::~CZString ()
@@ -218,6 +312,13 @@ Value::CZString::operator = ( const CZString& other )
     return *this;
 }
 
+Value::CZString&
+Value::CZString::operator = ( CZString&& other )
+{
+    swap ( other );
+    return *this;
+}
+
 bool
 Value::CZString::operator< ( const CZString& other ) const
 {
@@ -230,8 +331,9 @@ Value::CZString::operator< ( const CZString& other ) const
 bool
 Value::CZString::operator== ( const CZString& other ) const
 {
+    // Interned names usually share the same pointer
     if ( cstr_ )
-        return strcmp ( cstr_, other.cstr_ ) == 0;
+        return cstr_ == other.cstr_  ||  strcmp ( cstr_, other.cstr_ ) == 0;
 
     return index_ == other.index_;
 }
@@ -256,6 +358,211 @@ Value::CZString::isStaticString () const
     return index_ == noDuplication;
 }
 
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Value::ObjectValues
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+// Storage for values follows the header of each block
+struct Value::ObjectValues::Block
+{
+    Block* next;
+    unsigned int size;
+    unsigned int used;
+};
+
+// Blocks double in size up to this many values
+static const unsigned int maxBlockSize = 64;
+
+Value::ObjectValues::ObjectValues ()
+    : blocks_ ( 0 )
+    , free_ ( 0 )
+{
+}
+
+Value::ObjectValues::ObjectValues ( const ObjectValues& other )
+    : blocks_ ( 0 )
+    , free_ ( 0 )
+{
+    if ( other.empty () )
+        return;
+
+    entries_.reserve ( other.size () );
+    addBlock ( (unsigned int)other.size () );
+
+    for ( const_iterator it = other.begin (); it != other.end (); ++it )
+    {
+        Value* const value = new ( allocate () ) Value ( *it->value );
+        entries_.push_back ( Entry { it->key, value } );
+    }
+}
+
+Value::ObjectValues::~ObjectValues ()
+{
+    clear ();
+}
+
+void
+Value::ObjectValues::clear ()
+{
+    for ( iterator it = begin (); it != end (); ++it )
+        it->value->~Value ();
+
+    entries_.clear ();
+    free_ = 0;
+
+    while ( blocks_ )
+    {
+        Block* const next = blocks_->next;
+        ::operator delete ( blocks_ );
+        blocks_ = next;
+    }
+}
+
+void
+Value::ObjectValues::addBlock ( unsigned int size )
+{
+    Block* const block = static_cast<Block*> ( ::operator new (
+        sizeof ( Block ) + size * sizeof ( Value ) ) );
+    block->next = blocks_;
+    block->size = size;
+    block->used = 0;
+    blocks_ = block;
+}
+
+void*
+Value::ObjectValues::allocate ()
+{
+    if ( free_ )
+    {
+        void* const storage = free_;
+        free_ = *static_cast<void**> ( storage );
+        return storage;
+    }
+
+    if ( ! blocks_ )
+        addBlock ( 2 );
+    else if ( blocks_->used == blocks_->size )
+        addBlock ( std::min ( blocks_->size * 2, maxBlockSize ) );
+
+    return reinterpret_cast<Value*> ( blocks_ + 1 ) + blocks_->used++;
+}
+
+void
+Value::ObjectValues::release ( Value* value )
+{
+    value->~Value ();
+    *reinterpret_cast<void**> ( value ) = free_;
+    free_ = value;
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::lower_bound ( const CZString& key )
+{
+    // Elements are most often added at the end
+    if ( entries_.empty ()  ||  entries_.back ().key < key )
+        return entries_.end ();
+
+    return std::lower_bound ( entries_.begin (), entries_.end (), key,
+        [] ( const Entry& entry, const CZString& key )
+        {
+            return entry.key < key;
+        });
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::find ( const CZString& key )
+{
+    iterator const it = lower_bound ( key );
+
+    if ( it != end ()  &&  it->key == key )
+        return it;
+
+    return end ();
+}
+
+Value::ObjectValues::const_iterator
+Value::ObjectValues::find ( const CZString& key ) const
+{
+    return const_cast<ObjectValues*> ( this )->find ( key );
+}
+
+Value::ObjectValues::iterator
+Value::ObjectValues::insert ( iterator position, const CZString& key )
+{
+    Value* const value = new ( allocate () ) Value;
+
+    try
+    {
+        return entries_.insert ( position, Entry { key, value } );
+    }
+    catch ( ... )
+    {
+        release ( value );
+        throw;
+    }
+}
+
+void
+Value::ObjectValues::erase ( iterator position )
+{
+    release ( position->value );
+    entries_.erase ( position );
+}
+
+void
+Value::ObjectValues::erase ( const CZString& key )
+{
+    iterator const it = find ( key );
+
+    if ( it != end () )
+        erase ( it );
+}
+
+bool
+Value::ObjectValues::operator== ( const ObjectValues& other ) const
+{
+    if ( size () != other.size () )
+        return false;
+
+    for ( const_iterator it = begin (), otherIt = other.begin ();
+            it != end (); ++it, ++otherIt )
+    {
+        if ( ! ( it->key == otherIt->key )  ||  *it->value != *otherIt->value )
+            return false;
+    }
+
+    return true;
+}
+
+bool
+Value::ObjectValues::operator< ( const ObjectValues& other ) const
+{
+    // Lexicographic, as for std::map
+    const_iterator it = begin ();
+    const_iterator otherIt = other.begin ();
+
+    for ( ; it != end ()  &&  otherIt != other.end (); ++it, ++otherIt )
+    {
+        if ( it->key < otherIt->key )
+            return true;
+
+        if ( otherIt->key < it->key )
+            return false;
+
+        if ( *it->value < *otherIt->value )
+            return true;
+
+        if ( *otherIt->value < *it->value )
+            return false;
+    }
+
+    return it == end ()  &&  otherIt != other.end ();
+}
+
 #endif // ifndef JSON_VALUE_USE_INTERNAL_MAP
 
 
@@ -274,6 +581,7 @@ Value::CZString::isStaticString () const
 Value::Value ( ValueType type )
     : type_ ( type )
     , allocated_ ( 0 )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -325,6 +633,8 @@ Value::Value ( ValueType type )
 
 Value::Value ( Int value )
     : type_ ( intValue )
+    , allocated_ ( 0 )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -336,6 +646,8 @@ Value::Value ( Int value )
 
 Value::Value ( UInt value )
     : type_ ( uintValue )
+    , allocated_ ( 0 )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -346,6 +658,8 @@ Value::Value ( UInt value )
 
 Value::Value ( double value )
     : type_ ( realValue )
+    , allocated_ ( 0 )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -356,59 +670,52 @@ Value::Value ( double value )
 
 Value::Value ( const char* value )
     : type_ ( stringValue )
-    , allocated_ ( true )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
 #endif
 {
-    value_.string_ = valueAllocator ()->duplicateStringValue ( value );
+    setString ( value, (unsigned int)strlen ( value ) );
 }
 
 
 Value::Value ( const char* beginValue,
                const char* endValue )
     : type_ ( stringValue )
-    , allocated_ ( true )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
 #endif
 {
-    value_.string_ = valueAllocator ()->duplicateStringValue ( beginValue,
-                     UInt (endValue - beginValue) );
+    setString ( beginValue, UInt (endValue - beginValue) );
 }
 
 
 Value::Value ( const std::string& value )
     : type_ ( stringValue )
-    , allocated_ ( true )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
 #endif
 {
-    value_.string_ = valueAllocator ()->duplicateStringValue ( value.c_str (),
-                     (unsigned int)value.length () );
-
+    setString ( value.c_str (), (unsigned int)value.length () );
 }
 
 Value::Value (beast::String const& beastString)
     : type_ ( stringValue )
-    , allocated_ ( true )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
 #endif
 {
-    value_.string_ = valueAllocator ()->duplicateStringValue ( beastString.toStdString ().c_str (),
-                     (unsigned int)beastString.length () );
-
+    setString ( beastString.toStdString ().c_str (),
+                (unsigned int)beastString.length () );
 }
 
 Value::Value ( const StaticString& value )
     : type_ ( stringValue )
     , allocated_ ( false )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -421,18 +728,19 @@ Value::Value ( const StaticString& value )
 # ifdef JSON_USE_CPPTL
 Value::Value ( const CppTL::ConstString& value )
     : type_ ( stringValue )
-    , allocated_ ( true )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
 #endif
 {
-    value_.string_ = valueAllocator ()->duplicateStringValue ( value, value.length () );
+    setString ( value, value.length () );
 }
 # endif
 
 Value::Value ( bool value )
     : type_ ( booleanValue )
+    , allocated_ ( 0 )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -444,6 +752,8 @@ Value::Value ( bool value )
 
 Value::Value ( const Value& other )
     : type_ ( other.type_ )
+    , allocated_ ( 0 )
+    , inline_ ( 0 )
     , comments_ ( 0 )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( 0 )
@@ -460,11 +770,14 @@ Value::Value ( const Value& other )
         break;
 
     case stringValue:
-        if ( other.value_.string_ )
+        if ( other.inline_  ||  ( other.value_.string_  &&  !other.allocated_ ) )
         {
-            value_.string_ = valueAllocator ()->duplicateStringValue ( other.value_.string_ );
-            allocated_ = true;
+            // Inline and static strings are copied as they are
+            value_ = other.value_;
+            inline_ = other.inline_;
         }
+        else if ( other.value_.string_ )
+            setString ( other.value_.string_, (unsigned int)strlen ( other.value_.string_ ) );
         else
             value_.string_ = 0;
 
@@ -558,6 +871,7 @@ Value::Value ( Value&& other )
     : value_ ( other.value_ )
     , type_ ( other.type_ )
     , allocated_ ( other.allocated_ )
+    , inline_ ( other.inline_ )
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     , itemIsUsed_ ( other.itemIsUsed_ )
     , memberNameIsStatic_ ( other.memberNameIsStatic_ )
@@ -587,6 +901,10 @@ Value::swap ( Value& other )
     allocated_ = other.allocated_;
     other.allocated_ = temp2;
 
+    temp2 = inline_;
+    inline_ = other.inline_;
+    other.inline_ = temp2;
+
 # ifdef JSON_VALUE_USE_INTERNAL_MAP
     unsigned temp3 = itemIsUsed_;
     itemIsUsed_ = other.itemIsUsed_;
@@ -605,6 +923,30 @@ Value::type () const
     return type_;
 }
 
+void
+Value::setString ( const char* value, unsigned int length )
+{
+    if ( length < sizeof ( value_.chars_ ) )
+    {
+        memcpy ( value_.chars_, value, length );
+        value_.chars_[length] = 0;
+        allocated_ = false;
+        inline_ = true;
+    }
+    else
+    {
+        value_.string_ = valueAllocator ()->duplicateStringValue ( value, length );
+        allocated_ = true;
+        inline_ = false;
+    }
+}
+
+const char*
+Value::stringData () const
+{
+    return inline_ ? value_.chars_ : value_.string_;
+}
+
 
 int
 Value::compare ( const Value& other )
@@ -662,10 +1004,14 @@ Value::operator < ( const Value& other ) const
         return value_.bool_ < other.value_.bool_;
 
     case stringValue:
-        return ( value_.string_ == 0  &&  other.value_.string_ )
-               || ( other.value_.string_
-                    &&  value_.string_
-                    && strcmp ( value_.string_, other.value_.string_ ) < 0 );
+    {
+        const char* const string = stringData ();
+        const char* const otherString = other.stringData ();
+        return ( string == 0  &&  otherString )
+               || ( otherString
+                    &&  string
+                    && strcmp ( string, otherString ) < 0 );
+    }
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
 
     case arrayValue:
@@ -743,10 +1089,14 @@ Value::operator == ( const Value& other ) const
         return value_.bool_ == other.value_.bool_;
 
     case stringValue:
-        return ( value_.string_ == other.value_.string_ )
-               || ( other.value_.string_
-                    &&  value_.string_
-                    && strcmp ( value_.string_, other.value_.string_ ) == 0 );
+    {
+        const char* const string = stringData ();
+        const char* const otherString = other.stringData ();
+        return ( string == otherString )
+               || ( otherString
+                    &&  string
+                    && strcmp ( string, otherString ) == 0 );
+    }
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
 
     case arrayValue:
@@ -779,7 +1129,7 @@ const char*
 Value::asCString () const
 {
     JSON_ASSERT ( type_ == stringValue );
-    return value_.string_;
+    return stringData ();
 }
 
 
@@ -792,7 +1142,7 @@ Value::asString () const
         return "";
 
     case stringValue:
-        return value_.string_ ? value_.string_ : "";
+        return stringData () ? stringData () : "";
 
     case booleanValue:
         return value_.bool_ ? "true" : "false";
@@ -844,7 +1194,7 @@ Value::asInt () const
         return value_.bool_ ? 1 : 0;
 
     case stringValue:
-        return beast::lexicalCastThrow <int> (value_.string_);
+        return beast::lexicalCastThrow <int> (stringData ());
 
     case arrayValue:
     case objectValue:
@@ -880,7 +1230,7 @@ Value::asUInt () const
         return value_.bool_ ? 1 : 0;
 
     case stringValue:
-        return beast::lexicalCastThrow <unsigned int> (value_.string_);
+        return beast::lexicalCastThrow <unsigned int> (stringData ());
 
     case arrayValue:
     case objectValue:
@@ -944,7 +1294,7 @@ Value::asBool () const
         return value_.bool_;
 
     case stringValue:
-        return value_.string_  &&  value_.string_[0] != 0;
+        return stringData ()  &&  stringData ()[0] != 0;
 
     case arrayValue:
     case objectValue:
@@ -1000,7 +1350,7 @@ Value::isConvertibleTo ( ValueType other ) const
 
     case stringValue:
         return other == stringValue
-               || ( other == nullValue  &&  (!value_.string_  ||  value_.string_[0] == 0) );
+               || ( other == nullValue  &&  (!stringData ()  ||  stringData ()[0] == 0) );
 
     case arrayValue:
         return other == arrayValue
@@ -1038,7 +1388,7 @@ Value::size () const
         {
             ObjectValues::const_iterator itLast = value_.map_->end ();
             --itLast;
-            return (*itLast).first.index () + 1;
+            return itLast->key.index () + 1;
         }
 
         return 0;
@@ -1149,12 +1499,11 @@ Value::operator[] ( UInt index )
     CZString key ( index );
     ObjectValues::iterator it = value_.map_->lower_bound ( key );
 
-    if ( it != value_.map_->end ()  &&  (*it).first == key )
-        return (*it).second;
+    if ( it != value_.map_->end ()  &&  it->key == key )
+        return *it->value;
 
-    ObjectValues::value_type defaultValue ( key, null );
-    it = value_.map_->insert ( it, defaultValue );
-    return (*it).second;
+    it = value_.map_->insert ( it, key );
+    return *it->value;
 #else
     return value_.array_->resolveReference ( index );
 #endif
@@ -1176,7 +1525,7 @@ Value::operator[] ( UInt index ) const
     if ( it == value_.map_->end () )
         return null;
 
-    return (*it).second;
+    return *it->value;
 #else
     Value* value = value_.array_->find ( index );
     return value ? *value : null;
@@ -1205,13 +1554,11 @@ Value::resolveReference ( const char* key,
                          : CZString::duplicateOnCopy );
     ObjectValues::iterator it = value_.map_->lower_bound ( actualKey );
 
-    if ( it != value_.map_->end ()  &&  (*it).first == actualKey )
-        return (*it).second;
+    if ( it != value_.map_->end ()  &&  it->key == actualKey )
+        return *it->value;
 
-    ObjectValues::value_type defaultValue ( actualKey, null );
-    it = value_.map_->insert ( it, defaultValue );
-    Value& value = (*it).second;
-    return value;
+    it = value_.map_->insert ( it, actualKey );
+    return *it->value;
 #else
     return value_.map_->resolveReference ( key, isStatic );
 #endif
@@ -1250,7 +1597,7 @@ Value::operator[] ( const char* key ) const
     if ( it == value_.map_->end () )
         return null;
 
-    return (*it).second;
+    return *it->value;
 #else
     const Value* value = value_.map_->find ( key );
     return value ? *value : null;
@@ -1332,7 +1679,7 @@ Value::removeMember ( const char* key )
     if ( it == value_.map_->end () )
         return null;
 
-    Value old (it->second);
+    Value old (std::move (*it->value));
     value_.map_->erase (it);
     return old;
 #else
@@ -1405,7 +1752,7 @@ Value::getMemberNames () const
     ObjectValues::const_iterator itEnd = value_.map_->end ();
 
     for ( ; it != itEnd; ++it )
-        members.push_back ( std::string ( (*it).first.c_str () ) );
+        members.push_back ( std::string ( it->key.c_str () ) );
 
 #else
     ValueInternalMap::IteratorState it;
@@ -70,7 +70,7 @@ Value&
 ValueIteratorBase::deref () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    return current_->second;
+    return *current_->value;
 #else
 
     if ( isArray_ )
@@ -115,34 +115,17 @@ ValueIteratorBase::difference_type
 ValueIteratorBase::computeDistance ( const SelfType& other ) const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-# ifdef JSON_USE_CPPTL_SMALLMAP
-    return current_ - other.current_;
-# else
-
     // Iterator for null value are initialized using the default
-    // constructor, which initialize current_ to the default
-    // std::map::iterator. As begin() and end() are two instance
-    // of the default std::map::iterator, they can not be compared.
-    // To allow this, we handle this comparison specifically.
+    // constructor, which initialize current_ to a singular iterator.
+    // As begin() and end() are two such iterators, they can not be
+    // compared. To allow this, we handle this comparison specifically.
     if ( isNull_  &&  other.isNull_ )
     {
         return 0;
     }
 
-
-    // Usage of std::distance is not portable (does not compile with Sun Studio 12 RogueWave STL,
-    // which is the one used by default).
-    // Using a portable hand-made version for non random iterator instead:
-    //   return difference_type( std::distance( current_, other.current_ ) );
-    difference_type myDistance = 0;
-
-    for ( Value::ObjectValues::iterator it = current_; it != other.current_; ++it )
-    {
-        ++myDistance;
-    }
-
-    return myDistance;
-# endif
+    // The number of steps from this iterator to other
+    return difference_type ( other.current_ - current_ );
 #else
 
     if ( isArray_ )
@@ -193,7 +176,7 @@ Value
 ValueIteratorBase::key () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const Value::CZString czstring = (*current_).first;
+    const Value::CZString& czstring = current_->key;
 
     if ( czstring.c_str () )
     {
@@ -224,7 +207,7 @@ UInt
 ValueIteratorBase::index () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const Value::CZString czstring = (*current_).first;
+    const Value::CZString& czstring = current_->key;
 
     if ( !czstring.c_str () )
         return czstring.index ();
@@ -244,7 +227,7 @@ const char*
 ValueIteratorBase::memberName () const
 {
 #ifndef JSON_VALUE_USE_INTERNAL_MAP
-    const char* name = (*current_).first.c_str ();
+    const char* name = current_->key.c_str ();
     return name ? name : "";
 #else
 
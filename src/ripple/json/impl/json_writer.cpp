@@ -252,22 +252,19 @@ FastWriter::writeValue ( const Value& value )
 
     case objectValue:
     {
-        Value::Members members ( value.getMemberNames () );
         document_ += "{";
 
-        for ( Value::Members::iterator it = members.begin ();
-                it != members.end ();
+        for ( Value::const_iterator it = value.begin ();
+                it != value.end ();
                 ++it )
         {
-            const std::string& name = *it;
-
-            if ( it != members.begin () )
+            if ( it != value.begin () )
                 document_ += ",";
 
-            document_ += valueToQuotedString ( name.c_str () );
+            document_ += valueToQuotedString ( it.memberName () );
             document_ += yamlCompatiblityEnabled_ ? ": "
                          : ":";
-            writeValue ( value[name] );
+            writeValue ( *it );
         }
 
         document_ += "}";
@@ -19,9 +19,15 @@
 
 #include "../../BeastConfig.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <iomanip>
+#include <new>
 #include <sstream>
 #include <string>
 
@@ -43,6 +49,8 @@
 #include "impl/json_reader.cpp"
 #include "impl/json_value.cpp"
 #include "impl/json_writer.cpp"
+#include "impl/JsonParser.cpp"
+#include "impl/JsonStream.cpp"
 
 #include "impl/Tests.cpp"
 
@@ -46,7 +46,9 @@
 #include "api/json_features.h"
 #include "api/json_value.h"
 #include "api/json_reader.h"
+#include "api/JsonParser.h"
 #include "api/json_writer.h"
+#include "api/JsonStream.h"
 
 #include "api/JsonPropertyStream.h"
 
@@ -122,6 +122,18 @@ public:
     /** Called when legacy IP/port addresses are received. */
     virtual void on_legacy_endpoints (IPAddresses const& addresses) = 0;
 
+    /** Called with the round trip time of a ping to an active slot. */
+    virtual void on_latency (Slot::ptr const& slot,
+        std::chrono::milliseconds latency) = 0;
+
+    /** Called periodically with the number of useful messages a slot
+        delivered since the previous call.
+        Messages are useful when we had not already received them from
+        another peer.
+    */
+    virtual void on_useful (Slot::ptr const& slot,
+        std::uint32_t count) = 0;
+
     /** Called when the slot is closed.
         This always happens when the socket is closed, unless the socket
         was canceled.
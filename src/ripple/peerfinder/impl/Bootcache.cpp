@@ -181,6 +181,26 @@ Bootcache::on_failure (beast::IP::Endpoint const& endpoint)
     flagForUpdate();
 }
 
+void
+Bootcache::on_latency (beast::IP::Endpoint const& endpoint,
+    std::chrono::milliseconds latency)
+{
+    auto const iter (m_map.left.find (endpoint));
+    if (iter == m_map.left.end ())
+        return;
+    Entry entry (iter->second);
+    if (entry.latency() == latency)
+        return;
+    entry.latency() = latency;
+    m_map.left.erase (iter);
+    auto const result (m_map.insert (
+        value_type (endpoint, entry)));
+    assert (result.second);
+    if (m_journal.trace) m_journal.trace << beast::leftw (18) <<
+        "Bootcache latency " << endpoint <<
+        " at " << latency.count() << "ms";
+}
+
 void
 Bootcache::periodicActivity ()
 {
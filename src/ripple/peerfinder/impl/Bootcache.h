@@ -38,9 +38,14 @@ namespace PeerFinder {
         consecutive connection attempts when positive, and the number of
         failed consecutive connection attempts when negative.
 
+    Latency
+        The smoothed round trip time measured while we were connected to
+        the address, or zero if it was never measured. Latency is kept in
+        memory only and is not saved to the Store.
+
     When choosing addresses from the boot cache for the purpose of
     establishing outgoing connections, addresses are ranked in decreasing
-    order of high uptime, with valence as the tie breaker.
+    order of valence, with lower latency as the tie breaker.
 */
 class Bootcache
 {
@@ -48,8 +53,11 @@ private:
     class Entry
     {
     public:
-        Entry (int valence)
+        Entry (int valence,
+            std::chrono::milliseconds latency =
+                std::chrono::milliseconds (0))
             : m_valence (valence)
+            , m_latency (latency)
         {
         }
 
@@ -63,15 +71,36 @@ private:
             return m_valence;
         }
 
+        std::chrono::milliseconds& latency ()
+        {
+            return m_latency;
+        }
+
+        std::chrono::milliseconds latency () const
+        {
+            return m_latency;
+        }
+
+        // Unmeasured entries rank behind quick ones but ahead of slow ones
+        std::chrono::milliseconds rank_latency () const
+        {
+            if (m_latency.count () == 0)
+                return Tuning::bootcacheUnknownLatency;
+            return m_latency;
+        }
+
         friend bool operator< (Entry const& lhs, Entry const& rhs)
         {
             if (lhs.valence() > rhs.valence())
                 return true;
-            return false;
+            if (lhs.valence() < rhs.valence())
+                return false;
+            return lhs.rank_latency() < rhs.rank_latency();
         }
 
     private:
         int m_valence;
+        std::chrono::milliseconds m_latency;
     };
 
     typedef boost::bimaps::unordered_set_of <beast::IP::Endpoint> left_t;
@@ -123,7 +152,9 @@ public:
     /** Returns the number of entries in the cache. */
     map_type::size_type size() const;
 
-    /** IP::Endpoint iterators that traverse in decreasing valence. */
+    /** IP::Endpoint iterators that traverse in decreasing valence,
+        then increasing latency.
+    */
     /** @{ */
     const_iterator begin() const;
     const_iterator cbegin() const;
@@ -144,6 +175,10 @@ public:
     /** Called when an outbound connection attempt fails to handshake. */
     void on_failure (beast::IP::Endpoint const& endpoint);
 
+    /** Called with the measured latency of an outbound connection. */
+    void on_latency (beast::IP::Endpoint const& endpoint,
+        std::chrono::milliseconds latency);
+
     /** Stores the cache in the persistent database on a timer. */
     void periodicActivity ();
 
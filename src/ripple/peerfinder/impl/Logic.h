@@ -121,6 +121,8 @@ public:
 
     clock_type::time_point m_whenBroadcast;
 
+    clock_type::time_point m_whenChurn;
+
     ConnectHandouts::Squelches m_squelches;
 
     //--------------------------------------------------------------------------
@@ -138,6 +140,7 @@ public:
         , m_store (store)
         , m_checker (checker)
         , m_whenBroadcast (m_clock.now())
+        , m_whenChurn (m_clock.now() + Tuning::churnInterval)
         , m_squelches (m_clock)
     {
         setConfig (Config ());
@@ -703,6 +706,26 @@ public:
             "Logic cancel " << slot->remote_endpoint();
     }
 
+    void on_latency (SlotImp::ptr const& slot,
+        std::chrono::milliseconds latency)
+    {
+        SharedState::Access state (m_state);
+
+        slot->quality.on_latency (latency);
+
+        // Remember how quick the address was for the next time we connect
+        if (! slot->inbound ())
+            state->bootcache.on_latency (slot->remote_endpoint (),
+                slot->quality.latency ());
+    }
+
+    void on_useful (SlotImp::ptr const& slot, std::uint32_t count)
+    {
+        SharedState::Access state (m_state);
+
+        slot->quality.on_useful (count);
+    }
+
     //--------------------------------------------------------------------------
 
     // Returns `true` if the address matches a fixed slot address
@@ -923,6 +946,48 @@ public:
             broadcast ();
             m_whenBroadcast = now + Tuning::secondsPerMessage;
         }
+
+        if (m_whenChurn <= now)
+        {
+            churn (state);
+            m_whenChurn = now + Tuning::churnInterval;
+        }
+    }
+
+    // Gives up the slot of the outbound peer with the worst quality so that
+    // autoconnect can try a different address in its place. We only churn
+    // when the outbound slots are full, and never fixed or cluster peers.
+    void churn (SharedState::Access& state)
+    {
+        if (state->counts.out_active () < state->counts.out_max ())
+            return;
+
+        Slots::iterator const iter (worst_quality (
+            state->slots.begin (), state->slots.end (),
+            [](Slots::value_type const& entry) -> Quality const*
+            {
+                SlotImp const& slot (*entry.second);
+                if (slot.inbound () || slot.fixed () || slot.cluster () ||
+                    slot.state () != Slot::active)
+                    return nullptr;
+                return &slot.quality;
+            }));
+
+        if (iter == state->slots.end ())
+            return;
+
+        SlotImp::ptr const slot (iter->second);
+        if (m_journal.debug) m_journal.debug << beast::leftw (18) <<
+            "Logic churn " << slot->remote_endpoint () <<
+            " at " << slot->quality.latency ().count () << "ms";
+
+        // Don't reconnect to the same address right away
+        auto const result (m_squelches.insert (
+            slot->remote_endpoint ().address ()));
+        if (! result.second)
+            m_squelches.touch (result.first);
+
+        m_callback.disconnect (slot, true);
     }
 
     //--------------------------------------------------------------------------
@@ -1133,6 +1198,12 @@ public:
                 item ["fixed"]      = "yes";
             if (slot.cluster())
                 item ["cluster"]    = "yes";
+            if (slot.quality.measured())
+            {
+                item ["latency"]    = std::uint32_t (
+                    slot.quality.latency().count());
+                item ["useful"]     = slot.quality.useful();
+            }
             
             item ["state"] = stateString (slot.state());
         }
@@ -145,6 +145,19 @@ public:
         m_logic.on_legacy_endpoints (addresses);
     }
 
+    void on_latency (Slot::ptr const& slot,
+        std::chrono::milliseconds latency)
+    {
+        SlotImp::ptr impl (std::dynamic_pointer_cast <SlotImp> (slot));
+        m_logic.on_latency (impl, latency);
+    }
+
+    void on_useful (Slot::ptr const& slot, std::uint32_t count)
+    {
+        SlotImp::ptr impl (std::dynamic_pointer_cast <SlotImp> (slot));
+        m_logic.on_useful (impl, count);
+    }
+
     void on_closed (Slot::ptr const& slot)
     {
         SlotImp::ptr impl (std::dynamic_pointer_cast <SlotImp> (slot));
@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PEERFINDER_QUALITY_H_INCLUDED
+#define RIPPLE_PEERFINDER_QUALITY_H_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+namespace PeerFinder {
+
+/** Measures how quickly and how usefully a connected peer responds.
+
+    Latency is the round trip time of the overlay's ping messages. The
+    useful count is the number of messages the peer delivered that we had
+    not already seen, reported once per ping interval. Both are smoothed
+    so that a single slow reply does not cost a peer its slot.
+*/
+class Quality
+{
+public:
+    Quality ()
+        : m_latency (0)
+        , m_useful (0)
+        , m_reports (0)
+    {
+    }
+
+    /** Returns `true` if a round trip time has been measured. */
+    bool measured () const
+    {
+        return m_latency.count () > 0;
+    }
+
+    /** Returns the smoothed round trip time, or zero if unmeasured. */
+    std::chrono::milliseconds latency () const
+    {
+        return m_latency;
+    }
+
+    /** Returns the smoothed number of useful messages per report. */
+    std::uint32_t useful () const
+    {
+        return m_useful;
+    }
+
+    /** Called with each measured round trip time. */
+    void on_latency (std::chrono::milliseconds latency)
+    {
+        // Zero is reserved to mean unmeasured
+        latency = std::max (latency, std::chrono::milliseconds (1));
+        if (! measured ())
+            m_latency = latency;
+        else
+            m_latency = (m_latency * (Tuning::qualitySmoothing - 1) +
+                latency) / Tuning::qualitySmoothing;
+    }
+
+    /** Called once per interval with the number of useful messages. */
+    void on_useful (std::uint32_t count)
+    {
+        if (m_reports++ == 0)
+            m_useful = count;
+        else
+            m_useful = (m_useful * (Tuning::qualitySmoothing - 1) +
+                count) / Tuning::qualitySmoothing;
+    }
+
+    /** Returns a figure of merit where higher is better.
+        Unmeasured peers score zero.
+    */
+    double score () const
+    {
+        if (! measured ())
+            return 0;
+        return (1.0 + m_useful) * 1000 / m_latency.count ();
+    }
+
+private:
+    std::chrono::milliseconds m_latency;
+    std::uint32_t m_useful;
+    std::size_t m_reports;
+};
+
+/** Picks the connection that should give up its slot to a new one.
+
+    `quality` is called for each element and returns a pointer to its
+    Quality, or `nullptr` if the element may not be replaced. The element
+    with the lowest score is returned when enough peers are measured and
+    its score falls well below the median, otherwise `last` is returned.
+*/
+template <class FwdIter, class QualityOf>
+FwdIter
+worst_quality (FwdIter first, FwdIter last, QualityOf quality)
+{
+    std::vector <double> scores;
+    FwdIter worst (last);
+    double worstScore (0);
+    for (FwdIter iter (first); iter != last; ++iter)
+    {
+        Quality const* const q (quality (*iter));
+        if (q == nullptr || ! q->measured ())
+            continue;
+        double const score (q->score ());
+        scores.push_back (score);
+        if (worst == last || score < worstScore)
+        {
+            worst = iter;
+            worstScore = score;
+        }
+    }
+
+    if (scores.size () < Tuning::churnMinMeasured)
+        return last;
+
+    auto const middle (scores.begin () + scores.size () / 2);
+    std::nth_element (scores.begin (), middle, scores.end ());
+    if (worstScore * 100 >= *middle * Tuning::churnPercent)
+        return last;
+
+    return worst;
+}
+
+}
+}
+
+#endif
@@ -21,6 +21,7 @@
 #define RIPPLE_PEERFINDER_SLOTIMP_H_INCLUDED
 
 #include "../api/Slot.h"
+#include "Quality.h"
 
 #include "../../../beast/beast/container/aged_unordered_map.h"
 #include "../../../beast/beast/container/aged_container_utility.h"
@@ -139,6 +140,9 @@ public:
         recent.expire();
     }
 
+    /** Latency and usefulness measured while the slot is active. */
+    Quality quality;
+
 private:
     bool const m_inbound;
     bool const m_fixed;
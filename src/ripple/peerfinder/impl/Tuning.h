@@ -130,6 +130,31 @@ static std::chrono::seconds const liveCacheSecondsToLive (30);
 // Note that we ignore the port for purposes of comparison.
 static std::chrono::seconds const recentAttemptDuration (60);
 
+//------------------------------------------------------------------------------
+//
+// Quality
+//
+//------------------------------------------------------------------------------
+
+enum
+{
+    // Weight of the history when smoothing latency and useful counts
+    qualitySmoothing = 4
+
+    // The number of measured outbound peers needed before we churn
+    ,churnMinMeasured = 5
+
+    // We replace the worst outbound peer when its score is below
+    // this percentage of the median score.
+    ,churnPercent = 25
+};
+
+// How often we consider replacing the worst outbound peer
+static std::chrono::seconds const churnInterval (5 * 60);
+
+// The latency assumed for bootcache entries that were never measured
+static std::chrono::milliseconds const bootcacheUnknownLatency (250);
+
 }
 /** @} */
 
@@ -55,6 +55,7 @@
 #include "impl/Checker.h"
 #include "impl/CheckerAdapter.h"
 #include "impl/Livecache.h"
+#include "impl/Quality.h"
 #include "impl/SlotImp.h"
 #include "impl/Counts.h"
 #include "impl/Source.h"
@@ -84,4 +85,5 @@
 #include "sim/Message.h"
 #include "sim/NodeSnapshot.h"
 #include "sim/Params.h"
+#include "sim/LatencySimulation.cpp"
 #include "sim/Tests.cpp"
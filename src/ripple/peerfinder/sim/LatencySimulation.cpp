@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace ripple {
+namespace PeerFinder {
+namespace Sim {
+
+/** Compares broadcast convergence with and without quality churn.
+
+    Nodes are scattered over a square and the latency of a link grows with
+    the distance between its ends. Each node starts with randomly chosen
+    outbound peers. In every round a few messages are broadcast from random
+    nodes along the fastest paths, each node credits the neighbors that
+    delivered a message first as useful, measures the round trip time of
+    its outbound links, and then uses worst_quality to replace at most one
+    outbound peer, as Logic::churn does. The replacement is the quickest of
+    a few random addresses. The simulation reports how long a broadcast
+    takes to reach every node.
+*/
+class LatencySimulation_test : public beast::unit_test::suite
+{
+public:
+    static int const numberOfNodes = 200;
+    static int const outboundPeers = 8;
+    static int const churnRounds = 40;
+    static int const broadcastsPerRound = 20;
+    static int const measuredBroadcasts = 100;
+    static int const replacementChoices = 3;
+
+    struct Link
+    {
+        explicit Link (int peer_)
+            : peer (peer_)
+        {
+        }
+
+        int peer;
+        Quality quality;
+    };
+
+    struct Node
+    {
+        double x;
+        double y;
+        std::vector <Link> out;
+    };
+
+    struct Result
+    {
+        Result ()
+            : meanTime (0)
+            , maxTime (0)
+        {
+        }
+
+        // Milliseconds for a broadcast to reach every node
+        double meanTime;
+        double maxTime;
+    };
+
+    //--------------------------------------------------------------------------
+
+    /** The one way delay of a link in milliseconds. */
+    static double delay (Node const& a, Node const& b)
+    {
+        double const dx (a.x - b.x);
+        double const dy (a.y - b.y);
+        return 5 + 150 * std::sqrt (dx * dx + dy * dy);
+    }
+
+    // Links are usable in both directions
+    typedef std::vector <std::vector <int>> Graph;
+
+    static Graph graph (std::vector <Node> const& nodes)
+    {
+        Graph g (nodes.size ());
+        for (std::size_t i = 0; i < nodes.size (); ++i)
+        {
+            for (auto const& link : nodes [i].out)
+            {
+                g [i].push_back (link.peer);
+                g [link.peer].push_back (int (i));
+            }
+        }
+        return g;
+    }
+
+    /** Fastest arrival times from source, and who delivered each first. */
+    static void broadcast (std::vector <Node> const& nodes, Graph const& g,
+        int source, std::vector <double>& arrival, std::vector <int>& from)
+    {
+        arrival.assign (nodes.size (), -1);
+        from.assign (nodes.size (), -1);
+
+        typedef std::pair <double, int> Entry;
+        std::priority_queue <Entry, std::vector <Entry>,
+            std::greater <Entry>> queue;
+        std::vector <bool> done (nodes.size (), false);
+        arrival [source] = 0;
+        queue.push (Entry (0, source));
+        while (! queue.empty ())
+        {
+            int const n (queue.top ().second);
+            queue.pop ();
+            if (done [n])
+                continue;
+            done [n] = true;
+            for (int const peer : g [n])
+            {
+                double const t (arrival [n] + delay (nodes [n], nodes [peer]));
+                if (arrival [peer] < 0 || t < arrival [peer])
+                {
+                    arrival [peer] = t;
+                    from [peer] = n;
+                    queue.push (Entry (t, peer));
+                }
+            }
+        }
+    }
+
+    /** Adds an outbound peer that isn't already connected.
+        With `choices` above one, the quickest of that many random
+        addresses is used, the way autoconnect prefers bootcache entries
+        with a lower measured latency.
+    */
+    static void connect (std::vector <Node>& nodes, int n, int choices,
+        std::mt19937& rng)
+    {
+        std::uniform_int_distribution <int> pick (0, numberOfNodes - 1);
+        auto const& out (nodes [n].out);
+        int best (-1);
+        while (choices > 0)
+        {
+            int const peer (pick (rng));
+            if (peer == n || std::any_of (out.begin (), out.end (),
+                [peer](Link const& link) { return link.peer == peer; }))
+                continue;
+            if (best < 0 || delay (nodes [n], nodes [peer]) <
+                    delay (nodes [n], nodes [best]))
+                best = peer;
+            --choices;
+        }
+        nodes [n].out.push_back (Link (best));
+    }
+
+    static Result measure (std::vector <Node> const& nodes, std::mt19937& rng)
+    {
+        std::uniform_int_distribution <int> pick (0, numberOfNodes - 1);
+        Graph const g (graph (nodes));
+        std::vector <double> arrival;
+        std::vector <int> from;
+        Result result;
+        for (int i = 0; i < measuredBroadcasts; ++i)
+        {
+            broadcast (nodes, g, pick (rng), arrival, from);
+            double const time (*std::max_element (
+                arrival.begin (), arrival.end ()));
+            result.meanTime += time / measuredBroadcasts;
+            result.maxTime = std::max (result.maxTime, time);
+        }
+        return result;
+    }
+
+    //--------------------------------------------------------------------------
+
+    /** Runs the rounds, with or without churn. */
+    Result simulate (bool churn)
+    {
+        // The same seed gives the same starting network both times
+        std::mt19937 rng (5489);
+        std::uniform_real_distribution <double> position (0, 1);
+        std::uniform_real_distribution <double> jitter (0.9, 1.3);
+        std::uniform_int_distribution <int> pick (0, numberOfNodes - 1);
+
+        std::vector <Node> nodes (numberOfNodes);
+        for (auto& node : nodes)
+        {
+            node.x = position (rng);
+            node.y = position (rng);
+        }
+        for (int n = 0; n < numberOfNodes; ++n)
+            for (int i = 0; i < outboundPeers; ++i)
+                connect (nodes, n, 1, rng);
+
+        std::size_t churned (0);
+        std::vector <double> arrival;
+        std::vector <int> from;
+        for (int round = 0; round < churnRounds; ++round)
+        {
+            // Count the messages each node got first from each neighbor
+            Graph const g (graph (nodes));
+            std::vector <std::vector <std::uint32_t>> useful (numberOfNodes,
+                std::vector <std::uint32_t> (numberOfNodes, 0));
+            for (int i = 0; i < broadcastsPerRound; ++i)
+            {
+                broadcast (nodes, g, pick (rng), arrival, from);
+                for (int n = 0; n < numberOfNodes; ++n)
+                    if (from [n] >= 0)
+                        ++useful [n][from [n]];
+            }
+
+            for (int n = 0; n < numberOfNodes; ++n)
+            {
+                Node& node (nodes [n]);
+                for (auto& link : node.out)
+                {
+                    link.quality.on_latency (std::chrono::milliseconds (
+                        int (2 * delay (node, nodes [link.peer]) *
+                            jitter (rng))));
+                    link.quality.on_useful (useful [n][link.peer]);
+                }
+
+                if (! churn)
+                    continue;
+
+                auto const iter (worst_quality (
+                    node.out.begin (), node.out.end (),
+                    [](Link const& link) -> Quality const*
+                    {
+                        return &link.quality;
+                    }));
+                if (iter != node.out.end ())
+                {
+                    node.out.erase (iter);
+                    connect (nodes, n, replacementChoices, rng);
+                    ++churned;
+                }
+            }
+        }
+
+        Result const result (measure (nodes, rng));
+        log << (churn ? "churn" : "static") <<
+            ": " << result.meanTime << "ms mean, " <<
+            result.maxTime << "ms max to reach every node" <<
+            ", " << churned << " peers replaced";
+        return result;
+    }
+
+    void run ()
+    {
+        Result const fixed (simulate (false));
+        Result const churned (simulate (true));
+        expect (churned.meanTime < fixed.meanTime,
+            "churn makes broadcasts converge faster");
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(LatencySimulation,peerfinder,ripple);
+
+}
+}
+}
@@ -26,11 +26,17 @@ namespace Resource {
 typedef beast::abstract_clock <std::chrono::seconds> clock_type;
 
 // An entry in the table
+//
+// The key, shard and reference count are protected by the mutex of the
+// shard which owns the entry. The balances and the warning time are atomic
+// so that charging a consumer takes no lock at all.
+//
 struct Entry : public beast::List <Entry>::Node
 {
     // Dummy argument is necessary for zero-copy construction of elements
     Entry (int)
-        : refcount (0)
+        : shard (0)
+        , refcount (0)
         , remote_balance (0)
         , disposition (ok)
         , lastWarningTime (0)
@@ -59,35 +65,38 @@ struct Entry : public beast::List <Entry>::Node
     }
 
     // Balance including remote contributions
-    int balance (clock_type::rep const now)
+    int balance (clock_type::rep const now) const
     {
-        return local_balance.value (now) + remote_balance;
+        return local_balance.value (now) + remote_balance.load ();
     }
 
     // Add a charge and return normalized balance
     // including contributions from imports.
     int add (int charge, clock_type::rep const now)
     {
-        return local_balance.add (charge, now) + remote_balance;
+        return local_balance.add (charge, now) + remote_balance.load ();
     }
 
     // Back pointer to the map key (bit of a hack here)
     Key const* key;
 
+    // Index of the shard which owns this entry
+    std::size_t shard;
+
     // Number of Consumer references
     int refcount;
 
     // Exponentially decaying balance of resource consumption
-    DecayingSample <decayWindowSeconds> local_balance;
+    AtomicDecayingSample <decayWindowSeconds> local_balance;
 
     // Normalized balance contribution from imports
-    int remote_balance;
+    std::atomic <int> remote_balance;
 
     // Disposition
     Disposition disposition;
 
     // Time of the last warning
-    clock_type::rep lastWarningTime;
+    std::atomic <clock_type::rep> lastWarningTime;
 
     // For inactive entries, time after which this entry will be erased
     clock_type::rep whenExpires;
@@ -26,10 +26,11 @@ namespace Resource {
 /** A set of imported consumer data from a gossip origin. */
 struct Import
 {
+    // Each item holds a reference to its entry
     struct Item
     {
         int balance;
-        Consumer consumer;
+        Entry* entry;
     };
 
     // Dummy argument required for zero-copy construction
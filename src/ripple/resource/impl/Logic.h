@@ -24,6 +24,9 @@
 
 #include "../../beast/beast/chrono/abstract_clock.h"
 
+#include <algorithm>
+#include <mutex>
+
 namespace ripple {
 namespace Resource {
 
@@ -34,9 +37,14 @@ public:
     typedef ripple::unordered_map <std::string, Import> Imports;
     typedef ripple::unordered_map <Key, Entry, Key::hasher, Key::key_equal> Table;
 
-    struct State
+    // Consumers are spread over independently locked shards by the hash of
+    // their key. Only creating, copying and destroying a Consumer locks its
+    // shard; charges adjust the entry's atomic balance without a lock.
+    struct Shard
     {
-        // Table of all entries
+        std::mutex mutex;
+
+        // Table of all entries in this shard
         Table table;
 
         // List of all active inbound entries
@@ -50,12 +58,9 @@ public:
 
         // List of all inactve entries
         beast::List <Entry> inactive;
-
-        // All imported gossip data
-        Imports import_table;
     };
 
-    typedef beast::SharedData <State> SharedState;
+    typedef std::lock_guard <std::mutex> lock_guard;
 
     struct Stats
     {
@@ -69,7 +74,13 @@ public:
         beast::insight::Meter drop;
     };
 
-    SharedState m_state;
+    Key::hasher m_hasher;
+    std::vector <std::unique_ptr <Shard>> m_shards;
+
+    // All imported gossip data
+    std::mutex m_importMutex;
+    Imports m_imports;
+
     Stats m_stats;
     beast::abstract_clock <std::chrono::seconds>& m_clock;
     beast::Journal m_journal;
@@ -77,23 +88,23 @@ public:
     //--------------------------------------------------------------------------
 
     Logic (beast::insight::Collector::ptr const& collector,
-        clock_type& clock, beast::Journal journal)
+        clock_type& clock, beast::Journal journal,
+            std::size_t shards = consumerTableShards)
         : m_stats (collector)
         , m_clock (clock)
         , m_journal (journal)
     {
+        m_shards.reserve (std::max <std::size_t> (shards, 1));
+        do
+            m_shards.emplace_back (new Shard);
+        while (m_shards.size () < shards);
     }
 
     ~Logic ()
     {
-        // These have to be cleared before the Logic is destroyed
-        // since their destructors call back into the class.
-        // Order matters here as well, the import table has to be
-        // destroyed before the consumer table.
-        //
-        SharedState::UnlockedAccess state (m_state);
-        state->import_table.clear();
-        state->table.clear();
+        // The imports hold references to entries, so
+        // they are dropped before the consumer tables.
+        m_imports.clear ();
     }
 
     Consumer newInboundEndpoint (beast::IP::Endpoint const& address)
@@ -105,28 +116,12 @@ public:
         key.kind = kindInbound;
         key.address = address.at_port (0);
 
-        Entry* entry (nullptr);
-
-        {
-            SharedState::Access state (m_state);
-            std::pair <Table::iterator, bool> result (
-                state->table.emplace (key, 0));
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    state->inactive.erase (
-                        state->inactive.iterator_to (*entry));
-                state->inbound.push_back (*entry);
-            }
-        }
+        Entry& entry (insert (key));
 
         m_journal.debug <<
-            "New inbound endpoint " << *entry;
+            "New inbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Consumer newOutboundEndpoint (beast::IP::Endpoint const& address)
@@ -138,28 +133,12 @@ public:
         key.kind = kindOutbound;
         key.address = address;
 
-        Entry* entry (nullptr);
-
-        {
-            SharedState::Access state (m_state);
-            std::pair <Table::iterator, bool> result (
-                state->table.emplace (key, 0));
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    state->inactive.erase (
-                        state->inactive.iterator_to (*entry));
-                state->outbound.push_back (*entry);
-            }
-        }
+        Entry& entry (insert (key));
 
         m_journal.debug <<
-            "New outbound endpoint " << *entry;
+            "New outbound endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Consumer newAdminEndpoint (std::string const& name)
@@ -168,28 +147,12 @@ public:
         key.kind = kindAdmin;
         key.name = name;
 
-        Entry* entry (nullptr);
-
-        {
-            SharedState::Access state (m_state);
-            std::pair <Table::iterator, bool> result (
-                state->table.emplace (key, 0));
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    state->inactive.erase (
-                        state->inactive.iterator_to (*entry));
-                state->admin.push_back (*entry);
-            }
-        }
+        Entry& entry (insert (key));
 
         m_journal.debug <<
-            "New admin endpoint " << *entry;
+            "New admin endpoint " << entry;
 
-        return Consumer (*this, *entry);
+        return Consumer (*this, entry);
     }
 
     Entry& elevateToAdminEndpoint (Entry& prior, std::string const& name)
@@ -201,27 +164,9 @@ public:
         m_journal.info <<
             "Elevate " << prior << " to " << name;
 
-        Entry* entry (nullptr);
-
-        {
-            SharedState::Access state (m_state);
-            std::pair <Table::iterator, bool> result (
-                state->table.emplace (key, 0));
-            entry = &result.first->second;
-            entry->key = &result.first->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (! result.second)
-                    state->inactive.erase (
-                        state->inactive.iterator_to (*entry));
-                state->admin.push_back (*entry);
-            }
-
-            release (prior, state);
-        }
-
-        return *entry;
+        Entry& entry (insert (key));
+        release (prior);
+        return entry;
     }
 
     Json::Value getJson ()
@@ -234,46 +179,13 @@ public:
         clock_type::rep const now (m_clock.elapsed());
 
         Json::Value ret (Json::objectValue);
-        SharedState::Access state (m_state);
-
-        for (beast::List <Entry>::iterator iter (state->inbound.begin());
-            iter != state->inbound.end(); ++iter)
-        {
-            int localBalance = iter->local_balance.value (now);
-            if ((localBalance + iter->remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[iter->to_string()] = Json::objectValue);
-                entry["local"] = localBalance;
-                entry["remote"] = iter->remote_balance;
-                entry["type"] = "outbound";
-            }
 
-        }
-        for (beast::List <Entry>::iterator iter (state->outbound.begin());
-            iter != state->outbound.end(); ++iter)
+        for (auto const& shard : m_shards)
         {
-            int localBalance = iter->local_balance.value (now);
-            if ((localBalance + iter->remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[iter->to_string()] = Json::objectValue);
-                entry["local"] = localBalance;
-                entry["remote"] = iter->remote_balance;
-                entry["type"] = "outbound";
-            }
-
-        }
-        for (beast::List <Entry>::iterator iter (state->admin.begin());
-            iter != state->admin.end(); ++iter)
-        {
-            int localBalance = iter->local_balance.value (now);
-            if ((localBalance + iter->remote_balance) >= threshold)
-            {
-                Json::Value& entry = (ret[iter->to_string()] = Json::objectValue);
-                entry["local"] = localBalance;
-                entry["remote"] = iter->remote_balance;
-                entry["type"] = "admin";
-            }
-
+            lock_guard lock (shard->mutex);
+            writeJson (now, threshold, ret, shard->inbound, "outbound");
+            writeJson (now, threshold, ret, shard->outbound, "outbound");
+            writeJson (now, threshold, ret, shard->admin, "admin");
         }
 
         return ret;
@@ -284,19 +196,21 @@ public:
         clock_type::rep const now (m_clock.elapsed());
 
         Gossip gossip;
-        SharedState::Access state (m_state);
-
-        gossip.items.reserve (state->inbound.size());
 
-        for (beast::List <Entry>::iterator iter (state->inbound.begin());
-            iter != state->inbound.end(); ++iter)
+        for (auto const& shard : m_shards)
         {
-            Gossip::Item item;
-            item.balance = iter->local_balance.value (now);
-            if (item.balance >= minimumGossipBalance)
+            lock_guard lock (shard->mutex);
+
+            for (beast::List <Entry>::iterator iter (shard->inbound.begin());
+                iter != shard->inbound.end(); ++iter)
             {
-                item.address = iter->key->address;
-                gossip.items.push_back (item);
+                Gossip::Item item;
+                item.balance = iter->local_balance.value (now);
+                if (item.balance >= minimumGossipBalance)
+                {
+                    item.address = iter->key->address;
+                    gossip.items.push_back (item);
+                }
             }
         }
 
@@ -309,55 +223,36 @@ public:
     {
         clock_type::rep const now (m_clock.elapsed());
 
+        // Look up every entry first, locking each shard once for the
+        // whole batch instead of once per item.
+        std::vector <Key> keys;
+        keys.reserve (gossip.items.size());
+        for (std::vector <Gossip::Item>::const_iterator iter (gossip.items.begin());
+            iter != gossip.items.end(); ++iter)
+            keys.push_back (inboundKey (iter->address));
+
+        std::vector <Entry*> entries;
+        insert (keys, entries);
+
+        Import next;
+        next.whenExpires = now + gossipExpirationSeconds;
+        next.items.reserve (gossip.items.size());
+        for (std::size_t i = 0; i < entries.size(); ++i)
         {
-            SharedState::Access state (m_state);
-            std::pair <Imports::iterator, bool> result (
-                state->import_table.emplace (origin, 0));
-
-            if (result.second)
-            {
-                // This is a new import
-                Import& next (result.first->second);
-                next.whenExpires = now + gossipExpirationSeconds;
-                next.items.reserve (gossip.items.size());
-                for (std::vector <Gossip::Item>::const_iterator iter (gossip.items.begin());
-                    iter != gossip.items.end(); ++iter)
-                {
-                    Import::Item item;
-                    item.balance = iter->balance;
-                    item.consumer = newInboundEndpoint (iter->address);
-                    item.consumer.entry().remote_balance += item.balance;
-                    next.items.push_back (item);
-                }
-            }
-            else
-            {
-                // Previous import exists so add the new remote
-                // balances and then deduct the old remote balances.
-
-                Import next;
-                next.whenExpires = now + gossipExpirationSeconds;
-                next.items.reserve (gossip.items.size());
-                for (std::vector <Gossip::Item>::const_iterator iter (gossip.items.begin());
-                    iter != gossip.items.end(); ++iter)
-                {
-                    Import::Item item;
-                    item.balance = iter->balance;
-                    item.consumer = newInboundEndpoint (iter->address);
-                    item.consumer.entry().remote_balance += item.balance;
-                    next.items.push_back (item);
-                }
-
-                Import& prev (result.first->second);
-                for (std::vector <Import::Item>::iterator iter (prev.items.begin());
-                    iter != prev.items.end(); ++iter)
-                {
-                    iter->consumer.entry().remote_balance -= iter->balance;
-                }
+            Import::Item item;
+            item.balance = gossip.items[i].balance;
+            item.entry = entries[i];
+            item.entry->remote_balance += item.balance;
+            next.items.push_back (item);
+        }
 
-                std::swap (next, prev);
-            }
+        {
+            lock_guard lock (m_importMutex);
+            std::swap (m_imports[origin], next);
         }
+
+        // Deduct the balances of the import we replaced, if any
+        unimport (next);
     }
 
     //--------------------------------------------------------------------------
@@ -374,44 +269,52 @@ public:
     //
     void periodicActivity ()
     {
-        SharedState::Access state (m_state);
-
         clock_type::rep const now (m_clock.elapsed());
 
-        for (beast::List <Entry>::iterator iter (
-            state->inactive.begin()); iter != state->inactive.end();)
+        for (auto const& shard : m_shards)
         {
-            if (iter->whenExpires <= now)
-            {
-                m_journal.debug << "Expired " << *iter;
-                Table::iterator table_iter (
-                    state->table.find (*iter->key));
-                ++iter;
-                erase (table_iter, state);
-            }
-            else
+            lock_guard lock (shard->mutex);
+
+            for (beast::List <Entry>::iterator iter (
+                shard->inactive.begin()); iter != shard->inactive.end();)
             {
-                break;
+                if (iter->whenExpires <= now)
+                {
+                    m_journal.debug << "Expired " << *iter;
+                    Table::iterator table_iter (
+                        shard->table.find (*iter->key));
+                    ++iter;
+                    erase (table_iter, *shard);
+                }
+                else
+                {
+                    break;
+                }
             }
         }
 
-        Imports::iterator iter (state->import_table.begin());
-        while (iter != state->import_table.end())
+        std::vector <Import> expired;
+
         {
-            Import& import (iter->second);
-            if (iter->second.whenExpires <= now)
+            lock_guard lock (m_importMutex);
+
+            Imports::iterator iter (m_imports.begin());
+            while (iter != m_imports.end())
             {
-                for (std::vector <Import::Item>::iterator item_iter (import.items.begin());
-                    item_iter != import.items.end(); ++item_iter)
+                if (iter->second.whenExpires <= now)
                 {
-                    item_iter->consumer.entry().remote_balance -= item_iter->balance;
+                    expired.emplace_back ();
+                    std::swap (expired.back(), iter->second);
+                    iter = m_imports.erase (iter);
                 }
-
-                iter = state->import_table.erase (iter);
+                else
+                    ++iter;
             }
-            else
-                ++iter;
         }
+
+        for (std::vector <Import>::iterator iter (expired.begin());
+            iter != expired.end(); ++iter)
+            unimport (*iter);
     }
 
     //--------------------------------------------------------------------------
@@ -428,117 +331,181 @@ public:
         return Disposition::ok;
     }
 
-    void acquire (Entry& entry, SharedState::Access& state)
+    std::size_t shardOf (Key const& key)
     {
-        ++entry.refcount;
+        return m_hasher (key) % m_shards.size();
     }
 
-    void release (Entry& entry, SharedState::Access& state)
+    // The key of an inbound endpoint, or of the admin
+    // endpoint it maps to if the address is whitelisted.
+    Key inboundKey (beast::IP::Endpoint const& address)
     {
-        if (--entry.refcount == 0)
+        Key key;
+        if (isWhitelisted (address))
         {
-            m_journal.debug <<
-                "Inactive " << entry;
+            key.kind = kindAdmin;
+            key.name = to_string (address);
+        }
+        else
+        {
+            key.kind = kindInbound;
+            key.address = address.at_port (0);
+        }
+        return key;
+    }
 
-            switch (entry.key->kind)
-            {
-            case kindInbound:
-                state->inbound.erase (
-                    state->inbound.iterator_to (entry));
-                break;
-            case kindOutbound:
-                state->outbound.erase (
-                    state->outbound.iterator_to (entry));
-                break;
-            case kindAdmin:
-                state->admin.erase (
-                    state->admin.iterator_to (entry));
-                break;
-            default:
-                bassertfalse;
-                break;
-            }
-            state->inactive.push_back (entry);
-            entry.whenExpires = m_clock.elapsed() + secondsUntilExpiration;
+    static beast::List <Entry>& activeList (Shard& shard, Kind kind)
+    {
+        switch (kind)
+        {
+        case kindInbound:
+            return shard.inbound;
+        case kindOutbound:
+            return shard.outbound;
+        case kindAdmin:
+            return shard.admin;
+        default:
+            bassertfalse;
+            break;
         }
+        return shard.inbound;
     }
 
-    void erase (Table::iterator iter, SharedState::Access& state)
+    // Returns the entry for the key, creating it if needed, with
+    // one reference added. The caller must hold the shard's lock.
+    //
+    Entry& insert (Key const& key, std::size_t index)
     {
-        Entry& entry (iter->second);
-        bassert (entry.refcount == 0);
-        state->inactive.erase (
-            state->inactive.iterator_to (entry));
-        state->table.erase (iter);
+        Shard& shard (*m_shards [index]);
+        std::pair <Table::iterator, bool> result (
+            shard.table.emplace (key, 0));
+        Entry& entry (result.first->second);
+        entry.key = &result.first->first;
+        entry.shard = index;
+        ++entry.refcount;
+        if (entry.refcount == 1)
+        {
+            if (! result.second)
+                shard.inactive.erase (
+                    shard.inactive.iterator_to (entry));
+            activeList (shard, key.kind).push_back (entry);
+        }
+        return entry;
     }
 
-    Disposition charge (Entry& entry, Charge const& fee, SharedState::Access& state)
+    Entry& insert (Key const& key)
     {
-        clock_type::rep const now (m_clock.elapsed());
-        int const balance (entry.add (fee.cost(), now));
-        m_journal.trace <<
-            "Charging " << entry << " for " << fee;
-        return disposition (balance);
+        std::size_t const index (shardOf (key));
+        lock_guard lock (m_shards [index]->mutex);
+        return insert (key, index);
     }
 
-    bool warn (Entry& entry, SharedState::Access& state)
+    // Inserts a batch of keys, locking each shard at most once.
+    // The entries are returned in the same order as the keys.
+    void insert (std::vector <Key> const& keys, std::vector <Entry*>& entries)
     {
-        bool notify (false);
-        clock_type::rep const now (m_clock.elapsed());
-        if (entry.balance (now) >= warningThreshold && now != entry.lastWarningTime)
+        std::vector <std::pair <std::size_t, std::size_t>> order;
+        order.reserve (keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            order.emplace_back (shardOf (keys[i]), i);
+        std::sort (order.begin(), order.end());
+
+        entries.resize (keys.size());
+        for (std::size_t i = 0; i < order.size();)
+        {
+            std::size_t const index (order[i].first);
+            lock_guard lock (m_shards [index]->mutex);
+            for (; i < order.size() && order[i].first == index; ++i)
+                entries [order[i].second] = &insert (keys [order[i].second], index);
+        }
+    }
+
+    // Deducts the balances of an import which is no longer
+    // current and releases its references in one batch.
+    void unimport (Import& import)
+    {
+        std::vector <Entry*> entries;
+        entries.reserve (import.items.size());
+        for (std::vector <Import::Item>::iterator iter (import.items.begin());
+            iter != import.items.end(); ++iter)
         {
-            charge (entry, feeWarning, state);
-            notify = true;
-            entry.lastWarningTime = now;
+            iter->entry->remote_balance -= iter->balance;
+            entries.push_back (iter->entry);
         }
+        import.items.clear();
+        release (entries);
+    }
 
-        if (notify)
-            m_journal.info <<
-                "Load warning: " << entry;
+    void acquire (Entry& entry, Shard& shard)
+    {
+        ++entry.refcount;
+    }
 
-        if (notify)
-            ++m_stats.warn;
+    void release (Entry& entry, Shard& shard)
+    {
+        if (--entry.refcount == 0)
+        {
+            m_journal.debug <<
+                "Inactive " << entry;
 
-        return notify;
+            activeList (shard, entry.key->kind).erase (
+                activeList (shard, entry.key->kind).iterator_to (entry));
+            shard.inactive.push_back (entry);
+            entry.whenExpires = m_clock.elapsed() + secondsUntilExpiration;
+        }
     }
 
-    bool disconnect (Entry& entry, SharedState::Access& state)
+    // Releases a batch of entries, locking each shard at most once.
+    void release (std::vector <Entry*>& entries)
     {
-        bool drop (false);
-        clock_type::rep const now (m_clock.elapsed());
-        if (entry.balance (now) >= dropThreshold)
+        std::sort (entries.begin(), entries.end(),
+            [](Entry const* lhs, Entry const* rhs)
+            {
+                return lhs->shard < rhs->shard;
+            });
+
+        for (std::size_t i = 0; i < entries.size();)
         {
-            charge (entry, feeDrop, state);
-            drop = true;
+            std::size_t const index (entries[i]->shard);
+            Shard& shard (*m_shards [index]);
+            lock_guard lock (shard.mutex);
+            for (; i < entries.size() && entries[i]->shard == index; ++i)
+                release (*entries[i], shard);
         }
-        if (drop)
-            ++m_stats.drop;
-        return drop;
     }
 
-    int balance (Entry& entry, SharedState::Access& state)
+    void erase (Table::iterator iter, Shard& shard)
     {
-        return entry.balance (m_clock.elapsed());
+        Entry& entry (iter->second);
+        bassert (entry.refcount == 0);
+        shard.inactive.erase (
+            shard.inactive.iterator_to (entry));
+        shard.table.erase (iter);
     }
 
     //--------------------------------------------------------------------------
 
     void acquire (Entry& entry)
     {
-        SharedState::Access state (m_state);
-        acquire (entry, state);
+        Shard& shard (*m_shards [entry.shard]);
+        lock_guard lock (shard.mutex);
+        acquire (entry, shard);
     }
 
     void release (Entry& entry)
     {
-        SharedState::Access state (m_state);
-        release (entry, state);
+        Shard& shard (*m_shards [entry.shard]);
+        lock_guard lock (shard.mutex);
+        release (entry, shard);
     }
 
     Disposition charge (Entry& entry, Charge const& fee)
     {
-        SharedState::Access state (m_state);
-        return charge (entry, fee, state);
+        clock_type::rep const now (m_clock.elapsed());
+        int const balance (entry.add (fee.cost(), now));
+        m_journal.trace <<
+            "Charging " << entry << " for " << fee;
+        return disposition (balance);
     }
 
     bool warn (Entry& entry)
@@ -546,8 +513,24 @@ public:
         if (entry.admin())
             return false;
 
-        SharedState::Access state (m_state);
-        return warn (entry, state);
+        clock_type::rep const now (m_clock.elapsed());
+        if (entry.balance (now) < warningThreshold)
+            return false;
+
+        // At most one caller warns the entry each second
+        clock_type::rep last (entry.lastWarningTime.load ());
+        if (last == now || ! entry.lastWarningTime.compare_exchange_strong (
+            last, now))
+            return false;
+
+        charge (entry, feeWarning);
+
+        m_journal.info <<
+            "Load warning: " << entry;
+
+        ++m_stats.warn;
+
+        return true;
     }
 
     bool disconnect (Entry& entry)
@@ -555,18 +538,40 @@ public:
         if (entry.admin())
             return false;
 
-        SharedState::Access state (m_state);
-        return disconnect (entry, state);
+        clock_type::rep const now (m_clock.elapsed());
+        if (entry.balance (now) < dropThreshold)
+            return false;
+
+        charge (entry, feeDrop);
+        ++m_stats.drop;
+        return true;
     }
 
     int balance (Entry& entry)
     {
-        SharedState::Access state (m_state);
-        return balance (entry, state);
+        return entry.balance (m_clock.elapsed());
     }
 
     //--------------------------------------------------------------------------
 
+    void writeJson (clock_type::rep const now, int threshold,
+        Json::Value& ret, beast::List <Entry>& list, char const* type)
+    {
+        for (beast::List <Entry>::iterator iter (list.begin());
+            iter != list.end(); ++iter)
+        {
+            int localBalance = iter->local_balance.value (now);
+            int remoteBalance = iter->remote_balance.load ();
+            if ((localBalance + remoteBalance) >= threshold)
+            {
+                Json::Value& entry = (ret[iter->to_string()] = Json::objectValue);
+                entry["local"] = localBalance;
+                entry["remote"] = remoteBalance;
+                entry["type"] = type;
+            }
+        }
+    }
+
     void writeList (
         clock_type::rep const now,
             beast::PropertyStream::Set& items,
@@ -581,35 +586,31 @@ public:
             item ["name"] = iter->to_string();
             item ["balance"] = iter->balance(now);
             if (iter->remote_balance != 0)
-                item ["remote_balance"] = iter->remote_balance;
+                item ["remote_balance"] = iter->remote_balance.load ();
         }
     }
 
-    void onWrite (beast::PropertyStream::Map& map)
+    void writeList (
+        clock_type::rep const now,
+            beast::PropertyStream::Map& map, std::string const& name,
+                beast::List <Entry> Shard::* list)
     {
-        clock_type::rep const now (m_clock.elapsed());
-
-        SharedState::Access state (m_state);
-
+        beast::PropertyStream::Set items (name, map);
+        for (auto const& shard : m_shards)
         {
-            beast::PropertyStream::Set s ("inbound", map);
-            writeList (now, s, state->inbound);
-        }
-
-        {
-            beast::PropertyStream::Set s ("outbound", map);
-            writeList (now, s, state->outbound);
+            lock_guard lock (shard->mutex);
+            writeList (now, items, (*shard).*list);
         }
+    }
 
-        {
-            beast::PropertyStream::Set s ("admin", map);
-            writeList (now, s, state->admin);
-        }
+    void onWrite (beast::PropertyStream::Map& map)
+    {
+        clock_type::rep const now (m_clock.elapsed());
 
-        {
-            beast::PropertyStream::Set s ("inactive", map);
-            writeList (now, s, state->inactive);
-        }
+        writeList (now, map, "inbound", &Shard::inbound);
+        writeList (now, map, "outbound", &Shard::outbound);
+        writeList (now, map, "admin", &Shard::admin);
+        writeList (now, map, "inactive", &Shard::inactive);
     }
 };
 
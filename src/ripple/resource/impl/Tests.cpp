@@ -21,6 +21,8 @@
 #include "../../../beast/beast/chrono/manual_clock.h"
 #include "../../../beast/modules/beast_core/maths/Random.h"
 
+#include <thread>
+
 namespace ripple {
 namespace Resource {
 
@@ -181,7 +183,92 @@ public:
 
         logic.importConsumers ("g", g);
 
-        pass();
+        Consumer c (logic.newInboundEndpoint (item.address));
+        expect (c.balance() == 100);
+
+        // A new import from the same origin replaces the old one
+        g.items[0].balance = 200;
+        logic.importConsumers ("g", g);
+        expect (c.balance() == 200);
+
+        logic.importConsumers ("h", g);
+        expect (c.balance() == 400);
+
+        for (int i = 0; i <= gossipExpirationSeconds; ++i)
+            logic.advance();
+        logic.periodicActivity();
+        expect (c.balance() == 0);
+    }
+
+    void testDecay (beast::Journal j)
+    {
+        testcase ("Decay");
+
+        beast::Random r;
+        DecayingSample <decayWindowSeconds> sample;
+        AtomicDecayingSample <decayWindowSeconds> atomic;
+
+        int now (0);
+        bool same (true);
+        for (int i = 0; i < 10000 && same; ++i)
+        {
+            now += r.nextInt (5);
+            if (r.nextBool ())
+            {
+                int const value (r.nextInt (1000));
+                same = sample.add (value, now) == atomic.add (value, now);
+            }
+            else
+            {
+                same = sample.value (now) == atomic.value (now);
+            }
+        }
+        expect (same, "Atomic sample diverged");
+    }
+
+    void testConcurrency (beast::Journal j)
+    {
+        testcase ("Concurrency");
+
+        TestLogic logic (j);
+
+        int const threads (4);
+        int const charges (1000);
+
+        Consumer shared (logic.newInboundEndpoint (
+            beast::IP::Endpoint::from_string ("207.127.82.1")));
+
+        std::vector <std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back ([&, t] ()
+            {
+                for (int i = 0; i < charges; ++i)
+                {
+                    // Churn through short lived consumers as well
+                    Consumer c (logic.newInboundEndpoint (beast::IP::Endpoint (
+                        beast::IP::AddressV4 (207, 127, 83 + t, i % 200))));
+                    Consumer copy (shared);
+                    c.charge (Charge (1));
+                    copy.charge (Charge (decayWindowSeconds));
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join ();
+
+        // The clock did not move so nothing decayed
+        expect (shared.balance() == threads * charges);
+
+        for (int i = 0; i <= secondsUntilExpiration; ++i)
+            logic.advance();
+        logic.periodicActivity();
+
+        std::size_t size (0);
+        for (auto const& shard : logic.m_shards)
+            size += shard->table.size();
+        expect (size == 1, "Inactive entries not expired");
     }
 
     void testCharges (beast::Journal j)
@@ -233,10 +320,83 @@ public:
         testCharges (j);
         testImports (j);
         testImport (j);
+        testDecay (j);
+        testConcurrency (j);
     }
 };
 
 BEAST_DEFINE_TESTSUITE(Manager,resource,ripple);
 
+//------------------------------------------------------------------------------
+
+/** Many clients charging and connecting at once, as on a public server. */
+class Manager_timing_test : public beast::unit_test::suite
+{
+public:
+    void measure (std::size_t shards, int threads)
+    {
+        int const clients (1024);
+        int const calls (200000);
+
+        Logic logic (beast::insight::NullCollector::New(),
+            get_seconds_clock (), beast::Journal(), shards);
+
+        std::vector <Consumer> consumers;
+        consumers.reserve (clients);
+        for (int i = 0; i < clients; ++i)
+            consumers.push_back (logic.newInboundEndpoint (beast::IP::Endpoint (
+                beast::IP::AddressV4 (207, 127, i / 256, i % 256))));
+
+        typedef std::chrono::steady_clock clock_type;
+        clock_type::time_point const start (clock_type::now ());
+
+        std::vector <std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back ([&, t] ()
+            {
+                for (int i = t; i < calls; i += threads)
+                {
+                    Consumer& c (consumers [(i * 7919) % clients]);
+                    c.charge (feeReferenceRPC);
+                    c.warn ();
+                    c.disconnect ();
+
+                    // One call in sixteen is a new connection
+                    if ((i % 16) == 0)
+                    {
+                        Consumer fresh (logic.newInboundEndpoint (
+                            beast::IP::Endpoint (beast::IP::AddressV4 (
+                                208, (i >> 16) & 255, (i >> 8) & 255, i & 255))));
+                        fresh.charge (feeReferenceRPC);
+                    }
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join ();
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::nanoseconds> (clock_type::now () - start));
+
+        log << shards << " shards, " << threads << " threads: " <<
+            (elapsed.count () / double (calls)) << " ns per call";
+    }
+
+    void run ()
+    {
+        for (int threads = 1; threads <= 8; threads *= 2)
+        {
+            measure (1, threads);
+            measure (consumerTableShards, threads);
+        }
+
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Manager_timing,resource,ripple);
+
 }
 }
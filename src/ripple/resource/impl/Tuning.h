@@ -44,6 +44,9 @@ enum
 
     // Number of seconds until imported gossip expires
     ,gossipExpirationSeconds    = 30
+
+    // Number of independently locked shards in the consumer table
+    ,consumerTableShards        = 16
 };
 
 }
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SECP256K1_SECP256K1_H_INCLUDED
+#define RIPPLE_SECP256K1_SECP256K1_H_INCLUDED
+
+namespace ripple {
+
+/** Native ECDSA over the secp256k1 curve.
+
+    Secret keys are 32-byte big-endian integers in [1, n), public keys are
+    33-byte compressed points and signatures are DER encoded. Operations on
+    secret keys and nonces take time independent of their values.
+*/
+namespace Secp256k1 {
+
+/** Returns `true` if the value is a usable secret key. */
+bool isValidSecretKey (uint256 const& secret);
+
+/** Computes the compressed public key for a secret key.
+    @return `false` if the secret key is not valid.
+*/
+bool derivePublicKey (uint256 const& secret, Blob& publicKey);
+
+/** Computes (a + b) modulo the group order.
+    @return `false` if the result is not a valid secret key.
+*/
+bool addSecretKeys (uint256 const& a, uint256 const& b, uint256& result);
+
+/** Computes the public key of (s + tweak) from the public key of s.
+    @return `false` if the key or tweak is invalid or the sum is infinity.
+*/
+bool addPublicKey (void const* publicKey, std::size_t keySize,
+    uint256 const& tweak, Blob& result);
+
+/** Signs a hash, producing a fully canonical DER signature.
+    The nonce is derived from the key and hash as described in RFC 6979.
+    @return `false` if the secret key is not valid.
+*/
+bool sign (uint256 const& hash, uint256 const& secret, Blob& signature);
+
+/** Returns `true` if a signature is in the strict DER form verify takes.
+    Minimal integers in [1, n) are required; verify rejects anything else.
+*/
+bool isStrictSignature (void const* signature, std::size_t size);
+
+inline bool isStrictSignature (Blob const& signature)
+{
+    return ! signature.empty () &&
+        isStrictSignature (&signature[0], signature.size ());
+}
+
+/** Verifies a DER signature of a hash.
+    The public key may be compressed, uncompressed or hybrid.
+*/
+bool verify (uint256 const& hash, void const* publicKey, std::size_t keySize,
+    void const* signature, std::size_t signatureSize);
+
+inline bool verify (uint256 const& hash, Blob const& publicKey,
+    Blob const& signature)
+{
+    if (publicKey.empty () || signature.empty ())
+        return false;
+    return verify (hash, &publicKey[0], publicKey.size (),
+        &signature[0], signature.size ());
+}
+
+}
+
+}
+
+#endif
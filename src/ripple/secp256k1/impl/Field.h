@@ -0,0 +1,330 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SECP256K1_FIELD_H_INCLUDED
+#define RIPPLE_SECP256K1_FIELD_H_INCLUDED
+
+#include <cstdint>
+
+namespace ripple {
+namespace Secp256k1 {
+namespace detail {
+
+// Returns the low 64 bits of a * b + c + d and stores the high 64 bits.
+// The result cannot overflow 128 bits.
+inline std::uint64_t mulAdd (std::uint64_t a, std::uint64_t b,
+    std::uint64_t c, std::uint64_t d, std::uint64_t& hi)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 const t (static_cast <unsigned __int128> (a) * b + c + d);
+    hi = static_cast <std::uint64_t> (t >> 64);
+    return static_cast <std::uint64_t> (t);
+#else
+    std::uint64_t const mask (0xffffffff);
+    std::uint64_t const p00 ((a & mask) * (b & mask));
+    std::uint64_t const p01 ((a & mask) * (b >> 32));
+    std::uint64_t const p10 ((a >> 32) * (b & mask));
+    std::uint64_t const p11 ((a >> 32) * (b >> 32));
+    std::uint64_t const mid ((p00 >> 32) + (p01 & mask) + (p10 & mask));
+    std::uint64_t lo ((p00 & mask) | (mid << 32));
+    hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    lo += c;
+    hi += (lo < c);
+    lo += d;
+    hi += (lo < d);
+    return lo;
+#endif
+}
+
+// Returns a + b + carry and updates carry, which is 0 or 1
+inline std::uint64_t addCarry (std::uint64_t a, std::uint64_t b,
+    std::uint64_t& carry)
+{
+    std::uint64_t const t (a + carry);
+    std::uint64_t const r (t + b);
+    carry = (t < carry) | (r < b);
+    return r;
+}
+
+// Returns a - b - borrow and updates borrow, which is 0 or 1
+inline std::uint64_t subBorrow (std::uint64_t a, std::uint64_t b,
+    std::uint64_t& borrow)
+{
+    std::uint64_t const t (a - b);
+    std::uint64_t const r (t - borrow);
+    borrow = (a < b) | (t < borrow);
+    return r;
+}
+
+//------------------------------------------------------------------------------
+
+/** An element of the field of integers modulo p = 2^256 - 2^32 - 977.
+
+    Values are held as four little-endian 64-bit limbs and are always fully
+    reduced. All operations except the ones marked otherwise take time that
+    is independent of the values involved.
+*/
+struct FieldElement
+{
+    std::uint64_t n [4];
+
+    // 2^256 - p, the value 2^256 takes modulo p
+    static std::uint64_t const complement = 0x1000003D1ULL;
+
+    static FieldElement zero ()
+    {
+        FieldElement r = {{ 0, 0, 0, 0 }};
+        return r;
+    }
+
+    static FieldElement one ()
+    {
+        FieldElement r = {{ 1, 0, 0, 0 }};
+        return r;
+    }
+
+    static FieldElement fromLimbs (std::uint64_t n3, std::uint64_t n2,
+        std::uint64_t n1, std::uint64_t n0)
+    {
+        FieldElement r = {{ n0, n1, n2, n3 }};
+        return r;
+    }
+
+    static FieldElement fromInt (std::uint64_t v)
+    {
+        FieldElement r = {{ v, 0, 0, 0 }};
+        return r;
+    }
+
+    /** Loads a 32-byte big-endian value.
+        @return `false` if the value is not less than p.
+    */
+    bool setBytes (unsigned char const* bytes)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            std::uint64_t v (0);
+            for (int j = 0; j < 8; ++j)
+                v = (v << 8) | bytes [(3 - i) * 8 + j];
+            n [i] = v;
+        }
+        // p has all ones in the upper three limbs
+        return ! (n[3] == ~0ULL && n[2] == ~0ULL && n[1] == ~0ULL &&
+            n[0] >= 0ULL - complement);
+    }
+
+    /** Stores the value as 32 big-endian bytes. */
+    void getBytes (unsigned char* bytes) const
+    {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 8; ++j)
+                bytes [(3 - i) * 8 + j] =
+                    static_cast <unsigned char> (n [i] >> (56 - 8 * j));
+    }
+
+    bool isZero () const
+    {
+        return (n[0] | n[1] | n[2] | n[3]) == 0;
+    }
+
+    bool isOdd () const
+    {
+        return (n[0] & 1) != 0;
+    }
+
+    // Reduces a value below 2^256 + p given as four limbs and a carry bit
+    void normalize (std::uint64_t carry)
+    {
+        // The value is at least p exactly when adding 2^256 - p overflows
+        std::uint64_t c (0);
+        std::uint64_t t [4];
+        t[0] = addCarry (n[0], complement, c);
+        t[1] = addCarry (n[1], 0, c);
+        t[2] = addCarry (n[2], 0, c);
+        t[3] = addCarry (n[3], 0, c);
+        std::uint64_t const mask (0 - (c | carry));
+        for (int i = 0; i < 4; ++i)
+            n [i] = (t [i] & mask) | (n [i] & ~mask);
+    }
+
+    /** Replaces the value with `a` if `flag` is 1, in constant time. */
+    void assign (FieldElement const& a, std::uint64_t flag)
+    {
+        std::uint64_t const mask (0 - flag);
+        for (int i = 0; i < 4; ++i)
+            n [i] = (a.n [i] & mask) | (n [i] & ~mask);
+    }
+
+    FieldElement sqr () const;
+
+    // Returns this value squared `count` times
+    FieldElement sqr (int count) const;
+
+    /** Returns the multiplicative inverse. The inverse of zero is zero. */
+    FieldElement inverse () const;
+
+    /** Computes a square root.
+        @return `false` if the value has no square root.
+    */
+    bool sqrt (FieldElement& root) const;
+};
+
+inline bool operator== (FieldElement const& a, FieldElement const& b)
+{
+    return ((a.n[0] ^ b.n[0]) | (a.n[1] ^ b.n[1]) |
+        (a.n[2] ^ b.n[2]) | (a.n[3] ^ b.n[3])) == 0;
+}
+
+inline bool operator!= (FieldElement const& a, FieldElement const& b)
+{
+    return ! (a == b);
+}
+
+inline FieldElement operator+ (FieldElement const& a, FieldElement const& b)
+{
+    FieldElement r;
+    std::uint64_t c (0);
+    for (int i = 0; i < 4; ++i)
+        r.n [i] = addCarry (a.n [i], b.n [i], c);
+    r.normalize (c);
+    return r;
+}
+
+inline FieldElement operator- (FieldElement const& a, FieldElement const& b)
+{
+    FieldElement r;
+    std::uint64_t borrow (0);
+    for (int i = 0; i < 4; ++i)
+        r.n [i] = subBorrow (a.n [i], b.n [i], borrow);
+
+    // On underflow add p, which is subtracting 2^256 - p modulo 2^256
+    std::uint64_t b2 (0);
+    r.n[0] = subBorrow (r.n[0], FieldElement::complement & (0 - borrow), b2);
+    r.n[1] = subBorrow (r.n[1], 0, b2);
+    r.n[2] = subBorrow (r.n[2], 0, b2);
+    r.n[3] = subBorrow (r.n[3], 0, b2);
+    return r;
+}
+
+inline FieldElement operator- (FieldElement const& a)
+{
+    return FieldElement::zero () - a;
+}
+
+inline FieldElement operator* (FieldElement const& a, FieldElement const& b)
+{
+    // Schoolbook product into eight limbs
+    std::uint64_t t [8] = { 0 };
+    for (int i = 0; i < 4; ++i)
+    {
+        std::uint64_t carry (0);
+        for (int j = 0; j < 4; ++j)
+            t [i + j] = mulAdd (a.n [i], b.n [j], t [i + j], carry, carry);
+        t [i + 4] = carry;
+    }
+
+    // Fold the upper half down, since 2^256 = 2^256 - p (mod p)
+    std::uint64_t r [4];
+    std::uint64_t carry (0);
+    for (int i = 0; i < 4; ++i)
+        r [i] = mulAdd (t [i + 4], FieldElement::complement, t [i], carry, carry);
+
+    // carry is below 2^34, so carry * complement fits in two limbs
+    std::uint64_t hi;
+    std::uint64_t const lo (mulAdd (carry, FieldElement::complement, 0, 0, hi));
+    std::uint64_t c (0);
+    r[0] = addCarry (r[0], lo, c);
+    r[1] = addCarry (r[1], hi, c);
+    r[2] = addCarry (r[2], 0, c);
+    r[3] = addCarry (r[3], 0, c);
+
+    // A final overflow leaves a small value behind, so this cannot carry
+    std::uint64_t c2 (0);
+    r[0] = addCarry (r[0], FieldElement::complement & (0 - c), c2);
+    r[1] = addCarry (r[1], 0, c2);
+    r[2] = addCarry (r[2], 0, c2);
+    r[3] = addCarry (r[3], 0, c2);
+
+    FieldElement result = {{ r[0], r[1], r[2], r[3] }};
+    result.normalize (0);
+    return result;
+}
+
+inline FieldElement FieldElement::sqr () const
+{
+    return *this * *this;
+}
+
+inline FieldElement FieldElement::sqr (int count) const
+{
+    FieldElement r (*this);
+    while (count-- > 0)
+        r = r * r;
+    return r;
+}
+
+inline FieldElement FieldElement::inverse () const
+{
+    // Raise to p - 2 with an addition chain over the runs of ones in p - 2
+    FieldElement const& a (*this);
+    FieldElement const x2 (a.sqr () * a);
+    FieldElement const x3 (x2.sqr () * a);
+    FieldElement const x6 (x3.sqr (3) * x3);
+    FieldElement const x9 (x6.sqr (3) * x3);
+    FieldElement const x11 (x9.sqr (2) * x2);
+    FieldElement const x22 (x11.sqr (11) * x11);
+    FieldElement const x44 (x22.sqr (22) * x22);
+    FieldElement const x88 (x44.sqr (44) * x44);
+    FieldElement const x176 (x88.sqr (88) * x88);
+    FieldElement const x220 (x176.sqr (44) * x44);
+    FieldElement const x223 (x220.sqr (3) * x3);
+
+    FieldElement t (x223.sqr (23) * x22);
+    t = t.sqr (5) * a;
+    t = t.sqr (3) * x2;
+    return t.sqr (2) * a;
+}
+
+inline bool FieldElement::sqrt (FieldElement& root) const
+{
+    // Since p = 3 (mod 4) a root is the value raised to (p + 1) / 4
+    FieldElement const& a (*this);
+    FieldElement const x2 (a.sqr () * a);
+    FieldElement const x3 (x2.sqr () * a);
+    FieldElement const x6 (x3.sqr (3) * x3);
+    FieldElement const x9 (x6.sqr (3) * x3);
+    FieldElement const x11 (x9.sqr (2) * x2);
+    FieldElement const x22 (x11.sqr (11) * x11);
+    FieldElement const x44 (x22.sqr (22) * x22);
+    FieldElement const x88 (x44.sqr (44) * x44);
+    FieldElement const x176 (x88.sqr (88) * x88);
+    FieldElement const x220 (x176.sqr (44) * x44);
+    FieldElement const x223 (x220.sqr (3) * x3);
+
+    FieldElement t (x223.sqr (23) * x22);
+    t = t.sqr (6) * x2;
+    root = t.sqr (2);
+    return root.sqr () == a;
+}
+
+}
+}
+}
+
+#endif
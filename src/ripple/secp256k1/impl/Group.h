@@ -0,0 +1,348 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SECP256K1_GROUP_H_INCLUDED
+#define RIPPLE_SECP256K1_GROUP_H_INCLUDED
+
+namespace ripple {
+namespace Secp256k1 {
+namespace detail {
+
+/** A point on the curve y^2 = x^3 + 7 in affine coordinates. */
+struct AffinePoint
+{
+    FieldElement x;
+    FieldElement y;
+    bool infinity;
+
+    // The generator
+    static AffinePoint generator ()
+    {
+        AffinePoint g;
+        g.x = FieldElement::fromLimbs (
+            0x79BE667EF9DCBBACULL, 0x55A06295CE870B07ULL,
+            0x029BFCDB2DCE28D9ULL, 0x59F2815B16F81798ULL);
+        g.y = FieldElement::fromLimbs (
+            0x483ADA7726A3C465ULL, 0x5DA4FBFC0E1108A8ULL,
+            0xFD17B448A6855419ULL, 0x9C47D08FFB10D4B8ULL);
+        g.infinity = false;
+        return g;
+    }
+
+    bool isValid () const
+    {
+        return ! infinity &&
+            y.sqr () == x.sqr () * x + FieldElement::fromInt (7);
+    }
+
+    /** Decodes a public key in compressed, uncompressed or hybrid form. */
+    bool setBytes (unsigned char const* bytes, std::size_t size)
+    {
+        infinity = false;
+        if (size == 33 && (bytes[0] == 0x02 || bytes[0] == 0x03))
+        {
+            if (! x.setBytes (bytes + 1))
+                return false;
+            if (! (x.sqr () * x + FieldElement::fromInt (7)).sqrt (y))
+                return false;
+            if (y.isOdd () != (bytes[0] == 0x03))
+                y = -y;
+            return true;
+        }
+
+        if (size == 65 && (bytes[0] == 0x04 ||
+            bytes[0] == 0x06 || bytes[0] == 0x07))
+        {
+            if (! x.setBytes (bytes + 1) || ! y.setBytes (bytes + 33))
+                return false;
+            if (bytes[0] != 0x04 && y.isOdd () != (bytes[0] == 0x07))
+                return false;
+            return isValid ();
+        }
+
+        return false;
+    }
+
+    /** Encodes the point as a 33-byte compressed public key. */
+    void getBytes (unsigned char* bytes) const
+    {
+        bytes[0] = y.isOdd () ? 0x03 : 0x02;
+        x.getBytes (bytes + 1);
+    }
+};
+
+inline AffinePoint operator- (AffinePoint const& a)
+{
+    AffinePoint r (a);
+    r.y = -a.y;
+    return r;
+}
+
+//------------------------------------------------------------------------------
+
+/** A point in Jacobian coordinates, (X / Z^2, Y / Z^3).
+    These operations branch on their inputs and must only be used with
+    public values.
+*/
+struct JacobianPoint
+{
+    FieldElement x;
+    FieldElement y;
+    FieldElement z;
+    bool infinity;
+
+    static JacobianPoint atInfinity ()
+    {
+        JacobianPoint r;
+        r.x = FieldElement::zero ();
+        r.y = FieldElement::one ();
+        r.z = FieldElement::zero ();
+        r.infinity = true;
+        return r;
+    }
+
+    explicit JacobianPoint ()
+    {
+    }
+
+    explicit JacobianPoint (AffinePoint const& a)
+        : x (a.x)
+        , y (a.y)
+        , z (FieldElement::one ())
+        , infinity (a.infinity)
+    {
+    }
+
+    AffinePoint toAffine () const
+    {
+        AffinePoint r;
+        r.infinity = infinity;
+        if (infinity)
+            return r;
+        FieldElement const zi (z.inverse ());
+        FieldElement const zi2 (zi.sqr ());
+        r.x = x * zi2;
+        r.y = y * zi2 * zi;
+        return r;
+    }
+
+    JacobianPoint doubled () const
+    {
+        if (infinity)
+            return *this;
+
+        FieldElement const a (x.sqr ());
+        FieldElement const b (y.sqr ());
+        FieldElement const c (b.sqr ());
+        FieldElement d ((x + b).sqr () - a - c);
+        d = d + d;
+        FieldElement const e (a + a + a);
+
+        JacobianPoint r;
+        r.infinity = false;
+        r.x = e.sqr () - d - d;
+        FieldElement c8 (c + c);
+        c8 = c8 + c8;
+        c8 = c8 + c8;
+        r.y = e * (d - r.x) - c8;
+        r.z = y * z;
+        r.z = r.z + r.z;
+        return r;
+    }
+
+    JacobianPoint operator+ (AffinePoint const& b) const
+    {
+        if (b.infinity)
+            return *this;
+        if (infinity)
+            return JacobianPoint (b);
+
+        FieldElement const z2 (z.sqr ());
+        FieldElement const u2 (b.x * z2);
+        FieldElement const s2 (b.y * z2 * z);
+        FieldElement const h (u2 - x);
+        FieldElement const rr (s2 - y);
+        if (h.isZero ())
+            return rr.isZero () ? doubled () : atInfinity ();
+
+        FieldElement const hh (h.sqr ());
+        FieldElement const hhh (h * hh);
+        FieldElement const v (x * hh);
+
+        JacobianPoint r;
+        r.infinity = false;
+        r.x = rr.sqr () - hhh - v - v;
+        r.y = rr * (v - r.x) - y * hhh;
+        r.z = z * h;
+        return r;
+    }
+
+    JacobianPoint operator+ (JacobianPoint const& b) const
+    {
+        if (b.infinity)
+            return *this;
+        if (infinity)
+            return b;
+
+        FieldElement const z1z1 (z.sqr ());
+        FieldElement const z2z2 (b.z.sqr ());
+        FieldElement const u1 (x * z2z2);
+        FieldElement const u2 (b.x * z1z1);
+        FieldElement const s1 (y * z2z2 * b.z);
+        FieldElement const s2 (b.y * z1z1 * z);
+        FieldElement const h (u2 - u1);
+        FieldElement const rr (s2 - s1);
+        if (h.isZero ())
+            return rr.isZero () ? doubled () : atInfinity ();
+
+        FieldElement const hh (h.sqr ());
+        FieldElement const hhh (h * hh);
+        FieldElement const v (u1 * hh);
+
+        JacobianPoint r;
+        r.infinity = false;
+        r.x = rr.sqr () - hhh - v - v;
+        r.y = rr * (v - r.x) - s1 * hhh;
+        r.z = z * b.z * h;
+        return r;
+    }
+};
+
+/** Converts points to affine form using a single inversion.
+    None of the points may be at infinity.
+*/
+inline void toAffine (JacobianPoint const* in, AffinePoint* out, std::size_t count)
+{
+    if (count == 0)
+        return;
+
+    // Running products of the Z coordinates
+    std::vector <FieldElement> prod (count);
+    prod [0] = in [0].z;
+    for (std::size_t i = 1; i < count; ++i)
+        prod [i] = prod [i - 1] * in [i].z;
+
+    FieldElement inv (prod [count - 1].inverse ());
+    for (std::size_t i = count; i-- > 0;)
+    {
+        FieldElement const zi (i > 0 ? inv * prod [i - 1] : inv);
+        if (i > 0)
+            inv = inv * in [i].z;
+        FieldElement const zi2 (zi.sqr ());
+        out [i].x = in [i].x * zi2;
+        out [i].y = in [i].y * zi2 * zi;
+        out [i].infinity = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+/** A point in homogeneous projective coordinates, (X / Z, Y / Z).
+    Addition uses the complete formulas of Renes, Costello and Batina,
+    which have no special cases, so it takes the same time for all inputs.
+    The point at infinity is (0, 1, 0).
+*/
+struct ProjectivePoint
+{
+    FieldElement x;
+    FieldElement y;
+    FieldElement z;
+
+    static ProjectivePoint atInfinity ()
+    {
+        ProjectivePoint r;
+        r.x = FieldElement::zero ();
+        r.y = FieldElement::one ();
+        r.z = FieldElement::zero ();
+        return r;
+    }
+
+    explicit ProjectivePoint ()
+    {
+    }
+
+    explicit ProjectivePoint (AffinePoint const& a)
+        : x (a.x)
+        , y (a.y)
+        , z (FieldElement::one ())
+    {
+    }
+
+    bool isInfinity () const
+    {
+        return z.isZero ();
+    }
+
+    AffinePoint toAffine () const
+    {
+        AffinePoint r;
+        FieldElement const zi (z.inverse ());
+        r.x = x * zi;
+        r.y = y * zi;
+        r.infinity = z.isZero ();
+        return r;
+    }
+
+    ProjectivePoint operator+ (ProjectivePoint const& b) const
+    {
+        // Algorithm 7 of "Complete addition formulas for prime order
+        // elliptic curves", specialized for a = 0 and b3 = 3 * 7
+        FieldElement const b3 (FieldElement::fromInt (21));
+
+        FieldElement t0 (x * b.x);
+        FieldElement t1 (y * b.y);
+        FieldElement t2 (z * b.z);
+        FieldElement t3 ((x + y) * (b.x + b.y));
+        FieldElement t4 (t0 + t1);
+        t3 = t3 - t4;
+        t4 = (y + z) * (b.y + b.z);
+        FieldElement x3 (t1 + t2);
+        t4 = t4 - x3;
+        x3 = (x + z) * (b.x + b.z);
+        FieldElement y3 (t0 + t2);
+        y3 = x3 - y3;
+        x3 = t0 + t0;
+        t0 = x3 + t0;
+        t2 = b3 * t2;
+        FieldElement z3 (t1 + t2);
+        t1 = t1 - t2;
+        y3 = b3 * y3;
+        x3 = t4 * y3;
+        t2 = t3 * t1;
+        x3 = t2 - x3;
+        y3 = y3 * t0;
+        t1 = t1 * z3;
+        y3 = t1 + y3;
+        t0 = t0 * t3;
+        z3 = z3 * t4;
+        z3 = z3 + t0;
+
+        ProjectivePoint r;
+        r.x = x3;
+        r.y = y3;
+        r.z = z3;
+        return r;
+    }
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,289 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SECP256K1_SCALAR_H_INCLUDED
+#define RIPPLE_SECP256K1_SCALAR_H_INCLUDED
+
+namespace ripple {
+namespace Secp256k1 {
+namespace detail {
+
+/** An integer modulo the group order n.
+
+    Values are held as four little-endian 64-bit limbs and are always fully
+    reduced. Arithmetic takes time that is independent of the values.
+*/
+struct Scalar
+{
+    std::uint64_t n [4];
+
+    static Scalar zero ()
+    {
+        Scalar r = {{ 0, 0, 0, 0 }};
+        return r;
+    }
+
+    static Scalar one ()
+    {
+        Scalar r = {{ 1, 0, 0, 0 }};
+        return r;
+    }
+
+    static Scalar fromLimbs (std::uint64_t n3, std::uint64_t n2,
+        std::uint64_t n1, std::uint64_t n0)
+    {
+        Scalar r = {{ n0, n1, n2, n3 }};
+        return r;
+    }
+
+    // The group order
+    static Scalar const& order ()
+    {
+        static Scalar const n = {{ 0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL,
+            0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL }};
+        return n;
+    }
+
+    // 2^256 - n, the value 2^256 takes modulo n
+    static std::uint64_t complement (int i)
+    {
+        static std::uint64_t const c [4] = { 0x402DA1732FC9BEBFULL,
+            0x4551231950B75FC4ULL, 1, 0 };
+        return c [i];
+    }
+
+    /** Loads a 32-byte big-endian value, reducing it modulo n.
+        @return `true` if the value was not less than n.
+    */
+    bool setBytes (unsigned char const* bytes)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            std::uint64_t v (0);
+            for (int j = 0; j < 8; ++j)
+                v = (v << 8) | bytes [(3 - i) * 8 + j];
+            n [i] = v;
+        }
+        return reduce (0) != 0;
+    }
+
+    /** Stores the value as 32 big-endian bytes. */
+    void getBytes (unsigned char* bytes) const
+    {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 8; ++j)
+                bytes [(3 - i) * 8 + j] =
+                    static_cast <unsigned char> (n [i] >> (56 - 8 * j));
+    }
+
+    bool isZero () const
+    {
+        return (n[0] | n[1] | n[2] | n[3]) == 0;
+    }
+
+    /** Returns `true` if the value is greater than n / 2. */
+    bool isHigh () const
+    {
+        // Compare against (n - 1) / 2 from the top limb down
+        static std::uint64_t const h [4] = { 0xDFE92F46681B20A0ULL,
+            0x5D576E7357A4501DULL, 0xFFFFFFFFFFFFFFFFULL, 0x7FFFFFFFFFFFFFFFULL };
+        std::uint64_t borrow (0);
+        for (int i = 0; i < 4; ++i)
+            subBorrow (h [i], n [i], borrow);
+        return borrow != 0;
+    }
+
+    /** Returns `count` bits starting at `offset`, where count < 64. */
+    unsigned int getBits (int offset, int count) const
+    {
+        int const limb (offset >> 6);
+        int const shift (offset & 63);
+        std::uint64_t v (n [limb] >> shift);
+        if (shift + count > 64 && limb < 3)
+            v |= n [limb + 1] << (64 - shift);
+        return static_cast <unsigned int> (v & ((1ULL << count) - 1));
+    }
+
+    // Subtracts n if the value held with the given carry bit is at least n.
+    // Returns 1 if n was subtracted.
+    std::uint64_t reduce (std::uint64_t carry)
+    {
+        std::uint64_t c (0);
+        std::uint64_t t [4];
+        for (int i = 0; i < 4; ++i)
+            t [i] = addCarry (n [i], complement (i), c);
+        std::uint64_t const overflow (c | carry);
+        std::uint64_t const mask (0 - overflow);
+        for (int i = 0; i < 4; ++i)
+            n [i] = (t [i] & mask) | (n [i] & ~mask);
+        return overflow;
+    }
+
+    /** Replaces the value with `a` if `flag` is 1, in constant time. */
+    void assign (Scalar const& a, std::uint64_t flag)
+    {
+        std::uint64_t const mask (0 - flag);
+        for (int i = 0; i < 4; ++i)
+            n [i] = (a.n [i] & mask) | (n [i] & ~mask);
+    }
+
+    Scalar sqr () const;
+
+    /** Returns the multiplicative inverse. The inverse of zero is zero. */
+    Scalar inverse () const;
+
+    // Returns round (this * g / 2^384), used to split scalars
+    Scalar mulShift384 (Scalar const& g) const;
+};
+
+inline bool operator== (Scalar const& a, Scalar const& b)
+{
+    return ((a.n[0] ^ b.n[0]) | (a.n[1] ^ b.n[1]) |
+        (a.n[2] ^ b.n[2]) | (a.n[3] ^ b.n[3])) == 0;
+}
+
+inline bool operator!= (Scalar const& a, Scalar const& b)
+{
+    return ! (a == b);
+}
+
+inline Scalar operator+ (Scalar const& a, Scalar const& b)
+{
+    Scalar r;
+    std::uint64_t c (0);
+    for (int i = 0; i < 4; ++i)
+        r.n [i] = addCarry (a.n [i], b.n [i], c);
+    r.reduce (c);
+    return r;
+}
+
+inline Scalar operator- (Scalar const& a)
+{
+    // n - a, or zero when a is zero
+    Scalar r;
+    std::uint64_t borrow (0);
+    for (int i = 0; i < 4; ++i)
+        r.n [i] = subBorrow (Scalar::order ().n [i], a.n [i], borrow);
+    std::uint64_t const mask (0 - static_cast <std::uint64_t> (! a.isZero ()));
+    for (int i = 0; i < 4; ++i)
+        r.n [i] &= mask;
+    return r;
+}
+
+inline Scalar operator- (Scalar const& a, Scalar const& b)
+{
+    return a + (-b);
+}
+
+// Adds hi * (2^256 - n) to the low four limbs of t, where hi is the
+// `count` limbs of t starting at t[4]. Limbs above those must be zero.
+inline void foldScalar (std::uint64_t t [8], int count)
+{
+    std::uint64_t r [8] = { t[0], t[1], t[2], t[3], 0, 0, 0, 0 };
+    for (int i = 0; i < count; ++i)
+    {
+        std::uint64_t carry (0);
+        for (int j = 0; j < 3; ++j)
+            r [i + j] = mulAdd (t [4 + i], Scalar::complement (j), r [i + j],
+                carry, carry);
+        std::uint64_t c (0);
+        r [i + 3] = addCarry (r [i + 3], carry, c);
+        for (int k = i + 4; k < 8; ++k)
+            r [k] = addCarry (r [k], 0, c);
+    }
+    for (int i = 0; i < 8; ++i)
+        t [i] = r [i];
+}
+
+inline void mulWide (Scalar const& a, Scalar const& b, std::uint64_t t [8])
+{
+    for (int i = 0; i < 8; ++i)
+        t [i] = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        std::uint64_t carry (0);
+        for (int j = 0; j < 4; ++j)
+            t [i + j] = mulAdd (a.n [i], b.n [j], t [i + j], carry, carry);
+        t [i + 4] = carry;
+    }
+}
+
+inline Scalar operator* (Scalar const& a, Scalar const& b)
+{
+    std::uint64_t t [8];
+    mulWide (a, b, t);
+
+    // The upper half shrinks from 256 to 130, 4 and then 1 bit
+    foldScalar (t, 4);
+    foldScalar (t, 3);
+    foldScalar (t, 1);
+    foldScalar (t, 1);
+    foldScalar (t, 1);
+
+    Scalar r = {{ t[0], t[1], t[2], t[3] }};
+    r.reduce (0);
+    return r;
+}
+
+inline Scalar Scalar::sqr () const
+{
+    return *this * *this;
+}
+
+inline Scalar Scalar::inverse () const
+{
+    // Raise to n - 2 four bits at a time. The exponent is public so the
+    // table index does not leak anything about the value.
+    Scalar table [16];
+    table [0] = one ();
+    table [1] = *this;
+    for (int i = 2; i < 16; ++i)
+        table [i] = table [i - 1] * *this;
+
+    Scalar e (order ());
+    e.n [0] -= 2;
+
+    Scalar r (one ());
+    for (int i = 63; i >= 0; --i)
+    {
+        r = r.sqr ().sqr ().sqr ().sqr ();
+        r = r * table [e.getBits (i * 4, 4)];
+    }
+    return r;
+}
+
+inline Scalar Scalar::mulShift384 (Scalar const& g) const
+{
+    std::uint64_t t [8];
+    mulWide (*this, g, t);
+    Scalar r = {{ t[6], t[7], 0, 0 }};
+
+    // Round using bit 383
+    std::uint64_t c ((t[5] >> 63) & 1);
+    r.n[0] = addCarry (r.n[0], 0, c);
+    r.n[1] = addCarry (r.n[1], 0, c);
+    r.n[2] = addCarry (r.n[2], 0, c);
+    return r;
+}
+
+}
+}
+}
+
+#endif
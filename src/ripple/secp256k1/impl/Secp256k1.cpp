@@ -0,0 +1,574 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace ripple {
+namespace Secp256k1 {
+
+namespace detail {
+
+// Cube roots of unity for the endomorphism (x, y) -> (beta * x, y),
+// which multiplies a point by lambda.
+inline FieldElement beta ()
+{
+    return FieldElement::fromLimbs (
+        0x7AE96A2B657C0710ULL, 0x6E64479EAC3434E9ULL,
+        0x9CF0497512F58995ULL, 0xC1396C28719501EEULL);
+}
+
+inline Scalar lambda ()
+{
+    return Scalar::fromLimbs (
+        0x5363AD4CC05C30E0ULL, 0xA5261C028812645AULL,
+        0x122E22EA20816678ULL, 0xDF02967C1B23BD72ULL);
+}
+
+/** Splits k into k1 + k2 * lambda where k1 and k2 are at most 128 bits
+    in absolute value, using the lattice basis from "Guide to Elliptic
+    Curve Cryptography", algorithm 3.74.
+*/
+inline void splitLambda (Scalar const& k, Scalar& k1, Scalar& k2)
+{
+    Scalar const minusB1 (Scalar::fromLimbs (0, 0,
+        0xE4437ED6010E8828ULL, 0x6F547FA90ABFE4C3ULL));
+    Scalar const minusB2 (Scalar::fromLimbs (
+        0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFEULL,
+        0x8A280AC50774346DULL, 0xD765CDA83DB1562CULL));
+    Scalar const g1 (Scalar::fromLimbs (
+        0x3086D221A7D46BCDULL, 0xE86C90E49284EB15ULL,
+        0x3DAA8A1471E8CA7FULL, 0xE893209A45DBB031ULL));
+    Scalar const g2 (Scalar::fromLimbs (
+        0xE4437ED6010E8828ULL, 0x6F547FA90ABFE4C4ULL,
+        0x221208AC9DF506C6ULL, 0x1571B4AE8AC47F71ULL));
+
+    Scalar const c1 (k.mulShift384 (g1));
+    Scalar const c2 (k.mulShift384 (g2));
+    k2 = c1 * minusB1 + c2 * minusB2;
+    k1 = k - k2 * lambda ();
+}
+
+/** Computes the width-w non-adjacent form of a scalar.
+    Each digit is zero or odd and below 2^(w-1) in absolute value.
+    @return The number of digits.
+*/
+inline int computeWnaf (int* wnaf, Scalar const& k, int w)
+{
+    int last (-1);
+    int bit (0);
+    int carry (0);
+
+    std::fill (wnaf, wnaf + 257, 0);
+    while (bit < 256)
+    {
+        if (static_cast <int> (k.getBits (bit, 1)) == carry)
+        {
+            ++bit;
+            continue;
+        }
+
+        int const count (std::min (w, 256 - bit));
+        int word (static_cast <int> (k.getBits (bit, count)) + carry);
+        carry = (word >> (w - 1)) & 1;
+        word -= carry << w;
+        wnaf [bit] = word;
+        last = bit;
+        bit += count;
+    }
+    if (carry != 0)
+        wnaf [last = 256] = 1;
+    return last + 1;
+}
+
+//------------------------------------------------------------------------------
+
+// Precomputed multiples of the generator, built on first use
+class Context
+{
+public:
+    enum
+    {
+        // Four bit windows for constant time multiplication
+        combWindows = 64,
+        combSize = 16,
+
+        // Odd multiples used in variable time multiplication
+        wnafWindow = 8,
+        wnafSize = 1 << (wnafWindow - 2)
+    };
+
+    // comb[i][j] = j * 16^i * G, for j > 0
+    AffinePoint comb [combWindows][combSize];
+
+    // odd[i] = (2i + 1) * G, and the same times lambda
+    AffinePoint odd [wnafSize];
+    AffinePoint oddLambda [wnafSize];
+
+    static Context const& get ()
+    {
+        static std::once_flag once;
+        static std::unique_ptr <Context> instance;
+        std::call_once (once, []
+        {
+            instance.reset (new Context);
+        });
+        return *instance;
+    }
+
+private:
+    Context ()
+    {
+        AffinePoint const g (AffinePoint::generator ());
+
+        std::vector <JacobianPoint> points;
+        points.reserve (combWindows * (combSize - 1));
+        JacobianPoint base (g);
+        for (int i = 0; i < combWindows; ++i)
+        {
+            JacobianPoint p (base);
+            points.push_back (p);
+            for (int j = 2; j < combSize; ++j)
+            {
+                p = p + base;
+                points.push_back (p);
+            }
+            base = p + base;
+        }
+
+        std::vector <AffinePoint> affine (points.size ());
+        toAffine (&points[0], &affine[0], points.size ());
+        for (int i = 0; i < combWindows; ++i)
+        {
+            comb [i][0].infinity = true;
+            for (int j = 1; j < combSize; ++j)
+                comb [i][j] = affine [i * (combSize - 1) + j - 1];
+        }
+
+        points.clear ();
+        JacobianPoint const twice (JacobianPoint (g).doubled ());
+        JacobianPoint p (g);
+        points.push_back (p);
+        for (int i = 1; i < wnafSize; ++i)
+        {
+            p = p + twice;
+            points.push_back (p);
+        }
+        toAffine (&points[0], odd, wnafSize);
+        for (int i = 0; i < wnafSize; ++i)
+        {
+            oddLambda [i] = odd [i];
+            oddLambda [i].x = odd [i].x * beta ();
+        }
+    }
+};
+
+/** Computes k * G in time independent of k. */
+inline AffinePoint multiplyGenerator (Scalar const& k)
+{
+    Context const& context (Context::get ());
+    FieldElement const zero (FieldElement::zero ());
+    FieldElement const one (FieldElement::one ());
+
+    ProjectivePoint r (ProjectivePoint::atInfinity ());
+    for (int i = 0; i < Context::combWindows; ++i)
+    {
+        unsigned int const digit (k.getBits (i * 4, 4));
+
+        // Read the whole row so that memory access does not depend on k.
+        // A zero digit selects the point at infinity.
+        ProjectivePoint p;
+        p.x = zero;
+        p.y = one;
+        p.z = one;
+        for (unsigned int j = 1; j < Context::combSize; ++j)
+        {
+            std::uint64_t const match (j == digit);
+            p.x.assign (context.comb [i][j].x, match);
+            p.y.assign (context.comb [i][j].y, match);
+        }
+        p.z.assign (zero, digit == 0);
+        r = r + p;
+    }
+
+    return r.toAffine ();
+}
+
+inline void addDigit (JacobianPoint& r, int digit,
+    AffinePoint const* table, bool negate)
+{
+    if (digit == 0)
+        return;
+    AffinePoint const& p (table [(std::abs (digit) - 1) / 2]);
+    if ((digit < 0) != negate)
+        r = r + (-p);
+    else
+        r = r + p;
+}
+
+/** Computes u1 * G + u2 * a, taking time that depends on the inputs.
+    Both scalars are split with the endomorphism and the four halves are
+    processed together, sharing one chain of doublings.
+*/
+inline JacobianPoint multiplyAddVar (Scalar const& u1, Scalar const& u2,
+    AffinePoint const& a)
+{
+    int const window (5);
+    int const tableSize (1 << (window - 2));
+
+    Context const& context (Context::get ());
+
+    Scalar k [4];
+    splitLambda (u1, k[0], k[1]);
+    splitLambda (u2, k[2], k[3]);
+
+    bool negate [4];
+    int wnaf [4][257];
+    int length (0);
+    for (int i = 0; i < 4; ++i)
+    {
+        negate [i] = k [i].isHigh ();
+        if (negate [i])
+            k [i] = -k [i];
+        length = std::max (length,
+            computeWnaf (wnaf [i], k [i], i < 2 ? Context::wnafWindow : window));
+    }
+
+    // Odd multiples of a, and the same times lambda
+    JacobianPoint points [tableSize];
+    JacobianPoint const twice (JacobianPoint (a).doubled ());
+    points [0] = JacobianPoint (a);
+    for (int i = 1; i < tableSize; ++i)
+        points [i] = points [i - 1] + twice;
+
+    AffinePoint odd [tableSize];
+    AffinePoint oddLambda [tableSize];
+    toAffine (points, odd, tableSize);
+    FieldElement const b (beta ());
+    for (int i = 0; i < tableSize; ++i)
+    {
+        oddLambda [i] = odd [i];
+        oddLambda [i].x = odd [i].x * b;
+    }
+
+    JacobianPoint r (JacobianPoint::atInfinity ());
+    for (int i = length - 1; i >= 0; --i)
+    {
+        r = r.doubled ();
+        addDigit (r, wnaf [0][i], context.odd, negate [0]);
+        addDigit (r, wnaf [1][i], context.oddLambda, negate [1]);
+        addDigit (r, wnaf [2][i], odd, negate [2]);
+        addDigit (r, wnaf [3][i], oddLambda, negate [3]);
+    }
+    return r;
+}
+
+//------------------------------------------------------------------------------
+
+/** Deterministic nonces from RFC 6979 using HMAC-SHA256. */
+class NonceGenerator
+{
+public:
+    NonceGenerator (unsigned char const* secret, unsigned char const* hash)
+    {
+        std::memset (m_v, 0x01, sizeof (m_v));
+        std::memset (m_k, 0x00, sizeof (m_k));
+
+        unsigned char seed [32 + 1 + 32 + 32];
+        std::memcpy (seed, m_v, 32);
+        std::memcpy (seed + 33, secret, 32);
+        std::memcpy (seed + 65, hash, 32);
+
+        seed [32] = 0x00;
+        hmac (m_k, seed, sizeof (seed));
+        hmac (m_v, m_v, sizeof (m_v));
+
+        std::memcpy (seed, m_v, 32);
+        seed [32] = 0x01;
+        hmac (m_k, seed, sizeof (seed));
+        hmac (m_v, m_v, sizeof (m_v));
+
+        OPENSSL_cleanse (seed, sizeof (seed));
+        m_retry = false;
+    }
+
+    ~NonceGenerator ()
+    {
+        OPENSSL_cleanse (m_k, sizeof (m_k));
+        OPENSSL_cleanse (m_v, sizeof (m_v));
+    }
+
+    /** Produces the next candidate nonce, in [1, n). */
+    Scalar next ()
+    {
+        for (;;)
+        {
+            if (m_retry)
+            {
+                unsigned char data [33];
+                std::memcpy (data, m_v, 32);
+                data [32] = 0x00;
+                hmac (m_k, data, sizeof (data));
+                hmac (m_v, m_v, sizeof (m_v));
+            }
+            m_retry = true;
+
+            hmac (m_v, m_v, sizeof (m_v));
+            Scalar k;
+            if (! k.setBytes (m_v) && ! k.isZero ())
+                return k;
+        }
+    }
+
+private:
+    // Replaces out with HMAC(K, data); out may alias data
+    void hmac (unsigned char* out, unsigned char const* data, std::size_t size)
+    {
+        unsigned char result [32];
+        unsigned int length (sizeof (result));
+        HMAC (EVP_sha256 (), m_k, sizeof (m_k), data, size, result, &length);
+        std::memcpy (out, result, sizeof (result));
+        OPENSSL_cleanse (result, sizeof (result));
+    }
+
+    unsigned char m_k [32];
+    unsigned char m_v [32];
+    bool m_retry;
+};
+
+// Appends a DER integer holding a 32-byte big-endian value
+inline void appendInteger (Blob& out, unsigned char const* value)
+{
+    int skip (0);
+    while (skip < 31 && value [skip] == 0)
+        ++skip;
+    bool const pad ((value [skip] & 0x80) != 0);
+    out.push_back (0x02);
+    out.push_back (static_cast <unsigned char> (32 - skip + (pad ? 1 : 0)));
+    if (pad)
+        out.push_back (0);
+    out.insert (out.end (), value + skip, value + 32);
+}
+
+// Reads a DER integer into a scalar, which must be in [1, n)
+inline bool parseInteger (unsigned char const*& p, std::size_t& size,
+    Scalar& value)
+{
+    if (size < 3 || p[0] != 0x02)
+        return false;
+
+    std::size_t const length (p[1]);
+    if (length < 1 || length > 33 || length > size - 2)
+        return false;
+
+    unsigned char const* const data (p + 2);
+
+    // No negative values or unnecessary padding
+    if ((data[0] & 0x80) != 0)
+        return false;
+    if (length > 1 && data[0] == 0 && (data[1] & 0x80) == 0)
+        return false;
+    if (length == 33 && data[0] != 0)
+        return false;
+
+    unsigned char bytes [32] = { 0 };
+    std::size_t const used (length == 33 ? 32 : length);
+    std::memcpy (bytes + 32 - used, data + length - used, used);
+    if (value.setBytes (bytes) || value.isZero ())
+        return false;
+
+    p += length + 2;
+    size -= length + 2;
+    return true;
+}
+
+inline bool parseSignature (unsigned char const* p, std::size_t size,
+    Scalar& r, Scalar& s)
+{
+    if (size < 8 || size > 72 || p[0] != 0x30 || p[1] != size - 2)
+        return false;
+    p += 2;
+    size -= 2;
+    return parseInteger (p, size, r) && parseInteger (p, size, s) && size == 0;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+bool isValidSecretKey (uint256 const& secret)
+{
+    detail::Scalar d;
+    return ! d.setBytes (secret.begin ()) && ! d.isZero ();
+}
+
+bool derivePublicKey (uint256 const& secret, Blob& publicKey)
+{
+    detail::Scalar d;
+    if (d.setBytes (secret.begin ()) || d.isZero ())
+        return false;
+
+    publicKey.resize (33);
+    detail::multiplyGenerator (d).getBytes (&publicKey[0]);
+    d = detail::Scalar::zero ();
+    return true;
+}
+
+bool addSecretKeys (uint256 const& a, uint256 const& b, uint256& result)
+{
+    detail::Scalar x;
+    detail::Scalar y;
+    if (x.setBytes (a.begin ()) || y.setBytes (b.begin ()))
+        return false;
+
+    x = x + y;
+    y = detail::Scalar::zero ();
+    if (x.isZero ())
+        return false;
+
+    x.getBytes (result.begin ());
+    x = detail::Scalar::zero ();
+    return true;
+}
+
+bool addPublicKey (void const* publicKey, std::size_t keySize,
+    uint256 const& tweak, Blob& result)
+{
+    using namespace detail;
+
+    AffinePoint a;
+    if (! a.setBytes (static_cast <unsigned char const*> (publicKey), keySize))
+        return false;
+
+    Scalar t;
+    if (t.setBytes (tweak.begin ()) || t.isZero ())
+        return false;
+
+    ProjectivePoint const sum (ProjectivePoint (multiplyGenerator (t)) +
+        ProjectivePoint (a));
+    if (sum.isInfinity ())
+        return false;
+
+    result.resize (33);
+    sum.toAffine ().getBytes (&result[0]);
+    return true;
+}
+
+bool sign (uint256 const& hash, uint256 const& secret, Blob& signature)
+{
+    using namespace detail;
+
+    Scalar d;
+    if (d.setBytes (secret.begin ()) || d.isZero ())
+        return false;
+
+    Scalar z;
+    z.setBytes (hash.begin ());
+    unsigned char zb [32];
+    z.getBytes (zb);
+
+    NonceGenerator nonces (secret.begin (), zb);
+    for (;;)
+    {
+        Scalar k (nonces.next ());
+
+        unsigned char rb [32];
+        multiplyGenerator (k).x.getBytes (rb);
+        Scalar r;
+        r.setBytes (rb);
+        if (r.isZero ())
+            continue;
+
+        Scalar s (k.inverse () * (z + r * d));
+        k = Scalar::zero ();
+        if (s.isZero ())
+            continue;
+
+        // Use the smaller of s and n - s so the signature is fully canonical
+        s.assign (-s, s.isHigh ());
+
+        unsigned char sb [32];
+        r.getBytes (rb);
+        s.getBytes (sb);
+        d = Scalar::zero ();
+
+        signature.clear ();
+        signature.reserve (72);
+        signature.push_back (0x30);
+        signature.push_back (0);
+        appendInteger (signature, rb);
+        appendInteger (signature, sb);
+        signature [1] = static_cast <unsigned char> (signature.size () - 2);
+        return true;
+    }
+}
+
+bool isStrictSignature (void const* signature, std::size_t size)
+{
+    detail::Scalar r;
+    detail::Scalar s;
+    return detail::parseSignature (
+        static_cast <unsigned char const*> (signature), size, r, s);
+}
+
+bool verify (uint256 const& hash, void const* publicKey, std::size_t keySize,
+    void const* signature, std::size_t signatureSize)
+{
+    using namespace detail;
+
+    AffinePoint q;
+    if (! q.setBytes (static_cast <unsigned char const*> (publicKey), keySize))
+        return false;
+
+    Scalar r;
+    Scalar s;
+    if (! parseSignature (static_cast <unsigned char const*> (signature),
+            signatureSize, r, s))
+        return false;
+
+    Scalar z;
+    z.setBytes (hash.begin ());
+
+    Scalar const w (s.inverse ());
+    JacobianPoint const p (multiplyAddVar (z * w, r * w, q));
+    if (p.infinity)
+        return false;
+
+    // Compare x (mod n) with r without leaving Jacobian coordinates. Since
+    // p > n, x may also be r + n when that is below p.
+    unsigned char rb [32];
+    r.getBytes (rb);
+    FieldElement rx;
+    rx.setBytes (rb);
+    FieldElement const zz (p.z.sqr ());
+    if (rx * zz == p.x)
+        return true;
+
+    std::uint64_t const pMinusN [4] = { 0x402DA1722FC9BAEEULL,
+        0x4551231950B75FC4ULL, 1, 0 };
+    std::uint64_t borrow (0);
+    for (int i = 0; i < 4; ++i)
+        subBorrow (r.n [i], pMinusN [i], borrow);
+    if (borrow == 0)
+        return false;
+
+    Scalar const& n (Scalar::order ());
+    rx = rx + FieldElement::fromLimbs (n.n[3], n.n[2], n.n[1], n.n[0]);
+    return rx * zz == p.x;
+}
+
+}
+}
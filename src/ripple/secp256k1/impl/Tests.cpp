@@ -0,0 +1,556 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <chrono>
+#include <random>
+
+namespace ripple {
+namespace Secp256k1 {
+
+// Helpers for comparing against OpenSSL
+class OpenSSLCurve
+{
+public:
+    OpenSSLCurve ()
+        : m_group (EC_GROUP_new_by_curve_name (NID_secp256k1))
+        , m_ctx (BN_CTX_new ())
+        , m_p (BN_new ())
+        , m_n (BN_new ())
+    {
+        EC_GROUP_get_curve_GFp (m_group, m_p, nullptr, nullptr, m_ctx);
+        EC_GROUP_get_order (m_group, m_n, m_ctx);
+    }
+
+    ~OpenSSLCurve ()
+    {
+        BN_free (m_n);
+        BN_free (m_p);
+        BN_CTX_free (m_ctx);
+        EC_GROUP_free (m_group);
+    }
+
+    // Returns a * b mod m as 32 big-endian bytes
+    uint256 mulMod (uint256 const& a, uint256 const& b, bool order)
+    {
+        BIGNUM* x (BN_bin2bn (a.begin (), 32, nullptr));
+        BIGNUM* y (BN_bin2bn (b.begin (), 32, nullptr));
+        BN_mod_mul (x, x, y, order ? m_n : m_p, m_ctx);
+        uint256 result (toBytes (x));
+        BN_free (y);
+        BN_free (x);
+        return result;
+    }
+
+    Blob publicKey (uint256 const& secret)
+    {
+        BIGNUM* d (BN_bin2bn (secret.begin (), 32, nullptr));
+        EC_POINT* q (EC_POINT_new (m_group));
+        EC_POINT_mul (m_group, q, d, nullptr, nullptr, m_ctx);
+        Blob result (33);
+        EC_POINT_point2oct (m_group, q, POINT_CONVERSION_COMPRESSED,
+            &result[0], result.size (), m_ctx);
+        EC_POINT_free (q);
+        BN_free (d);
+        return result;
+    }
+
+    EC_KEY* makeKey (uint256 const& secret)
+    {
+        EC_KEY* key (EC_KEY_new_by_curve_name (NID_secp256k1));
+        BIGNUM* d (BN_bin2bn (secret.begin (), 32, nullptr));
+        EC_POINT* q (EC_POINT_new (m_group));
+        EC_POINT_mul (m_group, q, d, nullptr, nullptr, m_ctx);
+        EC_KEY_set_private_key (key, d);
+        EC_KEY_set_public_key (key, q);
+        EC_POINT_free (q);
+        BN_free (d);
+        return key;
+    }
+
+    Blob sign (uint256 const& hash, EC_KEY* key)
+    {
+        Blob sig (ECDSA_size (key));
+        unsigned int size (sig.size ());
+        ECDSA_sign (0, hash.begin (), 32, &sig[0], &size, key);
+        sig.resize (size);
+        return sig;
+    }
+
+    bool verify (uint256 const& hash, Blob const& sig, EC_KEY* key)
+    {
+        return ECDSA_verify (0, hash.begin (), 32, &sig[0], sig.size (), key) == 1;
+    }
+
+private:
+    static uint256 toBytes (BIGNUM const* bn)
+    {
+        uint256 result;
+        BN_bn2bin (bn, result.begin () + 32 - BN_num_bytes (bn));
+        return result;
+    }
+
+    EC_GROUP* m_group;
+    BN_CTX* m_ctx;
+    BIGNUM* m_p;
+    BIGNUM* m_n;
+};
+
+class Secp256k1_test : public beast::unit_test::suite
+{
+public:
+    std::mt19937_64 m_engine;
+    OpenSSLCurve m_openssl;
+
+    uint256 randomValue ()
+    {
+        uint256 v;
+        for (auto iter (v.begin ()); iter != v.end (); ++iter)
+            *iter = static_cast <unsigned char> (m_engine ());
+        return v;
+    }
+
+    uint256 randomSecret ()
+    {
+        for (;;)
+        {
+            uint256 const v (randomValue ());
+            if (isValidSecretKey (v))
+                return v;
+        }
+    }
+
+    static uint256 fromHex (char const* hex)
+    {
+        uint256 v;
+        v.SetHex (hex);
+        return v;
+    }
+
+    static Blob fromHexBlob (std::string const& hex)
+    {
+        Blob result;
+        for (std::size_t i = 0; i + 1 < hex.size (); i += 2)
+            result.push_back (static_cast <unsigned char> (
+                std::stoi (hex.substr (i, 2), nullptr, 16)));
+        return result;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void testField ()
+    {
+        testcase ("field");
+        using namespace detail;
+
+        bool mulOk (true);
+        bool invOk (true);
+        bool sqrtOk (true);
+        bool addOk (true);
+        for (int i = 0; i < 500; ++i)
+        {
+            uint256 a (randomValue ());
+            uint256 b (randomValue ());
+            FieldElement x;
+            FieldElement y;
+            if (! x.setBytes (a.begin ()) || ! y.setBytes (b.begin ()))
+                continue;
+
+            uint256 product;
+            (x * y).getBytes (product.begin ());
+            mulOk = mulOk && product == m_openssl.mulMod (a, b, false);
+
+            invOk = invOk && (x.isZero () || x * x.inverse () == FieldElement::one ());
+
+            FieldElement root;
+            sqrtOk = sqrtOk && x.sqr ().sqrt (root) && root.sqr () == x.sqr ();
+
+            addOk = addOk && (x + y) - y == x && x + (-x) == FieldElement::zero ();
+        }
+        expect (mulOk, "Field multiplication differs from OpenSSL");
+        expect (invOk, "Field inverse");
+        expect (sqrtOk, "Field square root");
+        expect (addOk, "Field addition");
+
+        // p - 1 is the largest element; p itself is rejected
+        FieldElement x;
+        expect (x.setBytes (fromHex (
+            "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2E").begin ()));
+        expect (x + FieldElement::one () == FieldElement::zero ());
+        expect (! x.setBytes (fromHex (
+            "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F").begin ()));
+    }
+
+    void testScalar ()
+    {
+        testcase ("scalar");
+        using namespace detail;
+
+        bool mulOk (true);
+        bool invOk (true);
+        bool splitOk (true);
+        for (int i = 0; i < 500; ++i)
+        {
+            uint256 a (randomValue ());
+            uint256 b (randomValue ());
+            Scalar x;
+            Scalar y;
+            if (x.setBytes (a.begin ()) || y.setBytes (b.begin ()))
+                continue;
+
+            uint256 product;
+            (x * y).getBytes (product.begin ());
+            mulOk = mulOk && product == m_openssl.mulMod (a, b, true);
+
+            invOk = invOk && (x.isZero () || x * x.inverse () == Scalar::one ());
+
+            Scalar k1;
+            Scalar k2;
+            splitLambda (x, k1, k2);
+            if (k1.isHigh ())
+                k1 = -k1;
+            if (k2.isHigh ())
+                k2 = -k2;
+            splitOk = splitOk && (k1.n[2] | k1.n[3] | k2.n[2] | k2.n[3]) == 0;
+        }
+        expect (mulOk, "Scalar multiplication differs from OpenSSL");
+        expect (invOk, "Scalar inverse");
+        expect (splitOk, "Split halves are too large");
+
+        // The endomorphism multiplies points by lambda
+        AffinePoint const g (AffinePoint::generator ());
+        uint256 l;
+        lambda ().getBytes (l.begin ());
+        Blob lg;
+        expect (derivePublicKey (l, lg));
+        AffinePoint e (g);
+        e.x = g.x * beta ();
+        Blob expected (33);
+        e.getBytes (&expected[0]);
+        expect (lg == expected, "Endomorphism");
+    }
+
+    void testPublicKey ()
+    {
+        testcase ("public key");
+
+        bool ok (true);
+        for (int i = 0; i < 200; ++i)
+        {
+            uint256 const secret (randomSecret ());
+            Blob key;
+            ok = ok && derivePublicKey (secret, key) &&
+                key == m_openssl.publicKey (secret);
+        }
+        expect (ok, "Public key differs from OpenSSL");
+
+        // Edge cases: 1, n - 1, small and sparse values
+        char const* const secrets [] = {
+            "0000000000000000000000000000000000000000000000000000000000000001",
+            "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364140",
+            "000000000000000000000000000000000000000000000000000000000000000F",
+            "8000000000000000000000000000000000000000000000000000000000000000",
+            "0000000000000000000000000000000100000000000000000000000000000000" };
+        for (auto hex : secrets)
+        {
+            Blob key;
+            expect (derivePublicKey (fromHex (hex), key) &&
+                key == m_openssl.publicKey (fromHex (hex)), hex);
+        }
+
+        Blob key;
+        expect (! derivePublicKey (uint256 (), key), "Zero secret");
+        expect (! derivePublicKey (fromHex (
+            "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141"), key),
+            "Secret equal to the order");
+    }
+
+    void testTweak ()
+    {
+        testcase ("key addition");
+
+        bool ok (true);
+        for (int i = 0; i < 100; ++i)
+        {
+            uint256 const a (randomSecret ());
+            uint256 const b (randomSecret ());
+            uint256 sum;
+            Blob publicA;
+            Blob publicSum;
+            Blob tweaked;
+            ok = ok && addSecretKeys (a, b, sum) &&
+                derivePublicKey (a, publicA) &&
+                derivePublicKey (sum, publicSum) &&
+                addPublicKey (&publicA[0], publicA.size (), b, tweaked) &&
+                tweaked == publicSum;
+        }
+        expect (ok, "Public and secret key addition disagree");
+
+        // A key plus its negation is the point at infinity
+        uint256 const one (fromHex (
+            "0000000000000000000000000000000000000000000000000000000000000001"));
+        uint256 const minusOne (fromHex (
+            "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364140"));
+        uint256 sum;
+        Blob key;
+        Blob result;
+        expect (! addSecretKeys (one, minusOne, sum));
+        expect (derivePublicKey (one, key));
+        expect (! addPublicKey (&key[0], key.size (), minusOne, result));
+    }
+
+    void testSign ()
+    {
+        testcase ("sign");
+
+        // RFC 6979 nonces, checked against an independent implementation
+        struct Vector
+        {
+            char const* secret;
+            char const* hash;
+            char const* signature;
+        };
+        Vector const vectors [] = {
+            {   "0000000000000000000000000000000000000000000000000000000000000001",
+                "A0DC65FFCA799873CBEA0AC274015B9526505DAAAED385155425F7337704883E",
+                "3045022100934B1EA10A4B3C1757E2B0C017D0B6143CE3C9A7E6A4A49860D7A6AB210EE3D8"
+                "02202442CE9D2B916064108014783E923EC36B49743E2FFA1C4496F01A512AAFD9E5" },
+            {   "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364140",
+                "A0DC65FFCA799873CBEA0AC274015B9526505DAAAED385155425F7337704883E",
+                "3045022100FD567D121DB66E382991534ADA77A6BD3106F0A1098C231E47993447CD6AF2D0"
+                "02206B39CD0EB1BC8603E159EF5C20A5C8AD685A45B06CE9BEBED3F153D10D93BED5" } };
+        for (auto const& v : vectors)
+        {
+            Blob sig;
+            expect (sign (fromHex (v.hash), fromHex (v.secret), sig));
+            expect (sig == fromHexBlob (v.signature), "RFC 6979 vector");
+        }
+
+        bool opensslOk (true);
+        bool nativeOk (true);
+        bool lowOk (true);
+        for (int i = 0; i < 100; ++i)
+        {
+            uint256 const secret (randomSecret ());
+            uint256 const hash (randomValue ());
+            Blob sig;
+            Blob key;
+            expect (sign (hash, secret, sig) && derivePublicKey (secret, key));
+
+            EC_KEY* const k (m_openssl.makeKey (secret));
+            opensslOk = opensslOk && m_openssl.verify (hash, sig, k);
+            EC_KEY_free (k);
+
+            nativeOk = nativeOk && verify (hash, key, sig);
+
+            // S must be at most n / 2
+            std::size_t const rLength (sig[3]);
+            std::size_t const sLength (sig[rLength + 5]);
+            lowOk = lowOk && sLength <= 32 && (sig[rLength + 6] & 0x80) == 0 &&
+                ! (sLength == 32 && sig[rLength + 6] > 0x7F);
+        }
+        expect (opensslOk, "OpenSSL rejected a native signature");
+        expect (nativeOk, "Native verify rejected a native signature");
+        expect (lowOk, "Signature is not fully canonical");
+
+        Blob sig;
+        expect (! sign (randomValue (), uint256 (), sig), "Zero secret");
+    }
+
+    void testVerify ()
+    {
+        testcase ("verify");
+
+        bool goodOk (true);
+        bool badHashOk (true);
+        bool badKeyOk (true);
+        bool badSigOk (true);
+        for (int i = 0; i < 100; ++i)
+        {
+            uint256 const secret (randomSecret ());
+            uint256 const hash (randomValue ());
+            EC_KEY* const k (m_openssl.makeKey (secret));
+            Blob sig (m_openssl.sign (hash, k));
+            EC_KEY_free (k);
+
+            Blob key;
+            derivePublicKey (secret, key);
+            goodOk = goodOk && verify (hash, key, sig);
+
+            uint256 otherHash (hash);
+            *otherHash.begin () ^= 1;
+            badHashOk = badHashOk && ! verify (otherHash, key, sig);
+
+            Blob otherKey;
+            derivePublicKey (randomSecret (), otherKey);
+            badKeyOk = badKeyOk && ! verify (hash, otherKey, sig);
+
+            sig [sig.size () - 1] ^= 1;
+            badSigOk = badSigOk && ! verify (hash, key, sig);
+        }
+        expect (goodOk, "Rejected an OpenSSL signature");
+        expect (badHashOk, "Accepted the wrong hash");
+        expect (badKeyOk, "Accepted the wrong key");
+        expect (badSigOk, "Accepted a modified signature");
+
+        // Uncompressed and hybrid keys are accepted
+        uint256 const secret (randomSecret ());
+        uint256 const hash (randomValue ());
+        Blob sig;
+        sign (hash, secret, sig);
+        EC_KEY* const k (m_openssl.makeKey (secret));
+        Blob full (65);
+        EC_POINT_point2oct (EC_KEY_get0_group (k), EC_KEY_get0_public_key (k),
+            POINT_CONVERSION_UNCOMPRESSED, &full[0], full.size (), nullptr);
+        EC_KEY_free (k);
+        expect (verify (hash, full, sig), "Uncompressed key");
+        Blob hybrid (full);
+        hybrid[0] = (full[64] & 1) ? 0x07 : 0x06;
+        expect (verify (hash, hybrid, sig), "Hybrid key");
+        hybrid[0] ^= 1;
+        expect (! verify (hash, hybrid, sig), "Hybrid key with the wrong parity");
+        full[10] ^= 1;
+        expect (! verify (hash, full, sig), "Point not on the curve");
+
+        // Zero and out of range values of r and s
+        Blob const zeroR (fromHexBlob ("3006020100020101"));
+        Blob key;
+        derivePublicKey (secret, key);
+        expect (! verify (hash, key, zeroR), "Zero r");
+        Blob const bigS (fromHexBlob (
+            "3026020101022100FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141"));
+        expect (! verify (hash, key, bigS), "s equal to the order");
+
+        // Only minimal DER integers are parsed
+        expect (isStrictSignature (sig), "Strict signature");
+        Blob padded (sig);
+        padded.insert (padded.begin () + 4, 0);
+        ++padded[1];
+        ++padded[3];
+        expect (! isStrictSignature (padded), "Padded r");
+        expect (! isStrictSignature (zeroR), "Zero r");
+        expect (! isStrictSignature (Blob ()), "Empty signature");
+    }
+
+    void run ()
+    {
+        testField ();
+        testScalar ();
+        testPublicKey ();
+        testTweak ();
+        testSign ();
+        testVerify ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Secp256k1,secp256k1,ripple);
+
+//------------------------------------------------------------------------------
+
+class Secp256k1_timing_test : public beast::unit_test::suite
+{
+public:
+    template <class Function>
+    void measure (std::string const& what, int iterations, Function f)
+    {
+        typedef std::chrono::steady_clock clock_type;
+        clock_type::time_point const start (clock_type::now ());
+
+        for (int i = 0; i < iterations; ++i)
+            f (i);
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::nanoseconds> (clock_type::now () - start));
+
+        log << what << ": " << (elapsed.count () / iterations / 1000.0) << " us, " <<
+            static_cast <int> (iterations * 1e9 / elapsed.count ()) << " ops/sec";
+    }
+
+    void run ()
+    {
+        int const iterations (2000);
+        OpenSSLCurve openssl;
+        std::mt19937_64 engine;
+
+        std::vector <uint256> secrets;
+        std::vector <uint256> hashes;
+        std::vector <Blob> keys;
+        std::vector <EC_KEY*> ecKeys;
+        while (secrets.size () < 100)
+        {
+            uint256 v;
+            for (auto iter (v.begin ()); iter != v.end (); ++iter)
+                *iter = static_cast <unsigned char> (engine ());
+            if (! isValidSecretKey (v))
+                continue;
+            secrets.push_back (v);
+            hashes.push_back (v);
+            *hashes.back ().begin () ^= 0x55;
+            keys.push_back (openssl.publicKey (v));
+            ecKeys.push_back (openssl.makeKey (v));
+        }
+
+        std::vector <Blob> signatures (secrets.size ());
+        for (std::size_t i = 0; i < secrets.size (); ++i)
+            sign (hashes [i], secrets [i], signatures [i]);
+
+        measure ("derive (native)", iterations, [&](int i)
+        {
+            Blob key;
+            derivePublicKey (secrets [i % 100], key);
+        });
+
+        measure ("derive (OpenSSL)", iterations, [&](int i)
+        {
+            openssl.publicKey (secrets [i % 100]);
+        });
+
+        measure ("sign (native)", iterations, [&](int i)
+        {
+            Blob sig;
+            sign (hashes [i % 100], secrets [i % 100], sig);
+        });
+
+        measure ("sign (OpenSSL)", iterations, [&](int i)
+        {
+            openssl.sign (hashes [i % 100], ecKeys [i % 100]);
+        });
+
+        measure ("verify (native)", iterations, [&](int i)
+        {
+            verify (hashes [i % 100], keys [i % 100], signatures [i % 100]);
+        });
+
+        measure ("verify (OpenSSL, parsed key)", iterations, [&](int i)
+        {
+            openssl.verify (hashes [i % 100], signatures [i % 100], ecKeys [i % 100]);
+        });
+
+        for (auto key : ecKeys)
+            EC_KEY_free (key);
+
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Secp256k1_timing,secp256k1,ripple);
+
+}
+}
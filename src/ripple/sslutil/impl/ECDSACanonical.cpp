@@ -19,73 +19,51 @@
 
 #include "../../../beast/beast/unit_test/suite.h"
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <iterator>
 
 namespace ripple {
 
 namespace detail {
-    // A simple wrapper for a BIGNUM to make it
-    // easier to allocate, construct, and free them
-    struct BigNum
-    {
-        BIGNUM* num;
-
-        BigNum& operator=(BigNum const&) = delete;
-
-        BigNum ()
-            : num (BN_new ())
-        {
-
-        }
-
-        BigNum (const char *hex)
-            : num (BN_new ())
-        {
-            BN_hex2bn (&num, hex);
-        }
-
-        BigNum (unsigned char const* ptr, size_t len)
-            : num (BN_new ())
-        {
-            set (ptr, len);
-        }
+    // A signature part as a big-endian unsigned integer. Parts are at most
+    // 33 bytes long, so this holds every value the encoding allows.
+    typedef std::array <unsigned char, 33> SignatureValue;
 
-        BigNum (BigNum const& other)
-            : num (BN_new ())
-        {
-            if (BN_copy (num, other.num) == nullptr)
-                BN_clear (num);
-        }
+    inline int compare (SignatureValue const& lhs, SignatureValue const& rhs)
+    {
+        return std::memcmp (lhs.data (), rhs.data (), lhs.size ());
+    }
 
-        ~BigNum ()
-        {
-            BN_free (num);
-        }
+    // Returns lhs - rhs, which must not be negative
+    inline SignatureValue subtract (SignatureValue const& lhs, SignatureValue const& rhs)
+    {
+        SignatureValue result;
+        int borrow (0);
 
-        operator BIGNUM* ()
-        {
-            return num;
-        }
-        
-        operator BIGNUM const* () const
+        for (std::size_t i = result.size (); i-- > 0;)
         {
-            return num;
+            int const diff (int (lhs[i]) - int (rhs[i]) - borrow);
+            result[i] = static_cast <unsigned char> (diff);
+            borrow = (diff < 0) ? 1 : 0;
         }
 
-        bool set (unsigned char const* ptr, size_t len)
-        {
-            if (BN_bin2bn (ptr, len, num) == nullptr)
-                return false;
+        return result;
+    }
 
-            return true;
-        }
-    };
+    inline SignatureValue makeValue (unsigned char const* ptr, size_t len)
+    {
+        SignatureValue result;
+        result.fill (0);
+        std::copy (ptr, ptr + len, result.end () - len);
+        return result;
+    }
 
     class SignaturePart
     {
     private:
         size_t m_skip;
-        BigNum m_bn;
+        SignatureValue m_value;
 
     public:
         SignaturePart (unsigned char const* sig, size_t size)
@@ -117,10 +95,10 @@ namespace detail {
             if ((sig[2] == 0) && ((sig[3] & 0x80) == 0))
                 return;
 
-            // Load the signature (ignore the marker prefix and length) and if
-            // successful, count the number of bytes we consumed.
-            if (m_bn.set (sig + 2, len))
-                m_skip = len + 2;
+            // Load the signature (ignore the marker prefix and length) and
+            // count the number of bytes we consumed.
+            m_value = makeValue (sig + 2, len);
+            m_skip = len + 2;
         }
 
         bool valid () const
@@ -128,10 +106,10 @@ namespace detail {
             return m_skip != 0;
         }
 
-        // The signature as a BIGNUM
-        BigNum getBigNum () const
+        // The signature as an integer
+        SignatureValue const& getValue () const
         {
-            return m_bn;
+            return m_value;
         }
         
         // Returns the number of bytes to skip for this signature part
@@ -142,8 +120,11 @@ namespace detail {
     };
 
     // The SECp256k1 modulus
-    static BigNum const modulus (
-        "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141");
+    static SignatureValue const modulus = {{ 0x00,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE,
+        0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48, 0xA0, 0x3B,
+        0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x41 }};
 }
 
 /** Determine whether a signature is canonical.
@@ -200,13 +181,13 @@ bool isCanonicalECDSASig (void const* vSig, size_t sigLen, ECDSA strict_param)
         return false;
 
     // Check whether R or S are greater than the modulus.
-    auto bnR (sigR.getBigNum ());
-    auto bnS (sigS.getBigNum ());
+    auto const& vR (sigR.getValue ());
+    auto const& vS (sigS.getValue ());
 
-    if (BN_cmp (bnR, detail::modulus) != -1)
+    if (detail::compare (vR, detail::modulus) >= 0)
         return false;
 
-    if (BN_cmp (bnS, detail::modulus) != -1)
+    if (detail::compare (vS, detail::modulus) >= 0)
         return false; 
 
     // For a given signature, (R,S), the signature (R, N-S) is also valid. For
@@ -214,12 +195,7 @@ bool isCanonicalECDSASig (void const* vSig, size_t sigLen, ECDSA strict_param)
     // be specified. If operating in strict mode, check that as well.
     if (strict_param == ECDSA::strict)
     {
-        detail::BigNum mS;
-
-        if (BN_sub (mS, detail::modulus, bnS) == 0)
-            return false;
-
-        if (BN_cmp (bnS, mS) == 1)
+        if (detail::compare (vS, detail::subtract (detail::modulus, vS)) > 0)
             return false;
     }
 
@@ -242,14 +218,15 @@ bool makeCanonicalECDSASig (void* vSig, size_t& sigLen)
     int rLen = sig[3];
     int sPos = rLen + 6, sLen = sig[rLen + 5];
 
-    detail::BigNum origS, newS;
-    BN_bin2bn (&sig[sPos], sLen, origS);
-    BN_sub (newS, detail::modulus, origS);
+    auto const origS (detail::makeValue (&sig[sPos], sLen));
+    auto const newS (detail::subtract (detail::modulus, origS));
 
-    if (BN_cmp (origS, newS) == 1)
+    if (detail::compare (origS, newS) > 0)
     { // original signature is not fully canonical
-        unsigned char newSbuf [64];
-        int newSlen = BN_bn2bin (newS, newSbuf);
+        auto const first (std::find_if (newS.begin (), newS.end (),
+            [](unsigned char c) { return c != 0; }));
+        unsigned char const* newSbuf = newS.data () + (first - newS.begin ());
+        int newSlen = static_cast <int> (newS.end () - first);
 
         if ((newSbuf[0] & 0x80) == 0)
         { // no extra padding byte is needed
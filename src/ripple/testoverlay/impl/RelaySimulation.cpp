@@ -0,0 +1,339 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../../ripple_overlay/api/RelayPolicy.h"
+
+#include "../../../beast/beast/chrono/manual_clock.h"
+#include "../../../beast/beast/unit_test/suite.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+namespace ripple {
+namespace TestOverlay {
+
+/** Compares flooding with the relay policy in a simulated network.
+
+    A few validators each sign one message per step, a few other nodes each
+    submit one transaction per step, and every node relays what it receives.
+    Links take one to four steps to deliver, and a step counts as a second
+    on the clock of each node's policy. The simulation reports how many
+    copies of each message a node receives and how long messages take to
+    reach everyone.
+*/
+class RelaySimulation_test : public beast::unit_test::suite
+{
+public:
+    static int const numberOfValidators = 10;
+    static int const numberOfSubmitters = 10;
+    static int const messageSteps = 60;
+    static int const drainSteps = 100;
+
+    // Payloads with a negative `what` are squelches, the others
+    // are the sequence number of a validator's message.
+    static int const squelchMessage = -1;
+    static int const unsquelchMessage = -2;
+
+    //--------------------------------------------------------------------------
+
+    template <class Config>
+    class RelayState : public StateBase <Config>
+    {
+    public:
+        typedef beast::manual_clock <std::chrono::seconds> clock_type;
+
+        /** Statistics for one kind of message. */
+        struct Stats
+        {
+            Stats ()
+                : messages (0)
+                , deliveries (0)
+                , arrivals (0)
+                , latencySum (0)
+                , latencyMax (0)
+            {
+            }
+
+            std::size_t messages;
+
+            // Every copy received, including duplicates
+            std::size_t deliveries;
+
+            // First arrivals and their latency in steps
+            std::size_t arrivals;
+            std::size_t latencySum;
+            int latencyMax;
+        };
+
+        clock_type& clock ()
+        {
+            return m_clock;
+        }
+
+        /** Returns the sequence number for a new message. */
+        int originate (int step, bool validation)
+        {
+            ++stats (validation).messages;
+            origins.push_back (step);
+            return int (origins.size ()) - 1;
+        }
+
+        Stats& stats (bool validation)
+        {
+            return validation ? m_validations : m_transactions;
+        }
+
+        // The step each message was created in
+        std::vector <int> origins;
+
+    private:
+        clock_type m_clock;
+        Stats m_validations;
+        Stats m_transactions;
+    };
+
+    //--------------------------------------------------------------------------
+
+    template <class Config>
+    class RelayLogic : public PeerLogicBase <Config>
+    {
+    public:
+        typedef PeerLogicBase <Config>      Base;
+        typedef typename Config::Payload    Payload;
+        typedef typename Base::Connection   Connection;
+        typedef typename Base::Peer         Peer;
+        typedef typename Base::Message      Message;
+
+        explicit RelayLogic (Peer& peer)
+            : Base (peer)
+            , m_policy (setup (), peer.network ().state ().clock (),
+                std::uint32_t (peer.id ()))
+            , m_started (false)
+        {
+        }
+
+        static RelayPolicy::Setup setup ()
+        {
+            RelayPolicy::Setup setup;
+            if (! Config::selective)
+            {
+                setup.fanout = 0;
+                setup.maxSources = 0;
+            }
+            return setup;
+        }
+
+        /** Links take one to four steps, the same in both directions. */
+        static int latency (Peer const& a, Peer const& b)
+        {
+            std::uint64_t const lo (std::min (a.id (), b.id ()));
+            std::uint64_t const hi (std::max (a.id (), b.id ()));
+            return 1 + int (((lo * 2654435761u) ^ (hi * 40503u)) % 4);
+        }
+
+        void pre_step ()
+        {
+            this->peer ().network ().state ().clock ().set (
+                this->peer ().network ().steps ());
+
+            if (m_started)
+                return;
+
+            // Pretend the peers were pinged before we start
+            for (auto& c : this->peer ().connections ())
+            {
+                RelayPolicy::id_t const id (c.peer ().id ());
+                m_policy.insert (id);
+                m_policy.onLatency (id, std::chrono::milliseconds (
+                    100 * latency (this->peer (), c.peer ())));
+            }
+            m_started = true;
+        }
+
+        void step ()
+        {
+            int const now (this->peer ().network ().steps ());
+
+            if (now < messageSteps &&
+                this->peer ().id () <= numberOfValidators + numberOfSubmitters)
+            {
+                bool const validator (this->peer ().id () <= numberOfValidators);
+                int const seq (this->peer ().network ().state ().originate (
+                    now, validator));
+                m_seen.insert (seq);
+                relay (Payload (seq, validator ? key () : beast::String ()),
+                    nullptr);
+            }
+
+            // Send what has waited out the latency of its link
+            auto const last (m_outbox.upper_bound (now));
+            for (auto iter = m_outbox.begin (); iter != last; ++iter)
+                this->peer ().send (*iter->second.first, Message (
+                    this->peer ().network ().state ().nextMessageID (),
+                        iter->second.second));
+            m_outbox.erase (m_outbox.begin (), last);
+        }
+
+        void receive (Connection const& c, Message const& m)
+        {
+            Payload const payload (m.payload ());
+            std::string const validator (payload.data ().toStdString ());
+            RelayPolicy::id_t const from (c.peer ().id ());
+
+            if (payload.what () < 0)
+            {
+                m_policy.onSquelch (from, validator,
+                    payload.what () == squelchMessage,
+                        std::chrono::seconds (payload.hops ()));
+                return;
+            }
+
+            auto& state (this->peer ().network ().state ());
+            auto& stats (state.stats (! validator.empty ()));
+            ++stats.deliveries;
+
+            bool const first (m_seen.insert (payload.what ()).second);
+
+            for (auto const& squelch : m_policy.onMessage (from, first, validator))
+            {
+                for (auto& link : this->peer ().connections ())
+                {
+                    if (link.peer ().id () == squelch.peer)
+                        this->peer ().send (link.peer (), Message (
+                            state.nextMessageID (), Payload (
+                                squelch.squelch ? squelchMessage : unsquelchMessage,
+                                    squelch.validator, int (squelch.duration.count ()))));
+                }
+            }
+
+            if (! first)
+                return;
+
+            int const latency (this->peer ().network ().steps () -
+                state.origins [payload.what ()]);
+            ++stats.arrivals;
+            stats.latencySum += latency;
+            stats.latencyMax = std::max (stats.latencyMax, latency);
+
+            relay (payload.withHop (), &c.peer ());
+        }
+
+    private:
+        beast::String key () const
+        {
+            return beast::String::fromNumber (int (this->peer ().id ()));
+        }
+
+        void relay (Payload const& payload, Peer const* from)
+        {
+            std::vector <RelayPolicy::id_t> candidates;
+            for (auto& c : this->peer ().connections ())
+                if (&c.peer () != from)
+                    candidates.push_back (c.peer ().id ());
+
+            candidates.resize (m_policy.select (
+                candidates, payload.data ().toStdString ()));
+
+            int const now (this->peer ().network ().steps ());
+            for (auto& c : this->peer ().connections ())
+            {
+                if (std::find (candidates.begin (), candidates.end (),
+                        c.peer ().id ()) != candidates.end ())
+                    m_outbox.emplace (now + latency (this->peer (), c.peer ()) - 1,
+                        std::make_pair (&c.peer (), payload));
+            }
+        }
+
+        RelayPolicy m_policy;
+        bool m_started;
+        std::unordered_set <int> m_seen;
+        std::multimap <int, std::pair <Peer*, Payload>> m_outbox;
+    };
+
+    //--------------------------------------------------------------------------
+
+    template <bool Selective>
+    struct Params : ConfigType <
+        Params <Selective>,
+        RelayState,
+        RelayLogic
+    >
+    {
+        static bool const selective = Selective;
+
+        // 200 nodes with about 50 peers each
+        typedef PremadeInitPolicy <200, 25> InitPolicy;
+    };
+
+    //--------------------------------------------------------------------------
+
+    template <class Stats>
+    double report (std::string const& name, Stats const& stats, double nodes)
+    {
+        double const coverage (
+            stats.arrivals / (stats.messages * (nodes - 1)));
+
+        log << name <<
+            ": " << (stats.deliveries / (stats.messages * nodes)) <<
+                " received per node per message" <<
+            ", latency " << (double (stats.latencySum) / stats.arrivals) <<
+                " mean, " << stats.latencyMax << " max" <<
+            ", coverage " << coverage;
+
+        return coverage;
+    }
+
+    template <bool Selective>
+    void simulate (std::string const& name)
+    {
+        typedef typename Params <Selective>::Network Network;
+
+        Network network;
+        for (int i = 0; i < messageSteps + drainSteps; ++i)
+            network.step ();
+
+        auto& state (network.state ());
+
+        expect (report (name + " validations", state.stats (true),
+            network.size ()) == 1, name + " validations reach every node");
+
+        // A bounded fanout may miss the odd node
+        expect (report (name + " transactions", state.stats (false),
+            network.size ()) > 0.999, name + " transactions reach the network");
+
+        m_deliveries [Selective] = state.stats (true).deliveries +
+            state.stats (false).deliveries;
+    }
+
+    void run ()
+    {
+        simulate <false> ("flood");
+        simulate <true> ("selective");
+        expect (m_deliveries [true] < m_deliveries [false]);
+    }
+
+private:
+    std::size_t m_deliveries [2];
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(RelaySimulation,overlay,ripple);
+
+}
+}
@@ -22,3 +22,4 @@
 #include "ripple_testoverlay.h"
 
 #include "impl/TestOverlay.cpp"
+#include "impl/RelaySimulation.cpp"
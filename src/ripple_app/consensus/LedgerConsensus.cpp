@@ -1271,9 +1271,14 @@ private:
         bool openLgr)
     {
         TransactionEngine engine (applyLedger);
+        std::vector <ParallelTransactionEngine::Candidate> candidates;
+
+        SHAMapIterator it (set);
+
+        for (bool more = it.first (); more; more = it.next ())
+        {
+            SHAMapItem::ref item = it.getItem ();
 
-        for (SHAMapItem::pointer item = set->peekFirstItem (); !!item; 
-            item = set->peekNextItem (item->getTag ()))
             if (!checkLedger->hasTransaction (item->getTag ()))
             {
                 WriteLog (lsINFO, LedgerConsensus) 
@@ -1288,11 +1293,8 @@ private:
                         = boost::make_shared<SerializedTransaction> 
                         (boost::ref (sit));
 
-                    if (applyTransaction (engine, txn, 
-                        applyLedger, openLgr, true) == resultRetry)
-                    {
-                        failedTransactions.push_back (txn);
-                    }
+                    candidates.push_back (std::make_pair (txn,
+                        getApplyParams (txn, openLgr, true)));
 
 #ifndef TRUST_NETWORK
                 }
@@ -1303,6 +1305,38 @@ private:
 
 #endif
             }
+        }
+
+        // Optionally run the transactors in parallel first. The serial
+        // pass below uses each result only if nothing it depends on
+        // was changed by an earlier transaction.
+        std::unique_ptr <ParallelTransactionEngine> speculation;
+
+        if ((getConfig ().PARALLEL_APPLY > 1) && (candidates.size () > 1))
+        {
+            speculation.reset (new ParallelTransactionEngine (
+                applyLedger, getConfig ().PARALLEL_APPLY,
+                    getApp().getJobQueue ()));
+            speculation->speculate (candidates);
+            engine.setSpeculation (speculation.get ());
+        }
+
+        BOOST_FOREACH (ParallelTransactionEngine::Candidate const& candidate, candidates)
+        {
+            if (applyTransaction (engine, candidate.first,
+                applyLedger, candidate.second) == resultRetry)
+            {
+                failedTransactions.push_back (candidate.first);
+            }
+        }
+
+        if (speculation)
+        {
+            engine.setSpeculation (nullptr);
+            WriteLog (lsDEBUG, LedgerConsensus) << "Speculation: "
+                << speculation->getHits () << " used, "
+                << speculation->getMisses () << " conflicted";
+        }
 
         int changes;
         bool certainRetry = true;
@@ -1363,7 +1397,15 @@ private:
         , SerializedTransaction::ref txn, Ledger::ref ledger
         , bool openLedger, bool retryAssured)
     {
-        // Returns false if the transaction has need not be retried.
+        return applyTransaction (engine, txn, ledger,
+            getApplyParams (txn, openLedger, retryAssured));
+    }
+
+    /** Determine the engine parameters for applying a transaction
+    */
+    TransactionEngineParams getApplyParams (SerializedTransaction::ref txn
+        , bool openLedger, bool retryAssured)
+    {
         TransactionEngineParams parms = openLedger ? tapOPEN_LEDGER : tapNONE;
 
         if (retryAssured)
@@ -1377,6 +1419,20 @@ private:
             parms = static_cast<TransactionEngineParams> 
                 (parms | tapNO_CHECK_SIGN);
         }
+
+        return parms;
+    }
+
+    /** Apply a transaction to a ledger with the given parameters
+    */
+    int applyTransaction (TransactionEngine& engine
+        , SerializedTransaction::ref txn, Ledger::ref ledger
+        , TransactionEngineParams parms)
+    {
+        // Returns false if the transaction has need not be retried.
+        bool const openLedger = is_bit_set (parms, tapOPEN_LEDGER);
+        bool const retryAssured = is_bit_set (parms, tapRETRY);
+
         WriteLog (lsDEBUG, LedgerConsensus) << "TXN " 
             << txn->getTransactionID ()
             << (openLedger ? " open" : " closed")
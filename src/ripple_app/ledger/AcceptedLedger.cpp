@@ -28,11 +28,11 @@ TaggedCache <uint256, AcceptedLedger> AcceptedLedger::s_cache (
 
 AcceptedLedger::AcceptedLedger (Ledger::ref ledger) : mLedger (ledger)
 {
-    SHAMap& txSet = *ledger->peekTransactionMap ();
+    SHAMapIterator it (ledger->peekTransactionMap ());
 
-    for (SHAMapItem::pointer item = txSet.peekFirstItem (); !!item; item = txSet.peekNextItem (item->getTag ()))
+    for (bool more = it.first (); more; more = it.next ())
     {
-        SerializerIterator sit (item->peekSerializer ());
+        SerializerIterator sit (it.getItem ()->peekSerializer ());
         insert (boost::make_shared<AcceptedLedgerTx> (ledger->getLedgerSeq (), boost::ref (sit)));
     }
 }
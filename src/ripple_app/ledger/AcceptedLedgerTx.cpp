@@ -29,20 +29,17 @@ AcceptedLedgerTx::AcceptedLedgerTx (std::uint32_t seq, SerializerIterator& sit)
     mMeta =     boost::make_shared<TransactionMetaSet> (mTxn->getTransactionID (), seq, mRawMeta);
     mAffected = mMeta->getAffectedAccounts ();
     mResult =   mMeta->getResultTER ();
-    buildJson ();
 }
 
 AcceptedLedgerTx::AcceptedLedgerTx (SerializedTransaction::ref txn, TransactionMetaSet::ref met) :
     mTxn (txn), mMeta (met), mAffected (met->getAffectedAccounts ())
 {
     mResult = mMeta->getResultTER ();
-    buildJson ();
 }
 
 AcceptedLedgerTx::AcceptedLedgerTx (SerializedTransaction::ref txn, TER result) :
     mTxn (txn), mResult (result), mAffected (txn->getMentionedAccounts ())
 {
-    buildJson ();
 }
 
 std::string AcceptedLedgerTx::getEscMeta () const
@@ -51,27 +48,29 @@ std::string AcceptedLedgerTx::getEscMeta () const
     return sqlEscape (mRawMeta);
 }
 
-void AcceptedLedgerTx::buildJson ()
+Json::Value AcceptedLedgerTx::getJson () const
 {
-    mJson = Json::objectValue;
-    mJson[jss::transaction] = mTxn->getJson (0);
+    Json::Value json (Json::objectValue);
+    json[jss::transaction] = mTxn->getJson (0);
 
     if (mMeta)
     {
-        mJson[jss::meta] = mMeta->getJson (0);
-        mJson[jss::raw_meta] = strHex (mRawMeta);
+        json[jss::meta] = mMeta->getJson (0);
+        json[jss::raw_meta] = strHex (mRawMeta);
     }
 
-    mJson[jss::result] = transHuman (mResult);
+    json[jss::result] = transHuman (mResult);
 
     if (!mAffected.empty ())
     {
-        Json::Value& affected = (mJson[jss::affected] = Json::arrayValue);
+        Json::Value& affected = (json[jss::affected] = Json::arrayValue);
         BOOST_FOREACH (const RippleAddress & ra, mAffected)
         {
             affected.append (ra.humanAccountID ());
         }
     }
+
+    return json;
 }
 
 } // ripple
@@ -91,20 +91,22 @@ public:
         return mMeta ? mMeta->getIndex () : 0;
     }
     std::string getEscMeta () const;
-    Json::Value getJson () const
+
+    /** The metadata as stored, empty unless read from a ledger. */
+    Blob const& getRawMeta () const
     {
-        return mJson;
+        return mRawMeta;
     }
 
+    /** Built on each call, it is only wanted for logging. */
+    Json::Value getJson () const;
+
 private:
     SerializedTransaction::pointer  mTxn;
     TransactionMetaSet::pointer     mMeta;
     TER                             mResult;
     std::vector <RippleAddress>     mAffected;
     Blob        mRawMeta;
-    Json::Value                     mJson;
-
-    void buildJson ();
 };
 
 } // ripple
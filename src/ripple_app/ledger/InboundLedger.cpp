@@ -34,6 +34,9 @@ enum
 
     // how many timeouts before we get aggressive
     ,ledgerBecomeAggressiveThreshold = 6
+
+    // how many peers to add to the set at a time
+    ,ledgerPeersToAdd = 6
 };
 
 InboundLedger::InboundLedger (uint256 const& hash, std::uint32_t seq, fcReason reason,
@@ -272,70 +275,29 @@ void InboundLedger::onTimer (bool wasProgress, ScopedLockType&)
 /** Add more peers to the set, if possible */
 void InboundLedger::addPeers ()
 {
-    Overlay::PeerSequence peerList = getApp().overlay ().getActivePeers ();
-
-    int vSize = peerList.size ();
-
-    if (vSize == 0)
-    {
-        WriteLog (lsERROR, InboundLedger) << 
-            "No peers to add for ledger acquisition";
-        return;
-    }
-
-    // FIXME-NIKB why are we doing this convoluted thing here instead of simply
-    // shuffling this vector and then pulling however many entries we need?
-
-    // We traverse the peer list in random order so as not to favor
-    // any particular peer
-    //
-    // VFALCO Use random_shuffle
-    //        http://en.cppreference.com/w/cpp/algorithm/random_shuffle
-    //
-    int firstPeer = rand () % vSize;
-
-    int found = 0;
-
-    // First look for peers that are likely to have this ledger
-    for (int i = 0; i < vSize; ++i)
-    {
-        Peer::ptr const& peer = peerList[ (i + firstPeer) % vSize];
-
-        if (peer->hasLedger (getHash (), mSeq))
+    // Peers likely to have the ledger rank first, then
+    // the ones that answer quickly and send useful data.
+    std::size_t const found = addBestPeers (ledgerPeersToAdd,
+        [this](Peer::ptr const& peer)
         {
-           if (peerHas (peer) && (++found > 6))
-               break;
-        }
-    }
+            return peer->hasLedger (getHash (), mSeq);
+        });
 
-    if (!found)
-    { // Oh well, try some random peers
-        for (int i = 0; (i < 6) && (i < vSize); ++i)
-        {
-            if (peerHas (peerList[ (i + firstPeer) % vSize]))
-                ++found;
-        }
-        if (mSeq != 0)
-        {
-            if (m_journal.debug) m_journal.debug <<
-                "Chose " << found << " peer(s) for ledger " << mSeq;
-        }
-        else
-        {
-            if (m_journal.debug) m_journal.debug <<
-                "Chose " << found << " peer(s) for ledger " <<
-                    to_string (getHash ());
-        }
+    if (found == 0)
+    {
+        if (getPeerCount () == 0)
+            WriteLog (lsERROR, InboundLedger) <<
+                "No peers to add for ledger acquisition";
     }
     else if (mSeq != 0)
     {
-        if (m_journal.debug) m_journal.debug << 
-            "Found " << found << " peer(s) with ledger " << mSeq;
+        if (m_journal.debug) m_journal.debug <<
+            "Chose " << found << " peer(s) for ledger " << mSeq;
     }
     else
     {
         if (m_journal.debug) m_journal.debug <<
-            "Found " << found << " peer(s) with ledger " <<
+            "Chose " << found << " peer(s) for ledger " <<
                 to_string (getHash ());
     }
 }
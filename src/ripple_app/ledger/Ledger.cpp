@@ -1012,17 +1012,114 @@ void Ledger::addJson (Json::Value& ret, int options)
     ret[jss::ledger] = getJson (options);
 }
 
-static void stateItemTagAppender(Json::Value& value, SHAMapItem::ref smi)
+static void stateItemTagAppender (std::function <void (Json::Value const&)> const& function,
+    SHAMapItem::ref smi)
 {
-    value.append (to_string (smi->getTag ()));
+    function (to_string (smi->getTag ()));
 }
 
-static void stateItemFullAppender(Json::Value& value, SLE::ref sle)
+static void stateItemFullAppender (std::function <void (Json::Value const&)> const& function,
+    SLE::ref sle)
 {
-    value.append (sle->getJson (0));
+    function (sle->getJson (0));
 }
 
 Json::Value Ledger::getJson (int options)
+{
+    ScopedLockType sl (mLock);
+
+    Json::Value ledger (getJsonHeader (options));
+
+    if (wantTransactionsJson (options))
+    {
+        Json::Value& txns = (ledger[jss::transactions] = Json::arrayValue);
+        visitTransactionsJson (options, [&txns] (Json::Value const& txn)
+        {
+            txns.append (txn);
+        });
+    }
+
+    if (wantStateJson (options))
+    {
+        Json::Value& state = (ledger[jss::accountState] = Json::arrayValue);
+        visitStateJson (options, [&state] (Json::Value const& item)
+        {
+            state.append (item);
+        });
+    }
+
+    return ledger;
+}
+
+void Ledger::writeJson (Json::Stream& stream, char const* key, int options)
+{
+    // Only the header is taken under the lock, the stream may block
+    // while a slow client catches up.
+    Json::Value const header (getJsonHeader (options));
+
+    // The arrays are written at the positions Json::Value would keep them
+    // in, so the text is the same as for getJson.
+    std::vector <char const*> arrays;
+
+    if (wantStateJson (options))
+        arrays.push_back (jss::accountState);
+
+    if (wantTransactionsJson (options))
+        arrays.push_back (jss::transactions);
+
+    std::sort (arrays.begin (), arrays.end (),
+        [] (char const* lhs, char const* rhs)
+        {
+            return std::strcmp (lhs, rhs) < 0;
+        });
+
+    auto nextArray (arrays.begin ());
+    auto writeArray = [&] ()
+    {
+        char const* const name (*nextArray++);
+
+        stream.startArray (name);
+
+        if (name == static_cast <char const*> (jss::transactions))
+        {
+            visitTransactionsJson (options, [&stream] (Json::Value const& txn)
+            {
+                stream.append (txn);
+            });
+        }
+        else
+        {
+            visitStateJson (options, [&stream] (Json::Value const& item)
+            {
+                stream.append (item);
+            });
+        }
+
+        stream.end ();
+    };
+
+    if (key != nullptr)
+        stream.startObject (key);
+    else
+        stream.startObject ();
+
+    Json::Value::Members const members (header.getMemberNames ());
+
+    for (auto const& member : members)
+    {
+        while (nextArray != arrays.end () && member.compare (*nextArray) > 0)
+            writeArray ();
+
+        stream.set (member, header[member]);
+    }
+
+    while (nextArray != arrays.end ())
+        writeArray ();
+
+    stream.end ();
+}
+
+Json::Value Ledger::getJsonHeader (int options)
 {
     Json::Value ledger (Json::objectValue);
 
@@ -1062,57 +1159,73 @@ Json::Value Ledger::getJson (int options)
         ledger[jss::closed] = false;
     }
 
-    if (mTransactionMap && (bFull || is_bit_set (options, LEDGER_JSON_DUMP_TXRP)))
+    return ledger;
+}
+
+bool Ledger::wantTransactionsJson (int options) const
+{
+    return mTransactionMap && (is_bit_set (options, LEDGER_JSON_FULL) ||
+        is_bit_set (options, LEDGER_JSON_DUMP_TXRP));
+}
+
+bool Ledger::wantStateJson (int options) const
+{
+    return mAccountStateMap && (is_bit_set (options, LEDGER_JSON_FULL) ||
+        is_bit_set (options, LEDGER_JSON_DUMP_STATE));
+}
+
+void Ledger::visitTransactionsJson (int options,
+    std::function <void (Json::Value const&)> const& function)
+{
+    bool const bExpand = is_bit_set (options, LEDGER_JSON_FULL) ||
+        is_bit_set (options, LEDGER_JSON_EXPAND);
+
+    SHAMapIterator it (mTransactionMap);
+
+    for (bool more = it.first (); more; more = it.next ())
     {
-        Json::Value& txns = (ledger[jss::transactions] = Json::arrayValue);
-        SHAMapTreeNode::TNType type;
+        SHAMapItem::ref item = it.getItem ();
+        SHAMapTreeNode::TNType const type = it.getType ();
 
-        for (SHAMapItem::pointer item = mTransactionMap->peekFirstItem (type); !!item;
-                item = mTransactionMap->peekNextItem (item->getTag (), type))
+        if (bExpand)
         {
-            if (bFull || is_bit_set (options, LEDGER_JSON_EXPAND))
+            if (type == SHAMapTreeNode::tnTRANSACTION_NM)
             {
-                if (type == SHAMapTreeNode::tnTRANSACTION_NM)
-                {
-                    SerializerIterator sit (item->peekSerializer ());
-                    SerializedTransaction txn (sit);
-                    txns.append (txn.getJson (0));
-                }
-                else if (type == SHAMapTreeNode::tnTRANSACTION_MD)
-                {
-                    SerializerIterator sit (item->peekSerializer ());
-                    Serializer sTxn (sit.getVL ());
+                SerializerIterator sit (item->peekSerializer ());
+                SerializedTransaction txn (sit);
+                function (txn.getJson (0));
+            }
+            else if (type == SHAMapTreeNode::tnTRANSACTION_MD)
+            {
+                SerializerIterator sit (item->peekSerializer ());
+                Serializer sTxn (sit.getVL ());
 
-                    SerializerIterator tsit (sTxn);
-                    SerializedTransaction txn (tsit);
+                SerializerIterator tsit (sTxn);
+                SerializedTransaction txn (tsit);
 
-                    TransactionMetaSet meta (item->getTag (), mLedgerSeq, sit.getVL ());
-                    Json::Value txJson = txn.getJson (0);
-                    txJson[jss::metaData] = meta.getJson (0);
-                    txns.append (txJson);
-                }
-                else
-                {
-                    Json::Value error = Json::objectValue;
-                    error[to_string (item->getTag ())] = type;
-                    txns.append (error);
-                }
+                TransactionMetaSet meta (item->getTag (), mLedgerSeq, sit.getVL ());
+                Json::Value txJson = txn.getJson (0);
+                txJson[jss::metaData] = meta.getJson (0);
+                function (txJson);
+            }
+            else
+            {
+                Json::Value error = Json::objectValue;
+                error[to_string (item->getTag ())] = type;
+                function (error);
             }
-            else txns.append (to_string (item->getTag ()));
         }
-
-    }
-
-    if (mAccountStateMap && (bFull || is_bit_set (options, LEDGER_JSON_DUMP_STATE)))
-    {
-        Json::Value& state = (ledger[jss::accountState] = Json::arrayValue);
-        if (bFull || is_bit_set (options, LEDGER_JSON_EXPAND))
-            visitStateItems(BIND_TYPE(stateItemFullAppender, std::ref(state), P_1));
-        else
-            mAccountStateMap->visitLeaves(BIND_TYPE(stateItemTagAppender, std::ref(state), P_1));
+        else function (to_string (item->getTag ()));
     }
+}
 
-    return ledger;
+void Ledger::visitStateJson (int options,
+    std::function <void (Json::Value const&)> const& function)
+{
+    if (is_bit_set (options, LEDGER_JSON_FULL) || is_bit_set (options, LEDGER_JSON_EXPAND))
+        visitStateItems (BIND_TYPE (stateItemFullAppender, std::cref (function), P_1));
+    else
+        mAccountStateMap->visitLeaves (BIND_TYPE (stateItemTagAppender, std::cref (function), P_1));
 }
 
 void Ledger::setAcquiring (void)
@@ -1313,46 +1426,46 @@ private:
 
 uint256 Ledger::getFirstLedgerIndex ()
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekFirstItem ();
-    return node ? node->getTag () : uint256 ();
+    SHAMapIterator it (mAccountStateMap);
+    return it.first () ? it.getKey () : uint256 ();
 }
 
 uint256 Ledger::getLastLedgerIndex ()
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekLastItem ();
-    return node ? node->getTag () : uint256 ();
+    SHAMapIterator it (mAccountStateMap);
+    return it.last () ? it.getKey () : uint256 ();
 }
 
 uint256 Ledger::getNextLedgerIndex (uint256 const& uHash)
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekNextItem (uHash);
-    return node ? node->getTag () : uint256 ();
+    SHAMapIterator it (mAccountStateMap);
+    return it.seekAfter (uHash) ? it.getKey () : uint256 ();
 }
 
 uint256 Ledger::getNextLedgerIndex (uint256 const& uHash, uint256 const& uEnd)
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekNextItem (uHash);
+    SHAMapIterator it (mAccountStateMap);
 
-    if ((!node) || (node->getTag () > uEnd))
+    if (!it.seekAfter (uHash) || (it.getKey () > uEnd))
         return uint256 ();
 
-    return node->getTag ();
+    return it.getKey ();
 }
 
 uint256 Ledger::getPrevLedgerIndex (uint256 const& uHash)
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekPrevItem (uHash);
-    return node ? node->getTag () : uint256 ();
+    SHAMapIterator it (mAccountStateMap);
+    return it.seekBefore (uHash) ? it.getKey () : uint256 ();
 }
 
 uint256 Ledger::getPrevLedgerIndex (uint256 const& uHash, uint256 const& uBegin)
 {
-    SHAMapItem::pointer node = mAccountStateMap->peekNextItem (uHash);
+    SHAMapIterator it (mAccountStateMap);
 
-    if ((!node) || (node->getTag () < uBegin))
+    if (!it.seekBefore (uHash) || (it.getKey () < uBegin))
         return uint256 ();
 
-    return node->getTag ();
+    return it.getKey ();
 }
 
 SLE::pointer Ledger::getASNodeI (uint256 const& nodeID, LedgerEntryType let)
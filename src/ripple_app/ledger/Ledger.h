@@ -467,10 +467,25 @@ public:
     Json::Value getJson (int options);
     void addJson (Json::Value&, int options);
 
+    /** Write the same object getJson returns to a stream.
+        Transactions and state entries are produced one at a time, so a
+        full ledger can be written without building it in memory. With a
+        null key the object is written as a value rather than a member.
+    */
+    void writeJson (Json::Stream& stream, char const* key, int options);
+
     bool walkLedger ();
     bool assertSane ();
 
 protected:
+    Json::Value getJsonHeader (int options);
+    bool wantTransactionsJson (int options) const;
+    bool wantStateJson (int options) const;
+    void visitTransactionsJson (int options,
+        std::function <void (Json::Value const&)> const& function);
+    void visitStateJson (int options,
+        std::function <void (Json::Value const&)> const& function);
+
     SLE::pointer getASNode (LedgerStateParms & parms, uint256 const & nodeID, LedgerEntryType let);
 
     // returned SLE is immutable
@@ -0,0 +1,64 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace ripple {
+
+LedgerDiffCache::LedgerDiffCache ()
+    : m_cache ("LedgerDiffs", 32, 60, get_seconds_clock (),
+        LogPartition::getJournal <TaggedCacheLog> ())
+{
+}
+
+LedgerDiffCache::pointer LedgerDiffCache::get (Ledger::ref parent, Ledger::ref child)
+{
+    pointer diff (m_cache.fetch (child->getHash ()));
+
+    if (diff)
+        return diff;
+
+    diff = boost::make_shared <Diff> ();
+    diff->seq = parent->getLedgerSeq ();
+
+    {
+        Serializer s (256);
+        s.add32 (HashPrefix::ledgerMaster);
+        parent->addRaw (s);
+        diff->objects.push_back (Object (parent->getHash (), s.peekData ()));
+    }
+
+    Diff& d (*diff);
+    auto const append = [&d] (uint256 const& hash, Blob const& data)
+    {
+        d.objects.push_back (Object (hash, data));
+    };
+
+    if (! parent->peekAccountStateMap ()->getFetchPack (
+        child->peekAccountStateMap ().get (), true, maxStateNodes, append))
+        return pointer ();
+
+    if (parent->getTransHash ().isNonZero ())
+        parent->peekTransactionMap ()->getFetchPack (
+            nullptr, true, maxTransactionNodes, append);
+
+    m_cache.canonicalize (child->getHash (), diff);
+
+    return diff;
+}
+
+}
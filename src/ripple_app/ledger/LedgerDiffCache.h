@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_LEDGERDIFFCACHE_H_INCLUDED
+#define RIPPLE_LEDGERDIFFCACHE_H_INCLUDED
+
+namespace ripple {
+
+/** Keeps the objects needed to go from a ledger back to its parent.
+
+    A diff holds the header of the parent ledger, the state nodes that
+    differ from those of its child and the transaction nodes of the parent,
+    in that order. Peers catching up through the same range of history ask
+    for the same diffs, so each one is built once and shared by their
+    fetch packs.
+*/
+class LedgerDiffCache
+{
+public:
+    typedef SHAMap::fetchPackEntry_t Object;
+
+    struct Diff
+    {
+        // Sequence of the parent ledger
+        std::uint32_t seq;
+        std::vector <Object> objects;
+    };
+
+    typedef boost::shared_ptr <Diff> pointer;
+
+    enum
+    {
+        // Largest number of nodes taken from each map
+        maxStateNodes = 1024,
+        maxTransactionNodes = 256
+    };
+
+    LedgerDiffCache ();
+
+    /** Return the diff between a ledger and its parent, building it if needed.
+        @return An empty pointer if the maps were busy.
+    */
+    pointer get (Ledger::ref parent, Ledger::ref child);
+
+    float getHitRate ()
+    {
+        return m_cache.getHitRate ();
+    }
+
+    void sweep ()
+    {
+        m_cache.sweep ();
+    }
+
+private:
+    // Keyed by the hash of the child ledger
+    TaggedCache <uint256, Diff> m_cache;
+};
+
+}
+
+#endif
@@ -46,7 +46,7 @@ void LedgerEntrySet::clear ()
 
 LedgerEntrySet LedgerEntrySet::duplicate () const
 {
-    return LedgerEntrySet (mLedger, mEntries, mSet, mSeq + 1);
+    return LedgerEntrySet (mLedger, mEntries, mSet, mSeq + 1, mReads);
 }
 
 void LedgerEntrySet::setTo (const LedgerEntrySet& e)
@@ -56,6 +56,7 @@ void LedgerEntrySet::setTo (const LedgerEntrySet& e)
     mSet = e.mSet;
     mParams = e.mParams;
     mSeq = e.mSeq;
+    mReads = e.mReads;
 }
 
 void LedgerEntrySet::swapWith (LedgerEntrySet& e)
@@ -65,8 +66,36 @@ void LedgerEntrySet::swapWith (LedgerEntrySet& e)
     mSet.swap (e.mSet);
     std::swap (mParams, e.mParams);
     std::swap (mSeq, e.mSeq);
+    std::swap (mReads, e.mReads);
 }
 
+bool LedgerEntryReads::intersects (std::set <uint256> const& written) const
+{
+    if (written.empty ())
+        return false;
+
+    BOOST_FOREACH (uint256 const& key, mKeys)
+    {
+        if (written.count (key) != 0)
+            return true;
+    }
+
+    typedef std::pair <uint256, uint256> range_type;
+    BOOST_FOREACH (range_type const& range, mRanges)
+    {
+        std::set <uint256>::const_iterator const it (
+            written.upper_bound (range.first));
+
+        if ((it != written.end ()) &&
+            (range.second.isZero () || (*it <= range.second)))
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
 // Find an entry in the set.  If it has the wrong sequence number, copy it and update the sequence number.
 // This is basically: copy-on-read.
 SLE::pointer LedgerEntrySet::getEntry (uint256 const& index, LedgerEntryAction& action)
@@ -113,6 +142,9 @@ SLE::pointer LedgerEntrySet::entryCache (LedgerEntryType letType, uint256 const&
             assert (action != taaDELETE);
             sleEntry = mImmutable ? mLedger->getSLEi (index) : mLedger->getSLE (index);
 
+            if (mReads != nullptr)
+                mReads->addKey (index);
+
             if (sleEntry)
                 entryCache (sleEntry);
         }
@@ -1012,6 +1044,24 @@ bool LedgerEntrySet::dirNext (
     return true;
 }
 
+// Walks through a book ask for the key after the one found last, which
+// the iterator steps to without descending from the root again.
+uint256 LedgerEntrySet::getNextInLedger (uint256 const& uHash)
+{
+    SHAMap::ref map = mLedger->peekAccountStateMap ();
+
+    if (!mLedgerNext || (mLedgerNext->getMap () != map))
+        mLedgerNext = SHAMapIterator (map);
+
+    SHAMapIterator& it = *mLedgerNext;
+
+    bool const found = (it.valid () && (it.getKey () == uHash))
+        ? it.next ()
+        : it.seekAfter (uHash);
+
+    return found ? it.getKey () : uint256 ();
+}
+
 uint256 LedgerEntrySet::getNextLedgerIndex (uint256 const& uHash)
 {
     // find next node in ledger that isn't deleted by LES
@@ -1020,11 +1070,14 @@ uint256 LedgerEntrySet::getNextLedgerIndex (uint256 const& uHash)
 
     do
     {
-        ledgerNext = mLedger->getNextLedgerIndex (ledgerNext);
+        ledgerNext = getNextInLedger (ledgerNext);
         it  = mEntries.find (ledgerNext);
     }
     while ((it != mEntries.end ()) && (it->second.mAction == taaDELETE));
 
+    if (mReads != nullptr)
+        mReads->addRange (uHash, ledgerNext);
+
     // find next node in LES that isn't deleted
     for (it = mEntries.upper_bound (uHash); it != mEntries.end (); ++it)
     {
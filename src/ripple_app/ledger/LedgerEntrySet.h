@@ -65,6 +65,43 @@ public:
     }
 };
 
+/** The ledger state consulted by a LedgerEntrySet.
+
+    When a LedgerEntrySet is attached to one of these, every entry it
+    fetches from its ledger and every key range it scans is recorded.
+    Speculative transaction application uses this to decide whether the
+    outcome of a transaction could have been changed by another one.
+*/
+class LedgerEntryReads
+{
+public:
+    void addKey (uint256 const& index)
+    {
+        mKeys.push_back (index);
+    }
+
+    /** Record a scan of the keys after 'after', up to and including 'last'.
+        A zero 'last' means the scan ran off the end of the ledger.
+    */
+    void addRange (uint256 const& after, uint256 const& last)
+    {
+        mRanges.push_back (std::make_pair (after, last));
+    }
+
+    /** Returns true if any recorded read could observe a key in 'written'. */
+    bool intersects (std::set <uint256> const& written) const;
+
+    void clear ()
+    {
+        mKeys.clear ();
+        mRanges.clear ();
+    }
+
+private:
+    std::vector <uint256> mKeys;
+    std::vector <std::pair <uint256, uint256> > mRanges;
+};
+
 /** An LES is a LedgerEntrySet.
 
     It's a view into a ledger used while a transaction is processing.
@@ -80,11 +117,11 @@ public:
     static char const* getCountedObjectName () { return "LedgerEntrySet"; }
 
     LedgerEntrySet (Ledger::ref ledger, TransactionEngineParams tep, bool immutable = false) :
-        mLedger (ledger), mParams (tep), mSeq (0), mImmutable (immutable)
+        mLedger (ledger), mParams (tep), mSeq (0), mImmutable (immutable), mReads (nullptr)
     {
     }
 
-    LedgerEntrySet () : mParams (tapNONE), mSeq (0), mImmutable (false)
+    LedgerEntrySet () : mParams (tapNONE), mSeq (0), mImmutable (false), mReads (nullptr)
     {
     }
 
@@ -110,6 +147,18 @@ public:
         mLedger.reset ();
     }
 
+    // Point the set at a different ledger with the same contents
+    void setLedger (Ledger::ref ledger)
+    {
+        mLedger = ledger;
+    }
+
+    // Record ledger reads made through this set (and its duplicates)
+    void setReads (LedgerEntryReads* reads)
+    {
+        mReads = reads;
+    }
+
     bool isValid () const
     {
         return mLedger != nullptr;
@@ -261,14 +310,21 @@ private:
     TransactionEngineParams mParams;
     int mSeq;
     bool mImmutable;
+    LedgerEntryReads* mReads;
+
+    // Where the last walk of the ledger's state map stopped
+    boost::optional <SHAMapIterator> mLedgerNext;
 
     LedgerEntrySet (Ledger::ref ledger, const std::map<uint256, LedgerEntrySetEntry>& e,
-                    const TransactionMetaSet & s, int m) :
-        mLedger (ledger), mEntries (e), mSet (s), mParams (tapNONE), mSeq (m), mImmutable (false)
+                    const TransactionMetaSet & s, int m, LedgerEntryReads* reads) :
+        mLedger (ledger), mEntries (e), mSet (s), mParams (tapNONE), mSeq (m), mImmutable (false),
+        mReads (reads)
     {
         ;
     }
 
+    uint256 getNextInLedger (uint256 const& uHash);
+
     SLE::pointer getForMod (uint256 const & node, Ledger::ref ledger,
                             ripple::unordered_map<uint256, SLE::pointer>& newMods);
 
@@ -0,0 +1,350 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+LedgerExport::LedgerExport (Json::Stream::Sink& sink, std::size_t bufferSize)
+    : m_sink (sink)
+    , m_bufferSize (bufferSize)
+    , m_items (0)
+{
+    m_buffer.reserve (bufferSize);
+}
+
+void LedgerExport::writeHeader (std::uint32_t seq, uint256 const& hash,
+    uint256 const& after)
+{
+    start (frameHeader, 1 + 4 + 32 + 32);
+    m_buffer.push_back (static_cast <char> (version));
+    put32 (seq);
+    put (hash.begin (), hash.size ());
+    put (after.begin (), after.size ());
+}
+
+void LedgerExport::writeHeader (std::uint32_t seq, uint256 const& hash,
+    uint256 const& after, std::uint32_t baseSeq, uint256 const& baseHash)
+{
+    start (frameHeader, 1 + 4 + 32 + 32 + 4 + 32);
+    m_buffer.push_back (static_cast <char> (version));
+    put32 (seq);
+    put (hash.begin (), hash.size ());
+    put (after.begin (), after.size ());
+    put32 (baseSeq);
+    put (baseHash.begin (), baseHash.size ());
+}
+
+void LedgerExport::writeState (SHAMapItem const& item)
+{
+    Blob const& data (item.peekData ());
+    uint256 const& key (item.getTag ());
+
+    start (frameState, key.size () + data.size ());
+    put (key.begin (), key.size ());
+    put (data.data (), data.size ());
+    ++m_items;
+}
+
+void LedgerExport::writeDelete (uint256 const& key)
+{
+    start (frameDelete, key.size ());
+    put (key.begin (), key.size ());
+    ++m_items;
+}
+
+void LedgerExport::writeMap (SHAMap::ref map, uint256 const& after)
+{
+    SHAMapIterator it (map);
+
+    for (bool more = it.seekAfter (after); more; more = it.next ())
+        writeState (*it.getItem ());
+}
+
+void LedgerExport::writeDelta (SHAMap::Delta const& delta,
+    uint256 const& after)
+{
+    for (auto iter = delta.upper_bound (after); iter != delta.end (); ++iter)
+    {
+        if (iter->second.first)
+            writeState (*iter->second.first);
+        else
+            writeDelete (iter->first);
+    }
+}
+
+void LedgerExport::finish ()
+{
+    start (frameEnd, 8);
+    put32 (static_cast <std::uint32_t> (m_items >> 32));
+    put32 (static_cast <std::uint32_t> (m_items));
+    flush ();
+}
+
+void LedgerExport::start (Frame type, std::size_t payloadBytes)
+{
+    // Frames are small next to the buffer, so a frame never waits
+    // on the sink while it is partly written.
+    if (m_buffer.size () + frameOverhead + payloadBytes > m_bufferSize)
+        flush ();
+
+    m_buffer.push_back (static_cast <char> (type));
+    put32 (static_cast <std::uint32_t> (payloadBytes));
+}
+
+void LedgerExport::put32 (std::uint32_t v)
+{
+    char const bytes [4] = {
+        static_cast <char> (v >> 24), static_cast <char> (v >> 16),
+        static_cast <char> (v >> 8), static_cast <char> (v) };
+    m_buffer.append (bytes, sizeof (bytes));
+}
+
+void LedgerExport::put (void const* data, std::size_t bytes)
+{
+    m_buffer.append (static_cast <char const*> (data), bytes);
+}
+
+void LedgerExport::flush ()
+{
+    if (! m_buffer.empty ())
+    {
+        m_sink.write (m_buffer.data (), m_buffer.size ());
+        m_buffer.clear ();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+class LedgerExport_test : public beast::unit_test::suite
+{
+public:
+    struct Item
+    {
+        int type;
+        uint256 key;
+        Blob data;
+    };
+
+    // Splits a stream back into frames, checking the framing
+    struct Parsed
+    {
+        Blob header;
+        std::vector <Item> items;
+        std::uint64_t count;
+        bool complete;
+    };
+
+    static std::uint32_t get32 (unsigned char const* p)
+    {
+        return (std::uint32_t (p[0]) << 24) | (std::uint32_t (p[1]) << 16) |
+            (std::uint32_t (p[2]) << 8) | std::uint32_t (p[3]);
+    }
+
+    Parsed parse (std::string const& stream)
+    {
+        Parsed result;
+        result.count = 0;
+        result.complete = false;
+
+        unsigned char const* p (
+            reinterpret_cast <unsigned char const*> (stream.data ()));
+        unsigned char const* const end (p + stream.size ());
+
+        while (end - p >= LedgerExport::frameOverhead)
+        {
+            int const type = p[0];
+            std::uint32_t const bytes = get32 (p + 1);
+            p += LedgerExport::frameOverhead;
+
+            if (! expect (std::size_t (end - p) >= bytes, "short frame"))
+                break;
+
+            if (type == LedgerExport::frameHeader)
+            {
+                result.header.assign (p, p + bytes);
+            }
+            else if (type == LedgerExport::frameEnd)
+            {
+                expect (bytes == 8, "bad end frame");
+                result.count = (std::uint64_t (get32 (p)) << 32) | get32 (p + 4);
+                result.complete = (p + bytes == end);
+            }
+            else
+            {
+                Item item;
+                item.type = type;
+                std::memcpy (item.key.begin (), p, 32);
+                item.data.assign (p + 32, p + bytes);
+                result.items.push_back (item);
+            }
+
+            p += bytes;
+        }
+
+        return result;
+    }
+
+    static uint256 makeKey (int i)
+    {
+        Serializer s;
+        s.add32 (i);
+        return s.getSHA512Half ();
+    }
+
+    static SHAMapItem makeItem (int i)
+    {
+        return SHAMapItem (makeKey (i), Blob (1 + (i % 50),
+            static_cast <unsigned char> (i)));
+    }
+
+    void testMap ()
+    {
+        testcase ("map");
+
+        FullBelowCache fullBelowCache ("test.full_below",
+            get_seconds_clock ());
+        SHAMap::pointer map (boost::make_shared <SHAMap> (
+            smtFREE, std::ref (fullBelowCache)));
+
+        for (int i = 0; i < 1000; ++i)
+            map->addItem (makeItem (i), false, false);
+
+        uint256 hash;
+        hash.SetHex ("0123");
+
+        std::string stream;
+        {
+            Json::StringSink sink (stream);
+            // A small buffer so frames are split over many writes
+            LedgerExport exporter (sink, 1024);
+            exporter.writeHeader (5, hash, uint256 ());
+            exporter.writeMap (map, uint256 ());
+            exporter.finish ();
+            expect (exporter.items () == 1000, "wrong item count");
+        }
+
+        Parsed const parsed (parse (stream));
+        expect (parsed.complete, "incomplete stream");
+        expect (parsed.count == 1000, "wrong end count");
+        expect (parsed.header.size () == 69, "wrong header");
+        expect (parsed.header[0] == LedgerExport::version, "wrong version");
+        expect (get32 (&parsed.header[1]) == 5, "wrong sequence");
+        expect (std::equal (hash.begin (), hash.end (),
+            parsed.header.begin () + 5), "wrong hash");
+
+        bool ordered (true);
+        bool matched (true);
+        for (std::size_t i = 0; i < parsed.items.size (); ++i)
+        {
+            Item const& item (parsed.items[i]);
+            if (i > 0 && item.key <= parsed.items[i - 1].key)
+                ordered = false;
+            SHAMapItem::pointer const found (map->peekItem (item.key));
+            if (item.type != LedgerExport::frameState || ! found ||
+                    found->peekData () != item.data)
+                matched = false;
+        }
+        expect (parsed.items.size () == 1000, "wrong number of items");
+        expect (ordered, "items out of order");
+        expect (matched, "items do not match the map");
+
+        // Resuming after any item gives the rest of the stream
+        uint256 const after (parsed.items[399].key);
+        std::string rest;
+        {
+            Json::StringSink sink (rest);
+            LedgerExport exporter (sink);
+            exporter.writeHeader (5, hash, after);
+            exporter.writeMap (map, after);
+            exporter.finish ();
+        }
+
+        Parsed const resumed (parse (rest));
+        expect (resumed.complete && resumed.count == 600, "wrong resume count");
+        expect (resumed.items.size () == 600 &&
+            resumed.items.front ().key == parsed.items[400].key &&
+            resumed.items.back ().key == parsed.items.back ().key,
+            "wrong resume");
+    }
+
+    void testDelta ()
+    {
+        testcase ("delta");
+
+        FullBelowCache fullBelowCache ("test.full_below",
+            get_seconds_clock ());
+        SHAMap::pointer base (boost::make_shared <SHAMap> (
+            smtFREE, std::ref (fullBelowCache)));
+
+        for (int i = 0; i < 100; ++i)
+            base->addItem (makeItem (i), false, false);
+
+        SHAMap::pointer map (base->snapShot (true));
+
+        // Delete 10, change 10 and add 10
+        for (int i = 0; i < 10; ++i)
+            map->delItem (makeKey (i));
+        for (int i = 10; i < 20; ++i)
+            map->updateGiveItem (boost::make_shared <SHAMapItem> (
+                makeKey (i), Blob (3, 0xff)), false, false);
+        for (int i = 100; i < 110; ++i)
+            map->addItem (makeItem (i), false, false);
+
+        SHAMap::Delta delta;
+        expect (map->compare (base, delta, 1000), "compare failed");
+        expect (delta.size () == 30, "wrong delta");
+
+        std::string stream;
+        {
+            Json::StringSink sink (stream);
+            LedgerExport exporter (sink);
+            exporter.writeHeader (6, uint256 (), uint256 (), 5, uint256 ());
+            exporter.writeDelta (delta, uint256 ());
+            exporter.finish ();
+        }
+
+        Parsed const parsed (parse (stream));
+        expect (parsed.complete && parsed.count == 30, "wrong count");
+        expect (parsed.header.size () == 105, "wrong header");
+
+        // Applying the stream to the base map gives the exported map
+        for (auto const& item : parsed.items)
+        {
+            if (item.type == LedgerExport::frameDelete)
+                base->delItem (item.key);
+            else if (! base->hasItem (item.key))
+                base->addItem (SHAMapItem (item.key, item.data), false, false);
+            else
+                base->updateGiveItem (boost::make_shared <SHAMapItem> (
+                    item.key, item.data), false, false);
+        }
+        expect (base->getHash () == map->getHash (), "diff does not apply");
+    }
+
+    void run ()
+    {
+        testMap ();
+        testDelta ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerExport,ripple_app,ripple);
+
+}
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_LEDGEREXPORT_H_INCLUDED
+#define RIPPLE_LEDGEREXPORT_H_INCLUDED
+
+namespace ripple {
+
+/** Writes the state of a ledger as a stream of binary frames.
+
+    Each frame is a one byte type, the length of the payload as four bytes
+    in network order, and the payload. A stream holds a header frame, the
+    item frames in increasing key order, and an end frame carrying the
+    number of item frames, so a reader can tell a complete stream from one
+    that was cut off.
+
+    An interrupted export is resumed by asking for the keys above the last
+    one received. The header records that key, which is zero for a stream
+    that starts at the beginning.
+*/
+class LedgerExport
+{
+public:
+    enum Frame
+    {
+        // version(1) seq(4) hash(32) after(32), and for a diff
+        // the base ledger's seq(4) hash(32)
+        frameHeader = 1,
+
+        // key(32) data
+        frameState = 2,
+
+        // key(32), for an item in the base ledger but not the exported one
+        frameDelete = 3,
+
+        // number of state and delete frames(8)
+        frameEnd = 4
+    };
+
+    enum
+    {
+        version = 1,
+
+        // Length of the type and payload length that precede a payload
+        frameOverhead = 5
+    };
+
+    explicit LedgerExport (Json::Stream::Sink& sink,
+        std::size_t bufferSize = 64 * 1024);
+
+    /** Write the header for the state of a ledger. */
+    void writeHeader (std::uint32_t seq, uint256 const& hash,
+        uint256 const& after);
+
+    /** Write the header for the changes from a base ledger to a ledger. */
+    void writeHeader (std::uint32_t seq, uint256 const& hash,
+        uint256 const& after, std::uint32_t baseSeq, uint256 const& baseHash);
+
+    void writeState (SHAMapItem const& item);
+
+    void writeDelete (uint256 const& key);
+
+    /** Write each item in the map with a key above `after`. */
+    void writeMap (SHAMap::ref map, uint256 const& after);
+
+    /** Write each difference with a key above `after`.
+        The first item of each pair is from the exported map and the
+        second from the base map, as produced by SHAMap::compare.
+    */
+    void writeDelta (SHAMap::Delta const& delta, uint256 const& after);
+
+    /** Write the end frame and pass all buffered data to the sink. */
+    void finish ();
+
+    /** Returns the number of state and delete frames written. */
+    std::uint64_t items () const
+    {
+        return m_items;
+    }
+
+private:
+    void start (Frame type, std::size_t payloadBytes);
+    void put32 (std::uint32_t v);
+    void put (void const* data, std::size_t bytes);
+    void flush ();
+
+    Json::Stream::Sink& m_sink;
+    std::size_t const m_bufferSize;
+    std::string m_buffer;
+    std::uint64_t m_items;
+};
+
+}
+
+#endif
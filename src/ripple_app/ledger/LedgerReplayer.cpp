@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace ripple {
+
+SETUP_LOG (LedgerReplayer)
+
+LedgerReplayer::LedgerReplayer ()
+    : m_journal (LogPartition::getJournal <LedgerReplayer> ())
+    , m_ledgers (0)
+    , m_mismatches (0)
+    , m_transactions (0)
+    , m_resultMismatches (0)
+    , m_speculationHits (0)
+    , m_speculationMisses (0)
+    , m_applyTime (0)
+    , m_totalTime (0)
+    , m_fetchCount (0)
+    , m_storeFetchCount (0)
+    , m_fetchMissCount (0)
+{
+}
+
+bool LedgerReplayer::replay (std::uint32_t first, std::uint32_t last)
+{
+    Ledger::pointer parent = Ledger::loadByIndex (first);
+
+    if (!parent)
+    {
+        m_journal.fatal << "Ledger " << first << " is not in the local database";
+        return false;
+    }
+
+    parent->setClosed ();
+    parent->setImmutable ();
+
+    std::uint64_t const fetchCount = SHAMap::getFetchCount ();
+    std::uint64_t const storeFetchCount = SHAMap::getStoreFetchCount ();
+    std::uint64_t const fetchMissCount = SHAMap::getFetchMissCount ();
+
+    bool ok = true;
+
+    try
+    {
+        for (std::uint32_t seq = first + 1; seq <= last; ++seq)
+        {
+            Ledger::pointer stored = Ledger::loadByIndex (seq);
+
+            if (!stored || (stored->getParentHash () != parent->getHash ()))
+            {
+                m_journal.fatal << "Ledger " << seq << " is missing or does not follow " <<
+                    parent->getLedgerSeq ();
+                ok = false;
+                break;
+            }
+
+            stored->setClosed ();
+            stored->setImmutable ();
+
+            clock_type::time_point const start = clock_type::now ();
+            Ledger::pointer built = replayLedger (parent, stored);
+            m_totalTime += clock_type::now () - start;
+            ++m_ledgers;
+
+            if (built->getHash () != stored->getHash ())
+            {
+                m_journal.error << "Ledger " << seq << " mismatch:" <<
+                    " hash " << built->getHash () << " != " << stored->getHash () <<
+                    ", state " << built->getAccountHash () << " != " << stored->getAccountHash () <<
+                    ", transactions " << built->getTransHash () << " != " << stored->getTransHash ();
+                ++m_mismatches;
+                ok = false;
+
+                // Continue from the stored ledger so one divergence
+                // does not make every following ledger mismatch too.
+                parent = stored;
+            }
+            else
+            {
+                m_journal.info << "Ledger " << seq << " matches";
+                parent = built;
+            }
+        }
+    }
+    catch (SHAMapMissingNode const& mn)
+    {
+        m_journal.fatal << "Replay stopped: " << mn;
+        ok = false;
+    }
+
+    m_fetchCount += SHAMap::getFetchCount () - fetchCount;
+    m_storeFetchCount += SHAMap::getStoreFetchCount () - storeFetchCount;
+    m_fetchMissCount += SHAMap::getFetchMissCount () - fetchMissCount;
+
+    return ok;
+}
+
+Ledger::pointer LedgerReplayer::replayLedger (Ledger::ref parent, Ledger::ref stored)
+{
+    // Recover the order the transactions were originally applied in
+    // from their metadata.
+    std::map <std::uint32_t, SerializedTransaction::pointer> ordered;
+    std::map <uint256, TER> expected;
+
+    SHAMapIterator it (stored->peekTransactionMap ());
+
+    for (bool more = it.first (); more; more = it.next ())
+    {
+        SHAMapItem::ref item = it.getItem ();
+        TransactionMetaSet::pointer meta;
+        SerializedTransaction::pointer txn = stored->getSMTransaction (item, it.getType (), meta);
+
+        if (!txn || !meta)
+            throw std::runtime_error ("stored transaction without metadata");
+
+        ordered[meta->getIndex ()] = txn;
+        expected[item->getTag ()] = meta->getResultTER ();
+    }
+
+    Ledger::pointer ledger = boost::make_shared<Ledger> (false, boost::ref (*parent));
+    TransactionEngine engine (ledger);
+
+    // The stored ledger was validated, so the signatures are not checked again.
+    TransactionEngineParams const params = tapNO_CHECK_SIGN;
+
+    std::unique_ptr <ParallelTransactionEngine> speculation;
+
+    if ((getConfig ().PARALLEL_APPLY > 1) && (ordered.size () > 1))
+    {
+        std::vector <ParallelTransactionEngine::Candidate> candidates;
+        candidates.reserve (ordered.size ());
+
+        for (auto const& entry : ordered)
+            candidates.push_back (std::make_pair (entry.second, params));
+
+        speculation.reset (new ParallelTransactionEngine (
+            ledger, getConfig ().PARALLEL_APPLY, getApp().getJobQueue ()));
+        speculation->speculate (candidates);
+        engine.setSpeculation (speculation.get ());
+    }
+
+    for (auto const& entry : ordered)
+    {
+        SerializedTransaction::ref txn = entry.second;
+        bool didApply = false;
+
+        clock_type::time_point const start = clock_type::now ();
+        TER const result = engine.applyTransaction (*txn, params, didApply);
+        clock_type::duration const elapsed = clock_type::now () - start;
+
+        TypeStats& stats = m_types[txn->getTxnType ()];
+        ++stats.count;
+        stats.total += elapsed;
+        stats.max = std::max (stats.max, elapsed);
+        m_applyTime += elapsed;
+        ++m_transactions;
+
+        if (!didApply || (result != expected[txn->getTransactionID ()]))
+        {
+            m_journal.warning << "Transaction " << txn->getTransactionID () <<
+                " gave " << transToken (result) << ", stored " <<
+                transToken (expected[txn->getTransactionID ()]);
+            ++m_resultMismatches;
+        }
+    }
+
+    if (speculation)
+    {
+        engine.setSpeculation (nullptr);
+        m_speculationHits += speculation->getHits ();
+        m_speculationMisses += speculation->getMisses ();
+    }
+
+    ledger->updateSkipList ();
+    ledger->setClosed ();
+    ledger->setAccepted (stored->getCloseTimeNC (),
+        stored->getCloseResolution (), stored->getCloseAgree ());
+
+    return ledger;
+}
+
+void LedgerReplayer::report (std::ostream& out) const
+{
+    using namespace std::chrono;
+
+    double const applySeconds = duration_cast <duration <double>> (m_applyTime).count ();
+    double const totalSeconds = duration_cast <duration <double>> (m_totalTime).count ();
+
+    out << "Replayed " << m_ledgers << " ledgers, " << m_transactions << " transactions" <<
+        std::endl;
+    out << "  mismatched ledgers:      " << m_mismatches << std::endl;
+    out << "  mismatched results:      " << m_resultMismatches << std::endl;
+    out << "  total time:              " << totalSeconds << " s" << std::endl;
+    out << "  apply time:              " << applySeconds << " s" << std::endl;
+
+    if (applySeconds > 0)
+        out << "  transactions/second:     " << (m_transactions / applySeconds) << std::endl;
+
+    if (totalSeconds > 0)
+        out << "  ledgers/second:          " << (m_ledgers / totalSeconds) << std::endl;
+
+    if ((m_speculationHits + m_speculationMisses) != 0)
+        out << "  speculation:             " << m_speculationHits << " used, " <<
+            m_speculationMisses << " conflicted" << std::endl;
+
+    out << "  node fetches:            " << m_fetchCount << std::endl;
+    out << "  node store fetches:      " << m_storeFetchCount << std::endl;
+    out << "  missing nodes:           " << m_fetchMissCount << std::endl;
+    out << "  tree node cache hit %:   " << SHAMap::getTreeNodeHitRate () << std::endl;
+    out << "  node store cache hit %:  " << getApp ().getNodeStore ().getCacheHitRate () << std::endl;
+    out << "  SLE cache hit %:         " << getApp ().getSLECache ().getHitRate () << std::endl;
+
+    out << "Per transaction type (count, mean us, max us):" << std::endl;
+
+    for (auto const& entry : m_types)
+    {
+        TxFormats::Item const* const item =
+            TxFormats::getInstance ()->findByType (entry.first);
+
+        std::uint64_t const total = duration_cast <microseconds> (entry.second.total).count ();
+        std::uint64_t const max = duration_cast <microseconds> (entry.second.max).count ();
+
+        out << "  " << std::left << std::setw (20) <<
+            (item ? item->getName () : std::string ("Unknown")) << std::right <<
+            std::setw (10) << entry.second.count <<
+            std::setw (12) << (total / entry.second.count) <<
+            std::setw (12) << max << std::endl;
+    }
+}
+
+} // ripple
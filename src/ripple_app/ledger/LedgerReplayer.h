@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_LEDGERREPLAYER_H_INCLUDED
+#define RIPPLE_LEDGERREPLAYER_H_INCLUDED
+
+namespace ripple {
+
+/** Re-applies stored ledgers through the transaction engine.
+
+    Starting from a ledger loaded out of the local databases, the
+    transactions of each following stored ledger are applied in their
+    original order to a fresh copy of the previous ledger. The result is
+    closed with the stored close time and its hashes are compared against
+    the stored ledger. Nothing is written back and no network access is
+    needed, so repeated runs over the same range are deterministic and the
+    collected timings can be used as a benchmark.
+*/
+class LedgerReplayer
+{
+public:
+    LedgerReplayer ();
+
+    /** Replay the ledgers after `first` up to and including `last`.
+        @return `true` if every replayed ledger matched the stored one.
+    */
+    bool replay (std::uint32_t first, std::uint32_t last);
+
+    /** Write a summary of the collected statistics. */
+    void report (std::ostream& out) const;
+
+private:
+    typedef std::chrono::steady_clock clock_type;
+
+    struct TypeStats
+    {
+        TypeStats ()
+            : count (0)
+            , total (0)
+            , max (0)
+        {
+        }
+
+        std::uint64_t count;
+        clock_type::duration total;
+        clock_type::duration max;
+    };
+
+    Ledger::pointer replayLedger (Ledger::ref parent, Ledger::ref stored);
+
+    beast::Journal m_journal;
+
+    std::map <TxType, TypeStats> m_types;
+    std::uint64_t m_ledgers;
+    std::uint64_t m_mismatches;
+    std::uint64_t m_transactions;
+    std::uint64_t m_resultMismatches;
+    std::uint64_t m_speculationHits;
+    std::uint64_t m_speculationMisses;
+    clock_type::duration m_applyTime;
+    clock_type::duration m_totalTime;
+
+    std::uint64_t m_fetchCount;
+    std::uint64_t m_storeFetchCount;
+    std::uint64_t m_fetchMissCount;
+};
+
+} // ripple
+
+#endif
@@ -235,10 +235,10 @@ BookListeners::pointer OrderBookDB::getBookListeners (RippleCurrency const& curr
 
 // Based on the meta, send the meta to the streams that are listening
 // We need to determine which streams a given meta effects
-void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx, Json::Value const& jvObj)
+void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
+    InfoSub::Message& message)
 {
-    ScopedLockType sl (mLock);
-
+    // getBookListeners locks, the books are published without the lock
     if (alTx.getResult () == tesSUCCESS)
     {
         // check if this is an offer or an offer cancel or a payment that consumes an offer
@@ -284,7 +284,7 @@ void OrderBookDB::processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
                                 getBookListeners (currencyPays, currencyGets, issuerPays, issuerGets);
 
                             if (book)
-                                book->publish (jvObj);
+                                book->publish (message);
                         }
                     }
                 }
@@ -315,25 +315,32 @@ void BookListeners::removeSubscriber (std::uint64_t seq)
     mListeners.erase (seq);
 }
 
-void BookListeners::publish (Json::Value const& jvObj)
+void BookListeners::publish (InfoSub::Message& message)
 {
-    Json::FastWriter jfwWriter;
-    std::string sObj = jfwWriter.write (jvObj);
-
-    ScopedLockType sl (mLock);
-    NetworkOPs::SubMapType::const_iterator it = mListeners.begin ();
+    std::vector <InfoSub::pointer> listeners;
 
-    while (it != mListeners.end ())
     {
-        InfoSub::pointer p = it->second.lock ();
+        ScopedLockType sl (mLock);
+        listeners.reserve (mListeners.size ());
+        NetworkOPs::SubMapType::const_iterator it = mListeners.begin ();
 
-        if (p)
+        while (it != mListeners.end ())
         {
-            p->send (jvObj, sObj, true);
-            ++it;
+            InfoSub::pointer p = it->second.lock ();
+
+            if (p)
+            {
+                listeners.push_back (std::move (p));
+                ++it;
+            }
+            else
+                it = mListeners.erase (it);
         }
-        else
-            it = mListeners.erase (it);
+    }
+
+    BOOST_FOREACH (InfoSub::ref p, listeners)
+    {
+        message.send (*p);
     }
 }
 
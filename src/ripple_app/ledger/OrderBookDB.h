@@ -31,7 +31,7 @@ public:
     BookListeners ();
     void addSubscriber (InfoSub::ref sub);
     void removeSubscriber (std::uint64_t sub);
-    void publish (Json::Value const& jvObj);
+    void publish (InfoSub::Message& message);
 
 private:
     typedef RippleRecursiveMutex LockType;
@@ -75,7 +75,8 @@ public:
             RippleIssuer const& issuerPays, RippleIssuer const& issuerGets);
 
     // see if this txn effects any orderbook
-    void processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx, Json::Value const& jvObj);
+    void processTxn (Ledger::ref ledger, const AcceptedLedgerTx& alTx,
+        InfoSub::Message& message);
 
 private:
     // by ci/ii
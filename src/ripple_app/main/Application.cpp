@@ -19,6 +19,7 @@
 
 #include "../ripple/common/seconds_clock.h"
 #include "../ripple_rpc/api/Manager.h"
+#include "../ripple_rpc/api/Tuning.h"
 #include "../ripple_overlay/api/make_Overlay.h"
 
 #include "Tuning.h"
@@ -66,6 +67,8 @@ template <> char const* LogPartition::getPartitionName <CollectorManager> () { r
 
 struct TaggedCacheLog;
 template <> char const* LogPartition::getPartitionName <TaggedCacheLog> () { return "TaggedCache"; }
+class MemoryGovernorLog;
+template <> char const* LogPartition::getPartitionName <MemoryGovernorLog> () { return "MemoryGovernor"; }
 
 //
 //------------------------------------------------------------------------------
@@ -115,6 +118,7 @@ public:
 
     NodeCache m_tempNodeCache;
     SLECache m_sleCache;
+    MemoryGovernor m_memoryGovernor;
     LocalCredentials m_localCredentials;
     TransactionMaster m_txMaster;
 
@@ -128,6 +132,8 @@ public:
     IoServicePool m_mainIoPool;
     std::unique_ptr <SiteFiles::Manager> m_siteFiles;
     std::unique_ptr <RPC::Manager> m_rpcManager;
+    std::unique_ptr <RPC::LatencyTracker> m_rpcLatency;
+    std::unique_ptr <RPC::KeyCache> m_rpcKeyCache;
     // VFALCO TODO Make OrderBookDB abstract
     OrderBookDB m_orderBookDB;
     std::unique_ptr <PathRequests> m_pathRequests;
@@ -148,6 +154,8 @@ public:
     std::unique_ptr <ProofOfWorkFactory> mProofOfWorkFactory;
     std::unique_ptr <LoadManager> m_loadManager;
     beast::DeadlineTimer m_sweepTimer;
+    std::unique_ptr <HotSet> m_hotSet;
+    std::chrono::steady_clock::time_point m_hotSetSaved;
     bool volatile mShutdown;
 
     std::unique_ptr <DatabaseCon> mRpcDB;
@@ -223,6 +231,8 @@ public:
         , m_sleCache ("LedgerEntryCache", 4096, 120, get_seconds_clock (),
             LogPartition::getJournal <TaggedCacheLog> ())
 
+        , m_memoryGovernor (LogPartition::getJournal <MemoryGovernorLog> ())
+
         , m_collectorManager (CollectorManager::New (
             getConfig().insightSettings,
                 LogPartition::getJournal <CollectorManager> ()))
@@ -257,6 +267,11 @@ public:
 
         , m_rpcManager (RPC::make_Manager (LogPartition::getJournal <RPCManagerLog> ()))
 
+        , m_rpcLatency (RPC::make_LatencyTracker (m_collectorManager->group ("rpc"),
+            std::chrono::milliseconds (getConfig ().RPC_SLOW_THRESHOLD)))
+
+        , m_rpcKeyCache (RPC::make_KeyCache (RPC::SIGNING_KEY_CACHE_SIZE))
+
         , m_orderBookDB (*m_jobQueue)
 
         , m_pathRequests ( new PathRequests (
@@ -301,7 +316,8 @@ public:
 
         , mFeeTrack (LoadFeeTrack::New (LogPartition::getJournal <LoadManagerLog> ()))
 
-        , mHashRouter (IHashRouter::New (IHashRouter::getDefaultHoldTime ()))
+        , mHashRouter (IHashRouter::New (get_seconds_clock (),
+            IHashRouter::getDefaultHoldTime ()))
 
         , mValidations (Validations::New ())
 
@@ -343,6 +359,13 @@ public:
         HashMaps::getInstance ().initializeNonce <size_t> ();
     }
 
+    ~ApplicationImp ()
+    {
+        // The tree node cache outlives us, don't leave it reporting
+        // to our collector.
+        SHAMap::setTreeCacheCollector (beast::insight::NullCollector::New ());
+    }
+
     //--------------------------------------------------------------------------
 
     CollectorManager& getCollectorManager ()
@@ -365,6 +388,16 @@ public:
         return *m_rpcManager;
     }
 
+    RPC::LatencyTracker& getRPCLatency ()
+    {
+        return *m_rpcLatency;
+    }
+
+    RPC::KeyCache& getRPCKeyCache ()
+    {
+        return *m_rpcKeyCache;
+    }
+
     SiteFiles::Manager& getSiteFiles()
     {
         return *m_siteFiles;
@@ -445,6 +478,11 @@ public:
         return m_sleCache;
     }
 
+    MemoryGovernor& getMemoryGovernor ()
+    {
+        return m_memoryGovernor;
+    }
+
     Validators::Manager& getValidators ()
     {
         return *m_validators;
@@ -609,6 +647,9 @@ public:
         if (!getConfig ().RUN_STANDALONE)
             updateTables ();
 
+        if (!getConfig ().SHARD_DIR.empty ())
+            addShards (getConfig ().SHARD_DIR);
+
         m_amendmentTable->addInitial();
         Pathfinder::initPathTable ();
 
@@ -664,6 +705,37 @@ public:
         m_sleCache.setTargetAge (getConfig ().getSize (siSLECacheAge));
         SHAMap::setTreeCache (getConfig ().getSize (siTreeCacheSize), getConfig ().getSize (siTreeCacheAge));
 
+        {
+            std::size_t cacheMB = getConfig ().CACHE_MEMORY;
+
+            if (cacheMB == 0)
+                cacheMB = getConfig ().getSize (siNodeCacheBytes) +
+                    getConfig ().getSize (siTreeCacheBytes) +
+                        getConfig ().getSize (siSLECacheBytes);
+
+            // The weights are the relative cost of a miss. A node store miss
+            // reads from disk, a tree node miss usually costs a node store
+            // fetch and a ledger entry miss only parses a tree node.
+            m_nodeStore->setGovernor (m_memoryGovernor, 4);
+            SHAMap::setTreeCacheGovernor (m_memoryGovernor, 2);
+            m_memoryGovernor.add ("ledger_entry", m_sleCache,
+                &ApplicationImp::getLedgerEntryBytes, 1);
+
+            m_memoryGovernor.setBudget (cacheMB * 1024 * 1024);
+            m_memoryGovernor.rebalance ();
+        }
+
+        m_nodeStore->setCollector (m_collectorManager->collector ());
+        SHAMap::setTreeCacheCollector (m_collectorManager->collector ());
+
+        if (getConfig ().WARM_RESTART_KEYS != 0)
+        {
+            m_hotSet = std::make_unique <HotSet> (
+                getConfig ().DATA_DIR / "hotset.dat", m_journal);
+            m_hotSet->load (*m_nodeStore);
+            m_hotSetSaved = std::chrono::steady_clock::now ();
+        }
+
 
         //----------------------------------------------------------------------
         //
@@ -710,7 +782,7 @@ public:
             m_wsPrivateDoor.reset (WSDoor::New (*m_resourceManager,
                 getOPs(), getConfig ().WEBSOCKET_IP,
                     getConfig ().WEBSOCKET_PORT, false, false,
-                        m_wsSSLContext->get ()));
+                        m_wsSSLContext->get (), m_collectorManager->group ("ws_admin")));
 
             if (m_wsPrivateDoor == nullptr)
             {
@@ -730,7 +802,7 @@ public:
             m_wsPublicDoor.reset (WSDoor::New (*m_resourceManager,
                 getOPs(), getConfig ().WEBSOCKET_PUBLIC_IP,
                     getConfig ().WEBSOCKET_PUBLIC_PORT, true, false,
-                        m_wsSSLContext->get ()));
+                        m_wsSSLContext->get (), m_collectorManager->group ("ws_public")));
 
             if (m_wsPublicDoor == nullptr)
             {
@@ -747,7 +819,7 @@ public:
             m_wsProxyDoor.reset (WSDoor::New (*m_resourceManager,
                 getOPs(), getConfig ().WEBSOCKET_PROXY_IP,
                     getConfig ().WEBSOCKET_PROXY_PORT, true, true,
-                        m_wsSSLContext->get ()));
+                        m_wsSSLContext->get (), m_collectorManager->group ("ws_proxy")));
 
             if (m_wsProxyDoor == nullptr)
             {
@@ -879,6 +951,12 @@ public:
 
         m_sweepTimer.cancel ();
 
+        // The sampler would keep signalling threads that are exiting
+        Profiler::stop ();
+
+        if (m_hotSet)
+            m_hotSet->save (*m_nodeStore, getConfig ().WARM_RESTART_KEYS);
+
         // VFALCO TODO get rid of this flag
         mShutdown = true;
 
@@ -1008,6 +1086,18 @@ public:
         //         have listeners register for "onSweep ()" notification.
         //
 
+        // Record the hot keys before the sweep evicts any of them
+        if (m_hotSet && (std::chrono::steady_clock::now () - m_hotSetSaved >=
+            std::chrono::seconds (hotSetSaveSeconds)))
+        {
+            m_hotSet->save (*m_nodeStore, getConfig ().WARM_RESTART_KEYS);
+            m_hotSetSaved = std::chrono::steady_clock::now ();
+        }
+
+        // Divide the cache memory using the hits since the last sweep and
+        // start a new pass over the governed caches.
+        m_memoryGovernor.rebalance ();
+
         m_fullBelowCache->sweep ();
 
         logTimedCall (m_journal.warning, "TransactionMaster::sweep", __FILE__, __LINE__, boost::bind (
@@ -1028,20 +1118,36 @@ public:
         logTimedCall (m_journal.warning, "InboundLedgers::sweep", __FILE__, __LINE__, boost::bind (
             &InboundLedgers::sweep, &getInboundLedgers ()));
 
-        logTimedCall (m_journal.warning, "SLECache::sweep", __FILE__, __LINE__, boost::bind (
-            &SLECache::sweep, &m_sleCache));
-
         logTimedCall (m_journal.warning, "AcceptedLedger::sweep", __FILE__, __LINE__,
             &AcceptedLedger::sweep);
 
-        logTimedCall (m_journal.warning, "SHAMap::sweep", __FILE__, __LINE__,
-            &SHAMap::sweep);
-
         logTimedCall (m_journal.warning, "NetworkOPs::sweepFetchPack", __FILE__, __LINE__, boost::bind (
             &NetworkOPs::sweepFetchPack, m_networkOPs.get ()));
 
-        // VFALCO NOTE does the call to sweep() happen on another thread?
-        m_sweepTimer.setExpiration (getConfig ().getSize (siSweepInterval));
+        doSweepSlice (j);
+    }
+
+    // Sweep the governed caches one time slice per job so that other jobs
+    // run in between, and restart the timer once the pass is complete.
+    void doSweepSlice (Job&)
+    {
+        if (m_memoryGovernor.sweep (std::chrono::milliseconds (sweepSliceMilliseconds)))
+        {
+            // VFALCO NOTE does the call to sweep() happen on another thread?
+            m_sweepTimer.setExpiration (getConfig ().getSize (siSweepInterval));
+        }
+        else
+        {
+            m_jobQueue->addJob (jtSWEEP, "sweepSlice",
+                BIND_TYPE (&ApplicationImp::doSweepSlice, this, P_1));
+        }
+    }
+
+    // Estimate the memory used by a cached ledger entry
+    static std::size_t getLedgerEntryBytes (SerializedLedgerEntry const& entry)
+    {
+        // The entry, each of its fields and the cache entry
+        return sizeof (SerializedLedgerEntry) + (entry.getCount () * 64) + 64;
     }
 
 
@@ -1049,6 +1155,7 @@ private:
     void updateTables ();
     void startNewLedger ();
     bool loadOldLedger (const std::string&, bool);
+    void addShards (boost::filesystem::path const& directory);
 
     void onAnnounceAddress ();
 };
@@ -1153,18 +1260,18 @@ bool ApplicationImp::loadOldLedger (const std::string& l, bool bReplay)
 
         if (bReplay)
         { // inject transaction from replayLedger into consensus set
-            SHAMap::ref txns = replayLedger->peekTransactionMap();
+            SHAMapIterator it (replayLedger->peekTransactionMap());
             Ledger::ref cur = getLedgerMaster().getCurrentLedger();
 
-            for (SHAMapItem::pointer it = txns->peekFirstItem(); it != nullptr; it = txns->peekNextItem(it->getTag()))
+            for (bool more = it.first(); more; more = it.next())
             {
-                Transaction::pointer txn = replayLedger->getTransaction(it->getTag());
+                Transaction::pointer txn = replayLedger->getTransaction(it.getKey());
                 m_journal.info << txn->getJson(0);
                 Serializer s;
                 txn->getSTransaction()->add(s);
-                if (!cur->addTransaction(it->getTag(), s))
+                if (!cur->addTransaction(it.getKey(), s))
                 {
-                    m_journal.warning << "Unable to add transaction " << it->getTag();
+                    m_journal.warning << "Unable to add transaction " << it.getKey();
                 }
             }
         }
@@ -1366,6 +1473,38 @@ void ApplicationImp::updateTables ()
     }
 }
 
+// Open the read-only history shards and attach them to the node store
+void ApplicationImp::addShards (boost::filesystem::path const& directory)
+{
+    boost::system::error_code ec;
+
+    for (boost::filesystem::directory_iterator iter (directory, ec), end;
+        !ec && iter != end; iter.increment (ec))
+    {
+        if (iter->path ().extension () != ".shard")
+            continue;
+
+        beast::StringPairArray params;
+        params.set ("type", "Shard");
+        params.set ("path", iter->path ().string ());
+
+        try
+        {
+            m_nodeStore->addShard (m_nodeStoreManager->make_Backend (params,
+                m_nodeStoreScheduler, LogPartition::getJournal <NodeObject> ()));
+        }
+        catch (std::exception const& e)
+        {
+            m_journal.error <<
+                "Unable to open shard '" << iter->path ().string () << "': " << e.what ();
+        }
+    }
+
+    if (ec)
+        m_journal.error <<
+            "Unable to read shards from '" << directory.string () << "': " << ec.message ();
+}
+
 void ApplicationImp::onAnnounceAddress ()
 {
     // NIKB CODEME
@@ -28,7 +28,7 @@ namespace SiteFiles { class Manager; }
 namespace Validators { class Manager; }
 namespace Resource { class Manager; }
 namespace NodeStore { class Database; }
-namespace RPC { class Manager; }
+namespace RPC { class Manager; class LatencyTracker; class KeyCache; }
 
 // VFALCO TODO Fix forward declares required for header dependency loops
 class CollectorManager;
@@ -84,9 +84,12 @@ public:
     virtual FullBelowCache&         getFullBelowCache () = 0;
     virtual JobQueue&               getJobQueue () = 0;
     virtual RPC::Manager&           getRPCManager () = 0;
+    virtual RPC::LatencyTracker&    getRPCLatency () = 0;
+    virtual RPC::KeyCache&          getRPCKeyCache () = 0;
     virtual SiteFiles::Manager&     getSiteFiles () = 0;
     virtual NodeCache&              getTempNodeCache () = 0;
     virtual SLECache&               getSLECache () = 0;
+    virtual MemoryGovernor&         getMemoryGovernor () = 0;
     virtual Validators::Manager&    getValidators () = 0;
     virtual AmendmentTable&         getAmendmentTable() = 0;
     virtual IHashRouter&            getHashRouter () = 0;
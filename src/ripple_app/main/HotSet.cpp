@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+static char const hotSetMagic [4] = { 'R', 'H', 'S', '1' };
+
+HotSet::HotSet (boost::filesystem::path const& path, beast::Journal journal)
+    : m_path (path)
+    , m_journal (journal)
+{
+}
+
+void HotSet::save (NodeStore::Database& database, std::size_t limit)
+{
+    // Until the warm up completes the old manifest is the better one
+    if (database.getPrefetchPending () != 0)
+        return;
+
+    std::vector <uint256> keys (SHAMap::getHotInnerNodes (limit / 2));
+
+    if (keys.size () < limit)
+    {
+        std::vector <uint256> const objects (
+            database.getHotKeys (limit - keys.size ()));
+        keys.insert (keys.end (), objects.begin (), objects.end ());
+    }
+
+    if (write (m_path, keys))
+    {
+        if (m_journal.debug) m_journal.debug <<
+            "Saved " << keys.size () << " hot keys";
+    }
+    else if (m_journal.warning) m_journal.warning <<
+        "Unable to write " << m_path.string ();
+}
+
+std::size_t HotSet::load (NodeStore::Database& database)
+{
+    std::vector <uint256> keys;
+
+    if (! read (m_path, keys))
+    {
+        if (boost::filesystem::exists (m_path) && m_journal.warning)
+            m_journal.warning << "Ignoring malformed " << m_path.string ();
+        return 0;
+    }
+
+    database.prefetch (keys);
+
+    if (m_journal.info) m_journal.info <<
+        "Warming up with " << keys.size () << " hot keys";
+
+    return keys.size ();
+}
+
+bool HotSet::write (boost::filesystem::path const& path,
+    std::vector <uint256> keys)
+{
+    // Sorted keys let the read threads walk the back end in order
+    std::sort (keys.begin (), keys.end ());
+    keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+
+    Serializer s (8 + static_cast <int> (keys.size ()) * 32);
+    s.addRaw (hotSetMagic, sizeof (hotSetMagic));
+    s.add32 (static_cast <std::uint32_t> (keys.size ()));
+    for (auto const& key : keys)
+        s.add256 (key);
+
+    boost::filesystem::path temp (path);
+    temp += ".tmp";
+
+    {
+        std::ofstream out (temp.string ().c_str (),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write (static_cast <char const*> (s.getDataPtr ()),
+            s.getDataLength ());
+        out.close ();
+
+        if (! out)
+            return false;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename (temp, path, ec);
+    return ! ec;
+}
+
+bool HotSet::read (boost::filesystem::path const& path,
+    std::vector <uint256>& keys)
+{
+    keys.clear ();
+
+    std::ifstream in (path.string ().c_str (), std::ios::in | std::ios::binary);
+    if (! in)
+        return false;
+
+    unsigned char header [8];
+    if (! in.read (reinterpret_cast <char*> (header), sizeof (header)) ||
+        ! std::equal (hotSetMagic, hotSetMagic + sizeof (hotSetMagic), header))
+        return false;
+
+    std::uint32_t const count = (std::uint32_t (header [4]) << 24) |
+        (std::uint32_t (header [5]) << 16) |
+            (std::uint32_t (header [6]) << 8) | header [7];
+
+    keys.reserve (count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        uint256 key;
+        if (! in.read (reinterpret_cast <char*> (key.begin ()), key.size ()))
+        {
+            keys.clear ();
+            return false;
+        }
+        keys.push_back (key);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+class HotSet_test : public beast::unit_test::suite
+{
+public:
+    void run ()
+    {
+        boost::filesystem::path const path (
+            boost::filesystem::temp_directory_path () /
+                boost::filesystem::unique_path ());
+
+        std::vector <uint256> keys;
+        expect (! HotSet::read (path, keys), "Should be missing");
+
+        for (int i = 0; i < 100; ++i)
+        {
+            Serializer s;
+            s.add32 (i);
+            keys.push_back (s.getSHA512Half ());
+        }
+        keys.push_back (keys.front ());
+
+        expect (HotSet::write (path, keys), "Should write");
+
+        std::vector <uint256> loaded;
+        expect (HotSet::read (path, loaded), "Should read");
+        expect (loaded.size () == 100, "Should drop duplicates");
+        expect (std::is_sorted (loaded.begin (), loaded.end ()),
+            "Should be sorted");
+
+        std::sort (keys.begin (), keys.end ());
+        keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+        expect (loaded == keys, "Should round trip");
+
+        {
+            // A truncated file is rejected
+            std::ofstream out (path.string ().c_str (),
+                std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write (hotSetMagic, sizeof (hotSetMagic));
+            char const count [4] = { 0, 0, 0, 2 };
+            out.write (count, sizeof (count));
+        }
+        expect (! HotSet::read (path, loaded), "Should be malformed");
+        expect (loaded.empty (), "Should be empty");
+
+        boost::filesystem::remove (path);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HotSet,ripple_app,ripple);
+
+}
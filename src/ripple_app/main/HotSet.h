@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOTSET_H_INCLUDED
+#define RIPPLE_APP_HOTSET_H_INCLUDED
+
+namespace ripple {
+
+/** A manifest of the most recently used node store keys.
+
+    The manifest is written periodically and at shutdown, and read at
+    startup to queue background reads so a restarted server does not pay
+    a cold cache miss for every object it was using before.
+
+    The file holds a four byte magic number, the number of keys as four
+    bytes in network order, and the keys in increasing order. It is
+    written to a temporary file which then replaces the old one, so a
+    crash never leaves a partial manifest behind.
+*/
+class HotSet
+{
+public:
+    HotSet (boost::filesystem::path const& path, beast::Journal journal);
+
+    /** Record the hottest keys from the tree node and node store caches.
+        Inner nodes come first, since they lead to everything else. Nothing
+        is recorded while keys from the last manifest are still queued.
+        @param limit The largest number of keys to record.
+    */
+    void save (NodeStore::Database& database, std::size_t limit);
+
+    /** Queue the recorded keys to be read in the background.
+        @return The number of keys queued.
+    */
+    std::size_t load (NodeStore::Database& database);
+
+    /** Write keys to a manifest file. */
+    static bool write (boost::filesystem::path const& path,
+        std::vector <uint256> keys);
+
+    /** Read keys from a manifest file.
+        @return `false` if the file is missing or malformed.
+    */
+    static bool read (boost::filesystem::path const& path,
+        std::vector <uint256>& keys);
+
+private:
+    boost::filesystem::path m_path;
+    beast::Journal m_journal;
+};
+
+}
+
+#endif
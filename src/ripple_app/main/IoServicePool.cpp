@@ -48,6 +48,8 @@ public:
 
     void run ()
     {
+        Profiler::registerThread (getThreadName ().toRawUTF8 ());
+
         m_service.run ();
 
         m_owner.onThreadExit();
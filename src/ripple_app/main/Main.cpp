@@ -85,6 +85,7 @@ void printHelp (const po::options_description& desc)
     cerr << "     book_offers <taker_pays> <taker_gets> [<taker [<ledger> [<limit> [<proof> [<marker>]]]]]" << endl;
     cerr << "     connect <ip> [<port>]" << endl;
     cerr << "     consensus_info" << endl;
+    cerr << "     cpu_profile [start [<interval>]|stop|dump]" << endl;
     cerr << "     get_counts" << endl;
     cerr << "     json <method> <json>" << endl;
     cerr << "     ledger [<id>|current|closed|validated] [full]" << endl;
@@ -100,6 +101,7 @@ void printHelp (const po::options_description& desc)
     cerr << "     random" << endl;
     cerr << "     ripple ..." << endl;
     cerr << "     ripple_path_find <json> [<ledger>]" << endl;
+    cerr << "     rpc_latency" << endl;
     //  cerr << "     send <seed> <paying_account> <account_id> <amount> [<currency>] [<send_max>] [<send_currency>]" << endl;
     cerr << "     stop" << endl;
     cerr << "     tx <id>" << endl;
@@ -162,6 +164,346 @@ runUnitTests (std::string pattern, std::string format)
 
 //------------------------------------------------------------------------------
 
+// Parse a ledger range given as <first>-<last>
+static
+bool
+parseLedgerRange (std::string const& range,
+    std::uint32_t& first, std::uint32_t& last)
+{
+    try
+    {
+        std::string::size_type const pos = range.find ('-');
+
+        if (pos == std::string::npos)
+            return false;
+
+        first = beast::lexicalCastThrow <std::uint32_t> (range.substr (0, pos));
+        last = beast::lexicalCastThrow <std::uint32_t> (range.substr (pos + 1));
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return (first != 0) && (last > first);
+}
+
+static
+int
+runReplayBenchmark (std::string const& range)
+{
+    std::uint32_t first = 0;
+    std::uint32_t last = 0;
+
+    if (! parseLedgerRange (range, first, last))
+    {
+        std::cerr << "replay_bench expects a range <first>-<last>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Run from the local databases only: no peers, no listening ports
+    // and nothing written back.
+    getConfig ().RUN_STANDALONE = true;
+    getConfig ().LEDGER_HISTORY = 0;
+    getConfig ().START_UP = Config::LOAD;
+    getConfig ().START_LEDGER = beast::lexicalCastThrow <std::string> (first);
+    getConfig ().WEBSOCKET_IP.clear ();
+    getConfig ().WEBSOCKET_PUBLIC_IP.clear ();
+    getConfig ().WEBSOCKET_PROXY_IP.clear ();
+    getConfig ().setRpcPort (0);
+
+    std::unique_ptr <Application> app (make_Application ());
+    setupServer ();
+
+    LedgerReplayer replayer;
+    bool const ok = replayer.replay (first, last);
+    replayer.report (std::cout);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Counts streamed ledger text and checks it against the text FastWriter produced
+class ExportCheckSink : public Json::Stream::Sink
+{
+public:
+    explicit ExportCheckSink (std::string const& expected)
+        : m_expected (expected)
+        , m_size (0)
+        , m_match (true)
+    {
+    }
+
+    void write (char const* data, std::size_t bytes)
+    {
+        if (m_match && m_expected.compare (m_size, bytes, data, bytes) != 0)
+            m_match = false;
+
+        m_size += bytes;
+    }
+
+    bool match () const
+    {
+        return m_match && (m_size == m_expected.size ());
+    }
+
+private:
+    std::string const& m_expected;
+    std::size_t m_size;
+    bool m_match;
+};
+
+static
+int
+runExportBenchmark (std::string const& ledger)
+{
+    std::uint32_t seq = 0;
+
+    if (! beast::lexicalCastChecked (seq, ledger) || seq == 0)
+    {
+        std::cerr << "export_bench expects a ledger sequence" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Run from the local databases only, as for replay_bench.
+    getConfig ().RUN_STANDALONE = true;
+    getConfig ().LEDGER_HISTORY = 0;
+    getConfig ().START_UP = Config::LOAD;
+    getConfig ().START_LEDGER = ledger;
+    getConfig ().WEBSOCKET_IP.clear ();
+    getConfig ().WEBSOCKET_PUBLIC_IP.clear ();
+    getConfig ().WEBSOCKET_PROXY_IP.clear ();
+    getConfig ().setRpcPort (0);
+
+    std::unique_ptr <Application> app (make_Application ());
+    setupServer ();
+
+    Ledger::pointer const lpLedger (Ledger::loadByIndex (seq));
+
+    if (! lpLedger)
+    {
+        std::cerr << "ledger " << seq << " is not in the local database" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int const options = LEDGER_JSON_FULL;
+    typedef std::chrono::steady_clock clock_type;
+
+    // Build the tree and write it out, as ledger did before streaming.
+    clock_type::time_point start (clock_type::now ());
+    std::string text;
+    {
+        Json::Value const tree (lpLedger->getJson (options));
+        Json::FastWriter writer;
+        text = writer.write (tree);
+        text.resize (text.size () - 1); // trailing newline
+    }
+    auto const treeTime (std::chrono::duration_cast <std::chrono::milliseconds> (
+        clock_type::now () - start));
+
+    // Stream it with the default buffer.
+    ExportCheckSink sink (text);
+    start = clock_type::now ();
+    {
+        Json::Stream stream (sink);
+        lpLedger->writeJson (stream, nullptr, options);
+    }
+    auto const streamTime (std::chrono::duration_cast <std::chrono::milliseconds> (
+        clock_type::now () - start));
+
+    std::cout <<
+        "ledger " << seq << ": " << text.size () << " bytes\n"
+        "tree:   " << treeTime.count () << " ms\n"
+        "stream: " << streamTime.count () << " ms\n"
+        "output " << (sink.match () ? "identical" : "DIFFERS") << std::endl;
+
+    return sink.match () ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// A subscriber that counts what it would be sent
+class PublishCountSub : public InfoSub
+{
+public:
+    PublishCountSub (InfoSub::Source& source, bool binary)
+        : InfoSub (source, Resource::Consumer ())
+        , m_messages (0)
+        , m_bytes (0)
+    {
+        setBinary (binary);
+    }
+
+    void send (Json::Value const& jvObj, bool)
+    {
+        Json::FastWriter w;
+        count (w.write (jvObj));
+    }
+
+    void send (Json::Value const&, std::string const& sObj, bool)
+    {
+        count (sObj);
+    }
+
+    void sendBinary (std::string const& frame)
+    {
+        count (frame);
+    }
+
+    bool canSendBinary () const
+    {
+        return true;
+    }
+
+    std::size_t messages () const
+    {
+        return m_messages;
+    }
+
+    std::size_t bytes () const
+    {
+        return m_bytes;
+    }
+
+private:
+    void count (std::string const& s)
+    {
+        ++m_messages;
+        m_bytes += s.size ();
+    }
+
+    std::size_t m_messages;
+    std::size_t m_bytes;
+};
+
+static
+int
+runPublishBenchmark (std::string const& range)
+{
+    std::uint32_t first = 0;
+    std::uint32_t last = 0;
+
+    if (! parseLedgerRange (range, first, last))
+    {
+        std::cerr << "publish_bench expects a range <first>-<last>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Run from the local databases only, as for replay_bench.
+    getConfig ().RUN_STANDALONE = true;
+    getConfig ().LEDGER_HISTORY = 0;
+    getConfig ().START_UP = Config::LOAD;
+    getConfig ().START_LEDGER = beast::lexicalCastThrow <std::string> (first);
+    getConfig ().WEBSOCKET_IP.clear ();
+    getConfig ().WEBSOCKET_PUBLIC_IP.clear ();
+    getConfig ().WEBSOCKET_PROXY_IP.clear ();
+    getConfig ().setRpcPort (0);
+
+    std::unique_ptr <Application> app (make_Application ());
+    setupServer ();
+
+    // Load and parse the ledgers first, the publish itself is timed. The
+    // accepted ledgers are held so that publishing finds them cached.
+    std::vector <AcceptedLedger::pointer> ledgers;
+
+    for (std::uint32_t seq = first; seq <= last; ++seq)
+    {
+        Ledger::pointer const ledger (Ledger::loadByIndex (seq));
+
+        if (! ledger)
+        {
+            std::cerr << "ledger " << seq << " is not in the local database" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        ledgers.push_back (AcceptedLedger::makeAcceptedLedger (ledger));
+    }
+
+    NetworkOPs& ops (getApp ().getOPs ());
+    typedef std::chrono::steady_clock clock_type;
+
+    for (int binary = 0; binary < 2; ++binary)
+    {
+        boost::shared_ptr <PublishCountSub> sub (
+            boost::make_shared <PublishCountSub> (boost::ref (ops), binary != 0));
+        Json::Value jvResult (Json::objectValue);
+        ops.subLedger (sub, jvResult);
+        ops.subTransactions (sub);
+
+        clock_type::time_point const start (clock_type::now ());
+
+        for (auto const& accepted : ledgers)
+            ops.pubLedger (accepted->getLedger ());
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::microseconds> (clock_type::now () - start));
+
+        std::cout <<
+            (binary ? "binary: " : "json:   ") <<
+            (elapsed.count () / ledgers.size ()) << " us per ledger, " <<
+            sub->messages () << " messages, " <<
+            sub->bytes () << " bytes" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static
+int
+runMakeShard (std::string const& range)
+{
+    std::uint32_t first = 0;
+    std::uint32_t last = 0;
+
+    if (! parseLedgerRange (range, first, last))
+    {
+        std::cerr << "make_shard expects a range <first>-<last>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (getConfig ().SHARD_DIR.empty ())
+    {
+        std::cerr << "make_shard requires the [" SECTION_NODE_SHARDS "] setting" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    boost::filesystem::create_directories (getConfig ().SHARD_DIR);
+
+    boost::filesystem::path const path (getConfig ().SHARD_DIR /
+        (range + ".shard"));
+
+    if (boost::filesystem::exists (path))
+    {
+        std::cerr << "'" << path.string () << "' already exists" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    beast::StringPairArray params;
+    params.set ("type", "Shard");
+    params.set ("path", path.string ());
+    params.set ("first_ledger", beast::String (first));
+    params.set ("last_ledger", beast::String (last));
+
+    std::unique_ptr <NodeStore::Manager> manager (NodeStore::make_Manager ());
+    NodeStore::DummyScheduler scheduler;
+
+    std::unique_ptr <NodeStore::Database> source (manager->make_Database (
+        "NodeStore.main", scheduler, LogPartition::getJournal <NodeObject> (), 0,
+            getConfig ().nodeDatabase));
+
+    {
+        // The shard is written when the database is destroyed
+        std::unique_ptr <NodeStore::Database> shard (manager->make_Database (
+            "NodeStore.shard", scheduler, LogPartition::getJournal <NodeObject> (), 0,
+                params));
+
+        shard->import (*source);
+    }
+
+    std::cout << "Wrote '" << path.string () << "'" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+
 int run (int argc, char** argv)
 {
     // Make sure that we have the right OpenSSL and Boost libraries.
@@ -208,6 +550,10 @@ int run (int argc, char** argv)
     ("net", "Get the initial ledger from the network.")
     ("fg", "Run in the foreground.")
     ("import", importDescription.toStdString ().c_str ())
+    ("replay_bench", po::value <std::string> (), "Re-apply the stored ledgers <first>-<last> offline and report timings.")
+    ("make_shard", po::value <std::string> (), "Write the objects from ledgers <first>-<last> to a read-only shard.")
+    ("export_bench", po::value <std::string> (), "Time writing the stored ledger <seq> as JSON, with and without streaming.")
+    ("publish_bench", po::value <std::string> (), "Time publishing the stored ledgers <first>-<last> to JSON and binary subscribers.")
     ("version", "Display the build version.")
     ;
 
@@ -266,7 +612,11 @@ int run (int argc, char** argv)
         && !vm.count ("parameters")
         && !vm.count ("fg")
         && !vm.count ("standalone")
-        && !vm.count ("unittest"))
+        && !vm.count ("unittest")
+        && !vm.count ("replay_bench")
+        && !vm.count ("make_shard")
+        && !vm.count ("export_bench")
+        && !vm.count ("publish_bench"))
     {
         std::string logMe = DoSustain (getConfig ().DEBUG_LOGFILE.string());
 
@@ -362,6 +712,18 @@ int run (int argc, char** argv)
         }
     }
 
+    if ((iResult == 0) && vm.count ("replay_bench"))
+        return runReplayBenchmark (vm ["replay_bench"].as <std::string> ());
+
+    if ((iResult == 0) && vm.count ("make_shard"))
+        return runMakeShard (vm ["make_shard"].as <std::string> ());
+
+    if ((iResult == 0) && vm.count ("export_bench"))
+        return runExportBenchmark (vm ["export_bench"].as <std::string> ());
+
+    if ((iResult == 0) && vm.count ("publish_bench"))
+        return runPublishBenchmark (vm ["publish_bench"].as <std::string> ());
+
     if (iResult == 0)
     {
         if (!vm.count ("parameters"))
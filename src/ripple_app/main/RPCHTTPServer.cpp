@@ -130,7 +130,7 @@ public:
     {
 #if 0
         Job job;
-        processSession (job, session);
+        processSession (job, session, RPC::LatencyTracker::clock_type::now ());
 #else
         session.detach();
 
@@ -139,7 +139,7 @@ public:
         // and so references to it are not callable.
         m_jobQueue.addJob (jtRPC, "RPC", boost::bind (
             &RPCHTTPServerImp::processSession, this, boost::_1,
-                boost::ref (session)));
+                boost::ref (session), RPC::LatencyTracker::clock_type::now ()));
 #endif
     }
 
@@ -154,12 +154,63 @@ public:
 
     //--------------------------------------------------------------------------
 
-    void processSession (Job& job, HTTP::Session& session)
+    // Passes response text to the session, waiting when too much of it
+    // is still unsent so a streamed response is produced no faster than
+    // the client reads it.
+    class SessionSink : public Json::Stream::Sink
     {
-        session.write (m_deprecatedHandler.processRequest (
-            session.content(), session.remoteAddress().at_port(0)));
+    public:
+        // Thrown to abandon a response the client stopped reading
+        class Stalled : public std::runtime_error
+        {
+        public:
+            Stalled ()
+                : std::runtime_error ("client is not reading the response")
+            {
+            }
+        };
+
+        // Most unsent data to allow before waiting
+        static std::size_t const maxQueued = 256 * 1024;
+
+        explicit SessionSink (HTTP::Session& session)
+            : m_session (session)
+        {
+        }
+
+        void write (char const* data, std::size_t bytes)
+        {
+            // Waiting first means a response written all at once never blocks
+            if (! m_session.waitForWrites (maxQueued, std::chrono::seconds (30)))
+                throw Stalled ();
+
+            m_session.write (data, bytes);
+        }
+
+    private:
+        HTTP::Session& m_session;
+    };
+
+    void processSession (Job& job, HTTP::Session& session,
+        RPC::LatencyTracker::clock_type::time_point received)
+    {
+        SessionSink sink (session);
+        RPC::LatencyTracker::Timing timing ("rpc", received);
+        timing.add (RPC::LatencyTracker::phaseQueue, received);
+
+        try
+        {
+            m_deprecatedHandler.processRequest (session.content(),
+                session.remoteAddress().at_port(0), sink, timing);
+        }
+        catch (SessionSink::Stalled const& e)
+        {
+            m_journal.warning << "Response abandoned: " << e.what();
+        }
 
         session.close();
+
+        getApp().getRPCLatency ().record (timing);
     }
 
     std::string createResponse (
@@ -180,10 +231,9 @@ public:
     {
         Json::Value jvRequest;
         {
-            Json::Reader reader;
+            Json::Parser parser;
 
-            if ((request.size () > 1000000) ||
-                ! reader.parse (request, jvRequest) ||
+            if (! parser.parse (request, jvRequest) ||
                 jvRequest.isNull () ||
                 ! jvRequest.isObject ())
             {
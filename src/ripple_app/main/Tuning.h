@@ -27,6 +27,12 @@ enum
     fullBelowTargetSize = 524288
 
     ,fullBelowExpirationSeconds = 600
+
+    // Longest time the governed caches are swept before yielding the job
+    ,sweepSliceMilliseconds = 10
+
+    // Seconds between writes of the warm restart manifest
+    ,hotSetSaveSeconds = 600
 };
 
 }
@@ -17,12 +17,96 @@
 */
 //==============================================================================
 
+#include "../../beast/beast/chrono/manual_clock.h"
+#include "../../beast/beast/unit_test/suite.h"
+
+#include <thread>
+
 namespace ripple {
 
 // VFALCO TODO Inline the function definitions
 class HashRouter : public IHashRouter
 {
 private:
+    /** The peers that have sent us an item.
+        Peers are numbered by slot within a shard, so a set is a few words
+        of bits instead of a tree node per peer.
+    */
+    class PeerBits
+    {
+    public:
+        PeerBits ()
+        {
+            m_bits[0] = m_bits[1] = 0;
+        }
+
+        void set (unsigned slot)
+        {
+            word (slot) |= mask (slot);
+        }
+
+        bool test (unsigned slot) const
+        {
+            unsigned const index (slot / 64);
+
+            if (index < inlineWords)
+                return (m_bits[index] & mask (slot)) != 0;
+
+            index_type const more (index - inlineWords);
+
+            return more < m_more.size () && (m_more[more] & mask (slot)) != 0;
+        }
+
+        void clear ()
+        {
+            m_bits[0] = m_bits[1] = 0;
+            m_more.clear ();
+        }
+
+        /** Call f with the slot of each peer in the set. */
+        template <class Function>
+        void forEach (Function f) const
+        {
+            for (unsigned i = 0; i < inlineWords + m_more.size (); ++i)
+            {
+                std::uint64_t bits (i < inlineWords
+                    ? m_bits[i] : m_more[i - inlineWords]);
+
+                for (unsigned bit = 0; bits != 0; ++bit, bits >>= 1)
+                    if (bits & 1)
+                        f (i * 64 + bit);
+            }
+        }
+
+    private:
+        typedef std::vector <std::uint64_t>::size_type index_type;
+
+        static unsigned const inlineWords = 2;
+
+        static std::uint64_t mask (unsigned slot)
+        {
+            return std::uint64_t (1) << (slot % 64);
+        }
+
+        std::uint64_t& word (unsigned slot)
+        {
+            unsigned const index (slot / 64);
+
+            if (index < inlineWords)
+                return m_bits[index];
+
+            index_type const more (index - inlineWords);
+
+            if (more >= m_more.size ())
+                m_more.resize (more + 1, 0);
+
+            return m_more[more];
+        }
+
+        std::uint64_t m_bits[inlineWords];
+        std::vector <std::uint64_t> m_more;
+    };
+
     /** An entry in the routing table.
     */
     class Entry : public CountedObject <Entry>
@@ -32,25 +116,15 @@ private:
 
         Entry ()
             : mFlags (0)
+            , mPending (false)
         {
         }
 
-        std::set <PeerShortID> const& peekPeers () const
+        PeerBits& peekPeers ()
         {
             return mPeers;
         }
 
-        void addPeer (PeerShortID peer)
-        {
-            if (peer != 0)
-                mPeers.insert (peer);
-        }
-        
-        bool hasPeer (PeerShortID peer) const
-        {
-            return mPeers.count (peer) > 0;
-        }
-
         int getFlags (void) const
         {
             return mFlags;
@@ -71,20 +145,75 @@ private:
             mFlags &= ~flagsToClear;
         }
 
-        void swapSet (std::set <PeerShortID>& other)
+        // True if only a cluster peer's report created the entry
+        bool isPending () const
+        {
+            return mPending;
+        }
+
+        void setPending (bool pending)
         {
-            mPeers.swap (other);
+            mPending = pending;
         }
 
     private:
         int mFlags;
-        std::set <PeerShortID> mPeers;
+        bool mPending;
+        PeerBits mPeers;
+    };
+
+    typedef RippleMutex LockType;
+    typedef std::lock_guard <LockType> ScopedLockType;
+
+    /** One part of the routing table, chosen by the first byte of the hash.
+
+        Expiration uses a timing wheel with one bucket per second of the
+        hold time. Entries are added to the bucket for the second they were
+        created in, and a bucket is emptied when the wheel comes back around
+        to it, so expiring costs no allocation per entry.
+    */
+    struct Shard
+    {
+        Shard ()
+            : wheelTime (0)
+        {
+        }
+
+        LockType mutex;
+
+        // Stores all suppressed hashes
+        ripple::unordered_map <uint256, Entry> entries;
+
+        // The hashes created in each second of the last hold time
+        std::vector <std::vector <uint256>> wheel;
+
+        // The second the wheel was last advanced to
+        clock_type::rep wheelTime;
+
+        // Peer slots
+        struct Slot
+        {
+            unsigned index;
+            clock_type::rep lastSeen;
+        };
+        ripple::unordered_map <PeerShortID, Slot> slots;
+        std::vector <PeerShortID> slotPeers;
+        std::vector <unsigned> freeSlots;
     };
 
 public:
-    explicit HashRouter (int holdTime)
-        : mHoldTime (holdTime)
+    HashRouter (clock_type& clock, int holdTime, std::size_t shardCount)
+        : mClock (clock)
+        , mHoldTime (std::max (1, holdTime))
+        , mShards (shardCount)
     {
+        clock_type::rep const now (mClock.now ().time_since_epoch ().count ());
+
+        for (auto& shard : mShards)
+        {
+            shard.wheel.resize (mHoldTime);
+            shard.wheelTime = now;
+        }
     }
 
     bool addSuppression (uint256 const& index);
@@ -94,112 +223,193 @@ public:
     bool addSuppressionFlags (uint256 const& index, int flag);
     bool setFlag (uint256 const& index, int flag);
     int getFlags (uint256 const& index);
+    bool setClusterResult (uint256 const& index, int flag);
 
     bool swapSet (uint256 const& index, std::set<PeerShortID>& peers, int flag);
 
 private:
-    Entry getEntry (uint256 const& );
+    Shard& getShard (uint256 const& index)
+    {
+        return mShards [*index.begin () % mShards.size ()];
+    }
 
-    Entry& findCreateEntry (uint256 const& , bool& created);
+    Entry& findCreateEntry (Shard& shard, uint256 const& index, bool& created);
 
-    typedef RippleMutex LockType;
-    typedef std::lock_guard <LockType> ScopedLockType;
-    LockType mLock;
+    Entry& receiveEntry (Shard& shard, uint256 const& index, bool& created);
+
+    void advance (Shard& shard, clock_type::rep now);
 
-    // Stores all suppressed hashes and their expiration time
-    ripple::unordered_map <uint256, Entry> mSuppressionMap;
+    void addPeer (Shard& shard, Entry& entry, PeerShortID peer);
 
-    // Stores all expiration times and the hashes indexed for them
-    std::map< int, std::list<uint256> > mSuppressionTimes;
+    clock_type& mClock;
 
-    int mHoldTime;
+    int const mHoldTime;
+
+    std::vector <Shard> mShards;
 };
 
 //------------------------------------------------------------------------------
 
-HashRouter::Entry& HashRouter::findCreateEntry (uint256 const& index, bool& created)
+void HashRouter::advance (Shard& shard, clock_type::rep now)
 {
-    ripple::unordered_map<uint256, Entry>::iterator fit = mSuppressionMap.find (index);
+    if (now <= shard.wheelTime)
+        return;
+
+    // Entries created a hold time ago share the bucket for this second
+    clock_type::rep const first (std::max (shard.wheelTime + 1, now - mHoldTime + 1));
 
-    if (fit != mSuppressionMap.end ())
+    for (clock_type::rep t = first; t <= now; ++t)
     {
-        created = false;
-        return fit->second;
+        std::vector <uint256>& bucket (shard.wheel [t % mHoldTime]);
+
+        for (auto const& index : bucket)
+            shard.entries.erase (index);
+
+        bucket.clear ();
+    }
+
+    shard.wheelTime = now;
+
+    // A peer unseen for a hold time is in no live entry, reuse its slot
+    for (auto it = shard.slots.begin (); it != shard.slots.end ();)
+    {
+        if (now - it->second.lastSeen >= mHoldTime)
+        {
+            shard.freeSlots.push_back (it->second.index);
+            it = shard.slots.erase (it);
+        }
+        else
+        {
+            ++it;
+        }
     }
+}
+
+HashRouter::Entry& HashRouter::findCreateEntry (Shard& shard, uint256 const& index, bool& created)
+{
+    advance (shard, mClock.now ().time_since_epoch ().count ());
 
-    created = true;
+    auto const result (shard.entries.emplace (index, Entry ()));
 
-    int now = UptimeTimer::getInstance ().getElapsedSeconds ();
-    int expireTime = now - mHoldTime;
+    created = result.second;
 
-    // See if any supressions need to be expired
-    std::map< int, std::list<uint256> >::iterator it = mSuppressionTimes.begin ();
+    if (created)
+        shard.wheel [shard.wheelTime % mHoldTime].push_back (index);
 
-    if ((it != mSuppressionTimes.end ()) && (it->first <= expireTime))
+    return result.first->second;
+}
+
+// Like findCreateEntry, for an item that has actually arrived
+HashRouter::Entry& HashRouter::receiveEntry (Shard& shard, uint256 const& index, bool& created)
+{
+    Entry& entry (findCreateEntry (shard, index, created));
+
+    if (entry.isPending ())
     {
-        BOOST_FOREACH (uint256 const & lit, it->second)
-        mSuppressionMap.erase (lit);
-        mSuppressionTimes.erase (it);
+        entry.setPending (false);
+        created = true;
     }
 
-    mSuppressionTimes[now].push_back (index);
-    return mSuppressionMap.emplace (index, Entry ()).first->second;
+    return entry;
 }
 
-bool HashRouter::addSuppression (uint256 const& index)
+void HashRouter::addPeer (Shard& shard, Entry& entry, PeerShortID peer)
 {
-    ScopedLockType sl (mLock);
+    if (peer == 0)
+        return;
 
-    bool created;
-    findCreateEntry (index, created);
-    return created;
+    auto const result (shard.slots.emplace (peer, Shard::Slot ()));
+    Shard::Slot& slot (result.first->second);
+
+    if (result.second)
+    {
+        if (shard.freeSlots.empty ())
+        {
+            slot.index = shard.slotPeers.size ();
+            shard.slotPeers.push_back (peer);
+        }
+        else
+        {
+            slot.index = shard.freeSlots.back ();
+            shard.freeSlots.pop_back ();
+            shard.slotPeers [slot.index] = peer;
+        }
+    }
+
+    slot.lastSeen = shard.wheelTime;
+    entry.peekPeers ().set (slot.index);
 }
 
-HashRouter::Entry HashRouter::getEntry (uint256 const& index)
+bool HashRouter::addSuppression (uint256 const& index)
 {
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    return findCreateEntry (index, created);
+    receiveEntry (shard, index, created);
+    return created;
 }
 
 bool HashRouter::addSuppressionPeer (uint256 const& index, PeerShortID peer)
 {
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    findCreateEntry (index, created).addPeer (peer);
+    addPeer (shard, receiveEntry (shard, index, created), peer);
     return created;
 }
 
 bool HashRouter::addSuppressionPeer (uint256 const& index, PeerShortID peer, int& flags)
 {
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    Entry& s = findCreateEntry (index, created);
-    s.addPeer (peer);
+    Entry& s = receiveEntry (shard, index, created);
+    addPeer (shard, s, peer);
     flags = s.getFlags ();
     return created;
 }
 
 int HashRouter::getFlags (uint256 const& index)
 {
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    return findCreateEntry (index, created).getFlags ();
+    return findCreateEntry (shard, index, created).getFlags ();
 }
 
 bool HashRouter::addSuppressionFlags (uint256 const& index, int flag)
 {
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    findCreateEntry (index, created).setFlag (flag);
+    receiveEntry (shard, index, created).setFlag (flag);
     return created;
 }
 
+bool HashRouter::setClusterResult (uint256 const& index, int flag)
+{
+    assert (flag == SF_SIGGOOD || flag == SF_BAD);
+
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
+
+    bool created;
+    Entry& s = findCreateEntry (shard, index, created);
+
+    if (created)
+        s.setPending (true);
+    else if (s.hasFlag (SF_SIGGOOD | SF_BAD))
+        return false;
+
+    s.setFlag (flag | SF_CLUSTER);
+    return true;
+}
+
 bool HashRouter::setFlag (uint256 const& index, int flag)
 {
     // VFALCO NOTE Comments like this belong in the HEADER file,
@@ -209,10 +419,11 @@ bool HashRouter::setFlag (uint256 const& index, int flag)
     // return: true = changed, false = unchanged
     assert (flag != 0);
 
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    Entry& s = findCreateEntry (index, created);
+    Entry& s = findCreateEntry (shard, index, created);
 
     if ((s.getFlags () & flag) == flag)
         return false;
@@ -223,24 +434,213 @@ bool HashRouter::setFlag (uint256 const& index, int flag)
 
 bool HashRouter::swapSet (uint256 const& index, std::set<PeerShortID>& peers, int flag)
 {
-    ScopedLockType sl (mLock);
+    Shard& shard (getShard (index));
+    ScopedLockType sl (shard.mutex);
 
     bool created;
-    Entry& s = findCreateEntry (index, created);
+    Entry& s = findCreateEntry (shard, index, created);
 
     if ((s.getFlags () & flag) == flag)
         return false;
 
-    s.swapSet (peers);
+    std::set <PeerShortID> previous;
+    s.peekPeers ().forEach ([&] (unsigned slot)
+    {
+        previous.insert (shard.slotPeers [slot]);
+    });
+
+    s.peekPeers ().clear ();
+    for (auto const peer : peers)
+        addPeer (shard, s, peer);
+
+    peers.swap (previous);
     s.setFlag (flag);
 
     return true;
 }
 
-IHashRouter* IHashRouter::New (int holdTime)
+IHashRouter* IHashRouter::New (clock_type& clock, int holdTime)
 {
-    return new HashRouter (holdTime);
+    return new HashRouter (clock, holdTime, 16);
 }
 
-} // ripple
+//------------------------------------------------------------------------------
+
+class HashRouter_test : public beast::unit_test::suite
+{
+public:
+    typedef beast::manual_clock <std::chrono::seconds> clock_type;
+
+    static uint256 hash (int n)
+    {
+        Serializer s;
+        s.add32 (n);
+        return s.getSHA512Half ();
+    }
 
+    void testSuppression ()
+    {
+        clock_type clock;
+        HashRouter router (clock, 2, 4);
+
+        expect (router.addSuppression (hash (1)));
+        expect (! router.addSuppression (hash (1)));
+        expect (router.addSuppressionPeer (hash (2), 7));
+        expect (! router.addSuppressionPeer (hash (2), 8));
+
+        expect (router.setFlag (hash (1), SF_RELAYED));
+        expect (! router.setFlag (hash (1), SF_RELAYED));
+        expect (router.getFlags (hash (1)) == SF_RELAYED);
+
+        int flags;
+        expect (! router.addSuppressionPeer (hash (1), 9, flags));
+        expect (flags == SF_RELAYED);
+
+        // Held for two seconds
+        clock.set (1);
+        expect (! router.addSuppression (hash (1)));
+        clock.set (2);
+        expect (router.addSuppression (hash (1)));
+        expect (router.getFlags (hash (1)) == 0);
+        expect (router.addSuppression (hash (2)));
+
+        clock.set (100);
+        expect (router.addSuppression (hash (1)));
+    }
+
+    void testPeers ()
+    {
+        clock_type clock;
+        HashRouter router (clock, 10, 1);
+
+        for (int i = 0; i < 300; ++i)
+            router.addSuppressionPeer (hash (1), 1000 + 3 * i);
+        router.addSuppressionPeer (hash (1), 0);
+        router.addSuppressionPeer (hash (2), 1000);
+
+        std::set <IHashRouter::PeerShortID> peers;
+        peers.insert (5);
+        expect (router.swapSet (hash (1), peers, SF_RELAYED));
+        expect (peers.size () == 300);
+        expect (*peers.begin () == 1000 && *peers.rbegin () == 1000 + 3 * 299);
+
+        peers.clear ();
+        expect (! router.swapSet (hash (1), peers, SF_RELAYED));
+        expect (router.swapSet (hash (1), peers, SF_SAVED));
+        expect (peers.size () == 1 && *peers.begin () == 5);
+
+        // Slots of peers gone for a hold time are reused
+        clock.set (20);
+        router.addSuppressionPeer (hash (3), 42);
+        peers.clear ();
+        expect (router.swapSet (hash (3), peers, SF_RELAYED));
+        expect (peers.size () == 1 && *peers.begin () == 42);
+    }
+
+    void testClusterResults ()
+    {
+        clock_type clock;
+        HashRouter router (clock, 10, 4);
+
+        // A reported hash is still new when the item arrives
+        expect (router.setClusterResult (hash (1), SF_SIGGOOD));
+        expect (! router.setClusterResult (hash (1), SF_BAD));
+        int flags;
+        expect (router.addSuppressionPeer (hash (1), 7, flags));
+        expect (flags == (SF_SIGGOOD | SF_CLUSTER));
+        expect (! router.addSuppressionPeer (hash (1), 8, flags));
+
+        expect (router.setClusterResult (hash (2), SF_BAD));
+        expect (router.addSuppression (hash (2)));
+        expect (router.getFlags (hash (2)) == (SF_BAD | SF_CLUSTER));
+
+        // Our own result is kept
+        expect (router.addSuppressionPeer (hash (3), 7));
+        expect (router.setFlag (hash (3), SF_BAD));
+        expect (! router.setClusterResult (hash (3), SF_SIGGOOD));
+        expect (router.getFlags (hash (3)) == SF_BAD);
+
+        // An item already received still takes a result
+        expect (router.addSuppressionPeer (hash (4), 7));
+        expect (router.setClusterResult (hash (4), SF_SIGGOOD));
+        expect (! router.addSuppressionPeer (hash (4), 8, flags));
+        expect (flags == (SF_SIGGOOD | SF_CLUSTER));
+    }
+
+    void run ()
+    {
+        testSuppression ();
+        testPeers ();
+        testClusterResults ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HashRouter,ripple_app,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Every peer relays every item, as proposals and validations are. */
+class HashRouter_timing_test : public beast::unit_test::suite
+{
+public:
+    void measure (std::size_t shards, int threads)
+    {
+        int const peers (32);
+        int const items (20000);
+
+        std::vector <uint256> hashes;
+        hashes.reserve (items);
+        for (int i = 0; i < items; ++i)
+        {
+            Serializer s;
+            s.add32 (i);
+            hashes.push_back (s.getSHA512Half ());
+        }
+
+        HashRouter router (get_seconds_clock (),
+            IHashRouter::getDefaultHoldTime (), shards);
+
+        typedef std::chrono::steady_clock clock_type;
+        clock_type::time_point const start (clock_type::now ());
+
+        std::vector <std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back ([&, t] ()
+            {
+                // Each thread hears about the items in a different order
+                int flags;
+                for (int i = 0; i < items; ++i)
+                {
+                    uint256 const& hash (hashes [(i + t * items / threads) % items]);
+                    for (int peer = 1 + t; peer <= peers; peer += threads)
+                        router.addSuppressionPeer (hash, peer, flags);
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join ();
+
+        auto const elapsed (std::chrono::duration_cast <
+            std::chrono::nanoseconds> (clock_type::now () - start));
+
+        log << shards << " shards, " << threads << " threads: " <<
+            (elapsed.count () / double (peers * items)) << " ns per call";
+    }
+
+    void run ()
+    {
+        for (int threads = 1; threads <= 8; threads *= 2)
+        {
+            measure (1, threads);
+            measure (16, threads);
+        }
+
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(HashRouter_timing,ripple_app,ripple);
+
+} // ripple
@@ -31,6 +31,7 @@ namespace ripple {
 #define SF_SAVED        0x08
 #define SF_RETRY        0x10    // Transaction can be retried
 #define SF_TRUSTED      0x20    // comes from trusted source
+#define SF_CLUSTER      0x40    // Signature result reported by a cluster peer
 
 /** Routing table for objects identified by hash.
 
@@ -44,6 +45,8 @@ public:
     // The type here *MUST* match the type of Peer::ShortId
     typedef std::uint32_t PeerShortID;
 
+    typedef beast::abstract_clock <std::chrono::seconds> clock_type;
+
     // VFALCO NOTE this preferred alternative to default parameters makes
     //         behavior clear.
     //
@@ -52,8 +55,13 @@ public:
         return 300;
     }
 
+    /** Create the routing table.
+
+        Hashes are forgotten once they have been held for `holdTime`
+        seconds as measured by `clock`.
+    */
     // VFALCO TODO rename the parameter to entryHoldTimeInSeconds
-    static IHashRouter* New (int holdTime);
+    static IHashRouter* New (clock_type& clock, int holdTime);
 
     virtual ~IHashRouter () { }
 
@@ -75,11 +83,18 @@ public:
 
     virtual int getFlags (uint256 const& index) = 0;
 
-    virtual bool swapSet (uint256 const& index, std::set<PeerShortID>& peers, int flag) = 0;
+    /** Record a signature result reported by a cluster peer.
 
-    // VFALCO TODO This appears to be unused!
-    //
-//    virtual Entry getEntry (uint256 const&) = 0;
+        The hash is not marked as received, so the item is still treated as
+        new when it arrives, but its signature need not be checked. A result
+        that is already known is kept.
+
+        @param flag Either SF_SIGGOOD or SF_BAD.
+        @return `true` if the result was recorded.
+    */
+    virtual bool setClusterResult (uint256 const& index, int flag) = 0;
+
+    virtual bool swapSet (uint256 const& index, std::set<PeerShortID>& peers, int flag) = 0;
 };
 
 } // ripple
@@ -438,20 +438,51 @@ private:
     void setMode (OperatingMode);
 
     Json::Value transJson (const SerializedTransaction& stTxn, TER terResult, bool bValidated, Ledger::ref lpCurrent);
+    Json::Value ledgerJson (AcceptedLedger const& accepted);
     bool haveConsensusObject ();
 
     Json::Value pubBootstrapAccountInfo (Ledger::ref lpAccepted, const RippleAddress& naAccountID);
 
-    void pubValidatedTransaction (Ledger::ref alAccepted, const AcceptedLedgerTx& alTransaction);
+    std::unique_ptr <InfoSub::Message> makeValidatedMessage (Ledger::ref alAccepted,
+        AcceptedLedgerTx::ref alTransaction);
+    void pubValidatedTransaction (Ledger::ref alAccepted, const AcceptedLedgerTx& alTransaction,
+        InfoSub::Message& message);
     void pubAccountTransaction (Ledger::ref lpCurrent, const AcceptedLedgerTx& alTransaction, bool isAccepted);
 
     void pubServer ();
 
 private:
-    clock_type& m_clock;
+    enum
+    {
+        // Objects in one fetch pack message
+        fetchPackChunkSize = 256,
+
+        // Ledgers examined while filling one message
+        fetchPackChunkLedgers = 16,
+
+        // Objects sent in reply to one fetch pack request
+        fetchPackMaxObjects = 4096
+    };
+
+    // Progress through a fetch pack that is sent in several messages
+    struct FetchPackStream
+    {
+        boost::weak_ptr <Peer> peer;
+        boost::shared_ptr <protocol::TMGetObjectByHash> request;
+        Ledger::pointer wantLedger;
+        Ledger::pointer haveLedger;
+        std::uint32_t uptime;
+
+        // Objects of the wanted ledger's diff already sent
+        std::size_t offset;
+
+        // Objects sent for the whole request
+        int sent;
+    };
+
+    void sendFetchPack (Job&, boost::shared_ptr <FetchPackStream> stream);
 
-    typedef ripple::unordered_map <uint160, SubMapType>               SubInfoMapType;
-    typedef ripple::unordered_map <uint160, SubMapType>::iterator     SubInfoMapIterator;
+    clock_type& m_clock;
 
     typedef ripple::unordered_map<std::string, InfoSub::pointer>     subRpcMapType;
 
@@ -493,8 +524,9 @@ private:
     // Recent positions taken
     std::map<uint256, std::pair<int, SHAMap::pointer> > mRecentPositions;
 
-    SubInfoMapType                                      mSubAccount;
-    SubInfoMapType                                      mSubRTAccount;
+    // Not protected by mLock
+    SubscriptionIndex                                   mSubAccount;
+    SubscriptionIndex                                   mSubRTAccount;
 
     subRpcMapType                                       mRpcSubMap;
 
@@ -505,6 +537,7 @@ private:
 
     TaggedCache< uint256, Blob>                         mFetchPack;
     std::uint32_t                                       mFetchSeq;
+    LedgerDiffCache                                     m_ledgerDiffs;
 
     std::uint32_t                                       mLastLoadBase;
     std::uint32_t                                       mLastLoadFactor;
@@ -544,6 +577,9 @@ void NetworkOPsImp::onDeadlineTimer (beast::DeadlineTimer& timer)
 
 void NetworkOPsImp::processHeartbeatTimer ()
 {
+    // Send signature results that did not fill a batch
+    getApp().overlay ().sendSignatureResults ();
+
     {
         Application::ScopedLockType lock (getApp().getMasterLock ());
 
@@ -902,9 +938,9 @@ void NetworkOPsImp::runTransactionQueue ()
                         tx.set_rawtransaction (&s.getData ().front (), s.getLength ());
                         tx.set_status (protocol::tsCURRENT);
                         tx.set_receivetimestamp (getNetworkTimeNC ()); // FIXME: This should be when we received it
-                        getApp ().overlay ().foreach (send_if_not (
+                        getApp ().overlay ().relay (
                             boost::make_shared<Message> (tx, protocol::mtTRANSACTION),
-                            peer_in_set(peers)));
+                            peers, std::string ());
                     }
                     else
                         m_journal.debug << "recently relayed";
@@ -1033,9 +1069,9 @@ Transaction::pointer NetworkOPsImp::processTransactionCb (
                 tx.set_rawtransaction (&s.getData ().front (), s.getLength ());
                 tx.set_status (protocol::tsCURRENT);
                 tx.set_receivetimestamp (getNetworkTimeNC ()); // FIXME: This should be when we received it
-                getApp ().overlay ().foreach (send_if_not (
+                getApp ().overlay ().relay (
                     boost::make_shared<Message> (tx, protocol::mtTRANSACTION),
-                    peer_in_set(peers)));
+                    peers, std::string ());
             }
         }
     }
@@ -1562,9 +1598,9 @@ void NetworkOPsImp::processTrustedProposal (LedgerProposal::pointer proposal,
             if (getApp().getHashRouter ().swapSet (
                 proposal->getSuppressionID (), peers, SF_RELAYED))
 	    {
-                getApp ().overlay ().foreach (send_if_not (
+                getApp ().overlay ().relay (
                     boost::make_shared<Message> (*set, protocol::mtPROPOSE_LEDGER),
-                    peer_in_set(peers)));
+                    peers, set->nodepubkey ());
 	    }
         }
         else
@@ -2216,6 +2252,16 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
     if (fp != 0)
         info[jss::fetch_pack] = Json::UInt (fp);
 
+    NodeStore::Database& nodeStore (getApp().getNodeStore ());
+    std::size_t const warmUp = nodeStore.getPrefetchTotal ();
+
+    if (warmUp != 0)
+    {
+        Json::Value& w = (info[jss::warm_up] = Json::objectValue);
+        w[jss::queued] = Json::UInt (warmUp);
+        w[jss::pending] = Json::UInt (nodeStore.getPrefetchPending ());
+    }
+
     info[jss::peers] = Json::UInt (getApp ().overlay ().size ());
 
     Json::Value lastClose = Json::objectValue;
@@ -2349,9 +2395,11 @@ Json::Value NetworkOPsImp::pubBootstrapAccountInfo (Ledger::ref lpAccepted, cons
 
 void NetworkOPsImp::pubProposedTransaction (Ledger::ref lpCurrent, SerializedTransaction::ref stTxn, TER terResult)
 {
-    Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
-
     {
+        InfoSub::Message message (
+            [&] { return transJson (*stTxn, terResult, false, lpCurrent); },
+            [&] { return transFrame (*stTxn, terResult, false, lpCurrent, Blob ()); });
+
         ScopedLockType sl (mLock);
         NetworkOPsImp::SubMapType::const_iterator it = mSubRTTransactions.begin ();
 
@@ -2361,7 +2409,7 @@ void NetworkOPsImp::pubProposedTransaction (Ledger::ref lpCurrent, SerializedTra
 
             if (p)
             {
-                p->send (jvObj, true);
+                message.send (*p);
                 ++it;
             }
             else
@@ -2369,7 +2417,8 @@ void NetworkOPsImp::pubProposedTransaction (Ledger::ref lpCurrent, SerializedTra
         }
     }
     AcceptedLedgerTx alt (stTxn, terResult);
-    m_journal.trace << "pubProposed: " << alt.getJson ();
+    if (m_journal.trace.active ())
+        m_journal.trace << "pubProposed: " << alt.getJson ();
     pubAccountTransaction (lpCurrent, alt, false);
 }
 
@@ -2386,22 +2435,9 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
 
         if (!mSubLedger.empty ())
         {
-            Json::Value jvObj (Json::objectValue);
-
-            jvObj[jss::type]           = jss::ledgerClosed;
-            jvObj[jss::ledger_index]   = lpAccepted->getLedgerSeq ();
-            jvObj[jss::ledger_hash]    = to_string (lpAccepted->getHash ());
-            jvObj[jss::ledger_time]    = Json::Value::UInt (lpAccepted->getCloseTimeNC ());
-
-            jvObj[jss::fee_ref]        = Json::UInt (lpAccepted->getReferenceFeeUnits ());
-            jvObj[jss::fee_base]       = Json::UInt (lpAccepted->getBaseFee ());
-            jvObj[jss::reserve_base]   = Json::UInt (lpAccepted->getReserve (0));
-            jvObj[jss::reserve_inc]    = Json::UInt (lpAccepted->getReserveInc ());
-
-            jvObj[jss::txn_count]      = Json::UInt (alpAccepted->getTxnCount ());
-
-            if (mMode >= omSYNCING)
-                jvObj[jss::validated_ledgers]  = getApp().getLedgerMaster ().getCompleteLedgers ();
+            InfoSub::Message message (
+                [&] { return ledgerJson (*alpAccepted); },
+                [&] { return ledgerFrame (*alpAccepted); });
 
             NetworkOPsImp::SubMapType::const_iterator it = mSubLedger.begin ();
 
@@ -2411,7 +2447,7 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
 
                 if (p)
                 {
-                    p->send (jvObj, true);
+                    message.send (*p);
                     ++it;
                 }
                 else
@@ -2420,12 +2456,38 @@ void NetworkOPsImp::pubLedger (Ledger::ref accepted)
         }
     }
 
+    // One message per transaction is shared by every stream
+    AcceptedLedger::map_t const& txns (alpAccepted->getMap ());
+
+    std::vector <std::unique_ptr <InfoSub::Message>> messages;
+    std::vector <InfoSub::Message*> accountMessages;
+    std::vector <std::vector <uint160>> affected;
+
+    messages.reserve (txns.size ());
+    accountMessages.reserve (txns.size ());
+    affected.reserve (txns.size ());
+
     // Don't lock since pubAcceptedTransaction is locking.
-    BOOST_FOREACH (const AcceptedLedger::value_type & vt, alpAccepted->getMap ())
+    BOOST_FOREACH (const AcceptedLedger::value_type & vt, txns)
     {
-        m_journal.trace << "pubAccepted: " << vt.second->getJson ();
-        pubValidatedTransaction (lpAccepted, *vt.second);
+        if (m_journal.trace.active ())
+            m_journal.trace << "pubAccepted: " << vt.second->getJson ();
+
+        messages.push_back (makeValidatedMessage (lpAccepted, vt.second));
+        pubValidatedTransaction (lpAccepted, *vt.second, *messages.back ());
+
+        accountMessages.push_back (messages.back ().get ());
+        affected.push_back (std::vector <uint160> ());
+        BOOST_FOREACH (const RippleAddress & affectedAccount, vt.second->getAffected ())
+            affected.back ().push_back (affectedAccount.getAccountID ());
     }
+
+    // The account subscribers are published to by shard, in parallel
+    std::vector <SubscriptionIndex const*> indexes;
+    indexes.push_back (&mSubRTAccount);
+    indexes.push_back (&mSubAccount);
+    SubscriptionIndex::publish (indexes, affected, accountMessages,
+        getApp().getJobQueue ());
 }
 
 void NetworkOPsImp::reportFeeChange ()
@@ -2474,14 +2536,91 @@ Json::Value NetworkOPsImp::transJson (const SerializedTransaction& stTxn, TER te
     return jvObj;
 }
 
-void NetworkOPsImp::pubValidatedTransaction (Ledger::ref alAccepted, const AcceptedLedgerTx& alTx)
+// The binary form of transJson, see InfoSub::isBinary
+std::string NetworkOPs::transFrame (const SerializedTransaction& stTxn, TER terResult, bool bValidated,
+                                    Ledger::ref lpCurrent, Blob const& rawMeta)
+{
+    Serializer s (512 + rawMeta.size ());
+
+    s.add8 (bValidated ? 2 : 3);
+    s.add32 (lpCurrent->getLedgerSeq ());
+    s.add256 (bValidated ? lpCurrent->getHash () : uint256 ());
+    s.add32 (static_cast <std::uint32_t> (terResult));
+
+    Serializer const tx (stTxn.getSerializer ());
+    s.add32 (tx.getDataLength ());
+    s.addRaw (tx);
+
+    s.add32 (rawMeta.size ());
+    s.addRaw (rawMeta);
+
+    return s.getString ();
+}
+
+Json::Value NetworkOPsImp::ledgerJson (AcceptedLedger const& accepted)
+{
+    Ledger::ref lpAccepted = accepted.getLedger ();
+    Json::Value jvObj (Json::objectValue);
+
+    jvObj[jss::type]           = jss::ledgerClosed;
+    jvObj[jss::ledger_index]   = lpAccepted->getLedgerSeq ();
+    jvObj[jss::ledger_hash]    = to_string (lpAccepted->getHash ());
+    jvObj[jss::ledger_time]    = Json::Value::UInt (lpAccepted->getCloseTimeNC ());
+
+    jvObj[jss::fee_ref]        = Json::UInt (lpAccepted->getReferenceFeeUnits ());
+    jvObj[jss::fee_base]       = Json::UInt (lpAccepted->getBaseFee ());
+    jvObj[jss::reserve_base]   = Json::UInt (lpAccepted->getReserve (0));
+    jvObj[jss::reserve_inc]    = Json::UInt (lpAccepted->getReserveInc ());
+
+    jvObj[jss::txn_count]      = Json::UInt (accepted.getTxnCount ());
+
+    if (mMode >= omSYNCING)
+        jvObj[jss::validated_ledgers]  = getApp().getLedgerMaster ().getCompleteLedgers ();
+
+    return jvObj;
+}
+
+// The binary form of ledgerJson, see InfoSub::isBinary
+std::string NetworkOPs::ledgerFrame (AcceptedLedger const& accepted)
 {
-    Json::Value jvObj   = transJson (*alTx.getTxn (), alTx.getResult (), true, alAccepted);
-    jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
+    Ledger::ref lpAccepted = accepted.getLedger ();
+    Serializer s (160);
+
+    s.add8 (1);
+    s.add256 (lpAccepted->getHash ());
+    lpAccepted->addRaw (s);
+    s.add64 (lpAccepted->getBaseFee ());
+    s.add32 (lpAccepted->getReferenceFeeUnits ());
+    s.add64 (lpAccepted->getReserve (0));
+    s.add64 (lpAccepted->getReserveInc ());
+    s.add32 (accepted.getTxnCount ());
+
+    return s.getString ();
+}
 
-    Json::FastWriter w;
-    std::string sObj = w.write (jvObj);
+std::unique_ptr <InfoSub::Message> NetworkOPsImp::makeValidatedMessage (
+    Ledger::ref alAccepted, AcceptedLedgerTx::ref alTx)
+{
+    // The message may be sent after this returns, so it holds its own references
+    Ledger::pointer const ledger (alAccepted);
+    AcceptedLedgerTx::pointer const tx (alTx);
+
+    return std::unique_ptr <InfoSub::Message> (new InfoSub::Message (
+        [this, ledger, tx] () -> Json::Value
+        {
+            Json::Value jvObj = transJson (*tx->getTxn (), tx->getResult (), true, ledger);
+            jvObj[jss::meta] = tx->getMeta ()->getJson (0);
+            return jvObj;
+        },
+        [this, ledger, tx]
+        {
+            return transFrame (*tx->getTxn (), tx->getResult (), true, ledger, tx->getRawMeta ());
+        }));
+}
 
+void NetworkOPsImp::pubValidatedTransaction (Ledger::ref alAccepted, const AcceptedLedgerTx& alTx,
+    InfoSub::Message& message)
+{
     {
         ScopedLockType sl (mLock);
 
@@ -2493,7 +2632,7 @@ void NetworkOPsImp::pubValidatedTransaction (Ledger::ref alAccepted, const Accep
 
             if (p)
             {
-                p->send (jvObj, sObj, true);
+                message.send (*p);
                 ++it;
             }
             else
@@ -2508,97 +2647,59 @@ void NetworkOPsImp::pubValidatedTransaction (Ledger::ref alAccepted, const Accep
 
             if (p)
             {
-                p->send (jvObj, sObj, true);
+                message.send (*p);
                 ++it;
             }
             else
                 it = mSubRTTransactions.erase (it);
         }
     }
-    getApp().getOrderBookDB ().processTxn (alAccepted, alTx, jvObj);
-    pubAccountTransaction (alAccepted, alTx, true);
+    getApp().getOrderBookDB ().processTxn (alAccepted, alTx, message);
 }
 
 void NetworkOPsImp::pubAccountTransaction (Ledger::ref lpCurrent, const AcceptedLedgerTx& alTx, bool bAccepted)
 {
-    boost::unordered_set<InfoSub::pointer>  notify;
-    int                             iProposed   = 0;
-    int                             iAccepted   = 0;
-
-    {
-        ScopedLockType sl (mLock);
-
-        if (!bAccepted && mSubRTAccount.empty ()) return;
-
-        if (!mSubAccount.empty () || (!mSubRTAccount.empty ()) )
-        {
-            BOOST_FOREACH (const RippleAddress & affectedAccount, alTx.getAffected ())
-            {
-                SubInfoMapIterator  simiIt  = mSubRTAccount.find (affectedAccount.getAccountID ());
-
-                if (simiIt != mSubRTAccount.end ())
-                {
-                    NetworkOPsImp::SubMapType::const_iterator it = simiIt->second.begin ();
+    if (mSubRTAccount.empty () && (!bAccepted || mSubAccount.empty ()))
+        return;
 
-                    while (it != simiIt->second.end ())
-                    {
-                        InfoSub::pointer p = it->second.lock ();
+    SubscriptionIndex::Listeners notify;
 
-                        if (p)
-                        {
-                            notify.insert (p);
-                            ++it;
-                            ++iProposed;
-                        }
-                        else
-                            it = simiIt->second.erase (it);
-                    }
-                }
+    BOOST_FOREACH (const RippleAddress & affectedAccount, alTx.getAffected ())
+    {
+        mSubRTAccount.find (affectedAccount.getAccountID (), notify);
 
-                if (bAccepted)
-                {
-                    simiIt  = mSubAccount.find (affectedAccount.getAccountID ());
+        if (bAccepted)
+            mSubAccount.find (affectedAccount.getAccountID (), notify);
+    }
 
-                    if (simiIt != mSubAccount.end ())
-                    {
-                        NetworkOPsImp::SubMapType::const_iterator it = simiIt->second.begin ();
+    SubscriptionIndex::unique (notify);
 
-                        while (it != simiIt->second.end ())
-                        {
-                            InfoSub::pointer p = it->second.lock ();
-
-                            if (p)
-                            {
-                                notify.insert (p);
-                                ++it;
-                                ++iAccepted;
-                            }
-                            else
-                                it = simiIt->second.erase (it);
-                        }
-                    }
-                }
-            }
-        }
-    }
-    m_journal.info << "pubAccountTransaction:" <<
-        " iProposed=" << iProposed <<
-        " iAccepted=" << iAccepted;
+    m_journal.trace << "pubAccountTransaction:" <<
+        " listeners=" << notify.size () <<
+        " accepted=" << bAccepted;
 
     if (!notify.empty ())
     {
-        Json::Value jvObj = transJson (
-            *alTx.getTxn (), alTx.getResult (), bAccepted, lpCurrent);
+        InfoSub::Message message (
+            [&] () -> Json::Value
+            {
+                Json::Value jvObj = transJson (
+                    *alTx.getTxn (), alTx.getResult (), bAccepted, lpCurrent);
 
-        if (alTx.isApplied ())
-            jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
+                if (alTx.isApplied ())
+                    jvObj[jss::meta] = alTx.getMeta ()->getJson (0);
 
-        Json::FastWriter w;
-        std::string sObj = w.write (jvObj);
+                return jvObj;
+            },
+            [&]
+            {
+                return transFrame (*alTx.getTxn (), alTx.getResult (), bAccepted, lpCurrent,
+                    alTx.getRawMeta ());
+            });
 
         BOOST_FOREACH (InfoSub::ref isrListener, notify)
         {
-            isrListener->send (jvObj, sObj, true);
+            message.send (*isrListener);
         }
     }
 }
@@ -2611,8 +2712,6 @@ void NetworkOPsImp::subAccount (InfoSub::ref isrListener,
     const boost::unordered_set<RippleAddress>& vnaAccountIDs,
     std::uint32_t uLedgerIndex, bool rt)
 {
-    SubInfoMapType& subMap = rt ? mSubRTAccount : mSubAccount;
-
     // For the connection, monitor each account.
     BOOST_FOREACH (const RippleAddress & naAccountID, vnaAccountIDs)
     {
@@ -2622,33 +2721,13 @@ void NetworkOPsImp::subAccount (InfoSub::ref isrListener,
         isrListener->insertSubAccountInfo (naAccountID, uLedgerIndex);
     }
 
-    ScopedLockType sl (mLock);
-
-    BOOST_FOREACH (const RippleAddress & naAccountID, vnaAccountIDs)
-    {
-        SubInfoMapType::iterator    simIterator = subMap.find (naAccountID.getAccountID ());
-
-        if (simIterator == subMap.end ())
-        {
-            // Not found, note that account has a new single listner.
-            SubMapType  usisElement;
-            usisElement[isrListener->getSeq ()] = isrListener;
-            subMap.insert (simIterator, make_pair (naAccountID.getAccountID (), usisElement));
-        }
-        else
-        {
-            // Found, note that the account has another listener.
-            simIterator->second[isrListener->getSeq ()] = isrListener;
-        }
-    }
+    (rt ? mSubRTAccount : mSubAccount).insert (isrListener, vnaAccountIDs);
 }
 
 void NetworkOPsImp::unsubAccount (std::uint64_t uSeq,
                                   const boost::unordered_set<RippleAddress>& vnaAccountIDs,
                                   bool rt)
 {
-    SubInfoMapType& subMap = rt ? mSubRTAccount : mSubAccount;
-
     // For the connection, unmonitor each account.
     // FIXME: Don't we need to unsub?
     // BOOST_FOREACH(const RippleAddress& naAccountID, vnaAccountIDs)
@@ -2656,30 +2735,7 @@ void NetworkOPsImp::unsubAccount (std::uint64_t uSeq,
     //  isrListener->deleteSubAccountInfo(naAccountID);
     // }
 
-    ScopedLockType sl (mLock);
-
-    BOOST_FOREACH (const RippleAddress & naAccountID, vnaAccountIDs)
-    {
-        SubInfoMapType::iterator    simIterator = subMap.find (naAccountID.getAccountID ());
-
-
-        if (simIterator == subMap.end ())
-        {
-            // Not found.  Done.
-            nothing ();
-        }
-        else
-        {
-            // Found
-            simIterator->second.erase (uSeq);
-
-            if (simIterator->second.empty ())
-            {
-                // Don't need hash entry.
-                subMap.erase (simIterator);
-            }
-        }
-    }
+    (rt ? mSubRTAccount : mSubAccount).erase (uSeq, vnaAccountIDs);
 }
 
 bool NetworkOPsImp::subBook (InfoSub::ref isrListener, RippleCurrency const& currencyPays, RippleCurrency const& currencyGets,
@@ -3180,35 +3236,47 @@ void NetworkOPsImp::getBookPage (Ledger::pointer lpLedger, const uint160& uTaker
 
 #endif
 
-static void fpAppender (protocol::TMGetObjectByHash* reply, std::uint32_t ledgerSeq,
-                        const uint256& hash, const Blob& blob)
-{
-    protocol::TMIndexedObject& newObj = * (reply->add_objects ());
-    newObj.set_ledgerseq (ledgerSeq);
-    newObj.set_hash (hash.begin (), 256 / 8);
-    newObj.set_data (&blob[0], blob.size ());
-}
-
-void NetworkOPsImp::makeFetchPack (Job&, boost::weak_ptr<Peer> wPeer,
+void NetworkOPsImp::makeFetchPack (Job& job, boost::weak_ptr<Peer> wPeer,
                                 boost::shared_ptr<protocol::TMGetObjectByHash> request,
                                 Ledger::pointer wantLedger, Ledger::pointer haveLedger,
                                 std::uint32_t uUptime)
 {
-    if (UptimeTimer::getInstance ().getElapsedSeconds () > (uUptime + 1))
+    boost::shared_ptr <FetchPackStream> stream (
+        boost::make_shared <FetchPackStream> ());
+    stream->peer = wPeer;
+    stream->request = request;
+    stream->wantLedger = wantLedger;
+    stream->haveLedger = haveLedger;
+    stream->uptime = uUptime;
+    stream->offset = 0;
+    stream->sent = 0;
+
+    sendFetchPack (job, stream);
+}
+
+// Each job sends one message and queues the next, walking back from the
+// ledger the peer asked about. Every ledger is sent as its header, then the
+// state nodes it does not share with its successor, then its transactions,
+// so the peer can use each message as it arrives. Ledgers the peer already
+// has are skipped.
+void NetworkOPsImp::sendFetchPack (Job&, boost::shared_ptr <FetchPackStream> stream)
+{
+    if (UptimeTimer::getInstance ().getElapsedSeconds () > (stream->uptime + 1))
     {
         m_journal.info << "Fetch pack request got stale";
         return;
     }
 
-    if (getApp().getFeeTrack ().isLoadedLocal ())
+    // Under load the peer still gets the first message
+    if ((stream->sent != 0) && getApp().getFeeTrack ().isLoadedLocal ())
     {
-        m_journal.info << "Too busy to make fetch pack";
+        m_journal.info << "Too busy to continue fetch pack";
         return;
     }
 
     try
     {
-        Peer::ptr peer = wPeer.lock ();
+        Peer::ptr peer = stream->peer.lock ();
 
         if (!peer)
             return;
@@ -3216,43 +3284,70 @@ void NetworkOPsImp::makeFetchPack (Job&, boost::weak_ptr<Peer> wPeer,
         protocol::TMGetObjectByHash reply;
         reply.set_query (false);
 
-        if (request->has_seq ())
-            reply.set_seq (request->seq ());
+        if (stream->request->has_seq ())
+            reply.set_seq (stream->request->seq ());
 
-        reply.set_ledgerhash (request->ledgerhash ());
+        reply.set_ledgerhash (stream->request->ledgerhash ());
         reply.set_type (protocol::TMGetObjectByHash::otFETCH_PACK);
 
-        do
+        int ledgers = 0;
+
+        while (stream->wantLedger && (reply.objects ().size () < fetchPackChunkSize) &&
+            (ledgers++ < fetchPackChunkLedgers))
         {
-            std::uint32_t lSeq = wantLedger->getLedgerSeq ();
+            Ledger::pointer const wantLedger = stream->wantLedger;
 
-            protocol::TMIndexedObject& newObj = *reply.add_objects ();
-            newObj.set_hash (wantLedger->getHash ().begin (), 256 / 8);
-            Serializer s (256);
-            s.add32 (HashPrefix::ledgerMaster);
-            wantLedger->addRaw (s);
-            newObj.set_data (s.getDataPtr (), s.getLength ());
-            newObj.set_ledgerseq (lSeq);
+            if (! peer->hasLedger (wantLedger->getHash (), wantLedger->getLedgerSeq ()))
+            {
+                LedgerDiffCache::pointer diff (m_ledgerDiffs.get (
+                    wantLedger, stream->haveLedger));
 
-            wantLedger->peekAccountStateMap ()->getFetchPack (haveLedger->peekAccountStateMap ().get (), true, 1024,
-                    BIND_TYPE (fpAppender, &reply, lSeq, P_1, P_2));
+                if (!diff)
+                {
+                    stream->wantLedger.reset ();
+                    break;
+                }
 
-            if (wantLedger->getTransHash ().isNonZero ())
-                wantLedger->peekTransactionMap ()->getFetchPack (nullptr, true, 256,
-                        BIND_TYPE (fpAppender, &reply, lSeq, P_1, P_2));
+                std::size_t const count (std::min (diff->objects.size () - stream->offset,
+                    static_cast <std::size_t> (fetchPackChunkSize - reply.objects ().size ())));
 
-            if (reply.objects ().size () >= 256)
-                break;
+                for (std::size_t i = stream->offset; i < stream->offset + count; ++i)
+                {
+                    LedgerDiffCache::Object const& object (diff->objects[i]);
+                    protocol::TMIndexedObject& newObj = *reply.add_objects ();
+                    newObj.set_hash (object.first.begin (), 256 / 8);
+                    newObj.set_data (&object.second[0], object.second.size ());
+                    newObj.set_ledgerseq (diff->seq);
+                }
+
+                stream->offset += count;
+
+                // The rest of this ledger goes in the next message
+                if (stream->offset < diff->objects.size ())
+                    break;
+            }
 
-            // VFALCO NOTE Why use move?
-            haveLedger = std::move (wantLedger);
-            wantLedger = getLedgerByHash (haveLedger->getParentHash ());
+            stream->offset = 0;
+            stream->haveLedger = std::move (stream->wantLedger);
+            stream->wantLedger = getLedgerByHash (stream->haveLedger->getParentHash ());
         }
-        while (wantLedger && (UptimeTimer::getInstance ().getElapsedSeconds () <= (uUptime + 1)));
 
-        m_journal.info << "Built fetch pack with " << reply.objects ().size () << " nodes";
-        Message::pointer msg = boost::make_shared<Message> (reply, protocol::mtGET_OBJECTS);
-        peer->sendPacket (msg, false);
+        if (reply.objects ().size () != 0)
+        {
+            stream->sent += reply.objects ().size ();
+            Message::pointer msg = boost::make_shared<Message> (reply, protocol::mtGET_OBJECTS);
+            peer->sendPacket (msg, false);
+        }
+
+        if (stream->wantLedger && (stream->sent < fetchPackMaxObjects))
+        {
+            getApp().getJobQueue ().addJob (jtPACK, "MakeFetchPack",
+                BIND_TYPE (&NetworkOPsImp::sendFetchPack, this, P_1, stream));
+        }
+        else
+        {
+            m_journal.info << "Sent fetch pack with " << stream->sent << " nodes";
+        }
     }
     catch (...)
     {
@@ -3263,6 +3358,7 @@ void NetworkOPsImp::makeFetchPack (Job&, boost::weak_ptr<Peer> wPeer,
 void NetworkOPsImp::sweepFetchPack ()
 {
     mFetchPack.sweep ();
+    m_ledgerDiffs.sweep ();
 }
 
 void NetworkOPsImp::addFetchPack (uint256 const& hash, boost::shared_ptr< Blob >& data)
@@ -3345,4 +3441,100 @@ NetworkOPs* NetworkOPs::New (clock_type& clock, LedgerMaster& ledgerMaster,
     return new NetworkOPsImp (clock, ledgerMaster, parent, journal);
 }
 
+//------------------------------------------------------------------------------
+
+// Pins the layout of the binary subscription frames, clients parse these
+class SubscriptionFrame_test : public beast::unit_test::suite
+{
+public:
+    static std::uint64_t get (std::string const& frame, std::size_t offset, int bytes)
+    {
+        std::uint64_t value (0);
+        for (int i = 0; i < bytes; ++i)
+            value = (value << 8) | static_cast <unsigned char> (frame[offset + i]);
+        return value;
+    }
+
+    static uint256 get256 (std::string const& frame, std::size_t offset)
+    {
+        uint256 value;
+        memcpy (value.begin (), frame.data () + offset, 32);
+        return value;
+    }
+
+    void testLedgerFrame (Ledger::ref ledger)
+    {
+        std::string const frame (NetworkOPs::ledgerFrame (
+            *AcceptedLedger::makeAcceptedLedger (ledger)));
+
+        Serializer header;
+        ledger->addRaw (header);
+        std::size_t const offset (1 + 32 + header.getDataLength ());
+
+        expect (frame.size () == offset + 8 + 4 + 8 + 8 + 4, "ledger frame size");
+        expect (get (frame, 0, 1) == 1, "ledger frame type");
+        expect (get256 (frame, 1) == ledger->getHash (), "ledger frame hash");
+        expect (frame.compare (33, header.getDataLength (), header.getString ()) == 0,
+            "ledger frame header");
+        expect (get (frame, offset, 8) == ledger->getBaseFee (), "ledger frame base fee");
+        expect (get (frame, offset + 8, 4) == ledger->getReferenceFeeUnits (),
+            "ledger frame reference fee");
+        expect (get (frame, offset + 12, 8) == ledger->getReserve (0),
+            "ledger frame reserve base");
+        expect (get (frame, offset + 20, 8) == ledger->getReserveInc (),
+            "ledger frame reserve increment");
+        expect (get (frame, offset + 28, 4) == 0, "ledger frame transaction count");
+    }
+
+    void testTransFrame (Ledger::ref ledger, bool validated)
+    {
+        RippleAddress const seed (RippleAddress::createSeedGeneric ("masterpassphrase"));
+        RippleAddress const generator (RippleAddress::createGeneratorPublic (seed));
+        RippleAddress const account (RippleAddress::createAccountPublic (generator, 0));
+
+        SerializedTransaction txn (ttACCOUNT_SET);
+        txn.setSourceAccount (account);
+        txn.setSigningPubKey (account);
+        txn.setFieldAmount (sfFee, STAmount (10));
+        txn.setFieldU32 (sfSequence, 1);
+
+        Blob const meta (3, 0xab);
+        std::string const frame (NetworkOPs::transFrame (
+            txn, tesSUCCESS, validated, ledger, meta));
+
+        std::string const raw (txn.getSerializer ().getString ());
+        std::size_t const offset (1 + 4 + 32 + 4 + 4 + raw.size ());
+
+        expect (frame.size () == offset + 4 + meta.size (), "transaction frame size");
+        expect (get (frame, 0, 1) == (validated ? 2 : 3), "transaction frame type");
+        expect (get (frame, 1, 4) == ledger->getLedgerSeq (), "transaction frame sequence");
+        expect (get256 (frame, 5) == (validated ? ledger->getHash () : uint256 ()),
+            "transaction frame hash");
+        expect (get (frame, 37, 4) == tesSUCCESS, "transaction frame result");
+        expect (get (frame, 41, 4) == raw.size (), "transaction frame length");
+        expect (frame.compare (45, raw.size (), raw) == 0, "transaction frame body");
+        expect (get (frame, offset, 4) == meta.size (), "transaction frame meta length");
+        expect (frame.compare (offset + 4, meta.size (),
+            std::string (meta.begin (), meta.end ())) == 0, "transaction frame meta");
+    }
+
+    void run ()
+    {
+        RippleAddress const seed (RippleAddress::createSeedGeneric ("masterpassphrase"));
+        RippleAddress const generator (RippleAddress::createGeneratorPublic (seed));
+
+        Ledger::pointer ledger (boost::make_shared <Ledger> (
+            RippleAddress::createAccountPublic (generator, 0), SYSTEM_CURRENCY_START));
+        ledger->updateHash ();
+        ledger->setClosed ();
+        ledger->setAccepted (1000, ledger->getCloseResolution (), true);
+
+        testLedgerFrame (ledger);
+        testTransFrame (ledger, true);
+        testTransFrame (ledger, false);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SubscriptionFrame,ripple_app,ripple);
+
 } // ripple
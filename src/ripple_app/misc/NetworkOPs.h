@@ -91,6 +91,13 @@ public:
 
     virtual ~NetworkOPs () = 0;
 
+    /** The binary form of a transaction notification, see InfoSub::isBinary. */
+    static std::string transFrame (const SerializedTransaction& stTxn, TER terResult,
+        bool bValidated, Ledger::ref lpCurrent, Blob const& rawMeta);
+
+    /** The binary form of a ledger closed notification, see InfoSub::isBinary. */
+    static std::string ledgerFrame (AcceptedLedger const& accepted);
+
     //--------------------------------------------------------------------------
     //
     // Network information
@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace ripple {
+
+SubscriptionIndex::SubscriptionIndex ()
+    : m_accounts (0)
+{
+    for (auto& shard : m_shards)
+        shard.map = std::make_shared <Map> ();
+}
+
+bool SubscriptionIndex::empty () const
+{
+    return m_accounts.load () == 0;
+}
+
+std::size_t SubscriptionIndex::getShard (std::uint64_t seq)
+{
+    return static_cast <std::size_t> (seq % shardCount);
+}
+
+std::shared_ptr <SubscriptionIndex::Map const>
+SubscriptionIndex::load (std::size_t shard) const
+{
+    return std::atomic_load (&m_shards [shard].map);
+}
+
+template <class Function>
+void SubscriptionIndex::modify (std::uint64_t seq,
+    boost::unordered_set <RippleAddress> const& accounts, Function f)
+{
+    if (accounts.empty ())
+        return;
+
+    Shard& shard (m_shards [getShard (seq)]);
+    std::lock_guard <std::mutex> lock (shard.mutex);
+
+    auto map (std::make_shared <Map> (*shard.map));
+    std::size_t const before (map->size ());
+
+    BOOST_FOREACH (RippleAddress const& account, accounts)
+        f (*map, account.getAccountID ());
+
+    if (map->size () > before)
+        m_accounts += map->size () - before;
+    else
+        m_accounts -= before - map->size ();
+
+    std::atomic_store (&shard.map, std::shared_ptr <Map const> (std::move (map)));
+}
+
+void SubscriptionIndex::insert (InfoSub::ref listener,
+    boost::unordered_set <RippleAddress> const& accounts)
+{
+    std::uint64_t const seq (listener->getSeq ());
+
+    modify (seq, accounts, [&](Map& map, uint160 const& id)
+    {
+        Map::iterator iter (map.find (id));
+
+        auto subscribers ((iter == map.end ())
+            ? std::make_shared <NetworkOPs::SubMapType> ()
+            : std::make_shared <NetworkOPs::SubMapType> (*iter->second));
+
+        (*subscribers) [seq] = listener;
+
+        // Drop the clients that went away without unsubscribing
+        for (auto it (subscribers->begin ()); it != subscribers->end ();)
+        {
+            if (it->second.expired ())
+                it = subscribers->erase (it);
+            else
+                ++it;
+        }
+
+        map [id] = std::move (subscribers);
+    });
+}
+
+void SubscriptionIndex::erase (std::uint64_t seq,
+    boost::unordered_set <RippleAddress> const& accounts)
+{
+    modify (seq, accounts, [&](Map& map, uint160 const& id)
+    {
+        Map::iterator iter (map.find (id));
+
+        if ((iter == map.end ()) || (iter->second->count (seq) == 0))
+            return;
+
+        if (iter->second->size () == 1)
+        {
+            map.erase (iter);
+        }
+        else
+        {
+            auto subscribers (std::make_shared <NetworkOPs::SubMapType> (*iter->second));
+            subscribers->erase (seq);
+            iter->second = std::move (subscribers);
+        }
+    });
+}
+
+void SubscriptionIndex::appendLive (Map const& map, uint160 const& account,
+    Listeners& listeners)
+{
+    Map::const_iterator const iter (map.find (account));
+
+    if (iter == map.end ())
+        return;
+
+    for (auto const& subscriber : *iter->second)
+    {
+        InfoSub::pointer p (subscriber.second.lock ());
+
+        if (p)
+            listeners.push_back (std::move (p));
+    }
+}
+
+void SubscriptionIndex::find (uint160 const& account, Listeners& listeners) const
+{
+    if (empty ())
+        return;
+
+    for (std::size_t shard = 0; shard < shardCount; ++shard)
+        appendLive (*load (shard), account, listeners);
+}
+
+void SubscriptionIndex::publish (
+    std::vector <SubscriptionIndex const*> const& indexes,
+        std::vector <std::vector <uint160>> const& accounts,
+            std::vector <InfoSub::Message*> const& messages, JobQueue& jobQueue)
+{
+    assert (accounts.size () == messages.size ());
+
+    auto publication (std::make_shared <Publication> ());
+    publication->accounts = &accounts;
+    publication->messages = &messages;
+
+    std::size_t lookups (0);
+    for (auto const& set : accounts)
+        lookups += set.size ();
+
+    for (auto const index : indexes)
+    {
+        if (! index->empty ())
+            publication->indexes.push_back (index);
+    }
+
+    if (publication->indexes.empty () || (lookups == 0))
+        return;
+
+    if (lookups >= parallelThreshold)
+    {
+        std::size_t const jobs (std::min <std::size_t> (shardCount,
+            std::max (1u, std::thread::hardware_concurrency ())));
+
+        for (std::size_t i = 1; i < jobs; ++i)
+        {
+            jobQueue.addJob (jtPUBLEDGER, "pubAccounts",
+                BIND_TYPE (&SubscriptionIndex::publishJob, publication, P_1));
+        }
+    }
+
+    // The caller publishes too, so this finishes even if no job thread is free
+    publishShards (publication);
+
+    std::unique_lock <std::mutex> lock (publication->mutex);
+    while (publication->done < shardCount)
+        publication->cond.wait (lock);
+}
+
+void SubscriptionIndex::publishJob (std::shared_ptr <Publication> publication, Job&)
+{
+    publishShards (publication);
+}
+
+void SubscriptionIndex::publishShards (
+    std::shared_ptr <Publication> const& publication)
+{
+    for (;;)
+    {
+        std::size_t const shard (publication->next++);
+
+        if (shard >= shardCount)
+            break;
+
+        std::vector <std::vector <uint160>> const& accounts (*publication->accounts);
+        std::vector <InfoSub::Message*> const& messages (*publication->messages);
+
+        // Load each snapshot once for the whole batch
+        std::vector <std::shared_ptr <Map const>> maps;
+        for (auto const index : publication->indexes)
+        {
+            std::shared_ptr <Map const> map (index->load (shard));
+            if (! map->empty ())
+                maps.push_back (std::move (map));
+        }
+
+        Listeners listeners;
+
+        for (std::size_t i = 0; (i < accounts.size ()) && ! maps.empty (); ++i)
+        {
+            listeners.clear ();
+
+            for (auto const& map : maps)
+            {
+                for (auto const& id : accounts [i])
+                    appendLive (*map, id, listeners);
+            }
+
+            unique (listeners);
+
+            for (auto const& listener : listeners)
+                messages [i]->send (*listener);
+        }
+
+        std::lock_guard <std::mutex> lock (publication->mutex);
+        if (++publication->done == shardCount)
+            publication->cond.notify_all ();
+    }
+}
+
+void SubscriptionIndex::unique (Listeners& listeners)
+{
+    std::sort (listeners.begin (), listeners.end ());
+    listeners.erase (std::unique (listeners.begin (), listeners.end ()),
+        listeners.end ());
+}
+
+} // ripple
@@ -0,0 +1,131 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SUBSCRIPTIONINDEX_H_INCLUDED
+#define RIPPLE_SUBSCRIPTIONINDEX_H_INCLUDED
+
+namespace ripple {
+
+/** Maps accounts to the clients subscribed to them.
+
+    The index is split into shards by client, so each client's
+    subscriptions are all in one shard. Each shard publishes an immutable
+    snapshot of its map, so lookups never wait for subscribers being added
+    or removed, or for each other. A change copies the map of the shard
+    it affects and swaps in the new snapshot.
+
+    Because a client lives in exactly one shard, the shards can be
+    published to independently: every client still receives each message
+    once, and in order.
+*/
+class SubscriptionIndex
+{
+public:
+    typedef std::vector <InfoSub::pointer> Listeners;
+
+    enum
+    {
+        shardCount = 32,
+
+        // Fewer lookups than this are published on the calling thread
+        parallelThreshold = 4096
+    };
+
+    SubscriptionIndex ();
+
+    /** Returns `true` if no account has a subscriber. */
+    bool empty () const;
+
+    /** Subscribe a client to each of the accounts. */
+    void insert (InfoSub::ref listener,
+        boost::unordered_set <RippleAddress> const& accounts);
+
+    /** Unsubscribe a client from each of the accounts. */
+    void erase (std::uint64_t seq,
+        boost::unordered_set <RippleAddress> const& accounts);
+
+    /** Append the live subscribers of an account. */
+    void find (uint160 const& account, Listeners& listeners) const;
+
+    /** Send a sequence of messages to the subscribers of their accounts.
+        Each client subscribed, in any of the indexes, to any account in
+        `accounts [i]` receives `messages [i]` once, in sequence order.
+        Large batches are published by jobs that each take whole shards,
+        with the caller taking shards too. Returns once all are sent.
+    */
+    static void publish (std::vector <SubscriptionIndex const*> const& indexes,
+        std::vector <std::vector <uint160>> const& accounts,
+        std::vector <InfoSub::Message*> const& messages, JobQueue& jobQueue);
+
+    /** Sort a list of subscribers and remove the duplicates. */
+    static void unique (Listeners& listeners);
+
+private:
+    typedef ripple::unordered_map <uint160,
+        std::shared_ptr <NetworkOPs::SubMapType const>> Map;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::shared_ptr <Map const> map;
+    };
+
+    // A batch being published. Jobs that start after the shards were all
+    // taken only look at the next shard index and return.
+    struct Publication
+    {
+        Publication ()
+            : accounts (nullptr)
+            , messages (nullptr)
+            , next (0)
+            , done (0)
+        {
+        }
+
+        std::vector <SubscriptionIndex const*> indexes;
+        std::vector <std::vector <uint160>> const* accounts;
+        std::vector <InfoSub::Message*> const* messages;
+        std::atomic <std::size_t> next;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t done;
+    };
+
+    static std::size_t getShard (std::uint64_t seq);
+
+    std::shared_ptr <Map const> load (std::size_t shard) const;
+
+    template <class Function>
+    void modify (std::uint64_t seq,
+        boost::unordered_set <RippleAddress> const& accounts, Function f);
+
+    static void appendLive (Map const& map, uint160 const& account,
+        Listeners& listeners);
+
+    static void publishShards (std::shared_ptr <Publication> const& publication);
+    static void publishJob (std::shared_ptr <Publication> publication, Job&);
+
+    Shard m_shards [shardCount];
+    std::atomic <std::size_t> m_accounts;
+};
+
+} // ripple
+
+#endif
@@ -0,0 +1,505 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <array>
+#include <deque>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Measures back ends under a synthetic ledger shaped workload.
+
+    The workload is a state tree with sixteen way inner nodes and a few
+    leaves under each bottom inner node. Reader threads walk from the root
+    to a leaf, fetching every node on the way as a SHAMap does, and most
+    walks land in a small hot region of the tree. At the same time a
+    writer stores new ledgers, each replacing some leaves and the inner
+    nodes above them, so the back end's batch writes overlap the reads.
+
+    Everything is generated from the seed, so every back end and every
+    run sees the same keys, payloads and access order.
+
+    Every factory the application registers is measured, which is why the
+    suite lives here rather than with the node store: SQLite is only
+    available in this module.
+*/
+class NodeStoreWorkload_test : public beast::unit_test::suite
+{
+public:
+    enum
+    {
+        // Levels of inner nodes below the root
+        innerDepth = 3,
+
+        branchFactor = 16,
+
+        leavesPerInner = 4,
+
+        readerThreads = 4,
+
+        walksPerReader = 5000,
+
+        // Percentage of walks that land in the hot region
+        hotWalkPercent = 80,
+
+        // Percentage of the leaves that make up the hot region
+        hotLeafPercent = 10,
+
+        ledgersToWrite = 50,
+
+        changesPerLedger = 200,
+
+        // Objects per storeBatch call when loading the tree
+        loadBatchSize = 256
+    };
+
+    enum Operation
+    {
+        opInnerFetch,
+        opLeafFetch,
+        opStore,
+        opBatchWrite,
+        opLoad,
+        opCount
+    };
+
+    static char const* getOperationName (int op)
+    {
+        switch (op)
+        {
+        case opInnerFetch:  return "inner fetch";
+        case opLeafFetch:   return "leaf fetch";
+        case opStore:       return "store";
+        case opBatchWrite:  return "batch write";
+        case opLoad:        return "load";
+        default:
+            break;
+        }
+        return "unknown";
+    }
+
+    typedef std::chrono::steady_clock clock_type;
+
+    // Latencies in microseconds and the objects each operation handled
+    struct Samples
+    {
+        Samples ()
+            : objects (0)
+        {
+        }
+
+        void add (std::uint64_t micros, std::size_t count = 1)
+        {
+            latencies.push_back (micros);
+            objects += count;
+        }
+
+        void append (Samples const& other)
+        {
+            latencies.insert (latencies.end (),
+                other.latencies.begin (), other.latencies.end ());
+            objects += other.objects;
+        }
+
+        std::vector <std::uint64_t> latencies;
+        std::size_t objects;
+    };
+
+    typedef std::array <Samples, opCount> Results;
+
+    static std::uint64_t microsSince (clock_type::time_point start)
+    {
+        return std::chrono::duration_cast <std::chrono::microseconds> (
+            clock_type::now () - start).count ();
+    }
+
+    //--------------------------------------------------------------------------
+
+    /** Runs batch writes on a thread of its own, as the job queue does. */
+    class WorkloadScheduler : public Scheduler
+    {
+    public:
+        WorkloadScheduler ()
+            : m_stop (false)
+            , m_thread (&WorkloadScheduler::run, this)
+        {
+        }
+
+        ~WorkloadScheduler ()
+        {
+            {
+                std::lock_guard <std::mutex> lock (m_mutex);
+                m_stop = true;
+            }
+            m_cond.notify_one ();
+            m_thread.join ();
+        }
+
+        void scheduleTask (Task& task)
+        {
+            {
+                std::lock_guard <std::mutex> lock (m_mutex);
+                m_tasks.push_back (&task);
+            }
+            m_cond.notify_one ();
+        }
+
+        void onFetch (FetchReport const&)
+        {
+        }
+
+        // The BatchWriter only reports whole milliseconds
+        void onBatchWrite (BatchWriteReport const& report)
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            m_batches.add (report.elapsed.count () * 1000, report.writeCount);
+        }
+
+        Samples takeBatches ()
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            Samples batches;
+            std::swap (batches, m_batches);
+            return batches;
+        }
+
+    private:
+        void run ()
+        {
+            for (;;)
+            {
+                Task* task;
+
+                {
+                    std::unique_lock <std::mutex> lock (m_mutex);
+
+                    while (! m_stop && m_tasks.empty ())
+                        m_cond.wait (lock);
+
+                    if (m_tasks.empty ())
+                        return;
+
+                    task = m_tasks.front ();
+                    m_tasks.pop_front ();
+                }
+
+                task->performScheduledTask ();
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::deque <Task*> m_tasks;
+        Samples m_batches;
+        bool m_stop;
+        std::thread m_thread;
+    };
+
+    //--------------------------------------------------------------------------
+
+    /** The keys of a synthetic state tree. */
+    class Tree
+    {
+    public:
+        explicit Tree (std::int64_t seedValue)
+            : m_random (seedValue)
+        {
+            std::size_t count = 1;
+            for (int depth = 0; depth <= innerDepth; ++depth)
+            {
+                m_inner.push_back (makeKeys (count));
+                count *= branchFactor;
+            }
+            m_leaves = makeKeys (m_inner.back ().size () * leavesPerInner);
+        }
+
+        std::size_t getLeafCount () const
+        {
+            return m_leaves.size ();
+        }
+
+        /** The keys from the root down to a leaf. */
+        void getPath (std::size_t leaf, std::vector <uint256>& path) const
+        {
+            path.resize (innerDepth + 2);
+            std::size_t index = leaf / leavesPerInner;
+            for (int depth = innerDepth; depth >= 0; --depth)
+            {
+                path [depth] = m_inner [depth][index];
+                index /= branchFactor;
+            }
+            path.back () = m_leaves [leaf];
+        }
+
+        /** Every object in the tree. */
+        void getObjects (Batch& batch)
+        {
+            for (auto const& level : m_inner)
+                for (auto const& key : level)
+                    batch.push_back (makeInner (m_random, key));
+
+            for (auto const& key : m_leaves)
+                batch.push_back (makeLeaf (m_random, key));
+        }
+
+    private:
+        std::vector <uint256> makeKeys (std::size_t count)
+        {
+            std::vector <uint256> keys (count);
+            for (auto& key : keys)
+                m_random.fillBitsRandomly (key.begin (), key.size ());
+            return keys;
+        }
+
+        beast::Random m_random;
+        std::vector <std::vector <uint256>> m_inner;
+        std::vector <uint256> m_leaves;
+    };
+
+    static uint256 makeKey (beast::Random& r)
+    {
+        uint256 key;
+        r.fillBitsRandomly (key.begin (), key.size ());
+        return key;
+    }
+
+    // Sixteen child hashes and a prefix, as a serialized inner node
+    static NodeObject::Ptr makeInner (beast::Random& r, uint256 const& key)
+    {
+        Blob data (4 + branchFactor * 32);
+        r.fillBitsRandomly (data.data (), data.size ());
+        return NodeObject::createObject (hotACCOUNT_NODE,
+            1, std::move (data), key);
+    }
+
+    // A serialized ledger entry and its key
+    static NodeObject::Ptr makeLeaf (beast::Random& r, uint256 const& key)
+    {
+        Blob data (64 + r.nextInt (320));
+        r.fillBitsRandomly (data.data (), data.size ());
+        return NodeObject::createObject (hotACCOUNT_NODE,
+            1, std::move (data), key);
+    }
+
+    //--------------------------------------------------------------------------
+
+    void load (Backend& backend, Batch const& batch, Results& results)
+    {
+        for (std::size_t i = 0; i < batch.size (); i += loadBatchSize)
+        {
+            Batch chunk (batch.begin () + i, batch.begin () +
+                std::min <std::size_t> (batch.size (), i + loadBatchSize));
+
+            clock_type::time_point const start (clock_type::now ());
+            backend.storeBatch (chunk);
+            results [opLoad].add (microsSince (start), chunk.size ());
+        }
+    }
+
+    // Walk from the root to a leaf, mostly in the hot region
+    static void read (Backend& backend, Tree const& tree,
+        std::int64_t seedValue, Results& results, int& missing)
+    {
+        beast::Random r (seedValue);
+        std::size_t const leaves (tree.getLeafCount ());
+        int const hotLeaves (std::max <int> (1, leaves * hotLeafPercent / 100));
+        std::vector <uint256> path;
+
+        for (int walk = 0; walk < walksPerReader; ++walk)
+        {
+            std::size_t const leaf = (r.nextInt (100) < hotWalkPercent)
+                ? r.nextInt (hotLeaves)
+                : r.nextInt (static_cast <int> (leaves));
+
+            tree.getPath (leaf, path);
+
+            for (std::size_t i = 0; i < path.size (); ++i)
+            {
+                NodeObject::Ptr object;
+                clock_type::time_point const start (clock_type::now ());
+                Status const status (backend.fetch (path [i].begin (), &object));
+                std::uint64_t const elapsed (microsSince (start));
+
+                if ((status != ok) || (object == nullptr))
+                    ++missing;
+
+                results [(i + 1 == path.size ()) ? opLeafFetch : opInnerFetch].add (elapsed);
+            }
+        }
+    }
+
+    // Store new ledgers, each replacing leaves and the inner nodes above them
+    static void write (Backend& backend, std::int64_t seedValue, Results& results)
+    {
+        beast::Random r (seedValue);
+
+        for (int ledger = 0; ledger < ledgersToWrite; ++ledger)
+        {
+            for (int change = 0; change < changesPerLedger; ++change)
+            {
+                for (int depth = 0; depth <= innerDepth + 1; ++depth)
+                {
+                    uint256 const key (makeKey (r));
+                    NodeObject::Ptr const object ((depth <= innerDepth)
+                        ? makeInner (r, key) : makeLeaf (r, key));
+
+                    clock_type::time_point const start (clock_type::now ());
+                    backend.store (object);
+                    results [opStore].add (microsSince (start));
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    void report (std::string const& name, Samples& samples, double seconds)
+    {
+        std::vector <std::uint64_t>& v (samples.latencies);
+        if (v.empty ())
+            return;
+
+        std::sort (v.begin (), v.end ());
+        auto const percentile = [&v] (double p) -> std::uint64_t
+        {
+            return v [std::min (v.size () - 1,
+                static_cast <std::size_t> (p * v.size ()))];
+        };
+
+        std::stringstream ss;
+        ss << "  " << std::left << std::setw (12) << name << std::right <<
+            std::fixed << std::setprecision (0) <<
+            std::setw (10) << (samples.objects / seconds) << " obj/s" <<
+            "  p50 " << std::setw (6) << percentile (0.5) <<
+            "  p99 " << std::setw (6) << percentile (0.99) <<
+            "  p999 " << std::setw (6) << percentile (0.999) << " us";
+        log << ss.str ();
+    }
+
+    // Returns why a back end cannot run the workload, or nullptr
+    static char const* getSkipReason (beast::String const& type)
+    {
+        if (type.compareIgnoreCase ("none") == 0)
+            return "it stores nothing";
+
+        if (type.compareIgnoreCase ("Shard") == 0)
+            return "it is written once, when the shard is built";
+
+        return nullptr;
+    }
+
+    void testBackend (Manager& manager, std::string const& type,
+        std::int64_t const seedValue)
+    {
+        testcase ("Workload on backend '" + type + "'");
+
+        // The scheduler must outlive the backend's batch writer
+        WorkloadScheduler scheduler;
+
+        beast::StringPairArray params;
+        beast::File const path (beast::File::createTempFile ("node_db"));
+        params.set ("type", type);
+        params.set ("path", path.getFullPathName ());
+
+        beast::Journal j;
+        std::unique_ptr <Backend> backend (manager.make_Backend (
+            params, scheduler, j));
+
+        Tree tree (seedValue);
+        Results results;
+
+        {
+            Batch batch;
+            tree.getObjects (batch);
+
+            clock_type::time_point const start (clock_type::now ());
+            load (*backend, batch, results);
+            report (getOperationName (opLoad), results [opLoad],
+                microsSince (start) / 1e6);
+        }
+
+        std::vector <Results> readerResults (readerThreads);
+        std::vector <int> missing (readerThreads, 0);
+        Results writerResults;
+
+        clock_type::time_point const start (clock_type::now ());
+
+        std::vector <std::thread> threads;
+        for (int i = 0; i < readerThreads; ++i)
+        {
+            threads.emplace_back (&NodeStoreWorkload_test::read,
+                std::ref (*backend), std::cref (tree), seedValue + 1 + i,
+                    std::ref (readerResults [i]), std::ref (missing [i]));
+        }
+        threads.emplace_back (&NodeStoreWorkload_test::write,
+            std::ref (*backend), seedValue + 1 + readerThreads,
+                std::ref (writerResults));
+
+        for (auto& thread : threads)
+            thread.join ();
+
+        // Include the writes still queued in the batch writer
+        backend.reset ();
+        double const seconds (microsSince (start) / 1e6);
+
+        for (int i = 0; i < readerThreads; ++i)
+        {
+            expect (missing [i] == 0, "Should find every object");
+            for (int op = 0; op < opCount; ++op)
+                results [op].append (readerResults [i][op]);
+        }
+        results [opStore].append (writerResults [opStore]);
+        results [opBatchWrite] = scheduler.takeBatches ();
+
+        for (int op = 0; op < opCount; ++op)
+        {
+            if (op != opLoad)
+                report (getOperationName (op), results [op], seconds);
+        }
+    }
+
+    void run ()
+    {
+        std::int64_t const seedValue = 50;
+
+        // The same factories as the application's node store
+        std::vector <std::unique_ptr <Factory>> list;
+        list.emplace_back (make_SqliteFactory ());
+        std::unique_ptr <Manager> manager (make_Manager (std::move (list)));
+
+        for (Factory* factory : manager->getFactories ())
+        {
+            beast::String const type (factory->getName ());
+            char const* const reason (getSkipReason (type));
+
+            if (reason != nullptr)
+                log << "Skipping backend '" << type.toStdString () <<
+                    "' since " << reason;
+            else
+                testBackend (*manager, type.toStdString (), seedValue);
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(NodeStoreWorkload,ripple_app,ripple);
+
+}
+}
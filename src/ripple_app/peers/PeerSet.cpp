@@ -69,6 +69,46 @@ void PeerSet::badPeer (Peer::ptr const& ptr)
     mPeers.erase (ptr->getShortId ());
 }
 
+std::size_t PeerSet::addBestPeers (std::size_t limit,
+    std::function <bool (Peer::ptr const&)> hasItem)
+{
+    Overlay::PeerSequence const peerList = getApp().overlay ().getActivePeers ();
+
+    // Peers that have the item come first, then the best scores.
+    // The random key only orders peers that are otherwise equal.
+    struct Scored
+    {
+        bool haveItem;
+        int score;
+        int random;
+        Peer::ptr peer;
+    };
+
+    std::vector <Scored> scored;
+    scored.reserve (peerList.size ());
+    BOOST_FOREACH (Peer::ptr const& peer, peerList)
+    {
+        Scored const entry = { hasItem (peer), peer->getScore (), rand (), peer };
+        scored.push_back (entry);
+    }
+
+    std::size_t const count (std::min (limit, scored.size ()));
+    std::partial_sort (scored.begin (), scored.begin () + count, scored.end (),
+        [](Scored const& lhs, Scored const& rhs)
+        {
+            return std::tie (lhs.haveItem, lhs.score, lhs.random) >
+                std::tie (rhs.haveItem, rhs.score, rhs.random);
+        });
+
+    std::size_t added = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (peerHas (scored[i].peer))
+            ++added;
+    }
+    return added;
+}
+
 void PeerSet::setTimer ()
 {
     mTimer.expires_from_now (boost::posix_time::milliseconds (mTimerInterval));
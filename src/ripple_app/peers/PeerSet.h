@@ -93,6 +93,17 @@ public:
 
     void badPeer (Peer::ptr const&);
 
+    /** Adds the highest scoring active peers to the set.
+        Peers that are likely to have the item are asked first, and among
+        those the ones with the best Peer::getScore. Ties are broken at
+        random.
+        @param limit The largest number of peers to add.
+        @param hasItem Returns `true` if the peer is likely to have the item.
+        @return The number of peers added.
+    */
+    std::size_t addBestPeers (std::size_t limit,
+        std::function <bool (Peer::ptr const&)> hasItem);
+
     void setTimer ();
 
     std::size_t takePeerSetFrom (const PeerSet& s);
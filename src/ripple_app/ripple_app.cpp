@@ -27,6 +27,10 @@
 #include <boost/optional.hpp>
 #include <boost/version.hpp>
 
+#include <zlib.h>
+
+#include <fstream> // for HotSet.cpp
+
 #include "ripple_app.h"
 
 #include "../ripple_net/ripple_net.h"
@@ -60,6 +64,9 @@
 # include "main/FatalErrorReporter.h"
 #include "main/FatalErrorReporter.cpp"
 
+# include "main/HotSet.h"
+#include "main/HotSet.cpp"
+
 # include "rpc/RPCHandler.h"
 # include "rpc/RPCServerHandler.h"
 # include "main/RPCHTTPServer.h"
@@ -67,6 +74,8 @@
 #include "rpc/RPCServerHandler.cpp"
 #include "rpc/RPCHandler.cpp"
 
+# include "websocket/WSDeflate.h"
+#include "websocket/WSDeflate.cpp"
 #include "websocket/WSConnection.h"
 
 # include "tx/TxQueueEntry.h"
@@ -84,6 +93,7 @@
 
 # include "node/SqliteFactory.h"
 #include "node/SqliteFactory.cpp"
+#include "node/WorkloadTests.cpp"
 
 #include "main/Application.cpp"
 
@@ -60,6 +60,7 @@
 
 #include "../../ripple/common/KeyCache.h"
 #include "../../ripple/common/TaggedCache.h"
+#include "../../ripple/common/MemoryGovernor.h"
 
 #include "data/Database.h"
 #include "data/DatabaseCon.h"
@@ -72,6 +73,7 @@
 #include "shamap/SHAMapSyncFilter.h"
 #include "shamap/SHAMapAddNode.h"
 #include "shamap/SHAMap.h"
+#include "shamap/SHAMapIterator.h"
 #include "misc/SerializedTransaction.h"
 #include "misc/SerializedLedger.h"
 #include "tx/TransactionMeta.h"
@@ -100,13 +102,17 @@
 #include "ledger/DirectoryEntryIterator.h"
 #include "ledger/OrderBookIterator.h"
 #include "tx/TransactionEngine.h"
+#include "tx/ParallelTransactionEngine.h"
 #include "misc/CanonicalTXSet.h"
 #include "ledger/LedgerHolder.h"
 #include "ledger/LedgerHistory.h"
+#include "ledger/LedgerDiffCache.h"
+#include "ledger/LedgerExport.h"
 #include "ledger/LedgerCleaner.h"
 #include "ledger/LedgerMaster.h"
 #include "ledger/LedgerProposal.h"
 #include "misc/NetworkOPs.h"
+#include "misc/SubscriptionIndex.h"
 #include "tx/TransactionMaster.h"
 #include "main/LocalCredentials.h"
 #include "main/Application.h"
@@ -116,6 +122,7 @@
 #include "consensus/DisputedTx.h"
 #include "consensus/LedgerConsensus.h"
 #include "ledger/LedgerTiming.h"
+#include "ledger/LedgerReplayer.h"
 #include "misc/Offer.h"
 #include "paths/RippleLineCache.h"
 #include "paths/PathRequest.h"
@@ -45,3 +45,4 @@
 # include "ledger/LedgerCleaner.h"
 #include "ledger/LedgerCleaner.cpp"
 #include "ledger/LedgerMaster.cpp"
+#include "ledger/LedgerReplayer.cpp"
@@ -26,6 +26,7 @@
 #include "shamap/SHAMap.cpp" // Uses theApp
 #include "shamap/SHAMapItem.cpp"
 #include "shamap/SHAMapSync.cpp"
+#include "shamap/SHAMapIterator.cpp"
 #include "shamap/SHAMapMissingNode.cpp"
 
 #include "misc/AccountItem.cpp"
@@ -36,6 +36,7 @@
 #include "tx/TransactionMaster.cpp"
 #include "tx/Transaction.cpp"
 #include "tx/TransactionEngine.cpp"
+#include "tx/ParallelTransactionEngine.cpp"
 #include "tx/TransactionMeta.cpp"
 
 #include "book/tests/OfferStream.test.cpp"
@@ -27,10 +27,13 @@
 
 #include "ledger/InboundLedgers.cpp"
 #include "ledger/LedgerHistory.cpp"
+#include "ledger/LedgerDiffCache.cpp"
+#include "ledger/LedgerExport.cpp"
 #include "misc/SerializedLedger.cpp"
 #include "tx/TransactionAcquire.cpp"
 
 # include "tx/TxQueueEntry.h"
 # include "tx/TxQueue.h"
 # include "tx/LocalTxs.cpp"
+#include "misc/SubscriptionIndex.cpp"
 #include "misc/NetworkOPs.cpp"
@@ -30,6 +30,8 @@ SETUP_LOG (RPCHandler)
 RPCHandler::RPCHandler (NetworkOPs* netOps)
     : mNetOps (netOps)
     , mRole (Config::FORBID)
+    , mStreaming (false)
+    , mTiming (nullptr)
 {
 }
 
@@ -37,6 +39,8 @@ RPCHandler::RPCHandler (NetworkOPs* netOps, InfoSub::pointer infoSub)
     : mNetOps (netOps)
     , mInfoSub (infoSub)
     , mRole (Config::FORBID)
+    , mStreaming (false)
+    , mTiming (nullptr)
 {
 }
 
@@ -127,6 +131,7 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         {   "blacklist",            &RPCHandler::doBlackList,           true,   optNone     },
         {   "book_offers",          &RPCHandler::doBookOffers,          false,  optCurrent  },
         {   "connect",              &RPCHandler::doConnect,             true,   optNone     },
+        {   "cpu_profile",          &RPCHandler::doCPUProfile,          true,   optNone     },
         {   "consensus_info",       &RPCHandler::doConsensusInfo,       true,   optNone     },
         {   "get_counts",           &RPCHandler::doGetCounts,           true,   optNone     },
         {   "internal",             &RPCHandler::doInternal,            true,   optNone     },
@@ -139,6 +144,7 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         {   "ledger_current",       &RPCHandler::doLedgerCurrent,       false,  optCurrent  },
         {   "ledger_data",          &RPCHandler::doLedgerData,          false,  optCurrent  },
         {   "ledger_entry",         &RPCHandler::doLedgerEntry,         false,  optCurrent  },
+        {   "ledger_export",        &RPCHandler::doLedgerExport,        true,   optCurrent  },
         {   "ledger_header",        &RPCHandler::doLedgerHeader,        false,  optCurrent  },
         {   "log_level",            &RPCHandler::doLogLevel,            true,   optNone     },
         {   "logrotate",            &RPCHandler::doLogRotate,           true,   optNone     },
@@ -154,6 +160,7 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         {   "proof_verify",         &RPCHandler::doProofVerify,         true,   optNone     },
         {   "random",               &RPCHandler::doRandom,              false,  optNone     },
         {   "ripple_path_find",     &RPCHandler::doRipplePathFind,      false,  optCurrent  },
+        {   "rpc_latency",          &RPCHandler::doRPCLatency,          true,   optNone     },
         {   "sign",                 &RPCHandler::doSign,                false,  optNone     },
         {   "submit",               &RPCHandler::doSubmit,              false,  optCurrent  },
         {   "server_info",          &RPCHandler::doServerInfo,          false,  optNone     },
@@ -195,9 +202,18 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         return rpcError (rpcNO_PERMISSION);
     }
 
+    typedef RPC::LatencyTracker::clock_type clock_type;
+
+    if (mTiming != nullptr)
+        mTiming->setCommand (strCommand);
+
     {
+        clock_type::time_point const lockStart (clock_type::now ());
         Application::ScopedLockType lock (getApp().getMasterLock ());
 
+        if (mTiming != nullptr)
+            mTiming->add (RPC::LatencyTracker::phaseLock, lockStart);
+
         if ((commandsA[i].iOptions & optNetwork) && (mNetOps->getOperatingMode () < NetworkOPs::omSYNCING))
         {
             WriteLog (lsINFO, RPCHandler) << "Insufficient network mode for RPC: " << mNetOps->strOperatingMode ();
@@ -215,12 +231,17 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
         }
         else
         {
+            clock_type::time_point const executeStart (clock_type::now ());
+
             try
             {
                 LoadEvent::autoptr ev   = getApp().getJobQueue().getLoadEventAP(
                     jtGENERIC, std::string("cmd:") + strCommand);
                 Json::Value jvRaw       = (this->* (commandsA[i].dfpFunc)) (params, loadType, lock);
 
+                if (mTiming != nullptr)
+                    mTiming->add (RPC::LatencyTracker::phaseExecute, executeStart);
+
                 // Regularize result.
                 if (jvRaw.isObject ())
                 {
@@ -239,6 +260,9 @@ Json::Value RPCHandler::doCommand (const Json::Value& params, int iRole, Resourc
             }
             catch (std::exception& e)
             {
+                if (mTiming != nullptr)
+                    mTiming->add (RPC::LatencyTracker::phaseExecute, executeStart);
+
                 WriteLog (lsINFO, RPCHandler) << "Caught throw: " << e.what ();
 
                 if (loadType == Resource::feeReferenceRPC)
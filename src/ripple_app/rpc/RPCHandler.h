@@ -48,6 +48,48 @@ public:
 
     Json::Value doRpcCommand    (const std::string& strCommand, Json::Value const& jvParams, int iRole, Resource::Charge& loadType);
 
+    /** Writes a member of the result directly to a stream.
+        Commands that can produce very large results may leave a member
+        out of the returned Json::Value and provide a Streamer for it
+        instead, when the transport has enabled streaming.
+    */
+    typedef std::function <void (Json::Stream&)> Streamer;
+
+    /** Set whether the transport can accept a streamed member. */
+    void setStreaming (bool streaming)
+    {
+        mStreaming = streaming;
+    }
+
+    /** Returns the streamer for the last command, if any. */
+    Streamer const& getStreamer () const
+    {
+        return mStreamer;
+    }
+
+    /** Returns the name of the member written by the streamer. */
+    std::string const& getStreamKey () const
+    {
+        return mStreamKey;
+    }
+
+    /** Writes a binary response in place of the JSON result.
+        Only provided when the transport has enabled streaming.
+    */
+    typedef std::function <void (Json::Stream::Sink&)> Exporter;
+
+    /** Returns the exporter for the last command, if any. */
+    Exporter const& getExporter () const
+    {
+        return mExporter;
+    }
+
+    /** Set where to record the lock wait and execution time of commands. */
+    void setTiming (RPC::LatencyTracker::Timing* timing)
+    {
+        mTiming = timing;
+    }
+
 private:
     typedef Json::Value (RPCHandler::*doFuncPtr) (
         Json::Value params,
@@ -74,6 +116,7 @@ private:
     Json::Value doAccountTxOld          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doBookOffers            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doBlackList             (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
+    Json::Value doCPUProfile            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doConnect               (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doConsensusInfo         (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doFeature               (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
@@ -87,6 +130,7 @@ private:
     Json::Value doLedgerCurrent         (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerData            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerEntry           (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
+    Json::Value doLedgerExport          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLedgerHeader          (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLogLevel              (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doLogRotate             (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
@@ -101,6 +145,7 @@ private:
     Json::Value doProofSolve            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doProofVerify           (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doRandom                (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
+    Json::Value doRPCLatency            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doRipplePathFind        (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doSMS                   (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh);
     Json::Value doServerInfo            (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& mlh); // for humans
@@ -138,6 +183,13 @@ private:
 
     // VFALCO TODO Create an enumeration for this.
     int                 mRole;
+
+    bool                mStreaming;
+    std::string         mStreamKey;
+    Streamer            mStreamer;
+    Exporter            mExporter;
+
+    RPC::LatencyTracker::Timing* mTiming;
 };
 
 class RPCInternalHandler
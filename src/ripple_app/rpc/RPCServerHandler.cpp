@@ -41,12 +41,41 @@ bool RPCServerHandler::isAuthorized (
 std::string RPCServerHandler::processRequest (std::string const& request,
                                               beast::IP::Endpoint const& remoteIPAddress)
 {
+    // Requests here are handled as they arrive, so there is no queue time
+    RPC::LatencyTracker::Timing timing ("rpc",
+        RPC::LatencyTracker::clock_type::now ());
+    std::string const response (process (
+        request, remoteIPAddress, nullptr, timing));
+    getApp().getRPCLatency ().record (timing);
+    return response;
+}
+
+void RPCServerHandler::processRequest (std::string const& request,
+                                       beast::IP::Endpoint const& remoteIPAddress,
+                                       Json::Stream::Sink& sink,
+                                       RPC::LatencyTracker::Timing& timing)
+{
+    std::string const response (process (
+        request, remoteIPAddress, &sink, timing));
+
+    if (! response.empty ())
+        sink.write (response.data (), response.size ());
+}
+
+// When sink is provided and the command streamed its result, the
+// response is written to the sink and an empty string is returned.
+std::string RPCServerHandler::process (std::string const& request,
+                                       beast::IP::Endpoint const& remoteIPAddress,
+                                       Json::Stream::Sink* sink,
+                                       RPC::LatencyTracker::Timing& timing)
+{
+    typedef RPC::LatencyTracker::clock_type clock_type;
+
     Json::Value jsonRequest;
     {
-        Json::Reader reader;
+        Json::Parser parser;
 
-        if ((request.size() > 1000000) ||
-            ! reader.parse (request, jsonRequest) ||
+        if (! parser.parse (request, jsonRequest) ||
             jsonRequest.isNull () ||
             ! jsonRequest.isObject ())
         {
@@ -127,18 +156,26 @@ std::string RPCServerHandler::processRequest (std::string const& request,
             strMethod, ripple_params, getApp ());
 
         // VFALCO Try processing the command using the new code
+        clock_type::time_point const start (clock_type::now ());
         if (getApp().getRPCManager().dispatch (req))
         {
+            timing.setCommand (strMethod);
+            timing.add (RPC::LatencyTracker::phaseExecute, start);
             usage.charge (req.fee);
             WriteLog (lsDEBUG, RPCServer) << "Reply: " << req.result;
-            return createResponse (200,
+            clock_type::time_point const serializeStart (clock_type::now ());
+            response = createResponse (200,
                 JSONRPCReply (req.result, Json::Value (), id));
+            timing.add (RPC::LatencyTracker::phaseSerialize, serializeStart);
+            return response;
         }
     }
 
     // legacy dispatcher
     Resource::Charge fee (Resource::feeReferenceRPC);
     RPCHandler rpcHandler (&m_networkOPs);
+    rpcHandler.setStreaming (sink != nullptr);
+    rpcHandler.setTiming (&timing);
     Json::Value const result = rpcHandler.doRpcCommand (
         strMethod, params, role, fee);
 
@@ -146,9 +183,113 @@ std::string RPCServerHandler::processRequest (std::string const& request,
 
     WriteLog (lsDEBUG, RPCServer) << "Reply: " << result;
 
-    response = JSONRPCReply (result, Json::Value (), id);
+    // A streamed member is produced while it is written, so
+    // for those commands serializing includes building it.
+    clock_type::time_point const serializeStart (clock_type::now ());
+
+    if (rpcHandler.getExporter ())
+    {
+        writeExported (*sink, rpcHandler);
+        timing.add (RPC::LatencyTracker::phaseSerialize, serializeStart);
+        return std::string ();
+    }
+
+    if (rpcHandler.getStreamer ())
+    {
+        writeStreamed (*sink, result, rpcHandler);
+        timing.add (RPC::LatencyTracker::phaseSerialize, serializeStart);
+        return std::string ();
+    }
+
+    response = createResponse (200,
+        JSONRPCReply (result, Json::Value (), id));
+    timing.add (RPC::LatencyTracker::phaseSerialize, serializeStart);
+
+    return response;
+}
+
+// Writes the same text as JSONRPCReply and HTTPReply would, with the
+// streamed member placed where Json::Value would have ordered it.
+void RPCServerHandler::writeStreamed (Json::Stream::Sink& sink,
+    Json::Value const& result, RPCHandler const& handler)
+{
+    std::string const header (HTTPStreamHeader (200));
+    sink.write (header.data (), header.size ());
+
+    {
+        Json::Stream stream (sink);
+        bool streamed (false);
+
+        stream.startObject ();
+        stream.startObject (jss::result);
+
+        Json::Value::Members const members (result.getMemberNames ());
+
+        for (auto const& member : members)
+        {
+            if (! streamed && member.compare (handler.getStreamKey ()) > 0)
+            {
+                handler.getStreamer () (stream);
+                streamed = true;
+            }
+
+            stream.set (member, result[member]);
+        }
+
+        if (! streamed)
+            handler.getStreamer () (stream);
+
+        stream.end ();
+        stream.end ();
+    }
+
+    static char const trailer [] = "\n\n\r\n";
+    sink.write (trailer, sizeof (trailer) - 1);
+}
+
+// Sends what the exporter writes as one chunk per write. Without the
+// final empty chunk the client knows the body is incomplete.
+void RPCServerHandler::writeExported (Json::Stream::Sink& sink,
+    RPCHandler const& handler)
+{
+    class ChunkedSink : public Json::Stream::Sink
+    {
+    public:
+        explicit ChunkedSink (Json::Stream::Sink& sink)
+            : m_sink (sink)
+        {
+        }
+
+        void write (char const* data, std::size_t bytes)
+        {
+            if (bytes == 0)
+                return;
+
+            static char const digits [] = "0123456789abcdef";
+
+            // The chunk size in hex, most significant digit first
+            std::string size ("\r\n");
+            for (std::size_t n = bytes; n != 0; n >>= 4)
+                size.insert (size.begin (), digits [n & 0xf]);
+
+            m_sink.write (size.data (), size.size ());
+            m_sink.write (data, bytes);
+            m_sink.write ("\r\n", 2);
+        }
+
+    private:
+        Json::Stream::Sink& m_sink;
+    };
+
+    std::string const header (HTTPChunkedHeader (200,
+        "application/octet-stream"));
+    sink.write (header.data (), header.size ());
+
+    ChunkedSink chunked (sink);
+    handler.getExporter () (chunked);
 
-    return createResponse (200, response);
+    static char const trailer [] = "0\r\n\r\n";
+    sink.write (trailer, sizeof (trailer) - 1);
 }
 
 }
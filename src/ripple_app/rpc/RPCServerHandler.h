@@ -38,7 +38,29 @@ public:
     std::string processRequest (std::string const& request,
                                 beast::IP::Endpoint const& remoteIPAddress);
 
+    /** Process a request, writing the response to a sink.
+        Commands which support it stream large results into the sink
+        instead of building the complete response first. A streamed
+        response is ended by closing the connection. The time spent in
+        each phase of the request is added to timing, which the caller
+        records once the response is sent.
+    */
+    void processRequest (std::string const& request,
+                         beast::IP::Endpoint const& remoteIPAddress,
+                         Json::Stream::Sink& sink,
+                         RPC::LatencyTracker::Timing& timing);
+
 private:
+    std::string process (std::string const& request,
+                         beast::IP::Endpoint const& remoteIPAddress,
+                         Json::Stream::Sink* sink,
+                         RPC::LatencyTracker::Timing& timing);
+
+    void writeStreamed (Json::Stream::Sink& sink, Json::Value const& result,
+                        RPCHandler const& handler);
+
+    void writeExported (Json::Stream::Sink& sink, RPCHandler const& handler);
+
     NetworkOPs& m_networkOPs;
     Resource::Manager& m_resourceManager;
 };
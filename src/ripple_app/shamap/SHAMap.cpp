@@ -38,6 +38,7 @@ SHAMap::SHAMap (SHAMapType t, FullBelowCache& fullBelowCache, std::uint32_t seq,
     , mState (smsModifying)
     , mType (t)
     , mTXMap (false)
+    , mGeneration (0)
     , m_missing_node_handler (missing_node_handler)
 {
     assert (mSeq != 0);
@@ -57,6 +58,7 @@ SHAMap::SHAMap (SHAMapType t, uint256 const& hash, FullBelowCache& fullBelowCach
     , mState (smsSynching)
     , mType (t)
     , mTXMap (false)
+    , mGeneration (0)
     , m_missing_node_handler (missing_node_handler)
 {
     if (t == smtSTATE)
@@ -72,6 +74,10 @@ TaggedCache <uint256, SHAMapTreeNode>
         get_seconds_clock (),
             LogPartition::getJournal <TaggedCacheLog> ());
 
+std::atomic <std::uint64_t> SHAMap::s_fetchCount (0);
+std::atomic <std::uint64_t> SHAMap::s_storeFetchCount (0);
+std::atomic <std::uint64_t> SHAMap::s_fetchMissCount (0);
+
 SHAMap::~SHAMap ()
 {
     mState = smsInvalid;
@@ -427,7 +433,7 @@ SHAMapTreeNode* SHAMap::lastBelow (SHAMapTreeNode* node)
 
         bool foundNode = false;
 
-        for (int i = 15; i >= 0; ++i)
+        for (int i = 15; i >= 0; --i)
             if (!node->isEmptyBranch (i))
             {
                 node = getNodePointer (node->getChildNodeID (i), node->getChildHash (i));
@@ -615,7 +621,7 @@ SHAMapItem::pointer SHAMap::peekPrevItem (uint256 const& id)
                 if (!node->isEmptyBranch (i))
                 {
                     node = getNode (node->getChildNodeID (i), node->getChildHash (i), false);
-                    SHAMapTreeNode* item = firstBelow (node.get ());
+                    SHAMapTreeNode* item = lastBelow (node.get ());
 
                     if (!item)
                         throw (std::runtime_error ("missing node"));
@@ -683,6 +689,7 @@ bool SHAMap::delItem (uint256 const& id)
     // delete the item with this ID
     ScopedWriteLockType sl (mLock);
     assert (mState != smsImmutable);
+    ++mGeneration;
 
     std::stack<SHAMapTreeNode::pointer> stack = getStack (id, true);
 
@@ -764,6 +771,7 @@ bool SHAMap::addGiveItem (SHAMapItem::ref item, bool isTransaction, bool hasMeta
 
     ScopedWriteLockType sl (mLock);
     assert (mState != smsImmutable);
+    ++mGeneration;
 
     std::stack<SHAMapTreeNode::pointer> stack = getStack (tag, true);
 
@@ -862,6 +870,7 @@ bool SHAMap::updateGiveItem (SHAMapItem::ref item, bool isTransaction, bool hasM
 
     ScopedWriteLockType sl (mLock);
     assert (mState != smsImmutable);
+    ++mGeneration;
 
     std::stack<SHAMapTreeNode::pointer> stack = getStack (tag, true);
 
@@ -994,6 +1003,8 @@ SHAMapTreeNode::pointer SHAMap::fetchNodeExternalNT (const SHAMapNode& id, uint2
     if (!getApp().running ())
         return ret;
 
+    ++s_fetchCount;
+
     // Check the cache of shared, immutable tree nodes
     ret = getCache (hash, id);
     if (ret)
@@ -1003,9 +1014,12 @@ SHAMapTreeNode::pointer SHAMap::fetchNodeExternalNT (const SHAMapNode& id, uint2
     }
     else
     { // Check the back end
+        ++s_storeFetchCount;
         NodeObject::pointer obj (getApp ().getNodeStore ().fetch (hash));
         if (!obj)
         {
+            ++s_fetchMissCount;
+
             if (mLedgerSeq != 0)
             {
                 m_missing_node_handler (mLedgerSeq);
@@ -1310,6 +1324,18 @@ void SHAMap::canonicalize (uint256 const& hash, SHAMapTreeNode::pointer& node)
     treeNodeCache.canonicalize (hash, node);
 }
 
+std::size_t SHAMap::getTreeNodeBytes (SHAMapTreeNode const& node)
+{
+    // The node itself, the shared pointer control block and the
+    // cache entry, plus the item held by a leaf.
+    std::size_t bytes = sizeof (SHAMapTreeNode) + 64;
+
+    if (node.mItem)
+        bytes += sizeof (SHAMapItem) + node.mItem->peekData ().capacity ();
+
+    return bytes;
+}
+
 //------------------------------------------------------------------------------
 
 class SHAMap_test : public beast::unit_test::suite
@@ -1384,7 +1410,6 @@ public:
         unexpected (!!i, "bad traverse");
 
 
-
         testcase ("snapshot");
 
         uint256 mapHash = sMap.getHash ();
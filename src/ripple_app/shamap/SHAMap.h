@@ -269,7 +269,13 @@ public:
     typedef std::pair <uint256, Blob> fetchPackEntry_t;
 
     std::list<fetchPackEntry_t> getFetchPack (SHAMap * have, bool includeLeaves, int max);
-    void getFetchPack (SHAMap * have, bool includeLeaves, int max, std::function<void (const uint256&, const Blob&)>);
+
+    /** Visit the nodes of this map that are not in another map.
+        Children that are not in memory are read from the node store in
+        batches, one inner node at a time.
+        @return `false` if the other map was busy and nothing was visited.
+    */
+    bool getFetchPack (SHAMap * have, bool includeLeaves, int max, std::function<void (const uint256&, const Blob&)>);
 
     // VFALCO NOTE These static members should be moved into a
     //             new Application singleton class.
@@ -283,6 +289,28 @@ public:
         return treeNodeCache.getCacheSize ();
     }
 
+    static float getTreeNodeHitRate ()
+    {
+        return treeNodeCache.getHitRate ();
+    }
+
+    // Number of nodes fetched from outside a map, how many of those had to
+    // go to the node store, and how many could not be found at all.
+    static std::uint64_t getFetchCount ()
+    {
+        return s_fetchCount.load ();
+    }
+
+    static std::uint64_t getStoreFetchCount ()
+    {
+        return s_storeFetchCount.load ();
+    }
+
+    static std::uint64_t getFetchMissCount ()
+    {
+        return s_fetchMissCount.load ();
+    }
+
     static void sweep ()
     {
         treeNodeCache.sweep ();
@@ -294,6 +322,30 @@ public:
         treeNodeCache.setTargetAge (age);
     }
 
+    // Limit the tree node cache by memory, zero means by count only
+    static void setTreeCacheBytes (std::size_t bytes)
+    {
+        treeNodeCache.setTargetBytes (bytes, &SHAMap::getTreeNodeBytes);
+    }
+
+    // Let the governor budget and sweep the tree node cache
+    static void setTreeCacheGovernor (MemoryGovernor& governor, int weight)
+    {
+        governor.add ("tree_node", treeNodeCache, &SHAMap::getTreeNodeBytes, weight);
+    }
+
+    static void setTreeCacheCollector (beast::insight::Collector::ptr const& collector)
+    {
+        treeNodeCache.setCollector (collector);
+    }
+
+    // The hashes of the most recently used cached inner nodes
+    static std::vector <uint256> getHotInnerNodes (std::size_t limit)
+    {
+        return treeNodeCache.getHotKeys (limit,
+            [] (SHAMapTreeNode const& node) { return node.isInner (); });
+    }
+
     void setTXMap ()
     {
         mTXMap = true;
@@ -303,6 +355,10 @@ public:
 
 private:
     static TaggedCache <uint256, SHAMapTreeNode> treeNodeCache;
+    static std::size_t getTreeNodeBytes (SHAMapTreeNode const& node);
+    static std::atomic <std::uint64_t> s_fetchCount;
+    static std::atomic <std::uint64_t> s_storeFetchCount;
+    static std::atomic <std::uint64_t> s_fetchMissCount;
 
     void dirtyUp (std::stack<SHAMapTreeNode::pointer>& stack, uint256 const & target, uint256 prevHash);
     std::stack<SHAMapTreeNode::pointer> getStack (uint256 const & id, bool include_nonmatching_leaf);
@@ -338,6 +394,7 @@ private:
     void visitLeavesInternal (std::function<void (SHAMapItem::ref item)>& function);
 
 private:
+    friend class SHAMapIterator;
 
     // This lock protects key SHAMap structures.
     // One may change anything with a write lock.
@@ -353,6 +410,10 @@ private:
     SHAMapState mState;
     SHAMapType mType;
     bool mTXMap;       // Map of transactions without metadata
+
+    // Counts changes to the items, so iterators know to find their path again
+    std::uint64_t mGeneration;
+
     MissingNodeHandler m_missing_node_handler;
 };
 
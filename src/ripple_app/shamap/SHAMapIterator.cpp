@@ -0,0 +1,415 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+// Holds the read lock of a mutable map, and tells whether the map
+// changed since the iterator last looked at it.
+class SHAMapIterator::ScopedRead
+{
+public:
+    explicit ScopedRead (SHAMapIterator& iterator)
+        : m_lock (iterator.m_map->mLock, boost::defer_lock)
+        , m_changed (false)
+    {
+        if (iterator.m_locking)
+        {
+            m_lock.lock ();
+            m_changed = iterator.m_generation != iterator.m_map->mGeneration;
+            iterator.m_generation = iterator.m_map->mGeneration;
+        }
+    }
+
+    bool changed () const
+    {
+        return m_changed;
+    }
+
+private:
+    SHAMap::ScopedReadLockType m_lock;
+    bool m_changed;
+};
+
+//------------------------------------------------------------------------------
+
+SHAMapIterator::SHAMapIterator (SHAMap::ref map)
+    : m_map (map)
+    , m_locking (! map->isImmutable ())
+    , m_generation (0)
+    , m_type (SHAMapTreeNode::tnERROR)
+{
+}
+
+bool SHAMapIterator::first ()
+{
+    ScopedRead lock (*this);
+    m_item.reset ();
+    m_path.clear ();
+    return descendFirst (m_map->root) && found ();
+}
+
+bool SHAMapIterator::last ()
+{
+    ScopedRead lock (*this);
+    m_item.reset ();
+    m_path.clear ();
+    return descendLast (m_map->root) && found ();
+}
+
+bool SHAMapIterator::seekAfter (uint256 const& key)
+{
+    ScopedRead lock (*this);
+    m_item.reset ();
+    descendTo (key);
+    return successor (key) && found ();
+}
+
+bool SHAMapIterator::seekBefore (uint256 const& key)
+{
+    ScopedRead lock (*this);
+    m_item.reset ();
+    descendTo (key);
+    return predecessor (key) && found ();
+}
+
+bool SHAMapIterator::next ()
+{
+    assert (valid ());
+    ScopedRead lock (*this);
+    uint256 const key (getKey ());
+    m_item.reset ();
+
+    // The nodes on our path may have been replaced
+    if (lock.changed ())
+        descendTo (key);
+
+    return successor (key) && found ();
+}
+
+bool SHAMapIterator::prev ()
+{
+    assert (valid ());
+    ScopedRead lock (*this);
+    uint256 const key (getKey ());
+    m_item.reset ();
+
+    if (lock.changed ())
+        descendTo (key);
+
+    return predecessor (key) && found ();
+}
+
+//------------------------------------------------------------------------------
+
+SHAMapTreeNode::pointer SHAMapIterator::getChild (
+    SHAMapTreeNode::ref node, int branch)
+{
+    return m_map->getNode (node->getChildNodeID (branch),
+        node->getChildHash (branch), false);
+}
+
+// Extends the path to the first leaf below a node
+bool SHAMapIterator::descendFirst (SHAMapTreeNode::pointer node)
+{
+    while (node)
+    {
+        m_path.push_back (node);
+
+        if (! node->isInner ())
+            return true;
+
+        int branch = 0;
+        while ((branch < 16) && node->isEmptyBranch (branch))
+            ++branch;
+
+        // Only an empty root has no children
+        if (branch == 16)
+            break;
+
+        node = getChild (node, branch);
+    }
+
+    m_path.clear ();
+    return false;
+}
+
+bool SHAMapIterator::descendLast (SHAMapTreeNode::pointer node)
+{
+    while (node)
+    {
+        m_path.push_back (node);
+
+        if (! node->isInner ())
+            return true;
+
+        int branch = 15;
+        while ((branch >= 0) && node->isEmptyBranch (branch))
+            --branch;
+
+        if (branch < 0)
+            break;
+
+        node = getChild (node, branch);
+    }
+
+    m_path.clear ();
+    return false;
+}
+
+// Sets the path to the nodes leading towards a key. It ends at the leaf
+// in the key's position, or at the inner node whose branch for the key
+// is empty.
+void SHAMapIterator::descendTo (uint256 const& key)
+{
+    m_path.clear ();
+
+    SHAMapTreeNode::pointer node (m_map->root);
+
+    while (node)
+    {
+        m_path.push_back (node);
+
+        if (! node->isInner ())
+            break;
+
+        int const branch = node->selectBranch (key);
+
+        if (node->isEmptyBranch (branch))
+            break;
+
+        node = getChild (node, branch);
+    }
+}
+
+// With a path leading towards a key, moves to the first item above it.
+// The branches of each inner node on the path up to the key's own have
+// been visited, or hold smaller keys.
+bool SHAMapIterator::successor (uint256 const& key)
+{
+    if (! m_path.empty () && ! m_path.back ()->isInner ())
+    {
+        if (m_path.back ()->peekItem ()->getTag () > key)
+            return true;
+
+        m_path.pop_back ();
+    }
+
+    while (! m_path.empty ())
+    {
+        SHAMapTreeNode::pointer const node (m_path.back ());
+
+        for (int branch = node->selectBranch (key) + 1; branch < 16; ++branch)
+        {
+            if (! node->isEmptyBranch (branch))
+                return descendFirst (getChild (node, branch));
+        }
+
+        m_path.pop_back ();
+    }
+
+    return false;
+}
+
+bool SHAMapIterator::predecessor (uint256 const& key)
+{
+    if (! m_path.empty () && ! m_path.back ()->isInner ())
+    {
+        if (m_path.back ()->peekItem ()->getTag () < key)
+            return true;
+
+        m_path.pop_back ();
+    }
+
+    while (! m_path.empty ())
+    {
+        SHAMapTreeNode::pointer const node (m_path.back ());
+
+        for (int branch = node->selectBranch (key) - 1; branch >= 0; --branch)
+        {
+            if (! node->isEmptyBranch (branch))
+                return descendLast (getChild (node, branch));
+        }
+
+        m_path.pop_back ();
+    }
+
+    return false;
+}
+
+// Takes the item from the leaf at the end of the path
+bool SHAMapIterator::found ()
+{
+    SHAMapTreeNode::ref leaf (m_path.back ());
+    m_item = leaf->peekItem ();
+    m_type = leaf->getType ();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+class SHAMapIterator_test : public beast::unit_test::suite
+{
+public:
+    typedef std::set <uint256> Keys;
+
+    static uint256 makeKey (int i)
+    {
+        Serializer s;
+        s.add32 (i);
+        return s.getSHA512Half ();
+    }
+
+    // Keys of the items visited from the first item to the last
+    static std::vector <uint256> forward (SHAMapIterator& it)
+    {
+        std::vector <uint256> keys;
+        for (bool more = it.first (); more; more = it.next ())
+            keys.push_back (it.getKey ());
+        return keys;
+    }
+
+    static std::vector <uint256> backward (SHAMapIterator& it)
+    {
+        std::vector <uint256> keys;
+        for (bool more = it.last (); more; more = it.prev ())
+            keys.push_back (it.getKey ());
+        return keys;
+    }
+
+    void testEmpty (FullBelowCache& fullBelowCache)
+    {
+        testcase ("empty");
+
+        SHAMap::pointer map (boost::make_shared <SHAMap> (
+            smtFREE, std::ref (fullBelowCache)));
+        SHAMapIterator it (map);
+
+        expect (! it.first () && ! it.valid (), "first in empty map");
+        expect (! it.last (), "last in empty map");
+        expect (! it.seekAfter (uint256 ()), "seekAfter in empty map");
+        expect (! it.seekBefore (makeKey (1)), "seekBefore in empty map");
+    }
+
+    void testOrder (FullBelowCache& fullBelowCache)
+    {
+        testcase ("order");
+
+        SHAMap::pointer map (boost::make_shared <SHAMap> (
+            smtFREE, std::ref (fullBelowCache)));
+        Keys keys;
+
+        for (int i = 0; i < 500; ++i)
+        {
+            uint256 const key (makeKey (i));
+            keys.insert (key);
+            map->addItem (SHAMapItem (key, Blob (8, i & 0xff)), false, false);
+        }
+
+        SHAMapIterator it (map);
+        std::vector <uint256> const expected (keys.begin (), keys.end ());
+        expect (forward (it) == expected, "bad forward walk");
+        expect (backward (it) == std::vector <uint256> (
+            expected.rbegin (), expected.rend ()), "bad backward walk");
+
+        // Seek to keys in the map and to keys between them
+        bool seeks (true);
+        for (int i = 0; i < 1000; ++i)
+        {
+            uint256 const key (makeKey (i));
+
+            Keys::const_iterator const after (keys.upper_bound (key));
+            if (it.seekAfter (key) != (after != keys.end ()) ||
+                    (it.valid () && it.getKey () != *after))
+                seeks = false;
+
+            Keys::const_iterator const before (keys.lower_bound (key));
+            if (it.seekBefore (key) != (before != keys.begin ()) ||
+                    (it.valid () && it.getKey () != *std::prev (before)))
+                seeks = false;
+        }
+        expect (seeks, "bad seek");
+
+        // A range between two keys
+        uint256 const begin (expected[100]);
+        uint256 const end (expected[200]);
+        std::vector <uint256> range;
+        for (bool more = it.seekAfter (begin); more && it.getKey () < end;
+                more = it.next ())
+            range.push_back (it.getKey ());
+        expect (range == std::vector <uint256> (
+            expected.begin () + 101, expected.begin () + 200), "bad range");
+
+        // An immutable snapshot is walked without locking
+        SHAMap::pointer snap (map->snapShot (false));
+        SHAMapIterator snapIt (snap);
+        expect (forward (snapIt) == expected, "bad snapshot walk");
+    }
+
+    void testModify (FullBelowCache& fullBelowCache)
+    {
+        testcase ("modify");
+
+        SHAMap::pointer map (boost::make_shared <SHAMap> (
+            smtFREE, std::ref (fullBelowCache)));
+        Keys keys;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            uint256 const key (makeKey (i));
+            keys.insert (key);
+            map->addItem (SHAMapItem (key, Blob (8, 1)), false, false);
+        }
+
+        // Delete the item after the current one, and add one further on
+        SHAMapIterator it (map);
+        expect (it.seekAfter (*keys.begin ()), "no second item");
+
+        Keys::iterator next (std::next (keys.find (it.getKey ())));
+        map->delItem (*next);
+        keys.erase (next);
+
+        uint256 const added (makeKey (1000));
+        map->addItem (SHAMapItem (added, Blob (8, 2)), false, false);
+        keys.insert (added);
+
+        std::vector <uint256> seen;
+        seen.push_back (it.getKey ());
+        while (it.next ())
+            seen.push_back (it.getKey ());
+
+        expect (seen == std::vector <uint256> (
+            std::next (keys.begin ()), keys.end ()), "bad walk after change");
+    }
+
+    void run ()
+    {
+        FullBelowCache fullBelowCache ("test.full_below",
+            get_seconds_clock ());
+
+        testEmpty (fullBelowCache);
+        testOrder (fullBelowCache);
+        testModify (fullBelowCache);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SHAMapIterator,ripple_app,ripple);
+
+}
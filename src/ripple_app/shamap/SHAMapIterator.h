@@ -0,0 +1,130 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAPITERATOR_H_INCLUDED
+#define RIPPLE_SHAMAPITERATOR_H_INCLUDED
+
+namespace ripple {
+
+/** Visits the items of a SHAMap in key order.
+
+    The iterator keeps the path from the root to its current item, so
+    moving to a neighbouring item only visits the nodes between the two
+    instead of descending from the root again.
+
+    An iterator over an immutable map never locks it. Over a mutable map
+    each operation takes the read lock, and if the map was changed since
+    the last operation the path is found again from the current key.
+
+    To visit the keys in a range:
+
+    @code
+        for (bool more = it.seekAfter (begin); more && it.getKey () < end;
+                more = it.next ())
+            ...
+    @endcode
+*/
+class SHAMapIterator
+{
+public:
+    explicit SHAMapIterator (SHAMap::ref map);
+
+    SHAMap::ref getMap () const
+    {
+        return m_map;
+    }
+
+    /** Returns `true` if the iterator is positioned at an item. */
+    bool valid () const
+    {
+        return m_item != nullptr;
+    }
+
+    /** Returns the current item. The iterator must be valid. */
+    /** @{ */
+    SHAMapItem::ref getItem () const
+    {
+        return m_item;
+    }
+
+    uint256 const& getKey () const
+    {
+        return m_item->getTag ();
+    }
+
+    SHAMapTreeNode::TNType getType () const
+    {
+        return m_type;
+    }
+    /** @} */
+
+    /** Position the iterator at the first or last item.
+        @return `false` if the map is empty.
+    */
+    /** @{ */
+    bool first ();
+    bool last ();
+    /** @} */
+
+    /** Position the iterator at the first item with a key above `key`.
+        The key need not be in the map.
+        @return `false` if there is no such item.
+    */
+    bool seekAfter (uint256 const& key);
+
+    /** Position the iterator at the last item with a key below `key`.
+        The key need not be in the map.
+        @return `false` if there is no such item.
+    */
+    bool seekBefore (uint256 const& key);
+
+    /** Move to the next or previous item. The iterator must be valid.
+        @return `false` if there is no such item.
+    */
+    /** @{ */
+    bool next ();
+    bool prev ();
+    /** @} */
+
+private:
+    class ScopedRead;
+
+    SHAMapTreeNode::pointer getChild (SHAMapTreeNode::ref node, int branch);
+    bool descendFirst (SHAMapTreeNode::pointer node);
+    bool descendLast (SHAMapTreeNode::pointer node);
+    void descendTo (uint256 const& key);
+    bool successor (uint256 const& key);
+    bool predecessor (uint256 const& key);
+    bool found ();
+
+    SHAMap::pointer m_map;
+    bool m_locking;
+    std::uint64_t m_generation;
+
+    // The nodes from the root towards the current item
+    std::vector <SHAMapTreeNode::pointer> m_path;
+
+    // Copied from the leaf, which a mutable map may change in place
+    SHAMapItem::pointer m_item;
+    SHAMapTreeNode::TNType m_type;
+};
+
+}
+
+#endif
@@ -345,6 +345,7 @@ SHAMapAddNode SHAMap::addRootNode (Blob const& rootNode, SHANodeFormat format,
                                    SHAMapSyncFilter* filter)
 {
     ScopedWriteLockType sl (mLock);
+    ++mGeneration;
 
     // we already have a root node
     if (root->getNodeHash ().isNonZero ())
@@ -384,6 +385,7 @@ SHAMapAddNode SHAMap::addRootNode (uint256 const& hash, Blob const& rootNode, SH
                                    SHAMapSyncFilter* filter)
 {
     ScopedWriteLockType sl (mLock);
+    ++mGeneration;
 
     // we already have a root node
     if (root->getNodeHash ().isNonZero ())
@@ -419,6 +421,7 @@ SHAMapAddNode SHAMap::addRootNode (uint256 const& hash, Blob const& rootNode, SH
 SHAMapAddNode SHAMap::addKnownNode (const SHAMapNode& node, Blob const& rawNode, SHAMapSyncFilter* filter)
 {
     ScopedWriteLockType sl (mLock);
+    ++mGeneration;
 
     // return value: true=okay, false=error
     assert (!node.isRoot ());
@@ -625,7 +628,7 @@ std::list<SHAMap::fetchPackEntry_t> SHAMap::getFetchPack (SHAMap* have, bool inc
     return ret;
 }
 
-void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
+bool SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
                            std::function<void (const uint256&, const Blob&)> func)
 {
     ScopedReadLockType ul1 (mLock);
@@ -640,16 +643,16 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
         if (! ul2->owns_lock ())
         {
             WriteLog (lsINFO, SHAMap) << "Unable to create pack due to lock";
-            return;
+            return false;
         }
     }
 
 
     if (root->getNodeHash ().isZero ())
-        return;
+        return true;
 
     if (have && (root->getNodeHash () == have->root->getNodeHash ()))
-        return;
+        return true;
 
     if (root->isLeaf ())
     {
@@ -662,7 +665,7 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
             --max;
         }
 
-        return;
+        return true;
     }
 
     std::stack<SHAMapTreeNode*> stack; // contains unexplored non-matching inner node entries
@@ -679,7 +682,25 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
         func (boost::cref(node->getNodeHash ()), boost::cref(s.peekData ()));
         --max;
 
-        // 2) push non-matching child inner nodes
+        // 2) start reading the children that are not in memory, so that
+        //    the node store can fetch them together
+        bool pending = false;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            if (!node->isEmptyBranch (i))
+            {
+                bool childPending;
+                getNodeAsync (node->getChildNodeID (i), node->getChildHash (i),
+                    nullptr, childPending);
+                pending = pending || childPending;
+            }
+        }
+
+        if (pending)
+            getApp().getNodeStore().waitReads ();
+
+        // 3) push non-matching child inner nodes
         for (int i = 0; i < 16; ++i)
         {
             if (!node->isEmptyBranch (i))
@@ -704,6 +725,8 @@ void SHAMap::getFetchPack (SHAMap* have, bool includeLeaves, int max,
             }
         }
     }
+
+    return true;
 }
 
 std::list<Blob > SHAMap::getTrustedPath (uint256 const& index)
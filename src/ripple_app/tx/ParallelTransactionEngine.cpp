@@ -0,0 +1,460 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../../beast/beast/unit_test/suite.h"
+
+namespace ripple {
+
+SETUP_LOG (ParallelTransactionEngine)
+
+ParallelTransactionEngine::ParallelTransactionEngine (Ledger::ref ledger,
+    int threads, JobQueue& jobQueue)
+    : mLedger (ledger)
+    , mThreads (std::max (threads, 1))
+    , mJobQueue (jobQueue)
+    , mHits (0)
+    , mMisses (0)
+{
+    assert (mLedger);
+}
+
+void ParallelTransactionEngine::speculate (std::vector <Candidate> const& candidates)
+{
+    mBatch = boost::make_shared <Batch> ();
+    mIndex.clear ();
+    mWritten.clear ();
+
+    std::vector <Result>& results (mBatch->results);
+    results.reserve (candidates.size ());
+
+    for (auto const& candidate : candidates)
+    {
+        SerializedTransaction::ref txn (candidate.first);
+
+        // Pseudo-transactions change server state outside the ledger
+        if ((txn->getTxnType () == ttAMENDMENT) || (txn->getTxnType () == ttFEE))
+            continue;
+
+        if (mIndex.emplace (txn->getTransactionID (), results.size ()).second)
+            results.emplace_back (txn, candidate.second);
+    }
+
+    if (results.empty ())
+        return;
+
+    // Transactors lock the ledger they work on, so every job
+    // gets its own immutable snapshot. Snapshots of an immutable
+    // ledger share all of their nodes.
+    Ledger::pointer const snapshot (
+        boost::make_shared <Ledger> (boost::ref (*mLedger), false));
+
+    int const threads (std::min <std::size_t> (mThreads, results.size ()));
+
+    for (int i = 1; i < threads; ++i)
+    {
+        mJobQueue.addJob (jtSPECULATE, "speculateTransactions",
+            BIND_TYPE (&ParallelTransactionEngine::workJob, mBatch,
+                boost::make_shared <Ledger> (boost::ref (*snapshot), false), P_1));
+    }
+
+    // The caller works too, so this finishes even if no job thread is free
+    work (mBatch, snapshot);
+
+    {
+        std::unique_lock <std::mutex> lock (mBatch->mutex);
+        while (mBatch->done < results.size ())
+            mBatch->cond.wait (lock);
+    }
+
+    WriteLog (lsDEBUG, ParallelTransactionEngine) <<
+        "Speculated " << results.size () << " transactions with " <<
+        threads << " workers";
+}
+
+bool ParallelTransactionEngine::take (SerializedTransaction const& txn,
+    TransactionEngineParams params, LedgerEntrySet& view, TER& result, bool& didApply)
+{
+    auto const iter (mIndex.find (txn.getTransactionID ()));
+
+    if (iter == mIndex.end ())
+        return false;
+
+    Result& r (mBatch->results [iter->second]);
+    mIndex.erase (iter);
+
+    if (!r.valid || (r.params != params) || r.reads.intersects (mWritten))
+    {
+        WriteLog (lsTRACE, ParallelTransactionEngine) <<
+            "Discarding speculative result for " << txn.getTransactionID ();
+        ++mMisses;
+        r.view.clear ();
+        return false;
+    }
+
+    view.swapWith (r.view);
+    view.setReads (nullptr);
+    result = r.result;
+    didApply = r.didApply;
+    ++mHits;
+    return true;
+}
+
+void ParallelTransactionEngine::written (uint256 const& index)
+{
+    mWritten.insert (index);
+}
+
+void ParallelTransactionEngine::workJob (boost::shared_ptr <Batch> batch,
+    Ledger::pointer snapshot, Job&)
+{
+    work (batch, snapshot);
+}
+
+void ParallelTransactionEngine::work (boost::shared_ptr <Batch> const& batch,
+    Ledger::pointer snapshot)
+{
+    TransactionEngine engine (snapshot);
+
+    for (;;)
+    {
+        std::size_t const index (batch->next++);
+
+        if (index >= batch->results.size ())
+            break;
+
+        Result& r (batch->results [index]);
+        LedgerEntrySet& view (engine.view ());
+
+        view.setReads (&r.reads);
+
+        // The fee schedule and the reserves are read from the ledger
+        // rather than through the view, and every transactor reads them
+        // to compute the fee due. A change to the fee settings by an
+        // earlier transaction must force the transaction to run again.
+        r.reads.addKey (Ledger::getLedgerFeeIndex ());
+
+        try
+        {
+            r.result = engine.applyTransactor (*r.txn, r.params, r.didApply);
+
+            // What a transaction changes conflicts with any earlier
+            // change to the same entries, whether or not it was read.
+            for (auto const& entry : view)
+            {
+                if (entry.second.mAction != taaCACHED)
+                    r.reads.addKey (entry.first);
+            }
+
+            r.view.swapWith (view);
+            r.view.setReads (nullptr);
+            r.valid = true;
+        }
+        catch (...)
+        {
+            // Let serial application reproduce the failure
+            WriteLog (lsDEBUG, ParallelTransactionEngine) <<
+                "Speculative apply throws: " << r.txn->getTransactionID ();
+            view.setReads (nullptr);
+            view.clear ();
+            r.valid = false;
+        }
+
+        std::lock_guard <std::mutex> lock (batch->mutex);
+        if (++batch->done == batch->results.size ())
+            batch->cond.notify_all ();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+class ParallelTransactionEngine_test : public beast::unit_test::suite
+{
+public:
+    struct Account
+    {
+        explicit Account (std::string const& passPhrase)
+            : sequence (1)
+        {
+            RippleAddress const seed (RippleAddress::createSeedGeneric (passPhrase));
+            RippleAddress const generator (RippleAddress::createGeneratorPublic (seed));
+            publicKey = RippleAddress::createAccountPublic (generator, 0);
+            privateKey = RippleAddress::createAccountPrivate (generator, seed, 0);
+        }
+
+        uint160 getID () const
+        {
+            return publicKey.getAccountID ();
+        }
+
+        RippleAddress publicKey;
+        RippleAddress privateKey;
+        std::uint32_t sequence;
+    };
+
+    typedef std::vector <SerializedTransaction::pointer> Transactions;
+
+    //--------------------------------------------------------------------------
+
+    SerializedTransaction::pointer makeTransaction (TxType type, Account& from)
+    {
+        SerializedTransaction::pointer txn (
+            boost::make_shared <SerializedTransaction> (type));
+        txn->setSourceAccount (from.publicKey);
+        txn->setSigningPubKey (from.publicKey);
+        txn->setFieldAmount (sfFee, STAmount (10));
+        txn->setFieldU32 (sfSequence, from.sequence++);
+        return txn;
+    }
+
+    SerializedTransaction::pointer payment (Account& from, Account const& to,
+        STAmount const& amount)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttPAYMENT, from));
+        txn->setFieldAccount (sfDestination, to.getID ());
+        txn->setFieldAmount (sfAmount, amount);
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    SerializedTransaction::pointer trust (Account& from, STAmount const& limit)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttTRUST_SET, from));
+        txn->setFieldAmount (sfLimitAmount, limit);
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    SerializedTransaction::pointer offer (Account& from,
+        STAmount const& takerPays, STAmount const& takerGets)
+    {
+        SerializedTransaction::pointer txn (makeTransaction (ttOFFER_CREATE, from));
+        txn->setFieldAmount (sfTakerPays, takerPays);
+        txn->setFieldAmount (sfTakerGets, takerGets);
+        txn->sign (from.privateKey);
+        return txn;
+    }
+
+    //--------------------------------------------------------------------------
+
+    // Build and close the ledger that follows parent
+    Ledger::pointer close (Ledger::ref parent, Transactions const& txns,
+        int threads, int& hits)
+    {
+        Ledger::pointer ledger (boost::make_shared <Ledger> (
+            false, boost::ref (*parent)));
+        TransactionEngine engine (ledger);
+
+        std::vector <ParallelTransactionEngine::Candidate> candidates;
+        for (auto const& txn : txns)
+            candidates.push_back (std::make_pair (txn, tapNONE));
+
+        std::unique_ptr <ParallelTransactionEngine> speculation;
+
+        if (threads > 1)
+        {
+            speculation.reset (new ParallelTransactionEngine (ledger, threads,
+                getApp().getJobQueue ()));
+            speculation->speculate (candidates);
+            engine.setSpeculation (speculation.get ());
+        }
+
+        for (auto const& candidate : candidates)
+        {
+            bool didApply;
+            engine.applyTransaction (*candidate.first, candidate.second, didApply);
+        }
+
+        engine.setSpeculation (nullptr);
+        hits = speculation ? speculation->getHits () : 0;
+
+        ledger->updateSkipList ();
+        ledger->setClosed ();
+        ledger->setAccepted (parent->getCloseTimeNC () + 10,
+            parent->getCloseResolution (), true);
+        return ledger;
+    }
+
+    // Close the ledger both ways and check that they are identical
+    Ledger::pointer closeBoth (Ledger::ref parent, Transactions const& txns)
+    {
+        int hits;
+        Ledger::pointer const serial (close (parent, txns, 1, hits));
+        Ledger::pointer const parallel (close (parent, txns, 4, hits));
+
+        expect (serial->getAccountHash () == parallel->getAccountHash (),
+            "Account state differs");
+        expect (serial->getTransHash () == parallel->getTransHash (),
+            "Transactions or metadata differ");
+        expect (serial->getTotalCoins () == parallel->getTotalCoins (),
+            "Total coins differ");
+        expect (serial->getHash () == parallel->getHash (),
+            "Ledger hash differs");
+
+        log << "Ledger " << serial->getLedgerSeq () << ": " <<
+            txns.size () << " transactions, " << hits << " speculative";
+
+        return serial;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void testReads ()
+    {
+        testcase ("reads");
+
+        uint256 a, b, c;
+        a.SetHex ("10");
+        b.SetHex ("20");
+        c.SetHex ("30");
+
+        std::set <uint256> written;
+        written.insert (b);
+
+        LedgerEntryReads keys;
+        keys.addKey (a);
+        keys.addKey (c);
+        expect (! keys.intersects (written));
+        keys.addKey (b);
+        expect (keys.intersects (written));
+
+        LedgerEntryReads ranges;
+        ranges.addRange (b, c);
+        expect (! ranges.intersects (written), "Range excludes its start");
+        ranges.addRange (a, b);
+        expect (ranges.intersects (written), "Range includes its end");
+
+        LedgerEntryReads tail;
+        tail.addRange (a, uint256 ());
+        expect (tail.intersects (written), "Open range runs to the end");
+    }
+
+    void testReplay ()
+    {
+        testcase ("replay");
+
+        Account master ("masterpassphrase");
+
+        Ledger::pointer genesis (boost::make_shared <Ledger> (
+            master.publicKey, SYSTEM_CURRENCY_START));
+        genesis->updateHash ();
+        genesis->setClosed ();
+        genesis->setAccepted (1000, genesis->getCloseResolution (), true);
+
+        int const count (24);
+        std::vector <Account> accounts;
+        for (int i = 0; i < count; ++i)
+            accounts.push_back (Account ("parallel" + std::to_string (i)));
+
+        Account& gateway (accounts.front ());
+        uint160 usd;
+        STAmount::currencyFromString (usd, "USD");
+
+        // Every payment comes from the master account, so
+        // each one conflicts with the one before it.
+        Transactions txns;
+        for (auto& account : accounts)
+            txns.push_back (payment (master, account,
+                STAmount (10000 * SYSTEM_CURRENCY_PARTS)));
+        Ledger::pointer ledger (closeBoth (genesis, txns));
+
+        // Independent pairs, a chain of overlapping payments, and trust lines
+        txns.clear ();
+        for (int i = 1; i + 1 < count / 2; i += 2)
+            txns.push_back (payment (accounts [i], accounts [i + 1],
+                STAmount (100 * SYSTEM_CURRENCY_PARTS)));
+        for (int i = count / 2; i + 1 < count; ++i)
+            txns.push_back (payment (accounts [i], accounts [i + 1],
+                STAmount (10 * SYSTEM_CURRENCY_PARTS)));
+        for (int i = 1; i < count; ++i)
+            txns.push_back (trust (accounts [i],
+                STAmount (usd, gateway.getID (), 1000)));
+        ledger = closeBoth (ledger, txns);
+
+        // Issue, then trade on one order book
+        txns.clear ();
+        for (int i = 1; i < count; ++i)
+            txns.push_back (payment (gateway, accounts [i],
+                STAmount (usd, gateway.getID (), 100)));
+        ledger = closeBoth (ledger, txns);
+
+        txns.clear ();
+        for (int i = 1; i < count; ++i)
+        {
+            if (i % 2)
+                txns.push_back (offer (accounts [i],
+                    STAmount (usd, gateway.getID (), 10),
+                    STAmount (100 * SYSTEM_CURRENCY_PARTS)));
+            else
+                txns.push_back (offer (accounts [i],
+                    STAmount (100 * SYSTEM_CURRENCY_PARTS),
+                    STAmount (usd, gateway.getID (), 10)));
+        }
+        ledger = closeBoth (ledger, txns);
+    }
+
+    void testFeeChange ()
+    {
+        testcase ("fee change");
+
+        Account master ("masterpassphrase");
+        Account destination ("parallelfee");
+
+        Ledger::pointer genesis (boost::make_shared <Ledger> (
+            master.publicKey, SYSTEM_CURRENCY_START));
+        genesis->updateHash ();
+        genesis->setClosed ();
+        genesis->setAccepted (1000, genesis->getCloseResolution (), true);
+
+        Ledger::pointer ledger (boost::make_shared <Ledger> (
+            false, boost::ref (*genesis)));
+
+        std::vector <ParallelTransactionEngine::Candidate> candidates;
+        candidates.push_back (std::make_pair (payment (master, destination,
+            STAmount (1000 * SYSTEM_CURRENCY_PARTS)), tapNONE));
+
+        ParallelTransactionEngine speculation (ledger, 2,
+            getApp().getJobQueue ());
+        speculation.speculate (candidates);
+
+        // As a fee pseudo-transaction would when applied first
+        speculation.written (Ledger::getLedgerFeeIndex ());
+
+        TransactionEngine engine (ledger);
+        engine.setSpeculation (&speculation);
+        bool didApply;
+        engine.applyTransaction (*candidates.front ().first,
+            candidates.front ().second, didApply);
+        engine.setSpeculation (nullptr);
+
+        expect (didApply, "Should apply");
+        expect (speculation.getHits () == 0, "Should not use the result");
+        expect (speculation.getMisses () == 1, "Should rerun");
+    }
+
+    void run ()
+    {
+        testReads ();
+        testFeeChange ();
+        testReplay ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ParallelTransactionEngine,ripple_app,ripple);
+
+} // ripple
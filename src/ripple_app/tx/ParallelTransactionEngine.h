@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PARALLELTRANSACTIONENGINE_H_INCLUDED
+#define RIPPLE_PARALLELTRANSACTIONENGINE_H_INCLUDED
+
+namespace ripple {
+
+/** Applies a batch of transactions speculatively on several threads.
+
+    Each transaction is run through its transactor against a private
+    LedgerEntrySet over an immutable snapshot of the target ledger, and
+    the ledger entries it reads and writes are recorded. Nothing is
+    written to the ledger.
+
+    The TransactionEngine that owns the target ledger then applies the
+    same transactions serially, in canonical order. For each one it asks
+    for the speculative result, which is handed over only if no
+    transaction committed before it wrote anything it read or wrote;
+    otherwise the transaction is run again against the real ledger.
+    Either way the resulting ledger is identical to serial application.
+*/
+class ParallelTransactionEngine
+    : public CountedObject <ParallelTransactionEngine>
+{
+public:
+    static char const* getCountedObjectName () { return "ParallelTransactionEngine"; }
+
+    typedef std::pair <SerializedTransaction::pointer,
+        TransactionEngineParams> Candidate;
+
+    /** Create a speculator for a ledger.
+        @param threads The number of threads to use, including the caller.
+        @param jobQueue Runs the work on the other threads.
+    */
+    ParallelTransactionEngine (Ledger::ref ledger, int threads,
+        JobQueue& jobQueue);
+
+    /** Run the transactors for the candidates in parallel.
+        The params must be exactly those that will later be passed to
+        TransactionEngine::applyTransaction. Blocks until all are done.
+    */
+    void speculate (std::vector <Candidate> const& candidates);
+
+    /** Hand over a speculative result if it is still valid.
+        Called by TransactionEngine::applyTransaction. Each result can
+        be taken at most once.
+        @return true if view, result and didApply were filled in.
+    */
+    bool take (SerializedTransaction const& txn, TransactionEngineParams params,
+        LedgerEntrySet& view, TER& result, bool& didApply);
+
+    /** Note a ledger entry changed by a committed transaction. */
+    void written (uint256 const& index);
+
+    /** Number of speculative results used. */
+    int getHits () const
+    {
+        return mHits;
+    }
+
+    /** Number of speculative results discarded because of conflicts. */
+    int getMisses () const
+    {
+        return mMisses;
+    }
+
+private:
+    struct Result
+    {
+        Result (SerializedTransaction::ref txn_, TransactionEngineParams params_)
+            : txn (txn_)
+            , params (params_)
+            , result (temUNKNOWN)
+            , didApply (false)
+            , valid (false)
+        {
+        }
+
+        SerializedTransaction::pointer txn;
+        TransactionEngineParams params;
+        LedgerEntrySet view;
+        LedgerEntryReads reads;
+        TER result;
+        bool didApply;
+        bool valid;
+    };
+
+    // The results shared with the jobs. A job that starts after the
+    // caller has finished only looks at the next index and returns.
+    struct Batch
+    {
+        Batch ()
+            : next (0)
+            , done (0)
+        {
+        }
+
+        std::vector <Result> results;
+        std::atomic <std::size_t> next;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t done;
+    };
+
+    static void work (boost::shared_ptr <Batch> const& batch,
+        Ledger::pointer snapshot);
+    static void workJob (boost::shared_ptr <Batch> batch,
+        Ledger::pointer snapshot, Job&);
+
+    Ledger::pointer mLedger;
+    int mThreads;
+    JobQueue& mJobQueue;
+
+    boost::shared_ptr <Batch> mBatch;
+    ripple::unordered_map <uint256, std::size_t> mIndex;
+
+    std::set <uint256> mWritten;
+    int mHits;
+    int mMisses;
+};
+
+} // ripple
+
+#endif
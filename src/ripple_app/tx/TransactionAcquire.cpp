@@ -29,6 +29,9 @@ enum
     // VFALCO NOTE This should be a std::chrono::duration constant.
     // TODO Document this. Is it seconds? Milliseconds? WTF?
     TX_ACQUIRE_TIMEOUT = 250
+
+    // How many peers to add when we run out of peers
+    ,TX_ACQUIRE_PEERS = 8
 };
 
 typedef std::map<uint160, LedgerProposal::pointer>::value_type u160_prop_pair;
@@ -111,22 +114,13 @@ void TransactionAcquire::onTimer (bool progress, ScopedLockType& psl)
         // out of peers
         WriteLog (lsWARNING, TransactionAcquire) << "Out of peers for TX set " << getHash ();
 
-        bool found = false;
-        Overlay::PeerSequence peerList = getApp().overlay ().getActivePeers ();
-        BOOST_FOREACH (Peer::ptr const& peer, peerList)
-        {
-            if (peer->hasTxSet (getHash ()))
+        // Peers that have the set rank first, then the
+        // ones that answer quickly and send useful data.
+        addBestPeers (TX_ACQUIRE_PEERS,
+            [this](Peer::ptr const& peer)
             {
-                found = true;
-                peerHas (peer);
-            }
-        }
-
-        if (!found)
-        {
-            BOOST_FOREACH (Peer::ptr const& peer, peerList)
-            peerHas (peer);
-        }
+                return peer->hasTxSet (getHash ());
+            });
     }
     else if (!progress)
         trigger (Peer::ptr ());
@@ -69,13 +69,15 @@ void TransactionEngine::txnWrite ()
         }
         break;
         }
+
+        if ((mSpeculation != nullptr) && (it.second.mAction != taaCACHED))
+            mSpeculation->written (it.first);
     }
 }
 
-TER TransactionEngine::applyTransaction (const SerializedTransaction& txn, TransactionEngineParams params,
+TER TransactionEngine::applyTransactor (const SerializedTransaction& txn, TransactionEngineParams params,
         bool& didApply)
 {
-    WriteLog (lsTRACE, TransactionEngine) << "applyTransaction>";
     didApply = false;
     assert (mLedger);
     mNodes.init (mLedger, txn.getTransactionID (), mLedger->getLedgerSeq (), params);
@@ -166,6 +168,30 @@ TER TransactionEngine::applyTransaction (const SerializedTransaction& txn, Trans
     else
         WriteLog (lsDEBUG, TransactionEngine) << "Not applying transaction " << txID;
 
+    return terResult;
+}
+
+TER TransactionEngine::applyTransaction (const SerializedTransaction& txn, TransactionEngineParams params,
+        bool& didApply)
+{
+    WriteLog (lsTRACE, TransactionEngine) << "applyTransaction>";
+
+    TER terResult;
+
+    if ((mSpeculation != nullptr) &&
+        mSpeculation->take (txn, params, mNodes, terResult, didApply))
+    {
+        // The view was built against a snapshot of our ledger
+        // whose entries no earlier transaction has changed.
+        mNodes.setLedger (mLedger);
+    }
+    else
+    {
+        terResult = applyTransactor (txn, params, didApply);
+    }
+
+    uint256 txID = txn.getTransactionID ();
+
     if (didApply)
     {
         if (!checkInvariants (terResult, txn, params))
@@ -22,6 +22,8 @@
 
 namespace ripple {
 
+class ParallelTransactionEngine;
+
 // A TransactionEngine applies serialized transactions to a ledger
 // It can also, verify signatures, verify fees, and give rejection reasons
 
@@ -52,6 +54,7 @@ private:
 protected:
     Ledger::pointer     mLedger;
     int                 mTxnSeq;
+    ParallelTransactionEngine* mSpeculation;
 
     uint160             mTxnAccountID;
     SLE::pointer        mTxnAccount;
@@ -61,11 +64,11 @@ protected:
 public:
     typedef boost::shared_ptr<TransactionEngine> pointer;
 
-    TransactionEngine () : mTxnSeq (0)
+    TransactionEngine () : mTxnSeq (0), mSpeculation (nullptr)
     {
         ;
     }
-    TransactionEngine (Ledger::ref ledger) : mLedger (ledger), mTxnSeq (0)
+    TransactionEngine (Ledger::ref ledger) : mLedger (ledger), mTxnSeq (0), mSpeculation (nullptr)
     {
         assert (mLedger);
     }
@@ -84,6 +87,15 @@ public:
         mLedger = ledger;
     }
 
+    /** Use speculative results computed in parallel where still valid.
+        The results must have been computed against this engine's ledger
+        before any transaction was applied to it. Pass nullptr to stop.
+    */
+    void setSpeculation (ParallelTransactionEngine* speculation)
+    {
+        mSpeculation = speculation;
+    }
+
     // VFALCO TODO Remove these pointless wrappers
     SLE::pointer entryCreate (LedgerEntryType type, uint256 const & index)
     {
@@ -106,6 +118,9 @@ public:
     }
 
     TER applyTransaction (const SerializedTransaction&, TransactionEngineParams, bool & didApply);
+
+    // Run the transactor into view () without writing to the ledger
+    TER applyTransactor (const SerializedTransaction&, TransactionEngineParams, bool & didApply);
     bool checkInvariants (TER result, const SerializedTransaction & txn, TransactionEngineParams params);
 };
 
@@ -36,6 +36,7 @@ WSConnection::WSConnection (Resource::Manager& resourceManager,
     , m_receiveQueueRunning (false)
     , m_isDead (false)
     , m_io_service (io_service)
+    , m_send (std::make_shared <WSSendState> ())
 {
     WriteLog (lsDEBUG, WSConnection) <<
         "Websocket connection from " << remoteAddress;
@@ -69,7 +70,7 @@ void WSConnection::rcvMessage (message_ptr msg, bool& msgRejected, bool& runQueu
     else
     {
         msgRejected = false;
-        m_receiveQueue.push_back (msg);
+        m_receiveQueue.emplace_back (msg, clock_type::now ());
 
         if (m_receiveQueueRunning)
             runQueue = false;
@@ -96,7 +97,7 @@ bool WSConnection::checkMessage ()
     return true;
 }
 
-WSConnection::message_ptr WSConnection::getMessage ()
+WSConnection::message_ptr WSConnection::getMessage (clock_type::time_point& received)
 {
     ScopedLockType sl (m_receiveQueueMutex);
 
@@ -106,23 +107,30 @@ WSConnection::message_ptr WSConnection::getMessage ()
         return message_ptr ();
     }
 
-    message_ptr m = m_receiveQueue.front ();
+    message_ptr m = m_receiveQueue.front ().first;
+    received = m_receiveQueue.front ().second;
     m_receiveQueue.pop_front ();
     return m;
 }
 
-void WSConnection::returnMessage (message_ptr ptr)
+void WSConnection::returnMessage (message_ptr ptr, clock_type::time_point received)
 {
     ScopedLockType sl (m_receiveQueueMutex);
 
     if (!m_isDead)
     {
-        m_receiveQueue.push_front (ptr);
+        m_receiveQueue.emplace_front (ptr, received);
         m_receiveQueueRunning = false;
     }
 }
 
-Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
+std::size_t WSConnection::getPending () const
+{
+    return m_send->pending;
+}
+
+Json::Value WSConnection::invokeCommand (Json::Value& jvRequest,
+    RPC::LatencyTracker::Timing& timing)
 {
     if (getConsumer().disconnect ())
     {
@@ -153,6 +161,7 @@ Json::Value WSConnection::invokeCommand (Json::Value& jvRequest)
 
     Resource::Charge loadType = Resource::feeReferenceRPC;
     RPCHandler  mRPCHandler (&this->m_netOPs, boost::dynamic_pointer_cast<InfoSub> (this->shared_from_this ()));
+    mRPCHandler.setTiming (&timing);
     Json::Value jvResult (Json::objectValue);
 
     Config::Role const role = m_isPublic
@@ -22,6 +22,39 @@
 
 namespace ripple {
 
+/** What is queued for sending to one websocket client.
+    The sends posted to the connection's strand share this, so it stays
+    valid after the connection itself is gone.
+*/
+struct WSSendState : public beast::Uncopyable
+{
+    WSSendState ()
+        : pending (0)
+        , heldBinary (false)
+        , holding (false)
+        , tooSlow (false)
+    {
+    }
+
+    // Bytes posted to the strand and not yet handed to websocketpp, whose
+    // buffered_amount () counts them from then on.
+    std::atomic <std::size_t> pending;
+
+    // Set if permessage-deflate was negotiated. Used only on the strand.
+    std::unique_ptr <WSDeflate> deflate;
+
+    // The latest ledger close kept back from a slow client.
+    RippleMutex heldMutex;
+    std::string heldLedger;
+    bool heldBinary;
+    std::atomic <bool> holding;
+
+    // Set once the client is being disconnected for falling behind.
+    std::atomic <bool> tooSlow;
+};
+
+//------------------------------------------------------------------------------
+
 /** A Ripple WebSocket connection handler.
     This handles everything that is independent of the endpint_type.
 */
@@ -36,6 +69,7 @@ public:
 
 protected:
     typedef websocketpp::message::data::ptr message_ptr;
+    typedef RPC::LatencyTracker::clock_type clock_type;
 
     WSConnection (Resource::Manager& resourceManager,
         Resource::Consumer usage, InfoSub::Source& source, bool isPublic,
@@ -49,10 +83,14 @@ protected:
 public:
     void onPong (const std::string&);
     void rcvMessage (message_ptr msg, bool& msgRejected, bool& runQueue);
-    message_ptr getMessage ();
+    message_ptr getMessage (clock_type::time_point& received);
     bool checkMessage ();
-    void returnMessage (message_ptr ptr);
-    Json::Value invokeCommand (Json::Value& jvRequest);
+    void returnMessage (message_ptr ptr, clock_type::time_point received);
+    Json::Value invokeCommand (Json::Value& jvRequest,
+        RPC::LatencyTracker::Timing& timing);
+
+    /** Bytes sent to this client that it has not been given yet. */
+    std::size_t getPending () const;
 
 protected:
     Resource::Manager& m_resourceManager;
@@ -60,13 +98,14 @@ protected:
     bool const m_isPublic;
     beast::IP::Endpoint const m_remoteAddress;
     LockType m_receiveQueueMutex;
-    std::deque <message_ptr> m_receiveQueue;
+    std::deque <std::pair <message_ptr, clock_type::time_point>> m_receiveQueue;
     NetworkOPs& m_netOPs;
     boost::asio::deadline_timer m_pingTimer;
     bool m_sentPing;
     bool m_receiveQueueRunning;
     bool m_isDead;
     boost::asio::io_service& m_io_service;
+    std::shared_ptr <WSSendState> const m_send;
 
 private:
     WSConnection (WSConnection const&);
@@ -104,6 +143,11 @@ public:
         , m_serverHandler (serverHandler)
         , m_connection (cpConnection)
     {
+        WSDeflate::Params params;
+
+        if (! server_type::negotiateDeflate (cpConnection, params).empty ())
+            m_send->deflate.reset (new WSDeflate (params));
+
         setPingTimer ();
     }
 
@@ -127,18 +171,63 @@ public:
     // Implement overridden functions from base class:
     void send (const Json::Value& jvObj, bool broadcast)
     {
-        connection_ptr ptr = m_connection.lock ();
+        Json::FastWriter    jfwWriter;
 
-        if (ptr)
-            m_serverHandler.send (ptr, jvObj, broadcast);
+        send (jvObj, jfwWriter.write (jvObj), broadcast);
     }
 
     void send (const Json::Value& jvObj, const std::string& sObj, bool broadcast)
     {
         connection_ptr ptr = m_connection.lock ();
 
-        if (ptr)
-            m_serverHandler.send (ptr, sObj, broadcast);
+        if (!ptr)
+            return;
+
+        if (broadcast && overBudget (ptr, sObj.size ()))
+            slowClient (ptr, sObj, false, jvObj.isMember (jss::type) &&
+                (jvObj[jss::type] == jss::ledgerClosed));
+        else
+            post (ptr, sObj, false, broadcast);
+    }
+
+    void sendBinary (std::string const& frame)
+    {
+        connection_ptr ptr = m_connection.lock ();
+
+        if (!ptr)
+            return;
+
+        // Stream messages only, see InfoSub::isBinary
+        if (overBudget (ptr, frame.size ()))
+            slowClient (ptr, frame, true, !frame.empty () && frame[0] == 1);
+        else
+            post (ptr, frame, true, true);
+    }
+
+    bool canSendBinary () const
+    {
+        return true;
+    }
+
+    // Called on the strand once the client has been sent everything
+    void onSendEmpty ()
+    {
+        if (! m_send->holding)
+            return;
+
+        std::string message;
+        bool binary;
+        {
+            ScopedLockType sl (m_send->heldMutex);
+            message.swap (m_send->heldLedger);
+            binary = m_send->heldBinary;
+            m_send->holding = false;
+        }
+
+        connection_ptr ptr = m_connection.lock ();
+
+        if (ptr && !message.empty ())
+            post (ptr, message, binary, true);
     }
 
     void disconnect ()
@@ -159,6 +248,15 @@ public:
             ptr->close (websocketpp::close::status::PROTOCOL_ERROR, "overload");
     }
 
+    static void handle_too_slow (weak_connection_ptr c)
+    {
+        connection_ptr ptr = c.lock ();
+
+        if (ptr)
+            ptr->close (websocketpp::close::status::value (server_type::crTooSlow),
+                std::string ("Client is too slow."));
+    }
+
     bool onPingTimer (std::string&)
     {
         if (m_sentPing)
@@ -199,6 +297,61 @@ public:
     }
 
 private:
+    void post (connection_ptr const& ptr, std::string const& message,
+        bool binary, bool broadcast)
+    {
+        m_send->pending += message.size ();
+        m_serverHandler.send (ptr, m_send, message, binary, broadcast);
+    }
+
+    // Whether a stream message would take the client past its send budget.
+    // A client with nothing queued is always sent the next message.
+    bool overBudget (connection_ptr const& ptr, std::size_t size) const
+    {
+        std::size_t const budget = getConfig ().WEBSOCKET_SEND_BUDGET;
+
+        if (budget == 0)
+            return false;
+
+        std::size_t const queued = m_send->pending + ptr->buffered_amount ();
+
+        return queued != 0 && queued + size > budget;
+    }
+
+    void slowClient (connection_ptr const& ptr, std::string const& message,
+        bool binary, bool ledgerClose)
+    {
+        switch (getConfig ().WEBSOCKET_SLOW_CLIENT)
+        {
+        case Config::slowCoalesce:
+            if (ledgerClose)
+            {
+                ScopedLockType sl (m_send->heldMutex);
+                m_send->heldLedger = message;
+                m_send->heldBinary = binary;
+                m_send->holding = true;
+                break;
+            }
+            // fall through
+
+        case Config::slowDrop:
+            m_serverHandler.onDropped ();
+            break;
+
+        case Config::slowDisconnect:
+            if (! m_send->tooSlow.exchange (true))
+            {
+                WriteLog (lsINFO, WSConnection) <<
+                    "Disconnecting slow client " << m_remoteAddress;
+                m_serverHandler.onTooSlow ();
+                m_io_service.dispatch (ptr->get_strand ().wrap (boost::bind (
+                    &WSConnectionType <endpoint_type>::handle_too_slow,
+                        m_connection)));
+            }
+            break;
+        }
+    }
+
     server_type& m_serverHandler;
     weak_connection_ptr m_connection;
 };
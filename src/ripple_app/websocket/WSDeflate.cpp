@@ -0,0 +1,321 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace ripple {
+
+// A 8KB window and memLevel 5 keep a stream at about 48KB, against 256KB
+// for the zlib defaults. Stream messages are small and repetitive so
+// little ratio is lost.
+static int const defaultWindowBits = 13;
+static int const defaultMemLevel = 5;
+
+WSDeflate::Params::Params ()
+    : windowBits (defaultWindowBits)
+    , noContextTakeover (false)
+{
+}
+
+std::string WSDeflate::negotiate (std::vector <std::string> const& offers,
+    Params& params)
+{
+    for (auto const& offer : offers)
+    {
+        std::vector <std::string> parts;
+        boost::split (parts, offer, boost::is_any_of (";"));
+
+        for (auto& part : parts)
+            boost::trim (part);
+
+        if (! boost::iequals (parts[0], "permessage-deflate"))
+            continue;
+
+        Params p;
+        int serverWindow = 0;
+        bool acceptable = true;
+
+        for (std::size_t i = 1; acceptable && i < parts.size (); ++i)
+        {
+            std::string name = parts[i];
+            std::string value;
+            std::size_t const eq = name.find ('=');
+
+            if (eq != std::string::npos)
+            {
+                value = name.substr (eq + 1);
+                name = name.substr (0, eq);
+                boost::trim (name);
+                boost::trim (value);
+                boost::trim_if (value, boost::is_any_of ("\""));
+            }
+
+            if (name == "server_no_context_takeover" && value.empty ())
+            {
+                p.noContextTakeover = true;
+            }
+            else if (name == "client_no_context_takeover" && value.empty ())
+            {
+                // We ask for this anyway
+            }
+            else if (name == "client_max_window_bits")
+            {
+                // We inflate with the largest window, so any is fine
+            }
+            else if (name == "server_max_window_bits" &&
+                beast::lexicalCastChecked (serverWindow, value) &&
+                    serverWindow >= 8 && serverWindow <= 15)
+            {
+                // zlib cannot produce a raw stream with a 256 byte window
+                if (serverWindow == 8)
+                    acceptable = false;
+                else
+                    p.windowBits = std::min (p.windowBits, serverWindow);
+            }
+            else
+            {
+                acceptable = false;
+            }
+        }
+
+        if (! acceptable)
+            continue;
+
+        std::string response ("permessage-deflate; client_no_context_takeover");
+
+        if (p.noContextTakeover)
+            response += "; server_no_context_takeover";
+
+        if (serverWindow != 0)
+            response += "; server_max_window_bits=" +
+                std::to_string (p.windowBits);
+
+        params = p;
+        return response;
+    }
+
+    return std::string ();
+}
+
+WSDeflate::WSDeflate (Params const& params)
+    : m_reset (params.noContextTakeover)
+{
+    std::memset (&m_stream, 0, sizeof (m_stream));
+
+    m_ok = deflateInit2 (&m_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+        -params.windowBits, defaultMemLevel, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+WSDeflate::~WSDeflate ()
+{
+    if (m_ok)
+        deflateEnd (&m_stream);
+}
+
+bool WSDeflate::compress (std::string const& in, std::string& out)
+{
+    if (! m_ok)
+        return false;
+
+    // deflateBound assumes Z_FINISH, a sync flush can add a few bytes
+    out.resize (deflateBound (&m_stream, in.size ()) + 16);
+
+    m_stream.next_in = reinterpret_cast <Bytef*> (
+        const_cast <char*> (in.data ()));
+    m_stream.avail_in = in.size ();
+    m_stream.next_out = reinterpret_cast <Bytef*> (&out[0]);
+    m_stream.avail_out = out.size ();
+
+    if (deflate (&m_stream, Z_SYNC_FLUSH) != Z_OK ||
+        m_stream.avail_in != 0 || m_stream.avail_out == 0)
+    {
+        deflateEnd (&m_stream);
+        m_ok = false;
+        return false;
+    }
+
+    out.resize (out.size () - m_stream.avail_out);
+
+    // The flush always ends with an empty stored block: 00 00 ff ff
+    assert (out.size () >= 4 && out.compare (out.size () - 4, 4,
+        std::string ("\0\0\xff\xff", 4)) == 0);
+    out.resize (out.size () - 4);
+
+    if (m_reset)
+        deflateReset (&m_stream);
+
+    return true;
+}
+
+bool WSDeflate::decompress (std::string const& in, std::string& out,
+    std::size_t maxSize)
+{
+    static char const tail[4] = { '\0', '\0', '\xff', '\xff' };
+
+    z_stream stream;
+    std::memset (&stream, 0, sizeof (stream));
+
+    if (inflateInit2 (&stream, -15) != Z_OK)
+        return false;
+
+    out.clear ();
+
+    char buffer [16384];
+    bool ok = true;
+    bool done = false;
+
+    // The sender stripped the end of the flush, put it back
+    for (int pass = 0; ok && ! done && pass < 2; ++pass)
+    {
+        char const* const data = (pass == 0) ? in.data () : tail;
+        stream.next_in = reinterpret_cast <Bytef*> (const_cast <char*> (data));
+        stream.avail_in = (pass == 0) ? in.size () : sizeof (tail);
+
+        do
+        {
+            stream.next_out = reinterpret_cast <Bytef*> (buffer);
+            stream.avail_out = sizeof (buffer);
+
+            int const result = inflate (&stream, Z_SYNC_FLUSH);
+
+            if (result == Z_BUF_ERROR)
+                break;
+
+            if (result != Z_OK && result != Z_STREAM_END)
+            {
+                ok = false;
+                break;
+            }
+
+            out.append (buffer, sizeof (buffer) - stream.avail_out);
+
+            if (out.size () > maxSize)
+            {
+                ok = false;
+                break;
+            }
+
+            if (result == Z_STREAM_END)
+            {
+                done = true;
+                break;
+            }
+        }
+        while (stream.avail_in != 0 || stream.avail_out == 0);
+    }
+
+    inflateEnd (&stream);
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+
+class WSDeflate_test : public beast::unit_test::suite
+{
+public:
+    std::string message (int n)
+    {
+        return "{\"engine_result\":\"tesSUCCESS\",\"ledger_index\":" +
+            std::to_string (6000000 + n) + ",\"transaction\":{\"Account\":"
+            "\"rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh\",\"Fee\":\"10\","
+            "\"Sequence\":" + std::to_string (n) + ",\"TransactionType\":"
+            "\"Payment\"},\"type\":\"transaction\",\"validated\":true}";
+    }
+
+    void testNegotiate ()
+    {
+        std::vector <std::string> offers;
+        WSDeflate::Params p;
+
+        expect (WSDeflate::negotiate (offers, p).empty ());
+
+        offers.push_back ("x-webkit-deflate-frame");
+        expect (WSDeflate::negotiate (offers, p).empty ());
+
+        offers.push_back ("permessage-deflate; client_max_window_bits");
+        expect (WSDeflate::negotiate (offers, p) ==
+            "permessage-deflate; client_no_context_takeover");
+        expect (p.windowBits == defaultWindowBits && ! p.noContextTakeover);
+
+        offers.clear ();
+        offers.push_back ("permessage-deflate; server_max_window_bits=8");
+        offers.push_back ("permessage-deflate; mystery");
+        offers.push_back ("permessage-deflate; server_max_window_bits=\"10\"; "
+            "server_no_context_takeover");
+        expect (WSDeflate::negotiate (offers, p) ==
+            "permessage-deflate; client_no_context_takeover; "
+                "server_no_context_takeover; server_max_window_bits=10");
+        expect (p.windowBits == 10 && p.noContextTakeover);
+    }
+
+    void testRoundTrip (bool noContextTakeover)
+    {
+        WSDeflate::Params p;
+        p.noContextTakeover = noContextTakeover;
+        WSDeflate deflate (p);
+
+        std::size_t first = 0;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            std::string const in (message (i));
+            std::string compressed;
+            std::string out;
+
+            expect (deflate.compress (in, compressed));
+            expect (compressed.size () < in.size ());
+
+            if (i == 0)
+            {
+                first = compressed.size ();
+                expect (WSDeflate::decompress (compressed, out, in.size ()));
+                expect (out == in);
+                expect (! WSDeflate::decompress (compressed, out,
+                    in.size () - 1));
+            }
+            else if (noContextTakeover)
+            {
+                expect (WSDeflate::decompress (compressed, out, in.size ()));
+                expect (out == in);
+            }
+            else
+            {
+                // Refers back to the first message
+                expect (compressed.size () < first / 2);
+            }
+        }
+    }
+
+    void testCorrupt ()
+    {
+        std::string out;
+        expect (! WSDeflate::decompress (std::string ("\xff\xff\xff\xff", 4),
+            out, 1000));
+    }
+
+    void run ()
+    {
+        testNegotiate ();
+        testRoundTrip (false);
+        testRoundTrip (true);
+        testCorrupt ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(WSDeflate,ripple_app,ripple);
+
+} // ripple
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_WSDEFLATE_H_INCLUDED
+#define RIPPLE_WSDEFLATE_H_INCLUDED
+
+namespace ripple {
+
+/** permessage-deflate (RFC 7692) for one websocket connection.
+
+    Outbound messages share one raw deflate stream, so the field names and
+    account IDs repeated from message to message compress against earlier
+    messages. Each message ends with a sync flush, and the empty block that
+    flush leaves at the end is stripped as the RFC requires.
+
+    The handshake response always includes client_no_context_takeover, so
+    client messages are inflated one at a time and no inflate window is kept
+    per connection.
+*/
+class WSDeflate : public beast::Uncopyable
+{
+public:
+    /** The negotiated parameters for our outbound stream. */
+    struct Params
+    {
+        Params ();
+
+        // The window as zlib windowBits.
+        int windowBits;
+
+        // The client asked us to start each message with an empty window.
+        bool noContextTakeover;
+    };
+
+    /** Choose an acceptable permessage-deflate offer.
+        @param offers The client's Sec-WebSocket-Extensions offers.
+        @return The value for the response, or empty if there is none.
+    */
+    static std::string negotiate (std::vector <std::string> const& offers,
+        Params& params);
+
+    explicit WSDeflate (Params const& params);
+
+    ~WSDeflate ();
+
+    /** Compress one message.
+        If this returns false the stream is broken and the message must be
+        sent uncompressed, as must every later one.
+    */
+    bool compress (std::string const& in, std::string& out);
+
+    /** Inflate one client message.
+        @return false if the data is corrupt or inflates to more than
+                maxSize bytes.
+    */
+    static bool decompress (std::string const& in, std::string& out,
+        std::size_t maxSize);
+
+private:
+    z_stream m_stream;
+    bool m_ok;
+    bool const m_reset;
+};
+
+} // ripple
+
+#endif
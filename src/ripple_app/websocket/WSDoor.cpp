@@ -47,12 +47,14 @@ class WSDoorImp
 public:
     WSDoorImp (Resource::Manager& resourceManager,
         InfoSub::Source& source, std::string const& strIp,
-            int iPort, bool bPublic, bool bProxy, boost::asio::ssl::context& ssl_context)
+            int iPort, bool bPublic, bool bProxy, boost::asio::ssl::context& ssl_context,
+                beast::insight::Collector::ptr const& collector)
         : WSDoor (source)
         , Thread ("websocket")
         , m_resourceManager (resourceManager)
         , m_source (source)
         , m_ssl_context (ssl_context)
+        , m_collector (collector)
         , mPublic (bPublic)
         , mProxy (bProxy)
         , mIp (strIp)
@@ -75,7 +77,7 @@ private:
 
         websocketpp::server_multitls::handler::ptr handler (
             new WSServerHandler <websocketpp::server_multitls> (
-                m_resourceManager, m_source, m_ssl_context, mPublic, mProxy));
+                m_resourceManager, m_source, m_ssl_context, mPublic, mProxy, m_collector));
 
         {
             ScopedLockType lock (m_endpointLock);
@@ -145,6 +147,7 @@ private:
     Resource::Manager& m_resourceManager;
     InfoSub::Source& m_source;
     boost::asio::ssl::context& m_ssl_context;
+    beast::insight::Collector::ptr m_collector;
     LockType m_endpointLock;
 
     boost::shared_ptr<websocketpp::server_multitls> m_endpoint;
@@ -165,14 +168,15 @@ WSDoor::WSDoor (Stoppable& parent)
 
 WSDoor* WSDoor::New (Resource::Manager& resourceManager,
     InfoSub::Source& source, std::string const& strIp,
-        int iPort, bool bPublic, bool bProxy, boost::asio::ssl::context& ssl_context)
+        int iPort, bool bPublic, bool bProxy, boost::asio::ssl::context& ssl_context,
+            beast::insight::Collector::ptr const& collector)
 {
     std::unique_ptr <WSDoor> door;
 
     try
     {
         door = std::make_unique <WSDoorImp> (resourceManager,
-            source, strIp, iPort, bPublic, bProxy, ssl_context);
+            source, strIp, iPort, bPublic, bProxy, ssl_context, collector);
     }
     catch (...)
     {
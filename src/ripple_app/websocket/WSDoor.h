@@ -33,7 +33,8 @@ public:
 
     static WSDoor* New (Resource::Manager& resourceManager,
         InfoSub::Source& source, std::string const& strIp,
-            int iPort, bool bPublic, bool bProxy, boost::asio::ssl::context& ssl_context);
+            int iPort, bool bPublic, bool bProxy, boost::asio::ssl::context& ssl_context,
+                beast::insight::Collector::ptr const& collector);
 };
 
 } // ripple
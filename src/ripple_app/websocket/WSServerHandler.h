@@ -49,6 +49,7 @@ public:
     typedef typename endpoint_type::handler::connection_ptr     connection_ptr;
     typedef typename endpoint_type::handler::message_ptr        message_ptr;
     typedef boost::shared_ptr< WSConnectionType <endpoint_type> >    wsc_ptr;
+    typedef RPC::LatencyTracker::clock_type                         clock_type;
 
     // Private reasons to close.
     enum
@@ -77,15 +78,68 @@ protected:
     bool const mPublic;
     bool const mProxy;
 
+private:
+    // Messages smaller than this are not worth compressing
+    static std::size_t const minimumCompressSize = 256;
+
+    beast::insight::Hook m_hook;
+    beast::insight::Gauge m_queuedBytes;
+    beast::insight::Counter m_rawBytes;
+    beast::insight::Counter m_compressedBytes;
+    beast::insight::Counter m_dropped;
+    beast::insight::Counter m_tooSlow;
+
 public:
     WSServerHandler (Resource::Manager& resourceManager,
-        InfoSub::Source& source, boost::asio::ssl::context& ssl_context, bool bPublic, bool bProxy)
+        InfoSub::Source& source, boost::asio::ssl::context& ssl_context, bool bPublic, bool bProxy,
+            beast::insight::Collector::ptr const& collector)
         : m_resourceManager (resourceManager)
         , m_source (source)
         , m_ssl_context (ssl_context)
         , mPublic (bPublic)
         , mProxy (bProxy)
     {
+        m_hook = collector->make_hook (std::bind (
+            &WSServerHandler::collect, this));
+        m_queuedBytes = collector->make_gauge ("queued_bytes");
+        m_rawBytes = collector->make_counter ("raw_bytes");
+        m_compressedBytes = collector->make_counter ("compressed_bytes");
+        m_dropped = collector->make_counter ("dropped");
+        m_tooSlow = collector->make_counter ("too_slow");
+    }
+
+    ~WSServerHandler ()
+    {
+        // Must unhook before destroying
+        m_hook = beast::insight::Hook ();
+    }
+
+    void collect ()
+    {
+        // Connections lock themselves before calling us, so they must
+        // not be asked for their queues while mLock is held.
+        std::vector <std::pair <connection_ptr, wsc_ptr> > clients;
+        {
+            ScopedLockType sl (mLock);
+            clients.assign (mMap.begin (), mMap.end ());
+        }
+
+        std::size_t queued = 0;
+
+        for (auto const& client : clients)
+            queued += client.first->buffered_amount () + client.second->getPending ();
+
+        m_queuedBytes = queued;
+    }
+
+    void onDropped ()
+    {
+        ++m_dropped;
+    }
+
+    void onTooSlow ()
+    {
+        ++m_tooSlow;
     }
 
     bool getPublic ()
@@ -105,13 +159,34 @@ public:
         }
     }
 
-    static void ssendb (connection_ptr cpClient, const std::string& strMessage, bool broadcast)
+    void ssendb (connection_ptr cpClient, std::shared_ptr <WSSendState> const& state,
+        const std::string& strMessage, bool binary, bool broadcast)
     {
+        state->pending -= strMessage.size ();
+
         try
         {
-            WriteLog (broadcast ? lsTRACE : lsDEBUG, WSServerHandlerLog) << "Ws:: Sending '" << strMessage << "'";
+            websocketpp::frame::opcode::value const op = binary
+                ? websocketpp::frame::opcode::BINARY
+                : websocketpp::frame::opcode::TEXT;
+
+            if (!binary)
+                WriteLog (broadcast ? lsTRACE : lsDEBUG, WSServerHandlerLog) << "Ws:: Sending '" << strMessage << "'";
 
-            cpClient->send (strMessage);
+            std::string compressed;
+
+            if (state->deflate && strMessage.size () >= minimumCompressSize &&
+                state->deflate->compress (strMessage, compressed))
+            {
+                m_rawBytes += strMessage.size ();
+                m_compressedBytes += compressed.size ();
+
+                cpClient->send (compressed, op, true);
+            }
+            else
+            {
+                cpClient->send (strMessage, op);
+            }
         }
         catch (...)
         {
@@ -125,19 +200,13 @@ public:
                                           &WSServerHandler<endpoint_type>::ssend, cpClient, mpMessage));
     }
 
-    void send (connection_ptr cpClient, const std::string& strMessage, bool broadcast)
+    // Callers account for the message in state->pending
+    void send (connection_ptr const& cpClient, std::shared_ptr <WSSendState> const& state,
+        const std::string& strMessage, bool binary, bool broadcast)
     {
         cpClient->get_strand ().post (BIND_TYPE (
-                                          &WSServerHandler<endpoint_type>::ssendb, cpClient, strMessage, broadcast));
-    }
-
-    void send (connection_ptr cpClient, const Json::Value& jvObj, bool broadcast)
-    {
-        Json::FastWriter    jfwWriter;
-
-        // WriteLog (lsDEBUG, WSServerHandlerLog) << "Ws:: Object '" << jfwWriter.write(jvObj) << "'";
-
-        send (cpClient, jfwWriter.write (jvObj), broadcast);
+                                          &WSServerHandler<endpoint_type>::ssendb, this, cpClient, state,
+                                              strMessage, binary, broadcast));
     }
 
     void pingTimer (connection_ptr cpClient)
@@ -186,6 +255,26 @@ public:
         ptr->onSendEmpty ();
     }
 
+    /** The permessage-deflate response for a client, empty if it gets none. */
+    static std::string negotiateDeflate (connection_ptr const& cpClient,
+        WSDeflate::Params& params)
+    {
+        // hybi00 has no reserved bits to mark compressed messages with
+        if (!getConfig ().WEBSOCKET_COMPRESS || cpClient->get_version () < 7)
+            return std::string ();
+
+        return WSDeflate::negotiate (cpClient->get_extensions (), params);
+    }
+
+    void validate (connection_ptr cpClient)
+    {
+        WSDeflate::Params params;
+        std::string const response (negotiateDeflate (cpClient, params));
+
+        if (!response.empty ())
+            cpClient->select_extension (response);
+    }
+
     void on_open (connection_ptr cpClient)
     {
         ScopedLockType   sl (mLock);
@@ -332,14 +421,15 @@ public:
         //
         for (int i = 0; i < 3; ++i)
         {
-            message_ptr msg = ptr->getMessage ();
+            clock_type::time_point received;
+            message_ptr msg = ptr->getMessage (received);
 
             if (!msg)
                 return;
 
-            if (!do_message (job, cpClient, ptr, msg))
+            if (!do_message (job, cpClient, ptr, msg, received))
             {
-                ptr->returnMessage(msg);
+                ptr->returnMessage(msg, received);
                 return;
             }
         }
@@ -349,16 +439,28 @@ public:
                                        BIND_TYPE (&WSServerHandler<endpoint_type>::do_messages, this, P_1, cpClient));
     }
 
-    bool do_message (Job& job, const connection_ptr& cpClient, const wsc_ptr& conn, const message_ptr& mpMessage)
+    bool do_message (Job& job, const connection_ptr& cpClient, const wsc_ptr& conn,
+        const message_ptr& mpMessage, clock_type::time_point received)
     {
+        RPC::LatencyTracker::Timing timing ("ws", received);
+        timing.add (RPC::LatencyTracker::phaseQueue, received);
+
         Json::Value     jvRequest;
-        Json::Reader    jrReader;
+        Json::Parser    jpParser;
+
+        // A compressed request may inflate to no more than rcvMessage allows
+        std::string inflated;
+        bool const inflateFailed = mpMessage->get_compressed () &&
+            !WSDeflate::decompress (mpMessage->get_payload (), inflated, 1000000);
+        std::string const& payload = mpMessage->get_compressed ()
+            ? inflated
+            : mpMessage->get_payload ();
 
         try
         {
             WriteLog (lsDEBUG, WSServerHandlerLog) <<
                 "Ws:: Receiving(" << to_string (cpClient->get_socket ().remote_endpoint ()) <<
-                ") '" << mpMessage->get_payload () << "'";
+                ") '" << payload << "'";
         }
         catch (...)
         {
@@ -371,17 +473,17 @@ public:
             jvResult[jss::type]    = jss::error;
             jvResult[jss::error]   = "wsTextRequired"; // We only accept text messages.
 
-            send (cpClient, jvResult, false);
+            conn->send (jvResult, false);
         }
-        else if (!jrReader.parse (mpMessage->get_payload (), jvRequest) || jvRequest.isNull () || !jvRequest.isObject ())
+        else if (inflateFailed || !jpParser.parse (payload, jvRequest) || jvRequest.isNull () || !jvRequest.isObject ())
         {
             Json::Value jvResult (Json::objectValue);
 
             jvResult[jss::type]    = jss::error;
             jvResult[jss::error]   = "jsonInvalid";    // Received invalid json.
-            jvResult[jss::value]   = mpMessage->get_payload ();
+            jvResult[jss::value]   = payload;
 
-            send (cpClient, jvResult, false);
+            conn->send (jvResult, false);
         }
         else
         {
@@ -392,7 +494,13 @@ public:
                     job.rename (std::string ("WSClient::") + jCmd.asString());
             }
 
-            send (cpClient, conn->invokeCommand (jvRequest), false);
+            Json::Value const jvResult (conn->invokeCommand (jvRequest, timing));
+
+            clock_type::time_point const serializeStart (clock_type::now ());
+            conn->send (jvResult, false);
+            timing.add (RPC::LatencyTracker::phaseSerialize, serializeStart);
+
+            getApp().getRPCLatency ().record (timing);
         }
 
         return true;
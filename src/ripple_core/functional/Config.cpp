@@ -103,6 +103,9 @@ Config::Config ()
     WEBSOCKET_PROXY_SECURE  = 1;
     WEBSOCKET_SECURE        = 0;
     WEBSOCKET_PING_FREQ     = (5 * 60);
+    WEBSOCKET_COMPRESS      = true;
+    WEBSOCKET_SEND_BUDGET   = 2048 * 1024;
+    WEBSOCKET_SLOW_CLIENT   = slowDisconnect;
     NUMBER_CONNECTIONS      = 30;
 
     // a new ledger every minute
@@ -110,6 +113,7 @@ Config::Config ()
     LEDGER_CREATOR          = false;
 
     RPC_ALLOW_REMOTE        = false;
+    RPC_SLOW_THRESHOLD      = 1000;
     RPC_ADMIN_ALLOW.push_back (beast::IP::Endpoint::from_string("127.0.0.1"));
 
     PEER_SSL_CIPHER_LIST    = DEFAULT_PEER_SSL_CIPHER_LIST;
@@ -121,6 +125,11 @@ Config::Config ()
     PEER_PRIVATE            = false;
     PEERS_MAX               = 0;    // indicates "use default"
 
+    RELAY_FANOUT            = 12;
+    RELAY_SQUELCH           = true;
+
+    CLUSTER_SIGNATURES      = false;
+
     TRANSACTION_FEE_BASE    = DEFAULT_FEE_DEFAULT;
 
     NETWORK_QUORUM          = 0;    // Don't need to see other nodes
@@ -133,6 +142,8 @@ Config::Config ()
     FEE_DEFAULT             = DEFAULT_FEE_DEFAULT;
     FEE_CONTRACT_OPERATION  = DEFAULT_FEE_OPERATION;
 
+    PARALLEL_APPLY          = 0;
+
     LEDGER_HISTORY          = 256;
     FETCH_DEPTH             = 1000000000;
 
@@ -166,6 +177,8 @@ void Config::setup (const std::string& strConf, bool bQuiet)
 
     QUIET       = bQuiet;
     NODE_SIZE   = 0;
+    CACHE_MEMORY = 0;
+    WARM_RESTART_KEYS = 200000;
 
     strDbPath           = Helpers::getDatabaseDirName ();
     strConfFile         = strConf.empty () ? Helpers::getConfigFileName () : strConf;
@@ -340,6 +353,9 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_DATABASE_PATH, DATABASE_PATH))
                 DATA_DIR    = DATABASE_PATH;
 
+            if (SectionSingleB (secConfig, SECTION_NODE_SHARDS, strTemp))
+                SHARD_DIR   = boost::filesystem::absolute (strTemp, CONFIG_DIR);
+
 
             (void) SectionSingleB (secConfig, SECTION_VALIDATORS_SITE, VALIDATORS_SITE);
 
@@ -351,6 +367,15 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_PEERS_MAX, strTemp))
                 PEERS_MAX           = beast::lexicalCastThrow <int> (strTemp);
 
+            if (SectionSingleB (secConfig, SECTION_RELAY_FANOUT, strTemp))
+                RELAY_FANOUT        = beast::lexicalCastThrow <unsigned int> (strTemp);
+
+            if (SectionSingleB (secConfig, SECTION_RELAY_SQUELCH, strTemp))
+                RELAY_SQUELCH       = beast::lexicalCastThrow <bool> (strTemp);
+
+            if (SectionSingleB (secConfig, SECTION_CLUSTER_SIGNATURES, strTemp))
+                CLUSTER_SIGNATURES  = beast::lexicalCastThrow <bool> (strTemp);
+
             smtTmp = SectionEntries (secConfig, SECTION_RPC_ADMIN_ALLOW);
 
             if (smtTmp)
@@ -436,6 +461,12 @@ void Config::load ()
                 }
             }
 
+            if (SectionSingleB (secConfig, SECTION_CACHE_MEMORY, strTemp))
+                CACHE_MEMORY        = std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
+            if (SectionSingleB (secConfig, SECTION_WARM_RESTART, strTemp))
+                WARM_RESTART_KEYS   = std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
             if (SectionSingleB (secConfig, SECTION_ELB_SUPPORT, strTemp))
                 ELB_SUPPORT         = beast::lexicalCastThrow <bool> (strTemp);
 
@@ -466,6 +497,24 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_WEBSOCKET_PING_FREQ, strTemp))
                 WEBSOCKET_PING_FREQ = beast::lexicalCastThrow <int> (strTemp);
 
+            if (SectionSingleB (secConfig, SECTION_WEBSOCKET_COMPRESS, strTemp))
+                WEBSOCKET_COMPRESS  = beast::lexicalCastThrow <bool> (strTemp);
+
+            if (SectionSingleB (secConfig, SECTION_WEBSOCKET_SEND_BUDGET, strTemp))
+                WEBSOCKET_SEND_BUDGET = 1024 * std::max (0, beast::lexicalCastThrow <int> (strTemp));
+
+            if (SectionSingleB (secConfig, SECTION_WEBSOCKET_SLOW_CLIENT, strTemp))
+            {
+                if (strTemp == "disconnect")
+                    WEBSOCKET_SLOW_CLIENT = slowDisconnect;
+                else if (strTemp == "drop")
+                    WEBSOCKET_SLOW_CLIENT = slowDrop;
+                else if (strTemp == "coalesce")
+                    WEBSOCKET_SLOW_CLIENT = slowCoalesce;
+                else
+                    throw std::runtime_error ("Unknown [" SECTION_WEBSOCKET_SLOW_CLIENT "] setting: " + strTemp);
+            }
+
             SectionSingleB (secConfig, SECTION_WEBSOCKET_SSL_CERT, WEBSOCKET_SSL_CERT);
             SectionSingleB (secConfig, SECTION_WEBSOCKET_SSL_CHAIN, WEBSOCKET_SSL_CHAIN);
             SectionSingleB (secConfig, SECTION_WEBSOCKET_SSL_KEY, WEBSOCKET_SSL_KEY);
@@ -477,6 +526,9 @@ void Config::load ()
             SectionSingleB (secConfig, SECTION_RPC_SSL_CHAIN, RPC_SSL_CHAIN);
             SectionSingleB (secConfig, SECTION_RPC_SSL_KEY, RPC_SSL_KEY);
 
+            if (SectionSingleB (secConfig, SECTION_RPC_SLOW_THRESHOLD, strTemp))
+                RPC_SLOW_THRESHOLD = beast::lexicalCastThrow <int> (strTemp);
+
 
             SectionSingleB (secConfig, SECTION_SSL_VERIFY_FILE, SSL_VERIFY_FILE);
             SectionSingleB (secConfig, SECTION_SSL_VERIFY_DIR, SSL_VERIFY_DIR);
@@ -577,6 +629,9 @@ void Config::load ()
             if (SectionSingleB (secConfig, SECTION_PATH_SEARCH_MAX, strTemp))
                 PATH_SEARCH_MAX     = beast::lexicalCastThrow <int> (strTemp);
 
+            if (SectionSingleB (secConfig, SECTION_PARALLEL_APPLY, strTemp))
+                PARALLEL_APPLY      = beast::lexicalCastThrow <int> (strTemp);
+
             if (SectionSingleB (secConfig, SECTION_ACCOUNT_PROBE_MAX, strTemp))
                 ACCOUNT_PROBE_MAX   = beast::lexicalCastThrow <int> (strTemp);
 
@@ -618,6 +673,11 @@ int Config::getSize (SizedItemName item)
         { siTreeCacheSize,      {   8192,   65536,  131072, 131072,     0       } },
         { siTreeCacheAge,       {   30,     60,     90,     120,        900     } },
 
+        // In megabytes
+        { siNodeCacheBytes,     {   16,     32,     128,    512,        1024    } },
+        { siTreeCacheBytes,     {   16,     64,     256,    1024,       2048    } },
+        { siSLECacheBytes,      {   4,      8,      16,     64,         128     } },
+
         { siSLECacheSize,       {   4096,   8192,   16384,  65536,      0       } },
         { siSLECacheAge,        {   30,     60,     90,     120,        300     } },
 
@@ -67,6 +67,9 @@ enum SizedItemName
     siNodeCacheAge,
     siTreeCacheSize,
     siTreeCacheAge,
+    siNodeCacheBytes,
+    siTreeCacheBytes,
+    siSLECacheBytes,
     siSLECacheSize,
     siSLECacheAge,
     siLedgerSize,
@@ -371,6 +374,7 @@ public:
 
     // Database
     std::string                 DATABASE_PATH;
+    boost::filesystem::path     SHARD_DIR;              // Read-only history shards
 
     // Network parameters
     int                         NETWORK_START_TIME;     // The Unix time we start ledger 0.
@@ -404,6 +408,8 @@ public:
     unsigned int                PEER_CONNECT_LOW_WATER;
     bool                        PEER_PRIVATE;           // True to ask peers not to relay current IP.
     unsigned int                PEERS_MAX;
+    unsigned int                RELAY_FANOUT;           // Peers each relayed transaction goes to, 0 for all
+    bool                        RELAY_SQUELCH;          // True to squelch redundant validator streams
 
     // Websocket networking parameters
     std::string                 WEBSOCKET_PUBLIC_IP;        // XXX Going away. Merge with the inbound peer connction.
@@ -420,6 +426,22 @@ public:
 
     int                         WEBSOCKET_PING_FREQ;
 
+    // Outbound permessage-deflate, when the client offers it.
+    bool                        WEBSOCKET_COMPRESS;
+
+    // Bytes a client may have queued for sending before stream messages
+    // are subject to WEBSOCKET_SLOW_CLIENT. Zero means no limit.
+    int                         WEBSOCKET_SEND_BUDGET;
+
+    /** What to do with stream messages for a client over its send budget. */
+    enum SlowClient
+    {
+        slowDisconnect,     // Close with "Client is too slow."
+        slowDrop,           // Discard the message
+        slowCoalesce        // Keep only the latest ledger close, drop the rest
+    };
+    SlowClient                  WEBSOCKET_SLOW_CLIENT;
+
     std::string                 WEBSOCKET_SSL_CERT;
     std::string                 WEBSOCKET_SSL_CHAIN;
     std::string                 WEBSOCKET_SSL_KEY;
@@ -438,6 +460,9 @@ public:
     std::string                 RPC_SSL_CHAIN;
     std::string                 RPC_SSL_KEY;
 
+    // Milliseconds after which a request is recorded as slow
+    int                         RPC_SLOW_THRESHOLD;
+
     // Path searching
     int                         PATH_SEARCH_OLD;
     int                         PATH_SEARCH;
@@ -449,6 +474,7 @@ public:
 
     // Node/Cluster
     std::vector<std::string>    CLUSTER_NODES;
+    bool                        CLUSTER_SIGNATURES;     // True to share signature check results with the cluster
     RippleAddress               NODE_SEED, NODE_PUB, NODE_PRIV;
 
     // Fee schedule (All below values are in fee units)
@@ -459,11 +485,23 @@ public:
     std::uint64_t                      FEE_OFFER;              // Rate per day.
     int                         FEE_CONTRACT_OPERATION; // fee for each contract operation
 
+    // Threads used to speculatively apply transactions when
+    // building a ledger. Zero or one means apply serially.
+    int                         PARALLEL_APPLY;
+
     // Node storage configuration
     std::uint32_t                      LEDGER_HISTORY;
     std::uint32_t                      FETCH_DEPTH;
     int                         NODE_SIZE;
 
+    // Megabytes shared by the node, tree node and ledger entry caches,
+    // zero means the default for the node size.
+    int                         CACHE_MEMORY;
+
+    // The number of hot node store keys recorded for a warm restart,
+    // zero disables recording and prefetching them.
+    int                         WARM_RESTART_KEYS;
+
     // Client behavior
     int                         ACCOUNT_PROBE_MAX;      // How far to scan for accounts.
 
@@ -37,7 +37,9 @@ struct ConfigSection
 
 // VFALCO TODO Rename and replace these macros with variables.
 #define SECTION_ACCOUNT_PROBE_MAX       "account_probe_max"
+#define SECTION_CACHE_MEMORY            "cache_memory"
 #define SECTION_CLUSTER_NODES           "cluster_nodes"
+#define SECTION_CLUSTER_SIGNATURES      "cluster_signatures"
 #define SECTION_DATABASE_PATH           "database_path"
 #define SECTION_DEBUG_LOGFILE           "debug_logfile"
 #define SECTION_CONSOLE_LOG_OUTPUT      "console_log_output"
@@ -55,7 +57,9 @@ struct ConfigSection
 #define SECTION_IPS_FIXED               "ips_fixed"
 #define SECTION_NETWORK_QUORUM          "network_quorum"
 #define SECTION_NODE_SEED               "node_seed"
+#define SECTION_NODE_SHARDS             "node_shards"
 #define SECTION_NODE_SIZE               "node_size"
+#define SECTION_PARALLEL_APPLY          "parallel_apply"
 #define SECTION_PATH_SEARCH_OLD         "path_search_old"
 #define SECTION_PATH_SEARCH             "path_search"
 #define SECTION_PATH_SEARCH_FAST        "path_search_fast"
@@ -69,6 +73,8 @@ struct ConfigSection
 #define SECTION_PEER_SCAN_INTERVAL_MIN  "peer_scan_interval_min"
 #define SECTION_PEER_SSL_CIPHER_LIST    "peer_ssl_cipher_list"
 #define SECTION_PEER_START_MAX          "peer_start_max"
+#define SECTION_RELAY_FANOUT            "relay_fanout"
+#define SECTION_RELAY_SQUELCH           "relay_squelch"
 #define SECTION_RPC_ALLOW_REMOTE        "rpc_allow_remote"
 #define SECTION_RPC_ADMIN_ALLOW         "rpc_admin_allow"
 #define SECTION_RPC_ADMIN_USER          "rpc_admin_user"
@@ -82,6 +88,7 @@ struct ConfigSection
 #define SECTION_RPC_SSL_CERT            "rpc_ssl_cert"
 #define SECTION_RPC_SSL_CHAIN           "rpc_ssl_chain"
 #define SECTION_RPC_SSL_KEY             "rpc_ssl_key"
+#define SECTION_RPC_SLOW_THRESHOLD      "rpc_slow_threshold"
 #define SECTION_SMS_FROM                "sms_from"
 #define SECTION_SMS_KEY                 "sms_key"
 #define SECTION_SMS_SECRET              "sms_secret"
@@ -94,6 +101,7 @@ struct ConfigSection
 #define SECTION_VALIDATORS_FILE         "validators_file"
 #define SECTION_VALIDATION_QUORUM       "validation_quorum"
 #define SECTION_VALIDATION_SEED         "validation_seed"
+#define SECTION_WARM_RESTART            "warm_restart"
 #define SECTION_WEBSOCKET_PUBLIC_IP     "websocket_public_ip"
 #define SECTION_WEBSOCKET_PUBLIC_PORT   "websocket_public_port"
 #define SECTION_WEBSOCKET_PUBLIC_SECURE "websocket_public_secure"
@@ -101,6 +109,9 @@ struct ConfigSection
 #define SECTION_WEBSOCKET_PROXY_PORT   "websocket_proxy_port"
 #define SECTION_WEBSOCKET_PROXY_SECURE "websocket_proxy_secure"
 #define SECTION_WEBSOCKET_PING_FREQ     "websocket_ping_frequency"
+#define SECTION_WEBSOCKET_COMPRESS      "websocket_compress"
+#define SECTION_WEBSOCKET_SEND_BUDGET   "websocket_send_budget"
+#define SECTION_WEBSOCKET_SLOW_CLIENT   "websocket_slow_client"
 #define SECTION_WEBSOCKET_IP            "websocket_ip"
 #define SECTION_WEBSOCKET_PORT          "websocket_port"
 #define SECTION_WEBSOCKET_SECURE        "websocket_secure"
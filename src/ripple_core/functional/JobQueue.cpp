@@ -543,6 +543,8 @@ private:
     //
     void processTask ()
     {
+        Profiler::registerThread ("JobQueue");
+
         Job job;
 
         {
@@ -565,7 +567,9 @@ private:
                 Job::clock_type::now());
 
             on_dequeue (job.getType (), start_time - job.queue_time ());
+            Profiler::setJob (data.info.name ().c_str ());
             job.doJob ();
+            Profiler::setJob (nullptr);
             on_execute (job.getType (), Job::clock_type::now() - start_time);
         }
         else
@@ -111,6 +111,10 @@ public:
         add (jtACCEPT,        "acceptLedger",
             maxLimit, false,  false, 0,     0);
 
+        // Apply consensus transactions speculatively
+        add (jtSPECULATE,     "speculateTransactions",
+            maxLimit, false,  false, 0,     0);
+
         // A proposal from a trusted source
         add (jtPROPOSAL_t,    "trustedProposal",
             maxLimit, false,  false, 100,   500);
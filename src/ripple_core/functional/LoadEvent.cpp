@@ -26,6 +26,7 @@ LoadEvent::LoadEvent (LoadMonitor& monitor, const std::string& name, bool should
     , m_timeStopped (beast::RelativeTime::fromStartup())
     , m_secondsWaiting (0)
     , m_secondsRunning (0)
+    , m_profilerTag (-1)
 {
     if (shouldStart)
         start ();
@@ -60,6 +61,9 @@ double LoadEvent::getSecondsTotal() const
 void LoadEvent::reName (const std::string& name)
 {
     m_name = name;
+
+    if (m_profilerTag >= 0)
+        Profiler::setTag (m_profilerTag, m_name);
 }
 
 void LoadEvent::start ()
@@ -75,6 +79,7 @@ void LoadEvent::start ()
     {
         m_secondsWaiting += (currentTime - m_timeStopped).inSeconds();
         m_isRunning = true;
+        m_profilerTag = Profiler::pushTag (m_name);
     }
 
     m_timeStarted = currentTime;
@@ -88,6 +93,8 @@ void LoadEvent::stop ()
     m_secondsRunning += (m_timeStopped - m_timeStarted).inSeconds();
 
     m_isRunning = false;
+    Profiler::popTag (m_profilerTag);
+    m_profilerTag = -1;
     m_loadMonitor.addLoadSample (*this);
 }
 
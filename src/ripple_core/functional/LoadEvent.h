@@ -79,6 +79,7 @@ private:
     beast::RelativeTime m_timeStarted;
     double m_secondsWaiting;
     double m_secondsRunning;
+    int m_profilerTag;
 };
 
 } // ripple
@@ -0,0 +1,680 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#if BEAST_LINUX || BEAST_MAC
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+namespace ripple {
+
+#if BEAST_LINUX || BEAST_MAC
+
+namespace ProfilerDetail {
+
+enum
+{
+    // Most threads that can be registered at once
+    maxThreads = 128
+
+    // Deepest call stack captured, including the signal frames
+    ,maxFrames = 48
+
+    // Samples buffered per thread between drains
+    ,ringSize = 16
+
+    // Nested LoadEvent tags tracked per thread
+    ,maxTags = 4
+
+    // Longest tag or thread name kept, including the terminator
+    ,nameSize = 32
+
+    // Frames for the signal handler and the trampoline that called it
+    ,skipFrames = 2
+};
+
+struct Sample
+{
+    char const* job;
+    char tag [nameSize];
+    int frames;
+    void* pc [maxFrames];
+};
+
+// Everything the signal handler touches lives here, in static storage.
+// The ring is single producer (the handler, on the owning thread) and
+// single consumer (the sampler thread).
+//
+struct Slot
+{
+    bool used;
+    pthread_t thread;
+    char name [nameSize];
+    std::atomic <char const*> job;
+    std::atomic <int> depth;
+    char tags [maxTags][nameSize];
+    std::atomic <unsigned> head;
+    std::atomic <unsigned> tail;
+    Sample ring [ringSize];
+};
+
+static void copyName (char* dest, char const* source)
+{
+    std::strncpy (dest, source, nameSize - 1);
+    dest [nameSize - 1] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+// A captured stack, identified by where and what it was doing
+struct Stack
+{
+    std::string thread;
+    std::string job;
+    std::string tag;
+    std::vector <void*> frames;
+
+    bool operator< (Stack const& other) const
+    {
+        return std::tie (thread, job, tag, frames) <
+            std::tie (other.thread, other.job, other.tag, other.frames);
+    }
+};
+
+class State
+{
+public:
+    State ()
+        : m_stopping (false)
+        , m_installed (false)
+        , m_interval (0)
+        , m_samples (0)
+    {
+        pthread_key_create (&m_key, &State::onThreadExit);
+    }
+
+    ~State ()
+    {
+        // A joinable std::thread would terminate the process
+        stop ();
+    }
+
+    static State& get ()
+    {
+        static State instance;
+        return instance;
+    }
+
+    static bool running ()
+    {
+        return s_running.load (std::memory_order_relaxed);
+    }
+
+    static Slot* slot ()
+    {
+        return t_slot;
+    }
+
+    void registerThread (char const* name)
+    {
+        if (t_registered)
+            return;
+        t_registered = true;
+
+        std::lock_guard <std::mutex> lock (m_mutex);
+        for (int i = 0; i < maxThreads; ++i)
+        {
+            Slot& slot (s_slots [i]);
+            if (! slot.used)
+            {
+                slot.used = true;
+                slot.thread = pthread_self ();
+                copyName (slot.name, name);
+                slot.job.store (nullptr, std::memory_order_relaxed);
+                slot.depth.store (0, std::memory_order_relaxed);
+                slot.head.store (0, std::memory_order_relaxed);
+                slot.tail.store (0, std::memory_order_relaxed);
+                pthread_setspecific (m_key, &slot);
+                t_slot = &slot;
+                return;
+            }
+        }
+        // All slots taken, this thread is not sampled
+    }
+
+    bool start (std::chrono::microseconds interval)
+    {
+        std::lock_guard <std::mutex> lock (m_mutex);
+        if (s_running.load ())
+            return false;
+
+        if (! m_installed)
+        {
+            // The first call to backtrace may allocate while loading the
+            // unwinder, which is not safe from inside the handler.
+            void* warmup [1];
+            backtrace (warmup, 1);
+
+            struct sigaction sa;
+            std::memset (&sa, 0, sizeof (sa));
+            sa.sa_handler = &State::onSignal;
+            sa.sa_flags = SA_RESTART;
+            sigemptyset (&sa.sa_mask);
+            if (sigaction (SIGPROF, &sa, nullptr) != 0)
+                return false;
+
+            // The handler stays installed: a pending SIGPROF after stop
+            // would otherwise terminate the process.
+            m_installed = true;
+        }
+
+        {
+            std::lock_guard <std::mutex> lock (m_stacksMutex);
+            m_stacks.clear ();
+            m_samples = 0;
+            s_dropped.store (0);
+        }
+
+        m_interval = interval;
+        m_started = std::chrono::steady_clock::now ();
+        m_stopping = false;
+        s_running.store (true);
+        m_thread = std::thread (&State::run, this);
+        return true;
+    }
+
+    bool stop ()
+    {
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            if (! s_running.load () || m_stopping)
+                return false;
+            m_stopping = true;
+            m_cond.notify_all ();
+        }
+
+        m_thread.join ();
+
+        std::lock_guard <std::mutex> lock (m_mutex);
+        s_running.store (false);
+        drain ();
+        m_stopping = false;
+        return true;
+    }
+
+    Json::Value getJson (bool stacks)
+    {
+        Json::Value ret (Json::objectValue);
+
+        ret["running"] = s_running.load ();
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            int threads (0);
+            for (int i = 0; i < maxThreads; ++i)
+                if (s_slots [i].used)
+                    ++threads;
+            ret["threads"] = threads;
+            if (s_running.load ())
+            {
+                ret["interval_us"] = static_cast <Json::UInt> (
+                    m_interval.count ());
+                ret["seconds"] = static_cast <Json::UInt> (
+                    std::chrono::duration_cast <std::chrono::seconds> (
+                        std::chrono::steady_clock::now () - m_started).count ());
+            }
+        }
+
+        std::map <Stack, std::size_t> copy;
+        {
+            std::lock_guard <std::mutex> lock (m_stacksMutex);
+            ret["samples"] = static_cast <Json::UInt> (m_samples);
+            ret["dropped"] = s_dropped.load ();
+            if (stacks)
+                copy = m_stacks;
+        }
+
+        if (stacks)
+        {
+            // Distinct addresses in the same function fold to one line
+            std::map <void*, std::string> symbols;
+            std::map <std::string, std::size_t> lines;
+            for (auto const& entry : copy)
+                lines [fold (entry.first, symbols)] += entry.second;
+
+            Json::Value& folded (ret["stacks"] = Json::arrayValue);
+            for (auto const& line : lines)
+                folded.append (line.first + " " + std::to_string (line.second));
+        }
+
+        return ret;
+    }
+
+private:
+    // Called on the interrupted thread
+    static void onSignal (int)
+    {
+        int const savedErrno = errno;
+
+        Slot* const slot (t_slot);
+        if (slot != nullptr && s_running.load (std::memory_order_relaxed))
+        {
+            unsigned const head (slot->head.load (std::memory_order_relaxed));
+            if (head - slot->tail.load (std::memory_order_acquire) >= ringSize)
+            {
+                s_dropped.fetch_add (1, std::memory_order_relaxed);
+            }
+            else
+            {
+                Sample& sample (slot->ring [head % ringSize]);
+                sample.frames = backtrace (sample.pc, maxFrames);
+                sample.job = slot->job.load (std::memory_order_relaxed);
+                int const depth (std::min <int> (maxTags,
+                    slot->depth.load (std::memory_order_relaxed)));
+                if (depth > 0)
+                    std::memcpy (sample.tag, slot->tags [depth - 1], nameSize);
+                else
+                    sample.tag [0] = 0;
+                slot->head.store (head + 1, std::memory_order_release);
+            }
+        }
+
+        errno = savedErrno;
+    }
+
+    // Called by pthreads when a registered thread exits
+    static void onThreadExit (void* arg)
+    {
+        Slot& slot (*static_cast <Slot*> (arg));
+        t_slot = nullptr;
+        std::atomic_signal_fence (std::memory_order_seq_cst);
+
+        State& state (get ());
+        std::lock_guard <std::mutex> lock (state.m_mutex);
+        state.drain (slot);
+        slot.used = false;
+    }
+
+    void run ()
+    {
+        std::unique_lock <std::mutex> lock (m_mutex);
+        while (! m_stopping)
+        {
+            for (int i = 0; i < maxThreads; ++i)
+            {
+                Slot& slot (s_slots [i]);
+                if (slot.used)
+                    pthread_kill (slot.thread, SIGPROF);
+            }
+
+            m_cond.wait_for (lock, m_interval);
+
+            drain ();
+        }
+    }
+
+    // m_mutex must be held
+    void drain ()
+    {
+        for (int i = 0; i < maxThreads; ++i)
+            if (s_slots [i].used)
+                drain (s_slots [i]);
+    }
+
+    // m_mutex must be held
+    void drain (Slot& slot)
+    {
+        unsigned const head (slot.head.load (std::memory_order_acquire));
+        unsigned tail (slot.tail.load (std::memory_order_relaxed));
+        if (head == tail)
+            return;
+
+        std::lock_guard <std::mutex> lock (m_stacksMutex);
+        for (; tail != head; ++tail)
+        {
+            Sample const& sample (slot.ring [tail % ringSize]);
+            Stack stack;
+            stack.thread = slot.name;
+            if (sample.job != nullptr)
+                stack.job = sample.job;
+            stack.tag = sample.tag;
+            if (sample.frames > skipFrames)
+                stack.frames.assign (sample.pc + skipFrames,
+                    sample.pc + sample.frames);
+            ++m_stacks [stack];
+            ++m_samples;
+        }
+        slot.tail.store (tail, std::memory_order_release);
+    }
+
+    static std::string fold (Stack const& stack,
+        std::map <void*, std::string>& symbols)
+    {
+        std::string result (stack.thread);
+        result += ";" + (stack.job.empty () ? std::string ("-") : stack.job);
+        result += ";" + (stack.tag.empty () ? std::string ("-") : stack.tag);
+
+        // Frames were captured innermost first
+        for (auto iter = stack.frames.rbegin ();
+            iter != stack.frames.rend (); ++iter)
+        {
+            auto found (symbols.find (*iter));
+            if (found == symbols.end ())
+                found = symbols.emplace (*iter, symbolize (*iter)).first;
+            result += ";" + found->second;
+        }
+        return result;
+    }
+
+    // Returns a readable name for a code address. Without a symbol the
+    // module and offset are given, suitable for addr2line.
+    static std::string symbolize (void* pc)
+    {
+        Dl_info info;
+        if (dladdr (pc, &info) == 0 || info.dli_fname == nullptr)
+        {
+            char buf [2 + 2 * sizeof (void*) + 1];
+            std::snprintf (buf, sizeof (buf), "%p", pc);
+            return buf;
+        }
+
+        if (info.dli_sname != nullptr)
+        {
+            int status (0);
+            char* const demangled (abi::__cxa_demangle (
+                info.dli_sname, nullptr, nullptr, &status));
+            std::string name (status == 0 ? demangled : info.dli_sname);
+            std::free (demangled);
+            std::replace (name.begin (), name.end (), ';', ',');
+            return name;
+        }
+
+        char const* module (std::strrchr (info.dli_fname, '/'));
+        module = (module != nullptr) ? module + 1 : info.dli_fname;
+        char buf [32];
+        std::snprintf (buf, sizeof (buf), "+0x%lx", static_cast <unsigned long> (
+            static_cast <char*> (pc) - static_cast <char*> (info.dli_fbase)));
+        return module + std::string (buf);
+    }
+
+    static Slot s_slots [maxThreads];
+    static std::atomic <bool> s_running;
+    static std::atomic <std::uint32_t> s_dropped;
+    static __thread Slot* t_slot;
+    static __thread bool t_registered;
+
+    pthread_key_t m_key;
+
+    // Guards slot registration and the sampler thread
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stopping;
+    bool m_installed;
+    std::chrono::microseconds m_interval;
+    std::chrono::steady_clock::time_point m_started;
+    std::thread m_thread;
+
+    std::mutex m_stacksMutex;
+    std::map <Stack, std::size_t> m_stacks;
+    std::size_t m_samples;
+};
+
+Slot State::s_slots [maxThreads];
+std::atomic <bool> State::s_running (false);
+std::atomic <std::uint32_t> State::s_dropped (0);
+__thread Slot* State::t_slot (nullptr);
+__thread bool State::t_registered (false);
+
+}
+
+//------------------------------------------------------------------------------
+
+void Profiler::registerThread (char const* name)
+{
+    ProfilerDetail::State::get ().registerThread (name);
+}
+
+void Profiler::setJob (char const* name)
+{
+    ProfilerDetail::Slot* const slot (ProfilerDetail::State::slot ());
+    if (slot != nullptr)
+        slot->job.store (name, std::memory_order_relaxed);
+}
+
+int Profiler::pushTag (std::string const& name)
+{
+    using namespace ProfilerDetail;
+
+    Slot* const slot (State::slot ());
+    if (slot == nullptr || ! State::running ())
+        return -1;
+
+    int const depth (slot->depth.load (std::memory_order_relaxed));
+    if (depth < maxTags)
+        copyName (slot->tags [depth], name.c_str ());
+    // The handler must not see the new depth before the text
+    std::atomic_signal_fence (std::memory_order_release);
+    slot->depth.store (depth + 1, std::memory_order_relaxed);
+    return depth;
+}
+
+void Profiler::setTag (int token, std::string const& name)
+{
+    using namespace ProfilerDetail;
+
+    Slot* const slot (State::slot ());
+    if (slot == nullptr || token < 0 || token >= maxTags)
+        return;
+
+    int const depth (slot->depth.load (std::memory_order_relaxed));
+    if (depth == token + 1)
+    {
+        // Hide the tag while it is rewritten
+        slot->depth.store (token, std::memory_order_relaxed);
+        std::atomic_signal_fence (std::memory_order_seq_cst);
+        copyName (slot->tags [token], name.c_str ());
+        std::atomic_signal_fence (std::memory_order_seq_cst);
+        slot->depth.store (depth, std::memory_order_relaxed);
+    }
+    else if (depth > token)
+    {
+        copyName (slot->tags [token], name.c_str ());
+    }
+}
+
+void Profiler::popTag (int token)
+{
+    ProfilerDetail::Slot* const slot (ProfilerDetail::State::slot ());
+    if (slot == nullptr || token < 0)
+        return;
+
+    if (slot->depth.load (std::memory_order_relaxed) > token)
+        slot->depth.store (token, std::memory_order_relaxed);
+}
+
+bool Profiler::start (std::chrono::microseconds interval)
+{
+    return ProfilerDetail::State::get ().start (interval);
+}
+
+bool Profiler::stop ()
+{
+    return ProfilerDetail::State::get ().stop ();
+}
+
+bool Profiler::isRunning ()
+{
+    return ProfilerDetail::State::running ();
+}
+
+Json::Value Profiler::getJson (bool stacks)
+{
+    return ProfilerDetail::State::get ().getJson (stacks);
+}
+
+#else
+
+void Profiler::registerThread (char const*)
+{
+}
+
+void Profiler::setJob (char const*)
+{
+}
+
+int Profiler::pushTag (std::string const&)
+{
+    return -1;
+}
+
+void Profiler::setTag (int, std::string const&)
+{
+}
+
+void Profiler::popTag (int)
+{
+}
+
+bool Profiler::start (std::chrono::microseconds)
+{
+    return false;
+}
+
+bool Profiler::stop ()
+{
+    return false;
+}
+
+bool Profiler::isRunning ()
+{
+    return false;
+}
+
+Json::Value Profiler::getJson (bool)
+{
+    Json::Value ret (Json::objectValue);
+    ret["running"] = false;
+    ret["supported"] = false;
+    return ret;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+// Manual, since it installs a SIGPROF handler and signals the
+// sampled threads every millisecond while the other suites run
+class Profiler_test : public beast::unit_test::suite
+{
+public:
+    // Keeps the thread busy inside a function of its own
+    static std::uint64_t spin (std::chrono::milliseconds duration)
+    {
+        std::uint64_t n (0);
+        auto const end (std::chrono::steady_clock::now () + duration);
+        while (std::chrono::steady_clock::now () < end)
+            for (int i = 0; i < 1000; ++i)
+                n += i * n + 1;
+        return n;
+    }
+
+    void testTags ()
+    {
+        testcase ("tags");
+
+        // Not sampling, so tags are not recorded
+        expect (Profiler::pushTag ("idle") < 0);
+
+        if (! Profiler::start (std::chrono::milliseconds (1)))
+        {
+            // Unsupported on this platform
+            pass ();
+            return;
+        }
+        expect (Profiler::isRunning ());
+        expect (! Profiler::start (std::chrono::milliseconds (1)));
+
+        int outer (-1);
+        int inner (-1);
+        std::thread t ([&]
+        {
+            Profiler::registerThread ("test");
+            Profiler::setJob ("testJob");
+
+            outer = Profiler::pushTag ("outer");
+            inner = Profiler::pushTag ("inner");
+            Profiler::setTag (inner, "renamed");
+            spin (std::chrono::milliseconds (300));
+            Profiler::popTag (inner);
+            spin (std::chrono::milliseconds (300));
+            Profiler::popTag (outer);
+            Profiler::setJob (nullptr);
+        });
+        t.join ();
+
+        expect (outer == 0);
+        expect (inner == 1);
+        expect (Profiler::stop ());
+        expect (! Profiler::stop ());
+        expect (! Profiler::isRunning ());
+
+        Json::Value const result (Profiler::getJson (true));
+        expect (result["samples"].asUInt () > 0, "No samples");
+
+        bool sawInner (false);
+        bool sawOuter (false);
+        std::size_t total (0);
+        Json::Value const& stacks (result["stacks"]);
+        for (Json::UInt i = 0; i < stacks.size (); ++i)
+        {
+            std::string const s (stacks[i].asString ());
+            if (s.compare (0, 5, "test;") != 0)
+                continue;
+            total += std::stoul (s.substr (s.rfind (' ') + 1));
+            if (s.find ("test;testJob;renamed;") == 0)
+                sawInner = true;
+            else if (s.find ("test;testJob;outer;") == 0)
+                sawOuter = true;
+        }
+        expect (total > 0, "No samples from the test thread");
+        expect (sawInner, "Missing inner tag");
+        expect (sawOuter, "Missing outer tag");
+    }
+
+    void run ()
+    {
+        testTags ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Profiler,ripple_core,ripple);
+
+} // ripple
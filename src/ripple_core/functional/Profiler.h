@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_PROFILER_H_INCLUDED
+#define RIPPLE_CORE_PROFILER_H_INCLUDED
+
+#include <chrono>
+#include <string>
+
+namespace ripple {
+
+/** Sampling profiler for the threads that do the server's work.
+
+    Threads opt in by calling registerThread. While the profiler is running
+    a sampler thread interrupts each registered thread with a signal at a
+    fixed interval; the signal handler captures the call stack into a
+    lock-free ring owned by that thread, tagged with the name of the Job
+    type and the innermost LoadEvent active on the thread. The sampler
+    drains the rings and aggregates identical stacks, which are reported
+    in the "folded" format used by flame graph tools.
+
+    When the profiler is not running the tagging calls reduce to a load of
+    a thread-local pointer and a relaxed atomic flag.
+
+    Sampling is only available on Linux and OS X. Elsewhere every call is
+    a no-op and start returns `false`.
+*/
+class Profiler
+{
+public:
+    /** Add the calling thread to the set of sampled threads.
+        Calling this more than once from the same thread has no effect.
+        The thread is removed automatically when it exits.
+    */
+    static void registerThread (char const* name);
+
+    /** Tag samples taken on the calling thread with a Job type name.
+        The string must remain valid for the life of the process.
+        Passing nullptr clears the tag.
+    */
+    static void setJob (char const* name);
+
+    /** Tag samples taken on the calling thread with a LoadEvent name.
+        Tags nest. The returned token is passed to setTag and popTag; it
+        is negative if the profiler was not running.
+    */
+    static int pushTag (std::string const& name);
+
+    /** Replace the text of a tag returned by pushTag. */
+    static void setTag (int token, std::string const& name);
+
+    /** Remove a tag returned by pushTag, and any tags pushed after it. */
+    static void popTag (int token);
+
+    /** Begin sampling at the given interval, discarding previous samples.
+        @return `false` if the profiler is already running or unsupported.
+    */
+    static bool start (std::chrono::microseconds interval);
+
+    /** Stop sampling. Samples collected so far are kept.
+        @return `false` if the profiler was not running.
+    */
+    static bool stop ();
+
+    /** Returns `true` if the profiler is sampling. */
+    static bool isRunning ();
+
+    /** Returns the profiler status and, optionally, the folded stacks.
+        Each stack is "thread;job;tag;outermost;...;innermost count".
+    */
+    static Json::Value getJson (bool stacks);
+};
+
+} // ripple
+
+#endif
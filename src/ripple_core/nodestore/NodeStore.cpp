@@ -17,9 +17,14 @@
 */
 //==============================================================================
 
+#include <fstream>
 #include <memory>
 #include <vector>
 
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 // backend support
 #include "../ripple_hyperleveldb/ripple_hyperleveldb.h"
 #include "../ripple_leveldb/ripple_leveldb.h"
@@ -30,6 +35,7 @@
 #include "../../ripple/common/seconds_clock.h"
 #include "../../ripple/common/TaggedCache.h"
 #include "../../ripple/common/KeyCache.h"
+#include "../../ripple/common/MemoryGovernor.h"
 
 #include "impl/Tuning.h"
 #  include "impl/DecodedBlob.h"
@@ -45,6 +51,8 @@
 #include "backend/NullFactory.cpp"
 # include "backend/RocksDBFactory.h"
 #include "backend/RocksDBFactory.cpp"
+# include "backend/ShardFactory.h"
+#include "backend/ShardFactory.cpp"
 
 #include "impl/Backend.cpp"
 #include "impl/BatchWriter.cpp"
@@ -21,6 +21,9 @@
 #define RIPPLE_NODESTORE_DATABASE_H_INCLUDED
 
 namespace ripple {
+
+class MemoryGovernor;
+
 namespace NodeStore {
 
 /** Persistency layer for NodeObject
@@ -84,6 +87,23 @@ public:
     */
     virtual int getDesiredAsyncReadCount () = 0;
 
+    /** Queue objects to be read into the cache in the background.
+        The keys are read in key order by the async read threads, but
+        only when no reads posted by asyncFetch are waiting.
+    */
+    virtual void prefetch (std::vector <uint256> const& keys) = 0;
+
+    /** Retrieve the number of queued prefetch reads not yet performed. */
+    virtual std::size_t getPrefetchPending () = 0;
+
+    /** Retrieve the total number of prefetch reads ever queued. */
+    virtual std::size_t getPrefetchTotal () = 0;
+
+    /** Retrieve the keys of the most recently used cached objects.
+        @param limit The largest number of keys to return.
+    */
+    virtual std::vector <uint256> getHotKeys (std::size_t limit) = 0;
+
     /** Store the object.
 
         The caller's Blob parameter is overwritten.
@@ -113,6 +133,15 @@ public:
     /** Import objects from another database. */
     virtual void import (Database& source) = 0;
 
+    /** Add a read-only backend holding a range of historical objects.
+        Shards are consulted in the order they were added, after the
+        main backend fails to produce an object.
+
+        @note This must be called during startup, before any fetch.
+        @see make_ShardFactory
+    */
+    virtual void addShard (std::unique_ptr <Backend> shard) = 0;
+
     /** Retrieve the estimated number of pending write operations.
         This is used for diagnostics.
     */
@@ -125,6 +154,23 @@ public:
     //        TODO Document the parameter meanings.
     virtual void tune (int size, int age) = 0;
 
+    /** Limit the cache by the memory used by the cached objects.
+        When set, this replaces the target size given to tune.
+        @param bytes The budget in bytes, or zero to limit by count only.
+    */
+    virtual void setCacheTargetBytes (std::size_t bytes) = 0;
+
+    /** Hand the cache over to a memory governor.
+        The governor then sets the byte budget and sweeps the cache, and
+        @ref sweep only sweeps the negative cache.
+        @param weight The relative cost of a miss in this cache.
+        @note This must be called during startup, before any sweep.
+    */
+    virtual void setGovernor (MemoryGovernor& governor, int weight) = 0;
+
+    /** Report cache metrics to the given collector. */
+    virtual void setCollector (beast::insight::Collector::ptr const& collector) = 0;
+
     // VFALCO TODO Document this.
     virtual void sweep () = 0;
 };
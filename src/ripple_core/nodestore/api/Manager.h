@@ -41,6 +41,12 @@ public:
     */
     virtual Factory* find (std::string const& name) const = 0;
 
+    /** Return every factory that was added, in the order they were added.
+        Thread safety:
+            Not thread-safe.
+    */
+    virtual std::vector <Factory*> getFactories () const = 0;
+
     /** Create a backend. */
     virtual std::unique_ptr <Backend> make_Backend (Parameters const& parameters,
         Scheduler& scheduler, beast::Journal journal) = 0;
@@ -27,6 +27,7 @@ public:
     beast::Journal m_journal;
     size_t const m_keyBytes;
     Map m_map;
+    std::mutex m_mutex;
     Scheduler& m_scheduler;
 
     MemoryBackend (size_t keyBytes, Parameters const& keyValues,
@@ -54,6 +55,7 @@ public:
     {
         uint256 const hash (uint256::fromVoid (key));
 
+        std::lock_guard <std::mutex> lock (m_mutex);
         Map::iterator iter = m_map.find (hash);
 
         if (iter != m_map.end ())
@@ -71,6 +73,7 @@ public:
     void
     store (NodeObject::ref object)
     {
+        std::lock_guard <std::mutex> lock (m_mutex);
         Map::iterator iter = m_map.find (object->getHash ());
 
         if (iter == m_map.end ())
@@ -89,6 +92,7 @@ public:
     void
     for_each (std::function <void(NodeObject::Ptr)> f)
     {
+        std::lock_guard <std::mutex> lock (m_mutex);
         for (auto const& e : m_map)
             f (e.second);
     }
@@ -0,0 +1,519 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+namespace ripple {
+namespace NodeStore {
+
+/*  Shard file format, all integers big endian:
+
+    Header, 64 bytes
+        0...7       "RPLSHARD"
+        8...11      Format version
+        12...15     Key size in bytes
+        16...19     First ledger index
+        20...23     Last ledger index
+        24...31     Number of objects
+        32...35     Number of leading key bits that select a bucket
+        36...39     Unused
+        40...47     Offset of the key table
+        48...55     Offset of the first record
+        56...63     Size of the file
+
+    Bucket table, (1 << bits) + 1 32-bit entries
+        The position in the key table of the first key in each bucket
+
+    Key table, sorted by key, one entry per object
+        Key         The object's hash
+        64-bit      Offset of the object's record
+
+    Records, in key order, each padded to a multiple of 8 bytes
+        32-bit      Size of the encoded object
+        32-bit      Checksum of the encoded object
+        ...         The encoded object, see EncodedBlob
+*/
+class ShardBackend
+    : public Backend
+    , public beast::LeakChecked <ShardBackend>
+{
+public:
+    enum
+    {
+        formatVersion = 1,
+        headerBytes = 64,
+        recordHeaderBytes = 8,
+        maxBucketBits = 24,
+
+        // Average number of keys searched per bucket
+        keysPerBucket = 8
+    };
+
+    ShardBackend (size_t keyBytes, Parameters const& keyValues,
+        Scheduler& scheduler, beast::Journal journal)
+        : m_journal (journal)
+        , m_keyBytes (keyBytes)
+        , m_path (keyValues ["path"].toStdString ())
+        , m_first (keyValues ["first_ledger"].getIntValue ())
+        , m_last (keyValues ["last_ledger"].getIntValue ())
+        , m_building (false)
+        , m_base (nullptr)
+        , m_size (0)
+        , m_count (0)
+        , m_bucketBits (0)
+        , m_dataOffset (0)
+        , m_buckets (nullptr)
+        , m_keys (nullptr)
+        , m_dataSize (0)
+    {
+        if (m_path.empty ())
+            throw std::runtime_error ("Missing path in ShardFactory backend");
+
+        if (boost::filesystem::exists (m_path))
+            open ();
+        else
+            create ();
+    }
+
+    ~ShardBackend ()
+    {
+        if (m_building)
+        {
+            try
+            {
+                finish ();
+            }
+            catch (std::exception const& e)
+            {
+                m_journal.fatal << "Unable to write shard '" << m_path << "': " << e.what ();
+            }
+        }
+    }
+
+    std::string
+    getName ()
+    {
+        return m_path;
+    }
+
+    //--------------------------------------------------------------------------
+
+    Status
+    fetch (void const* key, NodeObject::Ptr* pObject)
+    {
+        pObject->reset ();
+
+        // Objects become visible only once the shard is written.
+        if (m_building)
+            return notFound;
+
+        unsigned char const* const k (static_cast <unsigned char const*> (key));
+
+        std::uint32_t const bucket = (m_bucketBits == 0) ? 0 :
+            (getInt32 (k) >> (32 - m_bucketBits));
+
+        std::uint64_t lo = getInt32 (m_buckets + 4 * bucket);
+        std::uint64_t hi = getInt32 (m_buckets + 4 * (bucket + 1));
+
+        while (lo < hi)
+        {
+            std::uint64_t const mid = lo + (hi - lo) / 2;
+            unsigned char const* const entry = m_keys + mid * (m_keyBytes + 8);
+            int const cmp = memcmp (entry, k, m_keyBytes);
+
+            if (cmp < 0)
+                lo = mid + 1;
+            else if (cmp > 0)
+                hi = mid;
+            else
+                return decode (entry, pObject);
+        }
+
+        return notFound;
+    }
+
+    void
+    store (NodeObject::ref object)
+    {
+        if (! m_building)
+            throw std::logic_error ("Shard '" + m_path + "' is read-only");
+
+        if ((object->getIndex () < m_first) || ((m_last != 0) && (object->getIndex () > m_last)))
+            return;
+
+        EncodedBlob encoded;
+        encoded.prepare (object);
+
+        std::uint32_t const size = static_cast <std::uint32_t> (encoded.getSize ());
+        std::uint32_t const padded = (recordHeaderBytes + size + 7) & ~7;
+
+        unsigned char header [recordHeaderBytes];
+        putInt32 (header, size);
+        putInt32 (header + 4, checksum (encoded.getData (), size));
+
+        static char const padding [8] = { 0 };
+
+        std::lock_guard <std::mutex> lock (m_mutex);
+
+        m_data.write (reinterpret_cast <char const*> (header), recordHeaderBytes);
+        m_data.write (static_cast <char const*> (encoded.getData ()), size);
+        m_data.write (padding, padded - recordHeaderBytes - size);
+
+        m_index.push_back (IndexEntry (object->getHash (), m_dataSize, padded));
+        m_dataSize += padded;
+    }
+
+    void
+    storeBatch (Batch const& batch)
+    {
+        for (auto const& e : batch)
+            store (e);
+    }
+
+    void
+    for_each (std::function <void(NodeObject::Ptr)> f)
+    {
+        if (m_building)
+            return;
+
+        for (std::uint64_t i = 0; i < m_count; ++i)
+        {
+            NodeObject::Ptr object;
+
+            if (decode (m_keys + i * (m_keyBytes + 8), &object) == ok)
+                f (object);
+            else
+                m_journal.warning << "Corrupt record " << i << " in shard '" << m_path << "'";
+        }
+    }
+
+    int
+    getWriteLoad ()
+    {
+        return 0;
+    }
+
+private:
+    struct IndexEntry
+    {
+        IndexEntry (uint256 const& key_, std::uint64_t offset_, std::uint32_t bytes_)
+            : key (key_)
+            , offset (offset_)
+            , bytes (bytes_)
+        {
+        }
+
+        bool operator< (IndexEntry const& other) const
+        {
+            return key < other.key;
+        }
+
+        bool operator== (IndexEntry const& other) const
+        {
+            return key == other.key;
+        }
+
+        uint256 key;
+        std::uint64_t offset;
+        std::uint32_t bytes;
+    };
+
+    static std::uint32_t getInt32 (unsigned char const* p)
+    {
+        return (std::uint32_t (p[0]) << 24) | (std::uint32_t (p[1]) << 16) |
+            (std::uint32_t (p[2]) << 8) | std::uint32_t (p[3]);
+    }
+
+    static std::uint64_t getInt64 (unsigned char const* p)
+    {
+        return (std::uint64_t (getInt32 (p)) << 32) | getInt32 (p + 4);
+    }
+
+    static void putInt32 (unsigned char* p, std::uint32_t v)
+    {
+        p[0] = static_cast <unsigned char> (v >> 24);
+        p[1] = static_cast <unsigned char> (v >> 16);
+        p[2] = static_cast <unsigned char> (v >> 8);
+        p[3] = static_cast <unsigned char> (v);
+    }
+
+    static void putInt64 (unsigned char* p, std::uint64_t v)
+    {
+        putInt32 (p, static_cast <std::uint32_t> (v >> 32));
+        putInt32 (p + 4, static_cast <std::uint32_t> (v));
+    }
+
+    static std::uint32_t checksum (void const* data, std::size_t size)
+    {
+        std::uint32_t result;
+        beast::Murmur::Hash (data, static_cast <int> (size), 0, &result);
+        return result;
+    }
+
+    // Decode the record for a key table entry. The encoded object is
+    // read in place from the mapping.
+    Status decode (unsigned char const* entry, NodeObject::Ptr* pObject)
+    {
+        std::uint64_t const offset = getInt64 (entry + m_keyBytes);
+
+        if ((offset < m_dataOffset) || (offset + recordHeaderBytes > m_size))
+            return dataCorrupt;
+
+        unsigned char const* const record = m_base + offset;
+        std::uint32_t const size = getInt32 (record);
+
+        if (offset + recordHeaderBytes + size > m_size)
+            return dataCorrupt;
+
+        if (checksum (record + recordHeaderBytes, size) != getInt32 (record + 4))
+            return dataCorrupt;
+
+        DecodedBlob decoded (entry, record + recordHeaderBytes,
+            static_cast <int> (size));
+
+        if (! decoded.wasOk ())
+            return dataCorrupt;
+
+        *pObject = decoded.createObject ();
+        return ok;
+    }
+
+    void open ()
+    {
+        using namespace boost::interprocess;
+
+        {
+            file_mapping file (m_path.c_str (), read_only);
+            m_region.reset (new mapped_region (file, read_only));
+        }
+
+        m_base = static_cast <unsigned char const*> (m_region->get_address ());
+        m_size = m_region->get_size ();
+
+        if ((m_size < headerBytes) || (memcmp (m_base, "RPLSHARD", 8) != 0))
+            throw std::runtime_error ("'" + m_path + "' is not a shard");
+
+        if ((getInt32 (m_base + 8) != formatVersion) ||
+            (getInt32 (m_base + 12) != m_keyBytes))
+            throw std::runtime_error ("Shard '" + m_path + "' has an unsupported format");
+
+        m_first = getInt32 (m_base + 16);
+        m_last = getInt32 (m_base + 20);
+        m_count = getInt64 (m_base + 24);
+        m_bucketBits = getInt32 (m_base + 32);
+
+        std::uint64_t const keysOffset = getInt64 (m_base + 40);
+        m_dataOffset = getInt64 (m_base + 48);
+
+        if ((getInt64 (m_base + 56) != m_size) || (m_bucketBits > maxBucketBits) ||
+            (headerBytes + 4 * ((std::uint64_t (1) << m_bucketBits) + 1) > keysOffset) ||
+            (keysOffset + m_count * (m_keyBytes + 8) > m_dataOffset) ||
+            (m_dataOffset > m_size))
+            throw std::runtime_error ("Shard '" + m_path + "' is damaged");
+
+        m_buckets = m_base + headerBytes;
+        m_keys = m_base + keysOffset;
+
+        // Every bucket must lie within the key table, since fetch
+        // trusts the bounds it reads from here.
+        std::uint64_t const bucketCount = std::uint64_t (1) << m_bucketBits;
+        std::uint32_t previous = 0;
+
+        for (std::uint64_t i = 0; i <= bucketCount; ++i)
+        {
+            std::uint32_t const position = getInt32 (m_buckets + 4 * i);
+
+            if ((position < previous) || ((i == 0) && (position != 0)))
+                throw std::runtime_error ("Shard '" + m_path + "' is damaged");
+
+            previous = position;
+        }
+
+        if (previous != m_count)
+            throw std::runtime_error ("Shard '" + m_path + "' is damaged");
+
+        m_journal.info << "Opened shard '" << m_path << "' with " << m_count <<
+            " objects from ledgers " << m_first << " to " << m_last;
+    }
+
+    void create ()
+    {
+        m_building = true;
+        m_data.open (m_path + ".tmp", std::ios::binary | std::ios::trunc | std::ios::out);
+
+        if (! m_data)
+            throw std::runtime_error ("Unable to create shard '" + m_path + "'");
+    }
+
+    // Sort the collected objects and write the shard file.
+    void finish ()
+    {
+        m_building = false;
+        m_data.close ();
+
+        std::sort (m_index.begin (), m_index.end ());
+        m_index.erase (std::unique (m_index.begin (), m_index.end ()), m_index.end ());
+
+        std::uint64_t const count = m_index.size ();
+
+        std::uint32_t bits = 0;
+        while ((bits < maxBucketBits) && ((count >> bits) > keysPerBucket))
+            ++bits;
+
+        std::vector <std::uint32_t> buckets ((std::size_t (1) << bits) + 1, 0);
+
+        for (auto const& e : m_index)
+        {
+            std::uint32_t const bucket = (bits == 0) ? 0 :
+                (getInt32 (e.key.begin ()) >> (32 - bits));
+            ++buckets [bucket + 1];
+        }
+
+        for (std::size_t i = 1; i < buckets.size (); ++i)
+            buckets [i] += buckets [i - 1];
+
+        std::uint64_t const keysOffset =
+            (headerBytes + 4 * buckets.size () + 7) & ~std::uint64_t (7);
+        std::uint64_t const dataOffset = keysOffset + count * (m_keyBytes + 8);
+
+        std::uint64_t fileSize = dataOffset;
+        for (auto const& e : m_index)
+            fileSize += e.bytes;
+
+        std::string const partial (m_path + ".part");
+        std::ofstream out (partial.c_str (), std::ios::binary | std::ios::trunc | std::ios::out);
+
+        {
+            unsigned char header [headerBytes] = { 0 };
+            memcpy (header, "RPLSHARD", 8);
+            putInt32 (header + 8, formatVersion);
+            putInt32 (header + 12, static_cast <std::uint32_t> (m_keyBytes));
+            putInt32 (header + 16, m_first);
+            putInt32 (header + 20, m_last);
+            putInt64 (header + 24, count);
+            putInt32 (header + 32, bits);
+            putInt64 (header + 40, keysOffset);
+            putInt64 (header + 48, dataOffset);
+            putInt64 (header + 56, fileSize);
+            out.write (reinterpret_cast <char const*> (header), headerBytes);
+        }
+
+        {
+            std::vector <unsigned char> table (keysOffset - headerBytes, 0);
+            for (std::size_t i = 0; i < buckets.size (); ++i)
+                putInt32 (&table [4 * i], buckets [i]);
+            out.write (reinterpret_cast <char const*> (table.data ()), table.size ());
+        }
+
+        {
+            std::vector <unsigned char> entry (m_keyBytes + 8);
+            std::uint64_t offset = dataOffset;
+
+            for (auto const& e : m_index)
+            {
+                memcpy (entry.data (), e.key.begin (), m_keyBytes);
+                putInt64 (&entry [m_keyBytes], offset);
+                out.write (reinterpret_cast <char const*> (entry.data ()), entry.size ());
+                offset += e.bytes;
+            }
+        }
+
+        {
+            std::ifstream in ((m_path + ".tmp").c_str (), std::ios::binary | std::ios::in);
+            std::vector <char> record;
+
+            for (auto const& e : m_index)
+            {
+                record.resize (e.bytes);
+                in.seekg (e.offset);
+                in.read (record.data (), e.bytes);
+                out.write (record.data (), e.bytes);
+            }
+
+            if (! in)
+                throw std::runtime_error ("unable to read the collected objects");
+        }
+
+        out.close ();
+
+        if (! out)
+            throw std::runtime_error ("unable to write '" + partial + "'");
+
+        boost::filesystem::rename (partial, m_path);
+        boost::filesystem::remove (m_path + ".tmp");
+
+        m_journal.info << "Wrote shard '" << m_path << "' with " << count <<
+            " objects from ledgers " << m_first << " to " << m_last;
+    }
+
+    beast::Journal m_journal;
+    size_t const m_keyBytes;
+    std::string const m_path;
+    std::uint32_t m_first;
+    std::uint32_t m_last;
+    bool m_building;
+
+    // Reading
+    std::unique_ptr <boost::interprocess::mapped_region> m_region;
+    unsigned char const* m_base;
+    std::uint64_t m_size;
+    std::uint64_t m_count;
+    std::uint32_t m_bucketBits;
+    std::uint64_t m_dataOffset;
+    unsigned char const* m_buckets;
+    unsigned char const* m_keys;
+
+    // Building
+    std::mutex m_mutex;
+    std::ofstream m_data;
+    std::vector <IndexEntry> m_index;
+    std::uint64_t m_dataSize;
+};
+
+//------------------------------------------------------------------------------
+
+class ShardFactory : public Factory
+{
+public:
+    beast::String
+    getName () const
+    {
+        return "Shard";
+    }
+
+    std::unique_ptr <Backend>
+    createInstance (
+        size_t keyBytes,
+        Parameters const& keyValues,
+        Scheduler& scheduler,
+        beast::Journal journal)
+    {
+        return std::make_unique <ShardBackend> (
+            keyBytes, keyValues, scheduler, journal);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr <Factory>
+make_ShardFactory ()
+{
+    return std::make_unique <ShardFactory> ();
+}
+
+}
+}
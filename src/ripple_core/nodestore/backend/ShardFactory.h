@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_SHARDFACTORY_H_INCLUDED
+#define RIPPLE_NODESTORE_SHARDFACTORY_H_INCLUDED
+
+namespace ripple {
+namespace NodeStore {
+
+/** Factory to produce read-only shard backends for the NodeStore.
+
+    A shard is a single immutable file holding the objects written
+    during a fixed range of ledgers. The file is memory mapped and read
+    without locking. When the file named by the "path" parameter does not
+    exist, the backend builds it instead: objects whose ledger index lies
+    within "first_ledger" and "last_ledger" are collected as they are
+    stored, and the file is written when the backend is destroyed.
+
+    @see Database::import, Database::addShard
+*/
+std::unique_ptr <Factory> make_ShardFactory ();
+
+}
+}
+
+#endif
@@ -40,6 +40,8 @@ public:
     std::unique_ptr <Backend> m_backend;
     // Larger key/value storage, but not necessarily persistent.
     std::unique_ptr <Backend> m_fastBackend;
+    // Read-only backends holding ranges of history.
+    std::vector <std::unique_ptr <Backend>> m_shards;
 
     // Positive cache
     TaggedCache <uint256, NodeObject> m_cache;
@@ -47,10 +49,15 @@ public:
     // Negative cache
     KeyCache <uint256> m_negCache;
 
+    // The positive cache is swept by a MemoryGovernor
+    bool m_governed;
+
     std::mutex                m_readLock;
     std::condition_variable   m_readCondVar;
     std::condition_variable   m_readGenCondVar;
     std::set <uint256>        m_readSet;        // set of reads to do
+    std::set <uint256>        m_prefetchSet;    // background reads to do
+    std::size_t               m_prefetchTotal;  // background reads queued
     uint256                   m_readLast;       // last hash read
     std::vector <std::thread> m_readThreads;
     bool                      m_readShut;
@@ -70,6 +77,8 @@ public:
             get_seconds_clock (), LogPartition::getJournal <TaggedCacheLog> ())
         , m_negCache ("NodeStore", get_seconds_clock (),
             cacheTargetSize, cacheTargetSeconds)
+        , m_governed (false)
+        , m_prefetchTotal (0)
         , m_readShut (false)
         , m_readGen (0)
     {
@@ -136,6 +145,34 @@ public:
         return m_cache.getTargetSize() / asyncDivider;
     }
 
+    void prefetch (std::vector <uint256> const& keys)
+    {
+        std::unique_lock <std::mutex> lock (m_readLock);
+        for (auto const& key : keys)
+        {
+            if (m_prefetchSet.insert (key).second)
+                ++m_prefetchTotal;
+        }
+        m_readCondVar.notify_all ();
+    }
+
+    std::size_t getPrefetchPending ()
+    {
+        std::unique_lock <std::mutex> lock (m_readLock);
+        return m_prefetchSet.size ();
+    }
+
+    std::size_t getPrefetchTotal ()
+    {
+        std::unique_lock <std::mutex> lock (m_readLock);
+        return m_prefetchTotal;
+    }
+
+    std::vector <uint256> getHotKeys (std::size_t limit)
+    {
+        return m_cache.getHotKeys (limit);
+    }
+
     NodeObject::Ptr fetch (uint256 const& hash) override
     {
         return doTimedFetch (hash, false);
@@ -196,6 +233,14 @@ public:
             obj = fetchInternal (*m_backend, hash);
         }
 
+        // Finally, the history shards.
+        //
+        for (auto iter (m_shards.begin ());
+            (obj == nullptr) && (iter != m_shards.end ()); ++iter)
+        {
+            obj = fetchInternal (**iter, hash);
+        }
+
         if (obj == nullptr)
         {
 
@@ -298,9 +343,38 @@ public:
         m_negCache.setTargetAge (age);
     }
 
+    void addShard (std::unique_ptr <Backend> shard)
+    {
+        m_shards.push_back (std::move (shard));
+    }
+
+    void setCacheTargetBytes (std::size_t bytes)
+    {
+        m_cache.setTargetBytes (bytes, &DatabaseImp::getObjectBytes);
+    }
+
+    void setGovernor (MemoryGovernor& governor, int weight)
+    {
+        governor.add ("node_store", m_cache, &DatabaseImp::getObjectBytes, weight);
+        m_governed = true;
+    }
+
+    void setCollector (beast::insight::Collector::ptr const& collector)
+    {
+        m_cache.setCollector (collector);
+    }
+
+    static std::size_t getObjectBytes (NodeObject const& object)
+    {
+        // The object, its data, the shared pointer control
+        // block and the cache entry.
+        return sizeof (NodeObject) + object.getData ().capacity () + 64;
+    }
+
     void sweep ()
     {
-        m_cache.sweep ();
+        if (! m_governed)
+            m_cache.sweep ();
         m_negCache.sweep ();
     }
 
@@ -315,6 +389,7 @@ public:
     void threadEntry ()
     {
         beast::Thread::setCurrentThreadName ("prefetch");
+        Profiler::registerThread ("prefetch");
         while (1)
         {
             uint256 hash;
@@ -326,26 +401,40 @@ public:
                 {
                     // all work is done
                     m_readGenCondVar.notify_all ();
+
+                    if (! m_prefetchSet.empty ())
+                        break;
+
                     m_readCondVar.wait (lock);
                 }
 
                 if (m_readShut)
                     break;
 
-                // Read in key order to make the back end more efficient
-                std::set <uint256>::iterator it = m_readSet.lower_bound (m_readLast);
-                if (it == m_readSet.end ())
+                if (m_readSet.empty ())
                 {
-                    it = m_readSet.begin ();
-
-                    // A generation has completed
-                    ++m_readGen;
-                    m_readGenCondVar.notify_all ();
+                    // Background reads only run while no one is waiting
+                    std::set <uint256>::iterator it = m_prefetchSet.begin ();
+                    hash = *it;
+                    m_prefetchSet.erase (it);
+                }
+                else
+                {
+                    // Read in key order to make the back end more efficient
+                    std::set <uint256>::iterator it = m_readSet.lower_bound (m_readLast);
+                    if (it == m_readSet.end ())
+                    {
+                        it = m_readSet.begin ();
+
+                        // A generation has completed
+                        ++m_readGen;
+                        m_readGenCondVar.notify_all ();
+                    }
+
+                    hash = *it;
+                    m_readSet.erase (it);
+                    m_readLast = hash;
                 }
-
-                hash = *it;
-                m_readSet.erase (it);
-                m_readLast = hash;
             }
 
             // Perform the read
@@ -54,6 +54,7 @@ public:
 
         add_factory (make_MemoryFactory ());
         add_factory (make_NullFactory ());
+        add_factory (make_ShardFactory ());
 
     #if RIPPLE_HYPERLEVELDB_AVAILABLE
         add_factory (make_HyperDBFactory ());
@@ -74,6 +75,17 @@ public:
         return nullptr;
     }
 
+    std::vector <Factory*>
+    getFactories () const
+    {
+        std::vector <Factory*> factories;
+        factories.reserve (m_list.size ());
+        for (List::const_iterator iter (m_list.begin ());
+            iter != m_list.end (); ++iter)
+            factories.push_back (iter->get ());
+        return factories;
+    }
+
     static void
     missing_backend ()
     {
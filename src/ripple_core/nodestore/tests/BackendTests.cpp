@@ -88,12 +88,133 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void testShard (std::int64_t const seedValue, int numObjectsToTest = 2000)
+    {
+        std::unique_ptr <Manager> manager (make_Manager ());
+
+        DummyScheduler scheduler;
+
+        testcase ("Backend type=Shard");
+
+        LedgerIndex const first = 256 * 1024;
+        LedgerIndex const last = 768 * 1024;
+
+        beast::StringPairArray params;
+        beast::File const path (beast::File::createTempFile ("node_shard"));
+        params.set ("type", "Shard");
+        params.set ("path", path.getFullPathName ());
+        params.set ("first_ledger", beast::String (first));
+        params.set ("last_ledger", beast::String (last));
+
+        Batch batch;
+        createPredictableBatch (batch, 0, numObjectsToTest, seedValue);
+
+        beast::Journal j;
+
+        {
+            // Build the shard
+            std::unique_ptr <Backend> backend (manager->make_Backend (
+                params, scheduler, j));
+            storeBatch (*backend, batch);
+        }
+
+        {
+            // Open the shard, only objects in range should be present
+            std::unique_ptr <Backend> backend (manager->make_Backend (
+                params, scheduler, j));
+
+            bool allOk = true;
+            int present = 0;
+
+            for (auto const& object : batch)
+            {
+                NodeObject::Ptr copy;
+                Status const status = backend->fetch (
+                    object->getHash ().cbegin (), &copy);
+                bool const inRange = (object->getIndex () >= first) &&
+                    (object->getIndex () <= last);
+
+                if (inRange)
+                {
+                    ++present;
+                    allOk = allOk && (status == ok) && object->isCloneOf (copy);
+                }
+                else
+                {
+                    allOk = allOk && (status == notFound) && (copy == nullptr);
+                }
+            }
+
+            expect (allOk, "Should fetch in range objects only");
+
+            int visited = 0;
+            backend->for_each ([&](NodeObject::Ptr) { ++visited; });
+            expect (visited == present, "Should visit every object");
+        }
+
+        {
+            // Damage the first record, the checksum should catch it
+            std::fstream file (path.getFullPathName ().toStdString ().c_str (),
+                std::ios::binary | std::ios::in | std::ios::out);
+            unsigned char offset [8];
+            file.seekg (48);
+            file.read (reinterpret_cast <char*> (offset), sizeof (offset));
+            std::uint64_t dataOffset = 0;
+            for (int i = 0; i < 8; ++i)
+                dataOffset = (dataOffset << 8) | offset [i];
+            file.seekp (dataOffset + 12);
+            file.put (0x5a);
+            file.close ();
+
+            std::unique_ptr <Backend> backend (manager->make_Backend (
+                params, scheduler, j));
+
+            int corrupt = 0;
+            for (auto const& object : batch)
+            {
+                NodeObject::Ptr copy;
+                if (backend->fetch (object->getHash ().cbegin (), &copy) == dataCorrupt)
+                    ++corrupt;
+            }
+
+            expect (corrupt == 1, "Should detect the damaged record");
+        }
+
+        {
+            // Damage the bucket table, the shard should be rejected
+            std::fstream file (path.getFullPathName ().toStdString ().c_str (),
+                std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp (64 + 4);
+            for (int i = 0; i < 4; ++i)
+                file.put (static_cast <char> (0xff));
+            file.close ();
+
+            bool rejected = false;
+            try
+            {
+                manager->make_Backend (params, scheduler, j);
+            }
+            catch (std::runtime_error const&)
+            {
+                rejected = true;
+            }
+
+            expect (rejected, "Should reject the damaged bucket table");
+        }
+
+        path.deleteFile ();
+    }
+
+    //--------------------------------------------------------------------------
+
     void run ()
     {
         int const seedValue = 50;
 
         testBackend ("leveldb", seedValue);
 
+        testShard (seedValue);
+
     #ifdef RIPPLE_ENABLE_SQLITE_BACKEND_TESTS
         testBackend ("sqlite", seedValue);
     #endif
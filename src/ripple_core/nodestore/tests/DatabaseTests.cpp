@@ -177,6 +177,53 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void testPrefetch (std::int64_t const seedValue)
+    {
+        std::unique_ptr <Manager> manager (make_Manager ());
+
+        DummyScheduler scheduler;
+
+        testcase ("prefetch");
+
+        beast::File const node_db (beast::File::createTempFile ("node_db"));
+        beast::StringPairArray nodeParams;
+        nodeParams.set ("type", "leveldb");
+        nodeParams.set ("path", node_db.getFullPathName ());
+
+        Batch batch;
+        createPredictableBatch (batch, 0, 500, seedValue);
+
+        beast::Journal j;
+
+        {
+            std::unique_ptr <Database> db (manager->make_Database (
+                "test", scheduler, j, 2, nodeParams));
+            storeBatch (*db, batch);
+        }
+
+        // Re-open with a cold cache and warm it from the keys
+        std::unique_ptr <Database> db (manager->make_Database (
+            "test", scheduler, j, 2, nodeParams));
+        expect (db->getHotKeys (batch.size ()).empty (), "Should be cold");
+
+        std::vector <uint256> keys;
+        for (auto const& object : batch)
+            keys.push_back (object->getHash ());
+        db->prefetch (keys);
+        expect (db->getPrefetchTotal () == keys.size (), "Should be queued");
+
+        for (int i = 0; (i < 1000) && (db->getPrefetchPending () != 0); ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        expect (db->getPrefetchPending () == 0, "Should be drained");
+
+        std::vector <uint256> hot (db->getHotKeys (keys.size ()));
+        std::sort (hot.begin (), hot.end ());
+        std::sort (keys.begin (), keys.end ());
+        expect (hot == keys, "Should be cached");
+    }
+
+    //--------------------------------------------------------------------------
+
     void runBackendTests (bool useEphemeralDatabase, std::int64_t const seedValue)
     {
         testNodeStore ("leveldb", useEphemeralDatabase, true, seedValue);
@@ -226,6 +273,8 @@ public:
         runBackendTests (true, seedValue);
 
         runImportTests (seedValue);
+
+        testPrefetch (seedValue);
     }
 };
 
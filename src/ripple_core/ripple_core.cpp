@@ -36,6 +36,7 @@
 #include "functional/Config.cpp"
 # include "functional/LoadFeeTrackImp.h" // private
 #include "functional/LoadFeeTrackImp.cpp"
+#include "functional/Profiler.cpp"
 #include "functional/LoadEvent.cpp"
 #include "functional/LoadMonitor.cpp"
 
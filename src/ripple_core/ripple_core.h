@@ -33,6 +33,7 @@
 # include "functional/ConfigSections.h"
 #include "functional/Config.h"
 #include "functional/LoadFeeTrack.h"
+#   include "functional/Profiler.h"
 #  include "functional/LoadEvent.h"
 #  include "functional/LoadMonitor.h"
 
@@ -133,10 +133,14 @@ public:
 
 
     static uint128 PassPhraseToKey (const std::string& passPhrase);
+
+    // Deterministic keys as raw bytes, computed without OpenSSL
+    static uint256 DeriveRootKey (const uint128& seed);
+    static Blob DerivePublicKey (const RippleAddress& generator, int n);
+    static uint256 DerivePrivateKey (const RippleAddress& family, uint256 const& rootPriv, int n);
+
     static EC_KEY* GenerateRootDeterministicKey (const uint128& passPhrase);
-    static EC_KEY* GenerateRootPubKey (BIGNUM* pubGenerator);
     static EC_KEY* GeneratePublicDeterministicKey (const RippleAddress& generator, int n);
-    static EC_KEY* GeneratePrivateDeterministicKey (const RippleAddress& family, const BIGNUM* rootPriv, int n);
     static EC_KEY* GeneratePrivateDeterministicKey (const RippleAddress& family, uint256 const& rootPriv, int n);
 
     CKey (const uint128& passPhrase) : fSet (false)
@@ -154,7 +158,7 @@ public:
         assert (pkey);
     }
 
-    CKey (const RippleAddress& base, const BIGNUM* rootPrivKey, int n) : fSet (false)
+    CKey (const RippleAddress& base, uint256 const& rootPrivKey, int n) : fSet (false)
     {
         // private deterministic key
         pkey = GeneratePrivateDeterministicKey (base, rootPrivKey, n);
@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+
 namespace ripple {
 
 // #define EC_DEBUG
@@ -39,42 +40,10 @@ uint128 CKey::PassPhraseToKey (const std::string& passPhrase)
 }
 
 // --> seed
-// <-- private root generator + public root generator
-EC_KEY* CKey::GenerateRootDeterministicKey (const uint128& seed)
+// <-- private root generator
+uint256 CKey::DeriveRootKey (const uint128& seed)
 {
-    BN_CTX* ctx = BN_CTX_new ();
-
-    if (!ctx) return nullptr;
-
-    EC_KEY* pkey = EC_KEY_new_by_curve_name (NID_secp256k1);
-
-    if (!pkey)
-    {
-        BN_CTX_free (ctx);
-        return nullptr;
-    }
-
-    EC_KEY_set_conv_form (pkey, POINT_CONVERSION_COMPRESSED);
-
-    BIGNUM* order = BN_new ();
-
-    if (!order)
-    {
-        BN_CTX_free (ctx);
-        EC_KEY_free (pkey);
-        return nullptr;
-    }
-
-    if (!EC_GROUP_get_order (EC_KEY_get0_group (pkey), order, ctx))
-    {
-        assert (false);
-        BN_free (order);
-        EC_KEY_free (pkey);
-        BN_CTX_free (ctx);
-        return nullptr;
-    }
-
-    BIGNUM* privKey = nullptr;
+    uint256 root;
     int seq = 0;
 
     do
@@ -83,116 +52,19 @@ EC_KEY* CKey::GenerateRootDeterministicKey (const uint128& seed)
         Serializer s ((128 + 32) / 8);
         s.add128 (seed);
         s.add32 (seq++);
-        uint256 root = s.getSHA512Half ();
+        root = s.getSHA512Half ();
         s.secureErase ();
-        privKey = BN_bin2bn ((const unsigned char*) &root, sizeof (root), privKey);
-
-        if (privKey == nullptr)
-        {
-            EC_KEY_free (pkey);
-            BN_free (order);
-            BN_CTX_free (ctx);
-        }
-
-        root.zero ();
-    }
-    while (BN_is_zero (privKey) || (BN_cmp (privKey, order) >= 0));
-
-    BN_free (order);
-
-    if (!EC_KEY_set_private_key (pkey, privKey))
-    {
-        // set the random point as the private key
-        assert (false);
-        EC_KEY_free (pkey);
-        BN_clear_free (privKey);
-        BN_CTX_free (ctx);
-        return nullptr;
     }
+    while (!Secp256k1::isValidSecretKey (root));
 
-    EC_POINT* pubKey = EC_POINT_new (EC_KEY_get0_group (pkey));
-
-    if (!EC_POINT_mul (EC_KEY_get0_group (pkey), pubKey, privKey, nullptr, nullptr, ctx))
-    {
-        // compute the corresponding public key point
-        assert (false);
-        BN_clear_free (privKey);
-        EC_POINT_free (pubKey);
-        EC_KEY_free (pkey);
-        BN_CTX_free (ctx);
-        return nullptr;
-    }
-
-    BN_clear_free (privKey);
-
-    if (!EC_KEY_set_public_key (pkey, pubKey))
-    {
-        assert (false);
-        EC_POINT_free (pubKey);
-        EC_KEY_free (pkey);
-        BN_CTX_free (ctx);
-        return nullptr;
-    }
-
-    EC_POINT_free (pubKey);
-
-    BN_CTX_free (ctx);
-
-#ifdef EC_DEBUG
-    assert (EC_KEY_check_key (pkey) == 1); // CAUTION: This check is *very* expensive
-#endif
-    return pkey;
-}
-
-// Take ripple address.
-// --> root public generator (consumes)
-// <-- root public generator in EC format
-EC_KEY* CKey::GenerateRootPubKey (BIGNUM* pubGenerator)
-{
-    if (pubGenerator == nullptr)
-    {
-        assert (false);
-        return nullptr;
-    }
-
-    EC_KEY* pkey = EC_KEY_new_by_curve_name (NID_secp256k1);
-
-    if (!pkey)
-    {
-        BN_free (pubGenerator);
-        return nullptr;
-    }
-
-    EC_KEY_set_conv_form (pkey, POINT_CONVERSION_COMPRESSED);
-
-    EC_POINT* pubPoint = EC_POINT_bn2point (EC_KEY_get0_group (pkey), pubGenerator, nullptr, nullptr);
-    BN_free (pubGenerator);
-
-    if (!pubPoint)
-    {
-        assert (false);
-        EC_KEY_free (pkey);
-        return nullptr;
-    }
-
-    if (!EC_KEY_set_public_key (pkey, pubPoint))
-    {
-        assert (false);
-        EC_POINT_free (pubPoint);
-        EC_KEY_free (pkey);
-        return nullptr;
-    }
-
-    EC_POINT_free (pubPoint);
-
-    return pkey;
+    return root;
 }
 
 // --> public generator
-static BIGNUM* makeHash (const RippleAddress& pubGen, int seq, BIGNUM* order)
+static uint256 makeHash (const RippleAddress& pubGen, int seq)
 {
     int subSeq = 0;
-    BIGNUM* ret = nullptr;
+    uint256 ret;
 
     do
     {
@@ -200,166 +72,128 @@ static BIGNUM* makeHash (const RippleAddress& pubGen, int seq, BIGNUM* order)
         s.addRaw (pubGen.getGenerator ());
         s.add32 (seq);
         s.add32 (subSeq++);
-        uint256 root = s.getSHA512Half ();
+        ret = s.getSHA512Half ();
         s.secureErase ();
-        ret = BN_bin2bn ((const unsigned char*) &root, sizeof (root), ret);
-
-        if (!ret) return nullptr;
     }
-    while (BN_is_zero (ret) || (BN_cmp (ret, order) >= 0));
+    while (!Secp256k1::isValidSecretKey (ret));
 
     return ret;
 }
 
 // --> public generator
-EC_KEY* CKey::GeneratePublicDeterministicKey (const RippleAddress& pubGen, int seq)
+// <-- compressed public key, empty on failure
+Blob CKey::DerivePublicKey (const RippleAddress& pubGen, int seq)
 {
     // publicKey(n) = rootPublicKey EC_POINT_+ Hash(pubHash|seq)*point
-    EC_KEY*         rootKey     = CKey::GenerateRootPubKey (pubGen.getGeneratorBN ());
-    const EC_POINT* rootPubKey  = EC_KEY_get0_public_key (rootKey);
-    BN_CTX*         ctx         = BN_CTX_new ();
-    EC_KEY*         pkey        = EC_KEY_new_by_curve_name (NID_secp256k1);
-    EC_POINT*       newPoint    = 0;
-    BIGNUM*         order       = 0;
-    BIGNUM*         hash        = 0;
-    bool            success     = true;
-
-    if (!ctx || !pkey)  success = false;
+    Blob const& root (pubGen.getGenerator ());
+    Blob result;
 
-    if (success)
-        EC_KEY_set_conv_form (pkey, POINT_CONVERSION_COMPRESSED);
-
-    if (success)
-    {
-        newPoint    = EC_POINT_new (EC_KEY_get0_group (pkey));
-
-        if (!newPoint)   success = false;
-    }
-
-    if (success)
+    if (root.empty () || !Secp256k1::addPublicKey (
+            &root[0], root.size (), makeHash (pubGen, seq), result))
     {
-        order       = BN_new ();
-
-        if (!order || !EC_GROUP_get_order (EC_KEY_get0_group (pkey), order, ctx))
-            success = false;
+        assert (false);
+        result.clear ();
     }
 
-    // Calculate the private additional key.
-    if (success)
-    {
-        hash        = makeHash (pubGen, seq, order);
+    return result;
+}
 
-        if (!hash)   success = false;
-    }
+// --> root private key
+uint256 CKey::DerivePrivateKey (const RippleAddress& pubGen, uint256 const& rootPrivKey, int seq)
+{
+    // privateKey(n) = (rootPrivateKey + Hash(pubHash|seq)) % order
+    uint256 hash (makeHash (pubGen, seq));
+    uint256 result;
 
-    if (success)
+    if (!Secp256k1::addSecretKeys (rootPrivKey, hash, result))
     {
-        // Calculate the corresponding public key.
-        EC_POINT_mul (EC_KEY_get0_group (pkey), newPoint, hash, nullptr, nullptr, ctx);
-
-        // Add the master public key and set.
-        EC_POINT_add (EC_KEY_get0_group (pkey), newPoint, newPoint, rootPubKey, ctx);
-        EC_KEY_set_public_key (pkey, newPoint);
+        assert (false);
+        result.zero ();
     }
 
-    if (order)              BN_free (order);
-
-    if (hash)               BN_free (hash);
-
-    if (newPoint)           EC_POINT_free (newPoint);
-
-    if (ctx)                BN_CTX_free (ctx);
-
-    if (rootKey)            EC_KEY_free (rootKey);
-
-    if (pkey && !success)   EC_KEY_free (pkey);
+    hash.zero ();
 
-    return success ? pkey : nullptr;
+    return result;
 }
 
-EC_KEY* CKey::GeneratePrivateDeterministicKey (const RippleAddress& pubGen, uint256 const& u, int seq)
+// --> private key
+// <-- EC key holding the private key and its public key
+static EC_KEY* makeKey (uint256 const& privKey)
 {
-    CBigNum bn (u);
-    return GeneratePrivateDeterministicKey (pubGen, static_cast<BIGNUM*> (&bn), seq);
-}
-
-// --> root private key
-EC_KEY* CKey::GeneratePrivateDeterministicKey (const RippleAddress& pubGen, const BIGNUM* rootPrivKey, int seq)
-{
-    // privateKey(n) = (rootPrivateKey + Hash(pubHash|seq)) % order
-    BN_CTX* ctx = BN_CTX_new ();
+    Blob pubKey;
 
-    if (ctx == nullptr) return nullptr;
+    if (!Secp256k1::derivePublicKey (privKey, pubKey))
+        return nullptr;
 
     EC_KEY* pkey = EC_KEY_new_by_curve_name (NID_secp256k1);
 
-    if (pkey == nullptr)
-    {
-        BN_CTX_free (ctx);
+    if (!pkey)
         return nullptr;
-    }
 
     EC_KEY_set_conv_form (pkey, POINT_CONVERSION_COMPRESSED);
 
-    BIGNUM* order = BN_new ();
+    BIGNUM* bn = BN_bin2bn (privKey.begin (), privKey.size (), nullptr);
+    unsigned char const* begin = &pubKey[0];
 
-    if (order == nullptr)
+    if (!bn || !EC_KEY_set_private_key (pkey, bn) ||
+        !o2i_ECPublicKey (&pkey, &begin, pubKey.size ()))
     {
-        BN_CTX_free (ctx);
+        assert (false);
         EC_KEY_free (pkey);
-        return nullptr;
+        pkey = nullptr;
     }
 
-    if (!EC_GROUP_get_order (EC_KEY_get0_group (pkey), order, ctx))
-    {
-        BN_free (order);
-        BN_CTX_free (ctx);
-        EC_KEY_free (pkey);
-        return nullptr;
-    }
+    if (bn) BN_clear_free (bn);
 
-    // calculate the private additional key
-    BIGNUM* privKey = makeHash (pubGen, seq, order);
+#ifdef EC_DEBUG
+    assert (!pkey || EC_KEY_check_key (pkey) == 1); // CAUTION: This check is *very* expensive
+#endif
+    return pkey;
+}
 
-    if (privKey == nullptr)
-    {
-        BN_free (order);
-        BN_CTX_free (ctx);
-        EC_KEY_free (pkey);
-        return nullptr;
-    }
+// --> seed
+// <-- private root generator + public root generator
+EC_KEY* CKey::GenerateRootDeterministicKey (const uint128& seed)
+{
+    uint256 root (DeriveRootKey (seed));
+    EC_KEY* pkey = makeKey (root);
+    root.zero ();
+    return pkey;
+}
 
-    // calculate the final private key
-    BN_mod_add (privKey, privKey, rootPrivKey, order, ctx);
-    BN_free (order);
-    EC_KEY_set_private_key (pkey, privKey);
+// --> public generator
+EC_KEY* CKey::GeneratePublicDeterministicKey (const RippleAddress& pubGen, int seq)
+{
+    Blob const pubKey (DerivePublicKey (pubGen, seq));
 
-    // compute the corresponding public key
-    EC_POINT* pubKey = EC_POINT_new (EC_KEY_get0_group (pkey));
+    if (pubKey.empty ())
+        return nullptr;
 
-    if (!pubKey)
-    {
-        BN_clear_free (privKey);
-        BN_CTX_free (ctx);
-        EC_KEY_free (pkey);
+    EC_KEY* pkey = EC_KEY_new_by_curve_name (NID_secp256k1);
+
+    if (!pkey)
         return nullptr;
-    }
 
-    if (EC_POINT_mul (EC_KEY_get0_group (pkey), pubKey, privKey, nullptr, nullptr, ctx) == 0)
+    EC_KEY_set_conv_form (pkey, POINT_CONVERSION_COMPRESSED);
+
+    unsigned char const* begin = &pubKey[0];
+
+    if (!o2i_ECPublicKey (&pkey, &begin, pubKey.size ()))
     {
-        BN_clear_free (privKey);
-        EC_POINT_free (pubKey);
+        assert (false);
         EC_KEY_free (pkey);
-        BN_CTX_free (ctx);
         return nullptr;
     }
 
-    BN_clear_free (privKey);
-    EC_KEY_set_public_key (pkey, pubKey);
-
-    EC_POINT_free (pubKey);
-    BN_CTX_free (ctx);
+    return pkey;
+}
 
+// --> root private key
+EC_KEY* CKey::GeneratePrivateDeterministicKey (const RippleAddress& pubGen, uint256 const& rootPrivKey, int seq)
+{
+    uint256 privKey (DerivePrivateKey (pubGen, rootPrivKey, seq));
+    EC_KEY* pkey = makeKey (privKey);
+    privKey.zero ();
     return pkey;
 }
 
@@ -94,6 +94,8 @@ public:
         codeToField[fieldCode] = this;
 
         fieldNum = ++num;
+
+        Json::internMemberName (fn);
     }
 
     SField (SerializedTypeID tid, int fv, const char* fn)
@@ -111,6 +113,8 @@ public:
         codeToField[fieldCode] = this;
 
         fieldNum = ++num;
+
+        Json::internMemberName (fn);
     }
 
     explicit SField (int fc)
@@ -79,11 +79,14 @@ std::string RippleAddress::humanAddressType () const
 
 RippleAddress RippleAddress::createNodePublic (const RippleAddress& naSeed)
 {
-    CKey            ckSeed (naSeed.getSeed ());
+    uint256         uPrivKey    = CKey::DeriveRootKey (naSeed.getSeed ());
+    Blob            vPublic;
     RippleAddress   naNew;
 
-    // YYY Should there be a GetPubKey() equiv that returns a uint256?
-    naNew.setNodePublic (ckSeed.GetPubKey ());
+    Secp256k1::derivePublicKey (uPrivKey, vPublic);
+    uPrivKey.zero ();
+
+    naNew.setNodePublic (vPublic);
 
     return naNew;
 }
@@ -167,10 +170,13 @@ void RippleAddress::setNodePublic (Blob const& vPublic)
 
 bool RippleAddress::verifyNodePublic (uint256 const& hash, Blob const& vchSig, ECDSA fullyCanonical) const
 {
-    CKey    pubkey  = CKey ();
-    bool    bVerified;
+    bool    bVerified   = isCanonicalECDSASig (vchSig, fullyCanonical);
 
-    bVerified = isCanonicalECDSASig (vchSig, fullyCanonical);
+    // The native verifier only parses strict DER, OpenSSL takes the rest
+    if (bVerified && Secp256k1::isStrictSignature (vchSig))
+        return Secp256k1::verify (hash, getNodePublic (), vchSig);
+
+    CKey    pubkey  = CKey ();
 
     if (bVerified && !pubkey.SetPubKey (getNodePublic ()))
     {
@@ -198,13 +204,11 @@ bool RippleAddress::verifyNodePublic (uint256 const& hash, const std::string& st
 
 RippleAddress RippleAddress::createNodePrivate (const RippleAddress& naSeed)
 {
-    uint256         uPrivKey;
+    uint256         uPrivKey    = CKey::DeriveRootKey (naSeed.getSeed ());
     RippleAddress   naNew;
-    CKey            ckSeed (naSeed.getSeed ());
-
-    ckSeed.GetPrivateKeyU (uPrivKey);
 
     naNew.setNodePrivate (uPrivKey);
+    uPrivKey.zero ();
 
     return naNew;
 }
@@ -277,11 +281,7 @@ void RippleAddress::setNodePrivate (uint256 hash256)
 
 void RippleAddress::signNodePrivate (uint256 const& hash, Blob& vchSig) const
 {
-    CKey    ckPrivKey;
-
-    ckPrivKey.SetPrivateKeyU (getNodePrivate ());
-
-    if (!ckPrivKey.Sign (hash, vchSig))
+    if (!Secp256k1::sign (hash, getNodePrivate (), vchSig))
         throw std::runtime_error ("Signing failed.");
 }
 
@@ -382,10 +382,9 @@ void RippleAddress::setAccountID (const uint160& hash160)
 
 RippleAddress RippleAddress::createAccountPublic (const RippleAddress& naGenerator, int iSeq)
 {
-    CKey            ckPub (naGenerator, iSeq);
     RippleAddress   naNew;
 
-    naNew.setAccountPublic (ckPub.GetPubKey ());
+    naNew.setAccountPublic (CKey::DerivePublicKey (naGenerator, iSeq));
 
     return naNew;
 }
@@ -443,17 +442,19 @@ void RippleAddress::setAccountPublic (Blob const& vPublic)
 
 void RippleAddress::setAccountPublic (const RippleAddress& generator, int seq)
 {
-    CKey    pubkey  = CKey (generator, seq);
-
-    setAccountPublic (pubkey.GetPubKey ());
+    setAccountPublic (CKey::DerivePublicKey (generator, seq));
 }
 
 bool RippleAddress::accountPublicVerify (uint256 const& uHash, Blob const& vucSig, ECDSA fullyCanonical) const
 {
-    CKey        ckPublic;
-
     bool        bVerified = isCanonicalECDSASig (vucSig, fullyCanonical);
 
+    // The native verifier only parses strict DER, OpenSSL takes the rest
+    if (bVerified && Secp256k1::isStrictSignature (vucSig))
+        return Secp256k1::verify (uHash, getAccountPublic (), vucSig);
+
+    CKey        ckPublic;
+
     if (bVerified && !ckPublic.SetPubKey (getAccountPublic ()))
     {
         // Bad private key.
@@ -543,31 +544,21 @@ void RippleAddress::setAccountPrivate (uint256 hash256)
 
 void RippleAddress::setAccountPrivate (const RippleAddress& naGenerator, const RippleAddress& naSeed, int seq)
 {
-    CKey    ckPubkey    = CKey (naSeed.getSeed ());
-    CKey    ckPrivkey   = CKey (naGenerator, ckPubkey.GetSecretBN (), seq);
-    uint256 uPrivKey;
-
-    ckPrivkey.GetPrivateKeyU (uPrivKey);
+    uint256 uRootKey    = CKey::DeriveRootKey (naSeed.getSeed ());
+    uint256 uPrivKey    = CKey::DerivePrivateKey (naGenerator, uRootKey, seq);
 
     setAccountPrivate (uPrivKey);
+
+    uRootKey.zero ();
+    uPrivKey.zero ();
 }
 
 bool RippleAddress::accountPrivateSign (uint256 const& uHash, Blob& vucSig) const
 {
-    CKey        ckPrivate;
-    bool        bResult;
+    bool const bResult = Secp256k1::sign (uHash, getAccountPrivate (), vucSig);
 
-    if (!ckPrivate.SetPrivateKeyU (getAccountPrivate ()))
-    {
-        // Bad private key.
-        WriteLog (lsWARNING, RippleAddress) << "accountPrivateSign: Bad private key.";
-        bResult = false;
-    }
-    else
-    {
-        bResult = ckPrivate.Sign (uHash, vucSig);
-        CondLog (!bResult, lsWARNING, RippleAddress) << "accountPrivateSign: Signing failed.";
-    }
+    // Signing only fails when the private key is out of range.
+    CondLog (!bResult, lsWARNING, RippleAddress) << "accountPrivateSign: Bad private key.";
 
     return bResult;
 }
@@ -728,10 +719,14 @@ void RippleAddress::setGenerator (Blob const& vPublic)
 
 RippleAddress RippleAddress::createGeneratorPublic (const RippleAddress& naSeed)
 {
-    CKey            ckSeed (naSeed.getSeed ());
+    uint256         uPrivKey    = CKey::DeriveRootKey (naSeed.getSeed ());
+    Blob            vPublic;
     RippleAddress   naNew;
 
-    naNew.setGenerator (ckSeed.GetPubKey ());
+    Secp256k1::derivePublicKey (uPrivKey, vPublic);
+    uPrivKey.zero ();
+
+    naNew.setGenerator (vPublic);
 
     return naNew;
 }
@@ -42,6 +42,7 @@
 #include <openssl/hmac.h>
 #include <openssl/err.h>
 
+#include "../ripple/secp256k1/ripple_secp256k1.h"
 #include "../ripple/sslutil/ripple_sslutil.h"
 #include "../ripple_rpc/api/ErrorCodes.h"
 #include "../ripple/common/jsonrpc_fields.h"
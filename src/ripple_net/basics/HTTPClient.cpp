@@ -436,18 +436,14 @@ public:
         }
         else
         {
+            // A body without a Content-Length is delimited by the server
+            // closing the connection, so end of file completes the response.
             if (mShutdown)
-            {
                 WriteLog (lsTRACE, HTTPClient) << "Complete.";
 
-                nothing ();
-            }
-            else
-            {
-                mResponse.commit (bytes_transferred);
-                std::string strBody ((std::istreambuf_iterator<char> (&mResponse)), std::istreambuf_iterator<char> ());
-                invokeComplete (ecResult, mStatus, mBody + strBody);
-            }
+            mResponse.commit (bytes_transferred);
+            std::string strBody ((std::istreambuf_iterator<char> (&mResponse)), std::istreambuf_iterator<char> ());
+            invokeComplete (boost::system::error_code (), mStatus, mBody + strBody);
         }
     }
 
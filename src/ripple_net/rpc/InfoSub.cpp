@@ -39,9 +39,73 @@ InfoSub::Source::Source (char const* name, Stoppable& parent)
 
 //------------------------------------------------------------------------------
 
+InfoSub::Message::Message (JsonFunction json, BinaryFunction binary)
+    : m_makeJson (json)
+    , m_makeBinary (binary)
+    , m_haveJson (false)
+    , m_haveText (false)
+    , m_haveBinary (false)
+{
+}
+
+void InfoSub::Message::send (InfoSub& listener)
+{
+    if (m_makeBinary && listener.isBinary ())
+        listener.sendBinary (getBinary ());
+    else
+        listener.send (getJson (), getText (), true);
+}
+
+Json::Value const& InfoSub::Message::getJson ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+    return makeJson ();
+}
+
+Json::Value const& InfoSub::Message::makeJson ()
+{
+    if (! m_haveJson)
+    {
+        m_json = m_makeJson ();
+        m_haveJson = true;
+    }
+
+    return m_json;
+}
+
+std::string const& InfoSub::Message::getText ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    if (! m_haveText)
+    {
+        Json::FastWriter w;
+        m_text = w.write (makeJson ());
+        m_haveText = true;
+    }
+
+    return m_text;
+}
+
+std::string const& InfoSub::Message::getBinary ()
+{
+    std::lock_guard <std::mutex> lock (m_mutex);
+
+    if (! m_haveBinary)
+    {
+        m_binary = m_makeBinary ();
+        m_haveBinary = true;
+    }
+
+    return m_binary;
+}
+
+//------------------------------------------------------------------------------
+
 InfoSub::InfoSub (Source& source, Consumer consumer)
     : m_consumer (consumer)
     , m_source (source)
+    , mBinary (false)
 {
     static beast::Atomic <int> s_seq_id;
     mSeq = ++s_seq_id;
@@ -67,6 +131,25 @@ void InfoSub::send (const Json::Value& jvObj, const std::string& sObj, bool broa
     send (jvObj, broadcast);
 }
 
+void InfoSub::sendBinary (std::string const&)
+{
+}
+
+bool InfoSub::canSendBinary () const
+{
+    return false;
+}
+
+bool InfoSub::isBinary () const
+{
+    return mBinary;
+}
+
+void InfoSub::setBinary (bool binary)
+{
+    mBinary = binary;
+}
+
 std::uint64_t InfoSub::getSeq ()
 {
     return mSeq;
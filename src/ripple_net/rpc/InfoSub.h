@@ -98,6 +98,44 @@ public:
         virtual pointer addRpcSub (const std::string& strUrl, ref rspEntry) = 0;
     };
 
+public:
+    /** A message published to subscribers.
+
+        The message is produced in each form at most once, and only when a
+        listener wants that form. Listeners that chose binary receive the
+        binary frame if the message has one, and JSON otherwise. A message
+        may be sent from several threads at once.
+    */
+    class Message
+    {
+    public:
+        typedef std::function <Json::Value ()> JsonFunction;
+        typedef std::function <std::string ()> BinaryFunction;
+
+        explicit Message (JsonFunction json,
+            BinaryFunction binary = BinaryFunction ());
+
+        /** Send the message in the form the listener subscribed with. */
+        void send (InfoSub& listener);
+
+        Json::Value const& getJson ();
+        std::string const& getText ();
+        std::string const& getBinary ();
+
+    private:
+        Json::Value const& makeJson ();
+
+        std::mutex m_mutex;
+        JsonFunction m_makeJson;
+        BinaryFunction m_makeBinary;
+        bool m_haveJson;
+        bool m_haveText;
+        bool m_haveBinary;
+        Json::Value m_json;
+        std::string m_text;
+        std::string m_binary;
+    };
+
 public:
     InfoSub (Source& source, Consumer consumer);
 
@@ -110,9 +148,47 @@ public:
     // VFALCO NOTE Why is this virtual?
     virtual void send (const Json::Value & jvObj, const std::string & sObj, bool broadcast);
 
+    /** Send a binary subscription frame.
+        Only transports that can carry binary messages override this.
+    */
+    virtual void sendBinary (std::string const& frame);
+
+    virtual bool canSendBinary () const;
+
+    /** Whether the client asked for binary frames in subscribe.
+
+        Ledger closes and transactions are then sent without JSON. Each
+        frame is one binary message, integers are big-endian:
+
+        Ledger closed:
+            uint8       1
+            uint256     ledger hash
+            ...         ledger header, in the form that is hashed
+            uint64      base fee
+            uint32      reference fee units
+            uint64      reserve base
+            uint64      reserve increment
+            uint32      transaction count
+
+        Transaction:
+            uint8       2 if validated, 3 if proposed
+            uint32      ledger sequence, the open ledger's when proposed
+            uint256     ledger hash, zero when proposed
+            int32       engine result
+            uint32      length of the transaction, then the transaction
+            uint32      length of the metadata, then the metadata; the
+                        length is zero when there is none
+    */
+    /** @{ */
+    bool isBinary () const;
+
+    void setBinary (bool binary);
+    /** @} */
+
     std::uint64_t getSeq ();
 
-    void onSendEmpty ();
+    /** Called when everything queued for the client has been written. */
+    virtual void onSendEmpty ();
 
     void insertSubAccountInfo (RippleAddress addr, std::uint32_t uLedgerIndex);
 
@@ -135,6 +211,7 @@ private:
     boost::shared_ptr <PathRequest>             mPathRequest;
 
     std::uint64_t                               mSeq;
+    std::atomic <bool>                          mBinary;
 };
 
 } // ripple
@@ -127,6 +127,21 @@ private:
         return jvRequest;
     }
 
+    // cpu_profile [start [<interval>]|stop|dump]
+    Json::Value parseCPUProfile (const Json::Value& jvParams)
+    {
+        Json::Value     jvRequest (Json::objectValue);
+        unsigned int    iParams = jvParams.size ();
+
+        if (iParams != 0)
+            jvRequest["action"] = jvParams[0u].asString ();
+
+        if (iParams == 2)
+            jvRequest["interval"] = jvParams[1u].asUInt ();
+
+        return jvRequest;
+    }
+
     // account_tx accountID [ledger_min [ledger_max [limit [offset]]]] [binary] [count] [descending]
     Json::Value parseAccountTransactions (const Json::Value& jvParams)
     {
@@ -803,6 +818,7 @@ public:
             {   "account_tx",           &RPCParser::parseAccountTransactions,   1,  8   },
             {   "book_offers",          &RPCParser::parseBookOffers,            2,  7   },
             {   "connect",              &RPCParser::parseConnect,               1,  2   },
+            {   "cpu_profile",          &RPCParser::parseCPUProfile,            0,  2   },
             {   "consensus_info",       &RPCParser::parseAsIs,                  0,  0   },
             {   "feature",              &RPCParser::parseFeature,               0,  2   },
             {   "fetch_info",           &RPCParser::parseFetchInfo,             0,  1   },
@@ -827,6 +843,7 @@ public:
             {   "proof_verify",         &RPCParser::parseProofVerify,           2,  4   },
             {   "random",               &RPCParser::parseAsIs,                  0,  0   },
             {   "ripple_path_find",     &RPCParser::parseRipplePathFind,        1,  2   },
+            {   "rpc_latency",          &RPCParser::parseAsIs,                  0,  0   },
             {   "sign",                 &RPCParser::parseSignSubmit,            2,  3   },
             {   "sms",                  &RPCParser::parseSMS,                   1,  1   },
             {   "submit",               &RPCParser::parseSignSubmit,            1,  3   },
@@ -176,6 +176,70 @@ std::string HTTPReply (int nStatus, const std::string& strMsg)
     return ret;
 }
 
+std::string HTTPStreamHeader (int nStatus)
+{
+    std::string ret;
+
+    ret.reserve (256);
+
+    switch (nStatus)
+    {
+    case 200: ret.append ("HTTP/1.1 200 OK\r\n"); break;
+    case 500: ret.append ("HTTP/1.1 500 Internal Server Error\r\n"); break;
+    }
+
+    ret.append (getHTTPHeaderTimestamp ());
+
+    ret.append ("Connection: close\r\n");
+
+    if (getConfig ().RPC_ALLOW_REMOTE)
+        ret.append ("Access-Control-Allow-Origin: *\r\n");
+
+    ret.append ("Content-Type: application/json; charset=UTF-8\r\n");
+
+    ret.append ("Server: " SYSTEM_NAME "-json-rpc/");
+    ret.append (BuildInfo::getFullVersionString ());
+    ret.append ("\r\n");
+
+    ret.append ("\r\n");
+
+    return ret;
+}
+
+std::string HTTPChunkedHeader (int nStatus, std::string const& contentType)
+{
+    std::string ret;
+
+    ret.reserve (256);
+
+    switch (nStatus)
+    {
+    case 200: ret.append ("HTTP/1.1 200 OK\r\n"); break;
+    case 500: ret.append ("HTTP/1.1 500 Internal Server Error\r\n"); break;
+    }
+
+    ret.append (getHTTPHeaderTimestamp ());
+
+    ret.append ("Connection: close\r\n");
+
+    if (getConfig ().RPC_ALLOW_REMOTE)
+        ret.append ("Access-Control-Allow-Origin: *\r\n");
+
+    ret.append ("Content-Type: ");
+    ret.append (contentType);
+    ret.append ("\r\n");
+
+    ret.append ("Transfer-Encoding: chunked\r\n");
+
+    ret.append ("Server: " SYSTEM_NAME "-json-rpc/");
+    ret.append (BuildInfo::getFullVersionString ());
+    ret.append ("\r\n");
+
+    ret.append ("\r\n");
+
+    return ret;
+}
+
 int ReadHTTPStatus (std::basic_istream<char>& stream)
 {
     std::string str;
@@ -38,6 +38,14 @@ extern std::string createHTTPPost (const std::string& strHost, const std::string
 
 extern std::string HTTPReply (int nStatus, const std::string& strMsg);
 
+// The headers for a reply whose body is streamed. The body has no length
+// known in advance, it ends when the connection is closed.
+extern std::string HTTPStreamHeader (int nStatus);
+
+// The headers for a binary reply sent with chunked transfer encoding, so
+// the client can tell a complete body from one that was cut off.
+extern std::string HTTPChunkedHeader (int nStatus, std::string const& contentType);
+
 // VFALCO TODO Create a HTTPHeaders class with a nice interface instead of the std::map
 //
 extern bool HTTPAuthorized (std::map <std::string, std::string> const& mapHeaders);
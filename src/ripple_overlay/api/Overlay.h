@@ -29,6 +29,8 @@
 #include "../../beast/beast/utility/PropertyStream.h"
 
 #include "../../beast/beast/cxx14/type_traits.h" // <type_traits>
+#include <set>
+#include <string>
 
 namespace ripple {
 
@@ -74,6 +76,30 @@ public:
     // Peer 64-bit ID function
     virtual Peer::ptr findPeerByShortID (Peer::ShortId const& id) = 0;
 
+    /** Relay a message that we received from the network.
+        The message goes to the cluster peers and to the peers chosen by
+        the relay policy. It is never sent to the peers in `skip`, which
+        already have it.
+        @param validator The public key of the validator that signed the
+                         message, or empty if no validator signed it.
+    */
+    virtual void relay (Message::pointer const& m,
+        std::set <Peer::ShortId> const& skip,
+            std::string const& validator) = 0;
+
+    /** Record the result of checking a signature ourselves.
+        With [cluster_signatures] enabled, results are sent to the cluster
+        peers in batches so that they need not check the signature again.
+        @param hash The hash the HashRouter tracks the signed item by.
+    */
+    virtual void onSignatureChecked (uint256 const& hash, bool good) = 0;
+
+    /** A signature check was skipped because a cluster peer had done it. */
+    virtual void onSignatureCheckAvoided () = 0;
+
+    /** Send the batched signature results now, if there are any. */
+    virtual void sendSignatureResults () = 0;
+
     /** Visit every active peer and return a value
         The functor must:
         - Be callable as:
@@ -74,6 +74,12 @@ public:
     virtual void cycleStatus () = 0;
     virtual bool supportsVersion (int version) = 0;
     virtual bool hasRange (std::uint32_t uMin, std::uint32_t uMax) = 0;
+
+    /** Returns a figure of merit for choosing peers to query.
+        Higher is better. The score favors peers that answer pings quickly
+        and often deliver data we have not seen.
+    */
+    virtual int getScore () const = 0;
 };
 
 }
@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_RELAYPOLICY_H_INCLUDED
+#define RIPPLE_OVERLAY_RELAYPOLICY_H_INCLUDED
+
+#include "../../beast/beast/chrono/abstract_clock.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ripple {
+
+/** Chooses the peers that a relayed message is forwarded to.
+
+    Without a policy, proposals, validations and transactions go to every
+    peer that has not already sent them to us, so each message arrives at
+    each node many times over. The policy cuts the duplicates in two ways:
+
+    - Messages signed by a validator go to every peer, but a node that
+      receives a validator from more peers than it needs squelches the
+      others, which then stop relaying that validator to it for a while.
+
+    - Transactions go to a bounded number of peers, sampled at random with
+      a preference for peers that are close and that are unlikely to have
+      the transaction already.
+
+    Bounding the fan-out of validator messages as well would leave a node
+    that squelched its other peers depending on sources which may not pick
+    it, so the two are never combined.
+
+    The policy only makes decisions; the overlay sends the messages. It has
+    no dependencies on the rest of the server so that the same logic can be
+    run in a simulated network.
+
+    This class is not thread safe, the caller must synchronize access.
+*/
+class RelayPolicy
+{
+public:
+    // The type here *MUST* match the type of Peer::ShortId
+    typedef std::uint32_t id_t;
+
+    typedef beast::abstract_clock <std::chrono::seconds> clock_type;
+
+    struct Setup
+    {
+        Setup ();
+
+        /** The most peers a transaction is relayed to, zero for every peer. */
+        std::size_t fanout;
+
+        /** The peers we keep receiving each validator's messages from.
+            Zero means never squelch.
+        */
+        std::size_t maxSources;
+
+        /** Messages from a validator seen before choosing its sources. */
+        std::size_t minMessages;
+
+        /** How long the other peers stay squelched. */
+        std::chrono::seconds squelchDuration;
+    };
+
+    /** A squelch or unsquelch message that should be sent to a peer. */
+    struct Squelch
+    {
+        id_t peer;
+        std::string validator;
+        bool squelch;
+        std::chrono::seconds duration;
+    };
+
+    typedef std::vector <Squelch> Squelches;
+
+    /** The longest squelch we will honor from a peer. */
+    static std::chrono::seconds maxSquelchDuration ()
+    {
+        return std::chrono::seconds (3600);
+    }
+
+    /** The most validators a single peer may squelch at once. */
+    static std::size_t maxSquelches ()
+    {
+        return 1024;
+    }
+
+    /** The most validators whose sources are tracked at once.
+        Validators past the limit are not squelched until others go quiet.
+    */
+    static std::size_t maxValidators ()
+    {
+        return 1024;
+    }
+
+    RelayPolicy (Setup const& setup, clock_type& clock, std::uint32_t seed);
+
+    Setup const& setup () const
+    {
+        return m_setup;
+    }
+
+    /** Called when a peer is activated. */
+    void insert (id_t peer);
+
+    /** Called when a peer disconnects.
+        @return Unsquelch messages for the validators whose chosen sources
+                included this peer.
+    */
+    Squelches erase (id_t peer);
+
+    /** Record a round trip time measured to a peer. */
+    void onLatency (id_t peer, std::chrono::milliseconds rtt);
+
+    /** Record a relayed message received from a peer.
+        @param first `true` if no other peer sent us the message before.
+        @param validator The public key of the signing validator, or empty.
+        @return The squelch messages to send.
+    */
+    Squelches onMessage (id_t peer, bool first, std::string const& validator);
+
+    /** A peer asked us to stop, or resume, relaying a validator to it. */
+    void onSquelch (id_t peer, std::string const& validator,
+        bool squelch, std::chrono::seconds duration);
+
+    /** Choose the peers to relay a message to.
+        The candidates are reordered so that the chosen peers come first.
+        @param validator The public key of the signing validator, or empty.
+        @return The number of chosen peers.
+    */
+    std::size_t select (std::vector <id_t>& candidates,
+        std::string const& validator);
+
+private:
+    struct PeerState
+    {
+        PeerState ();
+
+        // Smoothed round trip time in milliseconds, zero if unmeasured
+        double latency;
+
+        // Messages received from the peer, and how many were new to us
+        std::uint32_t received;
+        std::uint32_t firsts;
+
+        // Validators this peer asked us not to relay, and until when
+        std::map <std::string, clock_type::time_point> squelched;
+    };
+
+    struct Sources
+    {
+        Sources ();
+
+        void reset ();
+
+        // Messages seen while choosing sources
+        std::size_t messages;
+
+        // How often each peer delivered the validator's message first
+        std::map <id_t, std::size_t> firsts;
+
+        // Once chosen, the sources we kept, the peers we squelched,
+        // and when the squelch ends
+        bool chosen;
+        std::vector <id_t> kept;
+        std::vector <id_t> squelched;
+        clock_type::time_point expires;
+
+        // Validators that go quiet are forgotten
+        clock_type::time_point lastSeen;
+    };
+
+    bool isSquelched (PeerState& state, std::string const& validator,
+        clock_type::time_point now);
+
+    double weight (PeerState const& state, double defaultLatency) const;
+
+    void choose (std::string const& validator, Sources& sources,
+        clock_type::time_point now, Squelches& result);
+
+    void expire (clock_type::time_point now);
+
+    Setup const m_setup;
+    clock_type& m_clock;
+    std::mt19937 m_random;
+
+    std::unordered_map <id_t, PeerState> m_peers;
+    std::unordered_map <std::string, Sources> m_validators;
+};
+
+}
+
+#endif
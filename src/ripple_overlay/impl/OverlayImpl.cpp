@@ -77,6 +77,19 @@ struct get_peer_json
 
 //------------------------------------------------------------------------------
 
+static
+RelayPolicy::Setup
+make_RelaySetup ()
+{
+    RelayPolicy::Setup setup;
+    setup.fanout = getConfig ().RELAY_FANOUT;
+    if (! getConfig ().RELAY_SQUELCH)
+        setup.maxSources = 0;
+    return setup;
+}
+
+//------------------------------------------------------------------------------
+
 OverlayImpl::OverlayImpl (Stoppable& parent,
     Resource::Manager& resourceManager,
     SiteFiles::Manager& siteFiles,
@@ -98,6 +111,12 @@ OverlayImpl::OverlayImpl (Stoppable& parent,
     , m_io_service (io_service)
     , m_ssl_context (ssl_context)
     , m_resolver (resolver)
+    , m_relay (make_RelaySetup (), get_seconds_clock (),
+        std::random_device () ())
+    , m_signaturesSent (0)
+    , m_signaturesReceived (0)
+    , m_signaturesApplied (0)
+    , m_signatureChecksAvoided (0)
 {
 }
 
@@ -480,6 +499,11 @@ OverlayImpl::onChildrenStopped ()
 void
 OverlayImpl::onWrite (beast::PropertyStream::Map& stream)
 {
+    beast::PropertyStream::Map signatures ("cluster_signatures", stream);
+    signatures ["sent"] = m_signaturesSent.load ();
+    signatures ["received"] = m_signaturesReceived.load ();
+    signatures ["applied"] = m_signaturesApplied.load ();
+    signatures ["checks_avoided"] = m_signatureChecksAvoided.load ();
 }
 
 //--------------------------------------------------------------------------
@@ -510,6 +534,11 @@ OverlayImpl::onPeerActivated (Peer::ptr const& peer)
         assert(result.second);
     }
 
+    {
+        std::lock_guard <decltype(m_relayMutex)> lock (m_relayMutex);
+        m_relay.insert (peer->getShortId ());
+    }
+
     m_journal.debug << 
         "activated " << peer->getRemoteAddress() <<
         " (" << peer->getShortId() << 
@@ -527,9 +556,18 @@ OverlayImpl::onPeerActivated (Peer::ptr const& peer)
 void
 OverlayImpl::onPeerDisconnect (Peer::ptr const& peer)
 {
-    std::lock_guard <decltype(m_mutex)> lock (m_mutex);
-    m_shortIdMap.erase (peer->getShortId ());
-    m_publicKeyMap.erase (peer->getNodePublic ());
+    {
+        std::lock_guard <decltype(m_mutex)> lock (m_mutex);
+        m_shortIdMap.erase (peer->getShortId ());
+        m_publicKeyMap.erase (peer->getNodePublic ());
+    }
+
+    RelayPolicy::Squelches squelches;
+    {
+        std::lock_guard <decltype(m_relayMutex)> lock (m_relayMutex);
+        squelches = m_relay.erase (peer->getShortId ());
+    }
+    sendSquelches (squelches);
 }
 
 /** The number of active peers on the network
@@ -579,6 +617,174 @@ OverlayImpl::findPeerByShortID (Peer::ShortId const& id)
     return Peer::ptr();
 }
 
+void
+OverlayImpl::relay (Message::pointer const& m,
+    std::set <Peer::ShortId> const& skip, std::string const& validator)
+{
+    PeerSequence const peers (getActivePeers ());
+
+    std::vector <Peer::ShortId> chosen;
+    chosen.reserve (peers.size ());
+
+    for (auto const& peer : peers)
+    {
+        if (skip.count (peer->getShortId ()) != 0)
+            continue;
+
+        // Cluster peers get everything we relay
+        if (peer->isInCluster ())
+            peer->sendPacket (m, false);
+        else
+            chosen.push_back (peer->getShortId ());
+    }
+
+    {
+        std::lock_guard <decltype(m_relayMutex)> lock (m_relayMutex);
+        chosen.resize (m_relay.select (chosen, validator));
+    }
+
+    std::sort (chosen.begin (), chosen.end ());
+
+    for (auto const& peer : peers)
+    {
+        if (std::binary_search (chosen.begin (), chosen.end (),
+                peer->getShortId ()))
+            peer->sendPacket (m, false);
+    }
+}
+
+void
+OverlayImpl::onRelayed (Peer::ShortId id, bool first,
+    std::string const& validator)
+{
+    RelayPolicy::Squelches squelches;
+    {
+        std::lock_guard <decltype(m_relayMutex)> lock (m_relayMutex);
+        squelches = m_relay.onMessage (id, first, validator);
+    }
+    sendSquelches (squelches);
+}
+
+void
+OverlayImpl::onLatency (Peer::ShortId id, std::chrono::milliseconds rtt)
+{
+    std::lock_guard <decltype(m_relayMutex)> lock (m_relayMutex);
+    m_relay.onLatency (id, rtt);
+}
+
+void
+OverlayImpl::onSquelch (Peer::ShortId id, bool squelch,
+    std::string const& validator, std::chrono::seconds duration)
+{
+    std::lock_guard <decltype(m_relayMutex)> lock (m_relayMutex);
+    m_relay.onSquelch (id, validator, squelch, duration);
+}
+
+void
+OverlayImpl::sendSquelches (RelayPolicy::Squelches const& squelches)
+{
+    for (auto const& squelch : squelches)
+    {
+        Peer::ptr const peer (findPeerByShortID (squelch.peer));
+
+        if (peer == nullptr)
+            continue;
+
+        protocol::TMSquelch tm;
+        tm.set_squelch (squelch.squelch);
+        tm.set_validatorpubkey (squelch.validator);
+        if (squelch.squelch)
+            tm.set_squelchduration (squelch.duration.count ());
+
+        peer->sendPacket (boost::make_shared <Message> (
+            tm, protocol::mtSQUELCH), false);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void
+OverlayImpl::onSignatureChecked (uint256 const& hash, bool good)
+{
+    if (! getConfig ().CLUSTER_SIGNATURES || getConfig ().CLUSTER_NODES.empty ())
+        return;
+
+    // Results are sent in batches, whichever of a full message or a
+    // short delay comes first. The heartbeat sends any stragglers.
+    std::size_t const batchSize (256);
+    std::chrono::milliseconds const batchDelay (200);
+
+    bool send;
+    {
+        std::lock_guard <std::mutex> lock (m_signatureMutex);
+
+        std::size_t const pending (
+            (m_goodSignatures.size () + m_badSignatures.size ()) / 32);
+
+        // Sharing is only an optimization, drop results past the limit
+        if (pending >= maxSignatureResults)
+            return;
+
+        auto const now (std::chrono::steady_clock::now ());
+        if (pending == 0)
+            m_signaturesSince = now;
+
+        std::string& list (good ? m_goodSignatures : m_badSignatures);
+        list.append (reinterpret_cast <char const*> (hash.begin ()), hash.size ());
+
+        send = (pending + 1 >= batchSize) ||
+            (now - m_signaturesSince >= batchDelay);
+    }
+
+    if (send)
+        sendSignatureResults ();
+}
+
+void
+OverlayImpl::onSignatureCheckAvoided ()
+{
+    ++m_signatureChecksAvoided;
+}
+
+void
+OverlayImpl::sendSignatureResults ()
+{
+    protocol::TMSignatureResults tm;
+    {
+        std::lock_guard <std::mutex> lock (m_signatureMutex);
+
+        if (m_goodSignatures.empty () && m_badSignatures.empty ())
+            return;
+
+        if (! m_goodSignatures.empty ())
+            tm.mutable_good ()->swap (m_goodSignatures);
+        if (! m_badSignatures.empty ())
+            tm.mutable_bad ()->swap (m_badSignatures);
+    }
+
+    std::size_t const count ((tm.good ().size () + tm.bad ().size ()) / 32);
+    assert (count <= maxSignatureResults);
+
+    Message::pointer const m (boost::make_shared <Message> (
+        tm, protocol::mtSIGNATURE_RESULTS));
+
+    for (auto const& peer : getActivePeers ())
+    {
+        if (peer->isInCluster ())
+        {
+            peer->sendPacket (m, false);
+            m_signaturesSent += count;
+        }
+    }
+}
+
+void
+OverlayImpl::onSignatureResults (std::size_t received, std::size_t applied)
+{
+    m_signaturesReceived += received;
+    m_signaturesApplied += applied;
+}
+
 //------------------------------------------------------------------------------
 
 std::unique_ptr <Overlay>
@@ -21,6 +21,7 @@
 #define RIPPLE_OVERLAY_OVERLAYIMPL_H_INCLUDED
 
 #include "../api/Overlay.h"
+#include "../api/RelayPolicy.h"
 
 #include "../../ripple/common/Resolver.h"
 #include "../../ripple/common/seconds_clock.h"
@@ -33,7 +34,9 @@
 #include <boost/unordered_map.hpp>
 
 #include "../../beast/beast/cxx14/memory.h" // <memory>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <unordered_map>
@@ -96,6 +99,25 @@ public:
     /** Monotically increasing identifiers for peers */
     beast::Atomic <Peer::ShortId> m_nextShortId;
 
+    /** Chooses the peers that relayed messages go to */
+    std::mutex m_relayMutex;
+    RelayPolicy m_relay;
+
+    /** The most hashes in one signature results message */
+    static std::size_t const maxSignatureResults = 1024;
+
+    /** Signature results waiting to be sent to the cluster */
+    std::mutex m_signatureMutex;
+    std::string m_goodSignatures;
+    std::string m_badSignatures;
+    std::chrono::steady_clock::time_point m_signaturesSince;
+
+    /** Counts of signature results shared with the cluster */
+    std::atomic <std::uint64_t> m_signaturesSent;
+    std::atomic <std::uint64_t> m_signaturesReceived;
+    std::atomic <std::uint64_t> m_signaturesApplied;
+    std::atomic <std::uint64_t> m_signatureChecksAvoided;
+
     //--------------------------------------------------------------------------
 
     OverlayImpl (Stoppable& parent,
@@ -219,6 +241,57 @@ public:
 
     Peer::ptr
     findPeerByShortID (Peer::ShortId const& id);
+
+    void
+    relay (Message::pointer const& m,
+        std::set <Peer::ShortId> const& skip,
+            std::string const& validator);
+
+    //--------------------------------------------------------------------------
+    //
+    // Relay policy
+    //
+
+    /** A peer sent us a message that is relayed across the network.
+        @param first `true` if we had not seen the message before.
+        @param validator The public key of the signing validator, or empty.
+    */
+    void
+    onRelayed (Peer::ShortId id, bool first, std::string const& validator);
+
+    /** A peer answered our ping after `rtt`. */
+    void
+    onLatency (Peer::ShortId id, std::chrono::milliseconds rtt);
+
+    /** A peer asked us to stop, or resume, relaying a validator to it. */
+    void
+    onSquelch (Peer::ShortId id, bool squelch,
+        std::string const& validator, std::chrono::seconds duration);
+
+    /** Send the squelch messages the relay policy decided on. */
+    void
+    sendSquelches (RelayPolicy::Squelches const& squelches);
+
+    //--------------------------------------------------------------------------
+    //
+    // Cluster signature results
+    //
+
+    void
+    onSignatureChecked (uint256 const& hash, bool good);
+
+    void
+    onSignatureCheckAvoided ();
+
+    void
+    sendSignatureResults ();
+
+    /** A cluster peer sent us signature results.
+        @param received The number of hashes in the message.
+        @param applied The number of hashes we had no result for.
+    */
+    void
+    onSignatureResults (std::size_t received, std::size_t applied);
 };
 
 } // ripple
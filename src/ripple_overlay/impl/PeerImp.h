@@ -33,6 +33,8 @@
 //        just include what is needed.
 #include "../ripple_app/ripple_app.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 
 namespace ripple {
@@ -64,6 +66,15 @@ private:
     /** Time alloted for a peer to send a HELLO message (DEPRECATED) */
     static const boost::posix_time::seconds nodeVerifySeconds;
 
+    /** How often we ping an active peer to measure its latency */
+    static const boost::posix_time::seconds pingSeconds;
+
+    /** Weights used by getScore when choosing peers to query */
+    static const int scoreLatency = 30;
+    static const int scoreNoLatency = 8000;
+    static const int scoreUseful = 20;
+    static const std::uint32_t scoreUsefulMax = 100;
+
     /** The clock drift we allow a remote peer to have */
     static const std::uint32_t clockToleranceDeltaSeconds = 20;
 
@@ -193,6 +204,18 @@ public:
 
     boost::asio::deadline_timer         m_timer;
 
+    // Latency measurement
+    boost::asio::deadline_timer         m_pingTimer;
+    std::uint32_t                       m_pingSeq;
+    std::chrono::steady_clock::time_point m_pingSent;
+
+    // Smoothed round trip time in milliseconds, zero until measured
+    std::atomic <std::uint32_t>         m_latency;
+
+    // Useful messages since the last ping, and their smoothed rate
+    std::atomic <std::uint32_t>         m_useful;
+    std::atomic <std::uint32_t>         m_usefulRate;
+
     std::vector<uint8_t>                m_readBuffer;
     std::list<Message::pointer>   mSendQ;
     Message::pointer              mSendingPacket;
@@ -235,6 +258,11 @@ public:
             , m_minLedger (0)
             , m_maxLedger (0)
             , m_timer (m_owned_socket.get_io_service())
+            , m_pingTimer (m_owned_socket.get_io_service())
+            , m_pingSeq (0)
+            , m_latency (0)
+            , m_useful (0)
+            , m_usefulRate (0)
             , m_slot (slot)
             , m_was_canceled (false)
     {
@@ -272,6 +300,11 @@ public:
             , m_minLedger (0)
             , m_maxLedger (0)
             , m_timer (io_service)
+            , m_pingTimer (io_service)
+            , m_pingSeq (0)
+            , m_latency (0)
+            , m_useful (0)
+            , m_usefulRate (0)
             , m_slot (slot)
             , m_was_canceled (false)
     {
@@ -346,6 +379,7 @@ public:
             mSendQ.clear ();
 
             (void) m_timer.cancel ();
+            (void) m_pingTimer.cancel ();
 
             if (graceful)
             {
@@ -434,6 +468,7 @@ public:
         bassert(m_shortId == 0);
         m_shortId = m_overlay.next_id();
         m_overlay.onPeerActivated(shared_from_this ());
+        setPingTimer ();
     }
 
     void start ()
@@ -501,6 +536,15 @@ public:
             p->charge (fee);
     }
 
+    // Credit a peer that sent us a new message, once its signature passed
+    static void useful (boost::weak_ptr <Peer>& peer)
+    {
+        Peer::ptr p (peer.lock());
+
+        if (p != nullptr)
+            ++static_cast <PeerImp&> (*p).m_useful;
+    }
+
     Json::Value json ()
     {
         Json::Value ret (Json::objectValue);
@@ -511,6 +555,9 @@ public:
         if (m_inbound)
             ret["inbound"] = true;
 
+        if (m_latency != 0)
+            ret["latency"] = m_latency.load ();
+
         if (m_clusterNode)
         {
             ret["cluster"] = true;
@@ -576,6 +623,22 @@ public:
         return m_clusterNode;
     }
 
+    int getScore () const
+    {
+        int score;
+
+        std::uint32_t const latency (m_latency);
+        if (latency != 0)
+            score = - static_cast <int> (latency) * scoreLatency;
+        else
+            score = - scoreNoLatency;
+
+        score += std::min <std::uint32_t> (m_usefulRate,
+            scoreUsefulMax) * scoreUseful;
+
+        return score;
+    }
+
     uint256 const& getClosedLedgerHash () const
     {
         return m_closedLedgerHash;
@@ -792,6 +855,44 @@ private:
         startReadHeader ();
     }
 
+    void setPingTimer ()
+    {
+        boost::system::error_code ec;
+
+        m_pingTimer.expires_from_now (pingSeconds, ec);
+
+        if (ec)
+        {
+            m_journal.error << "Failed to set ping timer.";
+            return;
+        }
+
+        m_pingTimer.async_wait (m_strand.wrap (boost::bind (
+            &PeerImp::handlePingTimer,
+            boost::static_pointer_cast <PeerImp> (shared_from_this ()),
+            boost::asio::placeholders::error)));
+    }
+
+    void handlePingTimer (boost::system::error_code const& ec)
+    {
+        if (m_detaching || ec == boost::asio::error::operation_aborted)
+            return;
+
+        // A ping still unanswered is simply forgotten
+        protocol::TMPing packet;
+        packet.set_type (protocol::TMPing::ptPING);
+        packet.set_seq (++m_pingSeq);
+        m_pingSent = std::chrono::steady_clock::now ();
+
+        sendPacket (boost::make_shared<Message> (packet, protocol::mtPING), true);
+
+        std::uint32_t const useful (m_useful.exchange (0));
+        m_usefulRate = (m_usefulRate * 3 + useful) / 4;
+        m_peerFinder.on_useful (m_slot, useful);
+
+        setPingTimer ();
+    }
+
     void handleVerifyTimer (boost::system::error_code const& ec)
     {
         if (m_detaching)
@@ -1123,6 +1224,32 @@ private:
             }
                 break;
 
+            case protocol::mtSQUELCH:
+            {
+                event->reName ("Peer::squelch");
+                protocol::TMSquelch msg;
+
+                if (msg.ParseFromArray (&m_readBuffer[Message::kHeaderBytes],
+                                        msgLen))
+                    recvSquelch (msg);
+                else
+                    m_journal.warning << "parse error: " << type;
+            }
+                break;
+
+            case protocol::mtSIGNATURE_RESULTS:
+            {
+                event->reName ("Peer::signature_results");
+                protocol::TMSignatureResults msg;
+
+                if (msg.ParseFromArray (&m_readBuffer[Message::kHeaderBytes],
+                                        msgLen))
+                    recvSignatureResults (msg);
+                else
+                    m_journal.warning << "parse error: " << type;
+            }
+                break;
+
             case protocol::mtPROOFOFWORK:
             {
                 event->reName ("Peer::proofofwork");
@@ -1510,7 +1637,12 @@ private:
 
             int flags;
 
-            if (! getApp().getHashRouter ().addSuppressionPeer (txID, m_shortId, flags))
+            bool const isNew (getApp().getHashRouter ().addSuppressionPeer (
+                txID, m_shortId, flags));
+
+            m_overlay.onRelayed (m_shortId, isNew, std::string ());
+
+            if (! isNew)
             {
                 // we have seen this transaction recently
                 if (is_bit_set (flags, SF_BAD))
@@ -1522,6 +1654,13 @@ private:
                 if (!is_bit_set (flags, SF_RETRY))
                     return;
             }
+            else if (is_bit_set (flags, SF_BAD))
+            {
+                // A cluster peer found the signature bad
+                m_overlay.onSignatureCheckAvoided ();
+                charge (Resource::feeInvalidSignature);
+                return;
+            }
 
              m_journal.debug << "Got transaction from peer " << *this << ": " << txID;
 
@@ -1536,7 +1675,7 @@ private:
                 getApp().getJobQueue ().addJob (jtTRANSACTION,
                     "recvTransaction->checkTransaction",
                     BIND_TYPE (
-                        &PeerImp::checkTransaction, P_1, flags, stx,
+                        &PeerImp::checkTransaction, P_1, flags, isNew, stx,
                         boost::weak_ptr<Peer> (shared_from_this ())));
 
     #ifndef TRUST_NETWORK
@@ -1576,13 +1715,33 @@ private:
                 return;
             }
 
-            if (! getApp().getHashRouter ().addSuppressionPeer (s.getSHA512Half(), m_shortId))
+            uint256 const suppression (s.getSHA512Half ());
+            int flags;
+
+            bool const isNew (getApp().getHashRouter ().addSuppressionPeer (
+                suppression, m_shortId, flags));
+
+            bool isTrusted = getApp().getUNL ().nodeInUNL (val->getSignerPublic ());
+
+            if (! isNew)
             {
+                // Only a copy of a message we verified counts towards its sources
+                if (isTrusted && is_bit_set (flags, SF_SIGGOOD))
+                    m_overlay.onRelayed (m_shortId, false,
+                        strCopy (val->getFieldVL (sfSigningPubKey)));
+
                 m_journal.trace << "Validation is duplicate";
                 return;
             }
 
-            bool isTrusted = getApp().getUNL ().nodeInUNL (val->getSignerPublic ());
+            if (is_bit_set (flags, SF_BAD))
+            {
+                // A cluster peer found the signature bad
+                m_overlay.onSignatureCheckAvoided ();
+                charge (Resource::feeInvalidRequest);
+                return;
+            }
+
             if (isTrusted || !getApp().getFeeTrack ().isLoadedLocal ())
             {
                 getApp().getJobQueue ().addJob (
@@ -1590,7 +1749,7 @@ private:
                     "recvValidation->checkValidation",
                     BIND_TYPE (
                         &PeerImp::checkValidation, P_1, &m_overlay, val,
-                        isTrusted, m_clusterNode, packet,
+                        suppression, isTrusted, m_clusterNode, packet,
                         boost::weak_ptr<Peer> (shared_from_this ())));
             }
             else
@@ -1817,7 +1976,81 @@ private:
         {
             packet.set_type (protocol::TMPing::ptPONG);
             sendPacket (boost::make_shared<Message> (packet, protocol::mtPING), true);
-        }        
+        }
+        else if (packet.type () == protocol::TMPing::ptPONG &&
+            packet.has_seq () && m_pingSeq != 0 && packet.seq () == m_pingSeq)
+        {
+            std::chrono::milliseconds const rtt (
+                std::chrono::duration_cast <std::chrono::milliseconds> (
+                    std::chrono::steady_clock::now () - m_pingSent));
+
+            // Zero is reserved to mean unmeasured
+            std::uint32_t const sample (std::max <std::uint32_t> (
+                rtt.count (), 1));
+            std::uint32_t const latency (m_latency);
+            m_latency = (latency == 0) ? sample : (latency * 3 + sample) / 4;
+
+            m_overlay.onLatency (m_shortId, rtt);
+            m_peerFinder.on_latency (m_slot, rtt);
+        }
+    }
+
+    void recvSquelch (protocol::TMSquelch const& packet)
+    {
+        if ((packet.validatorpubkey ().size () < 28) ||
+            (packet.validatorpubkey ().size () > 128))
+        {
+            m_journal.warning << "Received squelch is malformed";
+            charge (Resource::feeInvalidRequest);
+            return;
+        }
+
+        m_overlay.onSquelch (m_shortId, packet.squelch (),
+            packet.validatorpubkey (), std::chrono::seconds (
+                packet.has_squelchduration () ? packet.squelchduration () : 0));
+    }
+
+    void recvSignatureResults (protocol::TMSignatureResults const& packet)
+    {
+        // Only results from our own cluster are trusted
+        if (!m_clusterNode)
+        {
+            m_journal.warning << "Signature results from non-cluster peer";
+            charge (Resource::feeUnwantedData);
+            return;
+        }
+
+        std::size_t const count (
+            (packet.good ().size () + packet.bad ().size ()) / 32);
+
+        if ((packet.good ().size () % 32) != 0 ||
+            (packet.bad ().size () % 32) != 0 ||
+            count > OverlayImpl::maxSignatureResults)
+        {
+            m_journal.warning << "Received signature results are malformed";
+            charge (Resource::feeInvalidRequest);
+            return;
+        }
+
+        if (!getConfig ().CLUSTER_SIGNATURES)
+            return;
+
+        std::size_t applied (0);
+        auto apply = [&applied](std::string const& hashes, int flag)
+        {
+            for (std::size_t i = 0; i < hashes.size (); i += 32)
+            {
+                uint256 hash;
+                memcpy (hash.begin (), hashes.data () + i, 32);
+
+                if (getApp().getHashRouter ().setClusterResult (hash, flag))
+                    ++applied;
+            }
+        };
+        apply (packet.good (), SF_SIGGOOD);
+        apply (packet.bad (), SF_BAD);
+
+        m_overlay.onSignatureResults (count, applied);
     }
 
     void recvErrorMessage (protocol::TMErrorMsg& packet)
@@ -1913,6 +2146,10 @@ private:
             {
                 charge (Resource::feeUnwantedData);
             }
+            else if (san.isUseful ())
+            {
+                ++m_useful;
+            }
 
             return;
         }
@@ -1922,6 +2159,10 @@ private:
             WriteLog (lsTRACE, Peer) << "Got data for unwanted ledger";
             charge (Resource::feeUnwantedData);
         }
+        else
+        {
+            ++m_useful;
+        }
     }
 
     void recvStatus (protocol::TMStatusChange& packet)
@@ -2022,12 +2263,30 @@ private:
             Blob(set.nodepubkey ().begin (), set.nodepubkey ().end ()),
             Blob(set.signature ().begin (), set.signature ().end ()));
 
-        if (! getApp().getHashRouter ().addSuppressionPeer (suppression, m_shortId))
+        int flags;
+
+        bool const isNew (getApp().getHashRouter ().addSuppressionPeer (
+            suppression, m_shortId, flags));
+
+        if (! isNew)
         {
+            // Only a copy of a message we verified counts towards its sources
+            if (is_bit_set (flags, SF_SIGGOOD) && getApp().getUNL ().nodeInUNL (
+                    RippleAddress::createNodePublic (strCopy (set.nodepubkey ()))))
+                m_overlay.onRelayed (m_shortId, false, set.nodepubkey ());
+
             m_journal.trace << "Received duplicate proposal from peer " << m_shortId;
             return;
         }
 
+        // A cluster peer's result only holds for the previous ledger it names
+        if (is_bit_set (flags, SF_BAD) && set.has_previousledger ())
+        {
+            m_overlay.onSignatureCheckAvoided ();
+            charge (Resource::feeInvalidSignature);
+            return;
+        }
+
         RippleAddress signerPublic = RippleAddress::createNodePublic (strCopy (set.nodepubkey ()));
 
         if (signerPublic == getConfig ().VALIDATION_PUB)
@@ -2618,7 +2877,15 @@ private:
         }
     }
 
-    static void checkTransaction (Job&, int flags, SerializedTransaction::pointer stx, boost::weak_ptr<Peer> peer)
+    // Returns the routing flags if a cluster peer reported a signature result
+    static int clusterFlags (uint256 const& hash)
+    {
+        int const flags (getApp().getHashRouter ().getFlags (hash));
+
+        return is_bit_set (flags, SF_CLUSTER) ? flags : 0;
+    }
+
+    static void checkTransaction (Job&, int flags, bool isNew, SerializedTransaction::pointer stx, boost::weak_ptr<Peer> peer)
     {
     #ifndef TRUST_NETWORK
         try
@@ -2634,18 +2901,44 @@ private:
                 return;
             }
 
+            uint256 const txID (stx->getTransactionID ());
+
+            // A cluster peer may have reported the result while we waited
+            if (! is_bit_set (flags, SF_SIGGOOD))
+                flags |= clusterFlags (txID);
+
+            if (is_bit_set (flags, SF_BAD))
+            {
+                getApp().overlay ().onSignatureCheckAvoided ();
+                charge (peer, Resource::feeInvalidSignature);
+                return;
+            }
+
             bool needCheck = ! is_bit_set (flags, SF_SIGGOOD);
+
+            if (! needCheck && is_bit_set (flags, SF_CLUSTER))
+                getApp().overlay ().onSignatureCheckAvoided ();
+
             Transaction::pointer tx =
                 boost::make_shared<Transaction> (stx, needCheck);
 
             if (tx->getStatus () == INVALID)
             {
-                getApp().getHashRouter ().setFlag (stx->getTransactionID (), SF_BAD);
+                getApp().getHashRouter ().setFlag (txID, SF_BAD);
                 charge (peer, Resource::feeInvalidSignature);
+
+                if (needCheck)
+                    getApp().overlay ().onSignatureChecked (txID, false);
                 return;
             }
             else
-                getApp().getHashRouter ().setFlag (stx->getTransactionID (), SF_SIGGOOD);
+                getApp().getHashRouter ().setFlag (txID, SF_SIGGOOD);
+
+            if (needCheck)
+                getApp().overlay ().onSignatureChecked (txID, true);
+
+            if (isNew)
+                useful (peer);
 
             getApp().getOPs ().processTransaction (tx, is_bit_set (flags, SF_TRUSTED), false, false);
 
@@ -2661,7 +2954,20 @@ private:
     }
 
     // Called from our JobQueue
-    static void checkPropose (Job& job, Overlay* pPeers, boost::shared_ptr<protocol::TMProposeSet> packet,
+    // Called once a trusted validator's message is verified, so that the
+    // relay policy only learns about messages that really came from it
+    static void onVerified (OverlayImpl* pPeers, uint256 const& suppression,
+        boost::weak_ptr<Peer> const& peer, std::string const& validator)
+    {
+        getApp().getHashRouter ().setFlag (suppression, SF_SIGGOOD);
+
+        Peer::ptr const p (peer.lock ());
+
+        if (p)
+            pPeers->onRelayed (p->getShortId (), true, validator);
+    }
+
+    static void checkPropose (Job& job, OverlayImpl* pPeers, boost::shared_ptr<protocol::TMProposeSet> packet,
                               LedgerProposal::pointer proposal, uint256 consensusLCL, RippleAddress nodePublic,
                               boost::weak_ptr<Peer> peer, bool fromCluster)
     {
@@ -2683,7 +2989,23 @@ private:
             WriteLog(lsTRACE, Peer) << "proposal with previous ledger";
             memcpy (prevLedger.begin (), set.previousledger ().data (), 256 / 8);
 
-            if (!fromCluster && !proposal->checkSign (set.signature ()))
+            uint256 const suppression (proposal->getSuppressionID ());
+            int const reported (fromCluster ? 0 : clusterFlags (suppression));
+
+            if (is_bit_set (reported, SF_SIGGOOD | SF_BAD))
+            {
+                pPeers->onSignatureCheckAvoided ();
+                sigGood = is_bit_set (reported, SF_SIGGOOD);
+            }
+            else if (!fromCluster)
+            {
+                sigGood = proposal->checkSign (set.signature ());
+                pPeers->onSignatureChecked (suppression, sigGood);
+            }
+            else
+                sigGood = true;
+
+            if (!sigGood)
             {
                 Peer::ptr p = peer.lock ();
                 WriteLog(lsWARNING, Peer) << "proposal with previous ledger fails sig check: " <<
@@ -2691,8 +3013,6 @@ private:
                 charge (peer, Resource::feeInvalidSignature);
                 return;
             }
-            else
-                sigGood = true;
         }
         else
         {
@@ -2709,8 +3029,14 @@ private:
             }
         }
 
+        if (sigGood)
+            useful (peer);
+
         if (isTrusted)
         {
+            if (sigGood)
+                onVerified (pPeers, proposal->getSuppressionID (), peer, set.nodepubkey ());
+
             getApp().getOPs ().processTrustedProposal (proposal, packet, nodePublic, prevLedger, sigGood);
         }
         else if (sigGood && (prevLedger == consensusLCL))
@@ -2722,9 +3048,9 @@ private:
             if (getApp().getHashRouter ().swapSet (
                 proposal->getSuppressionID (), peers, SF_RELAYED))
             {
-                pPeers->foreach (send_if_not (
+                pPeers->relay (
                     boost::make_shared<Message> (set, protocol::mtPROPOSE_LEDGER),
-                    peer_in_set(peers)));
+                    peers, set.nodepubkey ());
 	    }
         }
         else
@@ -2733,7 +3059,8 @@ private:
         }
     }
 
-    static void checkValidation (Job&, Overlay* pPeers, SerializedValidation::pointer val, bool isTrusted, bool isCluster,
+    static void checkValidation (Job&, OverlayImpl* pPeers, SerializedValidation::pointer val, uint256 suppression,
+                                 bool isTrusted, bool isCluster,
                                  boost::shared_ptr<protocol::TMValidation> packet, boost::weak_ptr<Peer> peer)
     {
     #ifndef TRUST_NETWORK
@@ -2742,13 +3069,38 @@ private:
     #endif
         {
             uint256 signingHash = val->getSigningHash();
-            if (!isCluster && !val->isValid (signingHash))
+            bool sigGood = true;
+
+            if (!isCluster)
+            {
+                // A cluster peer may have reported the result while we waited
+                int const reported (clusterFlags (suppression));
+
+                if (is_bit_set (reported, SF_SIGGOOD | SF_BAD))
+                {
+                    pPeers->onSignatureCheckAvoided ();
+                    sigGood = is_bit_set (reported, SF_SIGGOOD);
+                }
+                else
+                {
+                    sigGood = val->isValid (signingHash);
+                    pPeers->onSignatureChecked (suppression, sigGood);
+                }
+            }
+
+            if (!sigGood)
             {
                 WriteLog(lsWARNING, Peer) << "Validation is invalid";
                 charge (peer, Resource::feeInvalidRequest);
                 return;
             }
 
+            useful (peer);
+
+            if (isTrusted)
+                onVerified (pPeers, suppression, peer,
+                    strCopy (val->getFieldVL (sfSigningPubKey)));
+
             std::string source;
             Peer::ptr lp = peer.lock ();
 
@@ -2774,9 +3126,9 @@ private:
             if (getApp().getOPs ().recvValidation (val, source) &&
                     getApp().getHashRouter ().swapSet (signingHash, peers, SF_RELAYED))
             {
-                pPeers->foreach (send_if_not (
+                pPeers->relay (
                     boost::make_shared<Message> (*packet, protocol::mtVALIDATION),
-                    peer_in_set(peers))); 
+                    peers, strCopy (val->getFieldVL (sfSigningPubKey)));
             }
         }
 
@@ -2793,6 +3145,7 @@ private:
 //------------------------------------------------------------------------------
 
 const boost::posix_time::seconds PeerImp::nodeVerifySeconds (15);
+const boost::posix_time::seconds PeerImp::pingSeconds (30);
 
 //------------------------------------------------------------------------------
 
@@ -0,0 +1,560 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../api/RelayPolicy.h"
+
+#include "../../beast/beast/chrono/manual_clock.h"
+#include "../../beast/beast/unit_test/suite.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ripple {
+
+RelayPolicy::Setup::Setup ()
+    : fanout (12)
+    , maxSources (5)
+    , minMessages (20)
+    , squelchDuration (300)
+{
+}
+
+RelayPolicy::PeerState::PeerState ()
+    : latency (0)
+    , received (0)
+    , firsts (0)
+{
+}
+
+RelayPolicy::Sources::Sources ()
+{
+    reset ();
+}
+
+void
+RelayPolicy::Sources::reset ()
+{
+    messages = 0;
+    firsts.clear ();
+    chosen = false;
+    kept.clear ();
+    squelched.clear ();
+}
+
+RelayPolicy::RelayPolicy (Setup const& setup, clock_type& clock,
+    std::uint32_t seed)
+    : m_setup (setup)
+    , m_clock (clock)
+    , m_random (seed)
+{
+}
+
+void
+RelayPolicy::insert (id_t peer)
+{
+    m_peers [peer];
+}
+
+RelayPolicy::Squelches
+RelayPolicy::erase (id_t peer)
+{
+    Squelches result;
+
+    m_peers.erase (peer);
+
+    for (auto& entry : m_validators)
+    {
+        Sources& sources (entry.second);
+
+        sources.firsts.erase (peer);
+
+        if (! sources.chosen)
+            continue;
+
+        if (std::find (sources.kept.begin (), sources.kept.end (), peer) !=
+            sources.kept.end ())
+        {
+            // We lost one of the sources, let the others back in
+            for (auto const id : sources.squelched)
+            {
+                Squelch const squelch = {
+                    id, entry.first, false, std::chrono::seconds (0) };
+                result.push_back (squelch);
+            }
+
+            sources.reset ();
+        }
+        else
+        {
+            sources.squelched.erase (std::remove (sources.squelched.begin (),
+                sources.squelched.end (), peer), sources.squelched.end ());
+        }
+    }
+
+    return result;
+}
+
+void
+RelayPolicy::onLatency (id_t peer, std::chrono::milliseconds rtt)
+{
+    auto const iter (m_peers.find (peer));
+
+    if (iter == m_peers.end ())
+        return;
+
+    double const sample (std::max <double> (1, rtt.count ()));
+    PeerState& state (iter->second);
+
+    if (state.latency == 0)
+        state.latency = sample;
+    else
+        state.latency = (3 * state.latency + sample) / 4;
+}
+
+RelayPolicy::Squelches
+RelayPolicy::onMessage (id_t peer, bool first, std::string const& validator)
+{
+    Squelches result;
+
+    auto const iter (m_peers.find (peer));
+
+    if (iter == m_peers.end ())
+        return result;
+
+    {
+        PeerState& state (iter->second);
+
+        ++state.received;
+        if (first)
+            ++state.firsts;
+
+        // Halve the counts now and then so they follow recent behavior
+        if (state.received > 1000)
+        {
+            state.received /= 2;
+            state.firsts /= 2;
+        }
+    }
+
+    if (validator.empty () || m_setup.maxSources == 0)
+        return result;
+
+    clock_type::time_point const now (m_clock.now ());
+    auto found (m_validators.find (validator));
+
+    if (found == m_validators.end ())
+    {
+        if (m_validators.size () >= maxValidators ())
+            expire (now);
+
+        if (m_validators.size () >= maxValidators ())
+            return result;
+
+        found = m_validators.emplace (validator, Sources ()).first;
+    }
+
+    Sources& sources (found->second);
+    sources.lastSeen = now;
+
+    if (sources.chosen)
+    {
+        if (now < sources.expires)
+        {
+            // A peer that connected after the sources were chosen
+            if (std::find (sources.kept.begin (), sources.kept.end (), peer) ==
+                    sources.kept.end () &&
+                std::find (sources.squelched.begin (), sources.squelched.end (),
+                    peer) == sources.squelched.end ())
+            {
+                sources.squelched.push_back (peer);
+
+                Squelch const squelch = { peer, validator, true,
+                    std::chrono::duration_cast <std::chrono::seconds> (
+                        sources.expires - now) };
+                result.push_back (squelch);
+            }
+
+            return result;
+        }
+
+        // The squelches have run out, choose again
+        sources.reset ();
+    }
+
+    ++sources.messages;
+
+    std::size_t& count (sources.firsts [peer]);
+    if (first)
+        ++count;
+
+    if (sources.messages >= m_setup.minMessages &&
+        sources.firsts.size () > m_setup.maxSources)
+        choose (validator, sources, now, result);
+
+    return result;
+}
+
+void
+RelayPolicy::choose (std::string const& validator, Sources& sources,
+    clock_type::time_point now, Squelches& result)
+{
+    // Keep the peers that most often delivered the message first
+    std::vector <std::pair <std::size_t, id_t>> ranked;
+    ranked.reserve (sources.firsts.size ());
+    for (auto const& entry : sources.firsts)
+        ranked.emplace_back (entry.second, entry.first);
+
+    std::sort (ranked.begin (), ranked.end (),
+        [](std::pair <std::size_t, id_t> const& lhs,
+            std::pair <std::size_t, id_t> const& rhs)
+        {
+            return lhs.first > rhs.first;
+        });
+
+    sources.chosen = true;
+    sources.expires = now + m_setup.squelchDuration;
+
+    for (std::size_t i = 0; i < ranked.size (); ++i)
+    {
+        id_t const id (ranked [i].second);
+
+        if (i < m_setup.maxSources)
+        {
+            sources.kept.push_back (id);
+        }
+        else
+        {
+            sources.squelched.push_back (id);
+
+            Squelch const squelch = {
+                id, validator, true, m_setup.squelchDuration };
+            result.push_back (squelch);
+        }
+    }
+
+    expire (now);
+}
+
+// Forget validators that have gone quiet
+void
+RelayPolicy::expire (clock_type::time_point now)
+{
+    for (auto iter = m_validators.begin (); iter != m_validators.end ();)
+    {
+        if (now - iter->second.lastSeen > 2 * m_setup.squelchDuration)
+            iter = m_validators.erase (iter);
+        else
+            ++iter;
+    }
+}
+
+void
+RelayPolicy::onSquelch (id_t peer, std::string const& validator,
+    bool squelch, std::chrono::seconds duration)
+{
+    auto const iter (m_peers.find (peer));
+
+    if (iter == m_peers.end () || validator.empty ())
+        return;
+
+    PeerState& state (iter->second);
+
+    if (! squelch)
+    {
+        state.squelched.erase (validator);
+        return;
+    }
+
+    if (state.squelched.size () >= maxSquelches () &&
+            state.squelched.count (validator) == 0)
+        return;
+
+    state.squelched [validator] = m_clock.now () +
+        std::min (duration, maxSquelchDuration ());
+}
+
+bool
+RelayPolicy::isSquelched (PeerState& state, std::string const& validator,
+    clock_type::time_point now)
+{
+    if (validator.empty ())
+        return false;
+
+    auto const iter (state.squelched.find (validator));
+
+    if (iter == state.squelched.end ())
+        return false;
+
+    if (now < iter->second)
+        return true;
+
+    state.squelched.erase (iter);
+    return false;
+}
+
+double
+RelayPolicy::weight (PeerState const& state, double defaultLatency) const
+{
+    double const latency (
+        state.latency != 0 ? state.latency : defaultLatency);
+
+    // A peer that often sends us messages first is ahead of us,
+    // and probably has what we are about to relay already.
+    double const ahead (state.received != 0
+        ? double (state.firsts) / state.received : 0);
+
+    return 1 / (latency * (1 + 2 * ahead));
+}
+
+std::size_t
+RelayPolicy::select (std::vector <id_t>& candidates,
+    std::string const& validator)
+{
+    clock_type::time_point const now (m_clock.now ());
+
+    // Peers that squelched the validator go to the back
+    auto const last (std::stable_partition (
+        candidates.begin (), candidates.end (),
+        [&](id_t id)
+        {
+            auto const iter (m_peers.find (id));
+            return iter == m_peers.end () ||
+                ! isSquelched (iter->second, validator, now);
+        }));
+
+    std::size_t const eligible (last - candidates.begin ());
+
+    if (! validator.empty () || m_setup.fanout == 0 ||
+            eligible <= m_setup.fanout)
+        return eligible;
+
+    // Unmeasured peers are assumed to be average
+    double total (0);
+    std::size_t measured (0);
+    for (auto iter = candidates.begin (); iter != last; ++iter)
+    {
+        auto const state (m_peers.find (*iter));
+        if (state != m_peers.end () && state->second.latency != 0)
+        {
+            total += state->second.latency;
+            ++measured;
+        }
+    }
+    double const defaultLatency (measured != 0 ? total / measured : 1);
+
+    // Weighted sampling without replacement: each peer draws
+    // log(u) / weight and the largest draws win. Every peer keeps
+    // a chance, so no part of the overlay is starved.
+    std::uniform_real_distribution <double> uniform (0, 1);
+    std::vector <std::pair <double, id_t>> keyed;
+    keyed.reserve (eligible);
+    for (auto iter = candidates.begin (); iter != last; ++iter)
+    {
+        auto const state (m_peers.find (*iter));
+        double const w (state != m_peers.end ()
+            ? weight (state->second, defaultLatency) : 1 / defaultLatency);
+        double const u (std::max (uniform (m_random), 1e-300));
+        keyed.emplace_back (std::log (u) / w, *iter);
+    }
+
+    std::partial_sort (keyed.begin (), keyed.begin () + m_setup.fanout,
+        keyed.end (),
+        [](std::pair <double, id_t> const& lhs,
+            std::pair <double, id_t> const& rhs)
+        {
+            return lhs.first > rhs.first;
+        });
+
+    for (std::size_t i = 0; i < eligible; ++i)
+        candidates [i] = keyed [i].second;
+
+    return m_setup.fanout;
+}
+
+//------------------------------------------------------------------------------
+
+class RelayPolicy_test : public beast::unit_test::suite
+{
+public:
+    typedef beast::manual_clock <std::chrono::seconds> clock_type;
+
+    static std::vector <RelayPolicy::id_t> peers (int count)
+    {
+        std::vector <RelayPolicy::id_t> result;
+        for (int i = 1; i <= count; ++i)
+            result.push_back (i);
+        return result;
+    }
+
+    void testSelect ()
+    {
+        clock_type clock;
+        RelayPolicy::Setup setup;
+        setup.fanout = 4;
+        RelayPolicy policy (setup, clock, 1);
+
+        for (auto const id : peers (10))
+        {
+            policy.insert (id);
+            policy.onLatency (id, std::chrono::milliseconds (10 * id));
+        }
+
+        // Peer 2 is as close as peer 1 but always has our messages first
+        for (int i = 0; i < 10; ++i)
+            policy.onMessage (2, true, "");
+        policy.onLatency (2, std::chrono::milliseconds (10));
+
+        std::vector <int> chosen (11);
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::vector <RelayPolicy::id_t> candidates (peers (10));
+            expect (policy.select (candidates, "") == 4);
+            for (int j = 0; j < 4; ++j)
+                ++chosen [candidates [j]];
+        }
+
+        // Close peers are preferred, but nobody is starved
+        expect (chosen [1] > chosen [2]);
+        expect (chosen [1] > chosen [10]);
+        expect (*std::min_element (chosen.begin () + 1, chosen.end ()) > 0);
+
+        // Validator messages and short lists are not bounded
+        std::vector <RelayPolicy::id_t> candidates (peers (10));
+        expect (policy.select (candidates, "v") == 10);
+        candidates = peers (3);
+        expect (policy.select (candidates, "") == 3);
+    }
+
+    void testSquelched ()
+    {
+        clock_type clock;
+        RelayPolicy::Setup setup;
+        setup.fanout = 0;
+        RelayPolicy policy (setup, clock, 1);
+
+        for (auto const id : peers (3))
+            policy.insert (id);
+
+        policy.onSquelch (2, "v", true, std::chrono::seconds (10));
+
+        std::vector <RelayPolicy::id_t> candidates (peers (3));
+        expect (policy.select (candidates, "v") == 2);
+        expect (candidates [2] == 2);
+
+        candidates = peers (3);
+        expect (policy.select (candidates, "w") == 3);
+
+        clock.set (10);
+        candidates = peers (3);
+        expect (policy.select (candidates, "v") == 3);
+
+        policy.onSquelch (2, "v", true, std::chrono::seconds (10));
+        policy.onSquelch (2, "v", false, std::chrono::seconds (0));
+        expect (policy.select (candidates, "v") == 3);
+    }
+
+    void testSources ()
+    {
+        clock_type clock;
+        RelayPolicy::Setup setup;
+        setup.maxSources = 2;
+        setup.minMessages = 8;
+        setup.squelchDuration = std::chrono::seconds (60);
+        RelayPolicy policy (setup, clock, 1);
+
+        for (auto const id : peers (4))
+            policy.insert (id);
+
+        RelayPolicy::Squelches squelches;
+        for (int i = 0; i < 10; ++i)
+        {
+            // Peers 1 and 2 take turns being first
+            for (RelayPolicy::id_t id = 1; id <= 4; ++id)
+            {
+                bool const first ((id - 1) == (i % 2));
+                RelayPolicy::Squelches const result (
+                    policy.onMessage (id, first, "v"));
+                squelches.insert (squelches.end (),
+                    result.begin (), result.end ());
+            }
+        }
+
+        expect (squelches.size () == 2);
+        for (auto const& squelch : squelches)
+            expect ((squelch.peer == 3 || squelch.peer == 4) &&
+                squelch.squelch && squelch.validator == "v" &&
+                squelch.duration == std::chrono::seconds (60));
+
+        // Newcomers are squelched for the rest of the period
+        policy.insert (5);
+        clock.set (20);
+        squelches = policy.onMessage (5, false, "v");
+        expect (squelches.size () == 1 && squelches [0].peer == 5 &&
+            squelches [0].duration == std::chrono::seconds (40));
+        expect (policy.onMessage (5, false, "v").empty ());
+
+        // Losing a source lets the others back in
+        expect (policy.erase (3).empty ());
+        squelches = policy.erase (1);
+        expect (squelches.size () == 2);
+        for (auto const& squelch : squelches)
+            expect ((squelch.peer == 4 || squelch.peer == 5) &&
+                ! squelch.squelch);
+    }
+
+    void testMaxValidators ()
+    {
+        clock_type clock;
+        RelayPolicy::Setup setup;
+        setup.maxSources = 1;
+        setup.minMessages = 1;
+        setup.squelchDuration = std::chrono::seconds (60);
+        RelayPolicy policy (setup, clock, 1);
+
+        for (auto const id : peers (2))
+            policy.insert (id);
+
+        // Fill the table with validators that are still being watched
+        for (std::size_t i = 0; i < RelayPolicy::maxValidators (); ++i)
+            policy.onMessage (1, true, std::to_string (i));
+
+        // A newcomer is not tracked, so it is never squelched
+        expect (policy.onMessage (1, true, "v").empty ());
+        expect (policy.onMessage (2, false, "v").empty ());
+
+        // Once the others go quiet there is room for it
+        clock.set (121);
+        expect (policy.onMessage (1, true, "v").empty ());
+        RelayPolicy::Squelches const squelches (
+            policy.onMessage (2, false, "v"));
+        expect (squelches.size () == 1 && squelches [0].peer == 2);
+    }
+
+    void run ()
+    {
+        testSelect ();
+        testSquelched ();
+        testSources ();
+        testMaxValidators ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RelayPolicy,overlay,ripple);
+
+}
@@ -23,4 +23,5 @@
 #include "impl/OverlayImpl.cpp"
 #include "impl/PeerImp.h"
 #include "impl/PeerDoor.cpp"
+#include "impl/RelayPolicy.cpp"
 
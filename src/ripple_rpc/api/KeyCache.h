@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_KEYCACHE_H_INCLUDED
+#define RIPPLE_RPC_KEYCACHE_H_INCLUDED
+
+#include "../../ripple/json/ripple_json.h"
+
+#include <memory>
+#include <string>
+
+namespace ripple {
+
+class RippleAddress;
+
+namespace RPC {
+
+/** Remembers the keys derived from the secrets of recent sign requests.
+
+    Deriving the master generator and the account key pair from a seed
+    costs several elliptic curve multiplications, and clients that sign
+    many transactions usually do so with a handful of secrets. Entries are
+    found by a salted hash of the secret, so the secret itself is never
+    stored. The key material lives in a fixed number of slots in memory
+    that is locked against swapping where the platform allows it, and a
+    slot is wiped when it is evicted or the cache is destroyed.
+*/
+class KeyCache
+{
+public:
+    virtual ~KeyCache () = 0;
+
+    /** Returns the keys for the zeroth account of a secret.
+        The secret may be in any form accepted by setSeedGeneric.
+        @return `false` if the secret is not a valid seed.
+    */
+    virtual bool getKeys (std::string const& secret,
+        RippleAddress& generator, RippleAddress& accountPublic,
+            RippleAddress& accountPrivate) = 0;
+
+    /** Returns the size, hit counts, and whether the memory is locked. */
+    virtual Json::Value getJson () = 0;
+};
+
+std::unique_ptr <KeyCache> make_KeyCache (std::size_t size);
+
+}
+}
+
+#endif
@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_LATENCYTRACKER_H_INCLUDED
+#define RIPPLE_RPC_LATENCYTRACKER_H_INCLUDED
+
+#include "../../beast/beast/Insight.h"
+#include "../../ripple/json/ripple_json.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace ripple {
+namespace RPC {
+
+/** Measures where the time goes in RPC and websocket commands.
+
+    Each request is timed in four phases: waiting in the job queue, waiting
+    for the master lock, executing the command, and serializing the reply.
+    The distributions are kept per command as log-linear histograms and are
+    also reported to the insight collector. Requests that take longer than
+    a threshold from start to finish are kept in a fixed size ring so they
+    can be examined after the fact.
+*/
+class LatencyTracker
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    enum Phase
+    {
+        phaseQueue,
+        phaseLock,
+        phaseExecute,
+        phaseSerialize,
+
+        phaseCount
+    };
+
+    /** Returns the name of a phase, as used in reports. */
+    static char const* getPhaseName (Phase phase);
+
+    /** The timing of one request, filled in as it is processed. */
+    class Timing
+    {
+    public:
+        Timing (char const* transport, clock_type::time_point received)
+            : m_transport (transport)
+            , m_received (received)
+        {
+            m_phases.fill (clock_type::duration::zero ());
+        }
+
+        /** Charges the time from start until now to a phase. */
+        void add (Phase phase, clock_type::time_point start)
+        {
+            m_phases [phase] += clock_type::now () - start;
+        }
+
+        /** Sets the command being timed.
+            Requests are only recorded once they are known to name a command,
+            so arbitrary strings from clients never become histograms.
+        */
+        void setCommand (std::string const& command)
+        {
+            m_command = command;
+        }
+
+        std::string const& getCommand () const
+        {
+            return m_command;
+        }
+
+        char const* getTransport () const
+        {
+            return m_transport;
+        }
+
+        clock_type::time_point getReceived () const
+        {
+            return m_received;
+        }
+
+        clock_type::duration getPhase (Phase phase) const
+        {
+            return m_phases [phase];
+        }
+
+    private:
+        char const* m_transport;
+        clock_type::time_point m_received;
+        std::string m_command;
+        std::array <clock_type::duration, phaseCount> m_phases;
+    };
+
+    virtual ~LatencyTracker () = 0;
+
+    /** Records a finished request.
+        The total time is measured from when the request was received.
+        Requests for which no command was set are ignored.
+    */
+    virtual void record (Timing const& timing) = 0;
+
+    /** Returns the histograms and the slowest recent requests. */
+    virtual Json::Value getJson () = 0;
+};
+
+std::unique_ptr <LatencyTracker> make_LatencyTracker (
+    beast::insight::Collector::ptr const& collector,
+        std::chrono::milliseconds slowThreshold);
+
+}
+}
+
+#endif
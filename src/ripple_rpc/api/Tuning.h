@@ -27,6 +27,12 @@ const int DEFAULT_AUTO_FILL_FEE_MULTIPLIER = 10;
 const int MAX_PATHFINDS_IN_PROGRESS = 2;
 const int MAX_PATHFIND_JOB_COUNT = 50;
 
+// The number of secrets whose derived keys are kept for signing
+const int SIGNING_KEY_CACHE_SIZE = 64;
+
+// The most differences between two ledgers that ledger_export will send
+const int MAX_EXPORT_DIFFERENCES = 1000000;
+
 // TODO(tom): Shouldn't DEFAULT_AUTO_FILL_FEE_MULTIPLIER be floating point?
 
 } // RPC
@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+namespace ripple {
+
+// Sampling profiler for the job queue, I/O and prefetch threads
+// {
+//   action: "start" | "stop" | "dump"   // optional, defaults to status
+//   interval: <number>                   // optional, microseconds, for start
+// }
+Json::Value RPCHandler::doCPUProfile (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& masterLockHolder)
+{
+    masterLockHolder.unlock ();
+
+    std::string const action (params.isMember ("action")
+        ? params["action"].asString () : std::string ());
+
+    if (action == "start")
+    {
+        std::uint32_t interval (10000);
+
+        if (params.isMember ("interval"))
+            interval = params["interval"].asUInt ();
+
+        if (interval < 100)
+            return RPC::make_param_error ("'interval' must be at least 100 microseconds.");
+
+        if (! Profiler::start (std::chrono::microseconds (interval)))
+            return rpcError (Profiler::isRunning () ?
+                rpcINVALID_PARAMS : rpcNOT_SUPPORTED);
+
+        return Profiler::getJson (false);
+    }
+
+    if (action == "stop")
+    {
+        if (! Profiler::stop ())
+            return rpcError (rpcINVALID_PARAMS);
+
+        return Profiler::getJson (true);
+    }
+
+    if (action == "dump")
+        return Profiler::getJson (true);
+
+    if (! action.empty ())
+        return rpcError (rpcINVALID_PARAMS);
+
+    return Profiler::getJson (false);
+}
+
+} // ripple
@@ -70,6 +70,9 @@ Json::Value RPCHandler::doGetCounts (Json::Value params, Resource::Charge& loadT
     ret["fullbelow_size"] = int(getApp().getFullBelowCache().size());
     ret["treenode_size"] = SHAMap::getTreeNodeSize ();
 
+    ret["memory"] = getApp().getMemoryGovernor ().getJson ();
+    ret["signing_keys"] = getApp().getRPCKeyCache ().getJson ();
+
     std::string uptime;
     int s = UptimeTimer::getInstance ().getElapsedSeconds ();
     textTime (uptime, s, "year", 365 * 24 * 60 * 60);
@@ -74,8 +74,19 @@ Json::Value RPCHandler::doLedger (Json::Value params, Resource::Charge& loadType
         loadType = Resource::feeHighBurdenRPC;
     }
 
-
     Json::Value ret (Json::objectValue);
+
+    if (mStreaming && (bFull || bAccounts || bTransactions))
+    {
+        mStreamKey = jss::ledger;
+        mStreamer = [lpLedger, iOptions] (Json::Stream& stream)
+        {
+            lpLedger->writeJson (stream, jss::ledger, iOptions);
+        };
+
+        return ret;
+    }
+
     lpLedger->addJson (ret, iOptions);
 
     return ret;
@@ -83,17 +83,15 @@ Json::Value RPCHandler::doLedgerData (Json::Value params, Resource::Charge& load
     jvReply["ledger_index"] = beast::lexicalCastThrow <std::string> (lpLedger->getLedgerSeq ());
 
     Json::Value& nodes = (jvReply["state"] = Json::arrayValue);
-    SHAMap& map = *(lpLedger->peekAccountStateMap ());
+    SHAMapIterator it (lpLedger->peekAccountStateMap ());
 
-    for (;;)
+    for (bool more = it.seekAfter (resumePoint); more; more = it.next ())
     {
-       SHAMapItem::pointer item = map.peekNextItem (resumePoint);
-       if (!item)
-           break;
-       resumePoint = item->getTag();
+       SHAMapItem::ref item = it.getItem ();
 
        if (limit-- <= 0)
        {
+           resumePoint = item->getTag ();
            --resumePoint;
            jvReply["marker"] = to_string (resumePoint);
            break;
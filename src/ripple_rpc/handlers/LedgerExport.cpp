@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../api/Tuning.h"
+
+namespace ripple {
+
+// Send the state of a ledger, or its differences from a base ledger, as
+// a binary stream. See LedgerExport for the format.
+//   Inputs:
+//     ledger_hash, ledger_index:            the exported ledger
+//     base_ledger_hash, base_ledger_index:  optional, export only the
+//                                           differences from this ledger
+//     marker:                               optional, export the keys
+//                                           above this one
+Json::Value RPCHandler::doLedgerExport (Json::Value params, Resource::Charge& loadType, Application::ScopedLockType& masterLockHolder)
+{
+    masterLockHolder.unlock ();
+
+    // The stream is sent in place of a JSON reply, which
+    // only the HTTP transport can do.
+    if (! mStreaming)
+        return rpcError (rpcNOT_SUPPORTED);
+
+    Ledger::pointer lpLedger;
+
+    Json::Value jvResult = RPC::lookupLedger (params, lpLedger, *mNetOps);
+    if (!lpLedger)
+        return jvResult;
+
+    uint256 after;
+    if (params.isMember ("marker"))
+    {
+        Json::Value const& jMarker = params["marker"];
+        if (!jMarker.isString () || !after.SetHex (jMarker.asString ()))
+            return RPC::expected_field_error ("marker", "valid");
+    }
+
+    Ledger::pointer lpBase;
+    if (params.isMember ("base_ledger_hash") || params.isMember ("base_ledger_index"))
+    {
+        Json::Value baseParams (Json::objectValue);
+        if (params.isMember ("base_ledger_hash"))
+            baseParams["ledger_hash"] = params["base_ledger_hash"];
+        if (params.isMember ("base_ledger_index"))
+            baseParams["ledger_index"] = params["base_ledger_index"];
+
+        jvResult = RPC::lookupLedger (baseParams, lpBase, *mNetOps);
+        if (!lpBase)
+            return jvResult;
+    }
+
+    loadType = Resource::feeHighBurdenRPC;
+
+    // Snapshots, in case the open ledger was asked for
+    SHAMap::pointer map (lpLedger->peekAccountStateMap ()->snapShot (false));
+    std::uint32_t const seq (lpLedger->getLedgerSeq ());
+    uint256 const hash (lpLedger->getHash ());
+
+    if (!lpBase)
+    {
+        mExporter = [map, seq, hash, after] (Json::Stream::Sink& sink)
+        {
+            LedgerExport exporter (sink);
+            exporter.writeHeader (seq, hash, after);
+
+            try
+            {
+                exporter.writeMap (map, after);
+            }
+            catch (SHAMapMissingNode const& e)
+            {
+                // Without the end frame the client knows to resume
+                WriteLog (lsWARNING, RPCHandler) << "Export stopped: " << e;
+                return;
+            }
+
+            exporter.finish ();
+        };
+
+        return jvResult;
+    }
+
+    // The differences are found before anything is sent, so the
+    // reply can still be an error if they are too many.
+    auto delta (std::make_shared <SHAMap::Delta> ());
+
+    try
+    {
+        if (!map->compare (lpBase->peekAccountStateMap ()->snapShot (false),
+                *delta, RPC::MAX_EXPORT_DIFFERENCES))
+        {
+            return RPC::make_error (rpcINVALID_PARAMS,
+                "Too many differences from the base ledger.");
+        }
+    }
+    catch (SHAMapMissingNode const&)
+    {
+        return rpcError (rpcLGR_NOT_FOUND);
+    }
+
+    std::uint32_t const baseSeq (lpBase->getLedgerSeq ());
+    uint256 const baseHash (lpBase->getHash ());
+
+    mExporter = [delta, seq, hash, after, baseSeq, baseHash] (
+        Json::Stream::Sink& sink)
+    {
+        LedgerExport exporter (sink);
+        exporter.writeHeader (seq, hash, after, baseSeq, baseHash);
+        exporter.writeDelta (*delta, after);
+        exporter.finish ();
+    };
+
+    return jvResult;
+}
+
+} // ripple
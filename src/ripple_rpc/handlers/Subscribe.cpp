@@ -39,6 +39,14 @@ Json::Value RPCHandler::doSubscribe (Json::Value params, Resource::Charge& loadT
         return rpcError (rpcINVALID_PARAMS);
     }
 
+    // Ledger closes and transactions are sent as binary frames. Only
+    // a websocket client can take them, and the request is checked
+    // before any subscriber is registered so a refusal leaves nothing.
+    bool const binary = params.isMember (jss::binary) && params[jss::binary].asBool ();
+
+    if (binary && (params.isMember ("url") || !mInfoSub->canSendBinary ()))
+        return rpcError (rpcINVALID_PARAMS);
+
     if (params.isMember ("url"))
     {
         if (mRole != Config::ADMIN)
@@ -83,6 +91,9 @@ Json::Value RPCHandler::doSubscribe (Json::Value params, Resource::Charge& loadT
         ispSub  = mInfoSub;
     }
 
+    if (params.isMember (jss::binary))
+        ispSub->setBinary (binary);
+
     if (!params.isMember ("streams"))
     {
         nothing ();
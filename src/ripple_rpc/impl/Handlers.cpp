@@ -27,6 +27,7 @@
 #include "../handlers/BlackList.cpp"
 #include "../handlers/BookOffers.cpp"
 #include "../handlers/Connect.cpp"
+#include "../handlers/CPUProfile.cpp"
 #include "../handlers/ConsensusInfo.cpp"
 #include "../handlers/Feature.cpp"
 #include "../handlers/FetchInfo.cpp"
@@ -38,6 +39,7 @@
 #include "../handlers/LedgerCurrent.cpp"
 #include "../handlers/LedgerData.cpp"
 #include "../handlers/LedgerEntry.cpp"
+#include "../handlers/LedgerExport.cpp"
 #include "../handlers/LedgerHeader.cpp"
 #include "../handlers/LogLevel.cpp"
 #include "../handlers/LogRotate.cpp"
@@ -53,6 +55,7 @@
 #include "../handlers/ProofVerify.cpp"
 #include "../handlers/Random.cpp"
 #include "../handlers/RipplePathFind.cpp"
+#include "../handlers/RPCLatency.cpp"
 #include "../handlers/SMS.cpp"
 #include "../handlers/ServerInfo.cpp"
 #include "../handlers/ServerState.cpp"
@@ -0,0 +1,385 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../api/KeyCache.h"
+#include "../api/Tuning.h"
+
+#include "../../beast/beast/unit_test/suite.h"
+
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+
+#if BEAST_WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+namespace ripple {
+namespace RPC {
+
+KeyCache::~KeyCache ()
+{
+}
+
+//------------------------------------------------------------------------------
+
+class KeyCacheImp : public KeyCache
+{
+public:
+    enum
+    {
+        fingerprintBytes = 32,
+        publicKeyBytes = 33,
+        privateKeyBytes = 32
+    };
+
+    // One cached secret. These live in locked memory.
+    struct Slot
+    {
+        unsigned char fingerprint [fingerprintBytes];
+        unsigned char generator [publicKeyBytes];
+        unsigned char accountPublic [publicKeyBytes];
+        unsigned char accountPrivate [privateKeyBytes];
+
+        // The tick of the most recent use, zero if the slot is empty
+        std::uint64_t lastUse;
+    };
+
+    explicit KeyCacheImp (std::size_t size)
+        : m_size (std::max <std::size_t> (size, 1))
+        , m_slots (new Slot [m_size])
+        , m_locked (lockMemory (m_slots.get (), bytes ()))
+        , m_tick (0)
+        , m_hits (0)
+        , m_misses (0)
+    {
+        std::memset (m_slots.get (), 0, bytes ());
+        RandomNumbers::getInstance ().fillBytes (m_salt, sizeof (m_salt));
+    }
+
+    ~KeyCacheImp ()
+    {
+        OPENSSL_cleanse (m_slots.get (), bytes ());
+        OPENSSL_cleanse (m_salt, sizeof (m_salt));
+        if (m_locked)
+            unlockMemory (m_slots.get (), bytes ());
+    }
+
+    bool getKeys (std::string const& secret,
+        RippleAddress& generator, RippleAddress& accountPublic,
+            RippleAddress& accountPrivate)
+    {
+        unsigned char fingerprint [fingerprintBytes];
+        makeFingerprint (secret, fingerprint);
+
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            Slot* const slot (find (fingerprint));
+            if (slot != nullptr)
+            {
+                ++m_hits;
+                slot->lastUse = ++m_tick;
+                generator.setGenerator (Blob (slot->generator,
+                    slot->generator + publicKeyBytes));
+                accountPublic.setAccountPublic (Blob (slot->accountPublic,
+                    slot->accountPublic + publicKeyBytes));
+                uint256 key (uint256::fromVoid (slot->accountPrivate));
+                accountPrivate.setAccountPrivate (key);
+                OPENSSL_cleanse (key.begin (), key.size ());
+                return true;
+            }
+            ++m_misses;
+        }
+
+        // Derive without holding the lock, this is the expensive part
+        RippleAddress seed;
+        if (! seed.setSeedGeneric (secret))
+            return false;
+        generator = RippleAddress::createGeneratorPublic (seed);
+        accountPublic = RippleAddress::createAccountPublic (generator, 0);
+        accountPrivate = RippleAddress::createAccountPrivate (
+            generator, seed, 0);
+
+        insert (fingerprint, generator, accountPublic, accountPrivate);
+        return true;
+    }
+
+    Json::Value getJson ()
+    {
+        std::lock_guard <std::mutex> lock (m_mutex);
+
+        std::uint32_t entries (0);
+        for (std::size_t i = 0; i < m_size; ++i)
+            if (m_slots [i].lastUse != 0)
+                ++entries;
+
+        Json::Value ret (Json::objectValue);
+        ret ["size"] = std::uint32_t (m_size);
+        ret ["entries"] = entries;
+        ret ["hits"] = std::uint32_t (m_hits);
+        ret ["misses"] = std::uint32_t (m_misses);
+        ret ["locked"] = m_locked;
+        return ret;
+    }
+
+private:
+    std::size_t bytes () const
+    {
+        return m_size * sizeof (Slot);
+    }
+
+    static bool lockMemory (void* p, std::size_t n)
+    {
+    #if BEAST_WIN32
+        return VirtualLock (p, n) != 0;
+    #else
+        return mlock (p, n) == 0;
+    #endif
+    }
+
+    static void unlockMemory (void* p, std::size_t n)
+    {
+    #if BEAST_WIN32
+        VirtualUnlock (p, n);
+    #else
+        munlock (p, n);
+    #endif
+    }
+
+    // The salt keeps fingerprints from being useful outside this process
+    void makeFingerprint (std::string const& secret,
+        unsigned char (&fingerprint) [fingerprintBytes]) const
+    {
+        unsigned char digest [SHA512_DIGEST_LENGTH];
+        SHA512_CTX ctx;
+        SHA512_Init (&ctx);
+        SHA512_Update (&ctx, m_salt, sizeof (m_salt));
+        SHA512_Update (&ctx, secret.data (), secret.size ());
+        SHA512_Final (digest, &ctx);
+        std::memcpy (fingerprint, digest, fingerprintBytes);
+        OPENSSL_cleanse (digest, sizeof (digest));
+        OPENSSL_cleanse (&ctx, sizeof (ctx));
+    }
+
+    Slot* find (unsigned char const* fingerprint)
+    {
+        for (std::size_t i = 0; i < m_size; ++i)
+        {
+            Slot& slot (m_slots [i]);
+            if (slot.lastUse != 0 && std::memcmp (slot.fingerprint,
+                    fingerprint, fingerprintBytes) == 0)
+                return &slot;
+        }
+        return nullptr;
+    }
+
+    void insert (unsigned char const* fingerprint,
+        RippleAddress const& generator, RippleAddress const& accountPublic,
+            RippleAddress const& accountPrivate)
+    {
+        Blob const& gen (generator.getGenerator ());
+        Blob const& pub (accountPublic.getAccountPublic ());
+        if (gen.size () != publicKeyBytes || pub.size () != publicKeyBytes)
+            return;
+
+        std::lock_guard <std::mutex> lock (m_mutex);
+
+        // Another thread may have derived the same secret meanwhile
+        if (find (fingerprint) != nullptr)
+            return;
+
+        // Use an empty slot, or evict the least recently used one
+        Slot* slot (&m_slots [0]);
+        for (std::size_t i = 1; i < m_size && slot->lastUse != 0; ++i)
+            if (m_slots [i].lastUse < slot->lastUse)
+                slot = &m_slots [i];
+        OPENSSL_cleanse (slot, sizeof (Slot));
+
+        uint256 key (accountPrivate.getAccountPrivate ());
+        std::memcpy (slot->fingerprint, fingerprint, fingerprintBytes);
+        std::memcpy (slot->generator, &gen.front (), publicKeyBytes);
+        std::memcpy (slot->accountPublic, &pub.front (), publicKeyBytes);
+        std::memcpy (slot->accountPrivate, key.begin (), privateKeyBytes);
+        OPENSSL_cleanse (key.begin (), key.size ());
+        slot->lastUse = ++m_tick;
+    }
+
+    std::mutex m_mutex;
+    std::size_t const m_size;
+    std::unique_ptr <Slot []> m_slots;
+    bool const m_locked;
+    unsigned char m_salt [32];
+    std::uint64_t m_tick;
+    std::uint64_t m_hits;
+    std::uint64_t m_misses;
+};
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr <KeyCache> make_KeyCache (std::size_t size)
+{
+    return std::make_unique <KeyCacheImp> (size);
+}
+
+//------------------------------------------------------------------------------
+
+class KeyCache_test : public beast::unit_test::suite
+{
+public:
+    // Derives the keys the slow way
+    static void derive (std::string const& secret, RippleAddress& generator,
+        RippleAddress& accountPublic, RippleAddress& accountPrivate)
+    {
+        RippleAddress const seed (RippleAddress::createSeedGeneric (secret));
+        generator = RippleAddress::createGeneratorPublic (seed);
+        accountPublic = RippleAddress::createAccountPublic (generator, 0);
+        accountPrivate = RippleAddress::createAccountPrivate (
+            generator, seed, 0);
+    }
+
+    void check (KeyCache& cache, std::string const& secret)
+    {
+        RippleAddress generator, accountPublic, accountPrivate;
+        RippleAddress expectGenerator, expectPublic, expectPrivate;
+        expect (cache.getKeys (secret,
+            generator, accountPublic, accountPrivate), secret);
+        derive (secret, expectGenerator, expectPublic, expectPrivate);
+        expect (generator.getGenerator () ==
+            expectGenerator.getGenerator (), secret + " generator");
+        expect (accountPublic.humanAccountID () ==
+            expectPublic.humanAccountID (), secret + " account");
+        expect (accountPrivate.getAccountPrivate () ==
+            expectPrivate.getAccountPrivate (), secret + " private key");
+    }
+
+    void testKeys ()
+    {
+        testcase ("Keys");
+
+        std::unique_ptr <KeyCache> cache (make_KeyCache (4));
+
+        check (*cache, "masterpassphrase");
+        check (*cache, "masterpassphrase");
+        // The same seed in base58 is cached under its own fingerprint
+        check (*cache, "snoPBrXtMeMyMHUVTgbuqAfg1SUTb");
+
+        RippleAddress a, b, c;
+        expect (! cache->getKeys ("", a, b, c));
+        expect (! cache->getKeys ("rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh",
+            a, b, c), "An account is not a secret");
+
+        Json::Value const json (cache->getJson ());
+        expect (json ["hits"].asUInt () == 1);
+        expect (json ["entries"].asUInt () == 2);
+    }
+
+    void testEviction ()
+    {
+        testcase ("Eviction");
+
+        std::unique_ptr <KeyCache> cache (make_KeyCache (2));
+
+        check (*cache, "alice");
+        check (*cache, "bob");
+        check (*cache, "alice");
+        // Evicts bob, the least recently used
+        check (*cache, "carol");
+        check (*cache, "alice");
+        check (*cache, "bob");
+
+        Json::Value const json (cache->getJson ());
+        expect (json ["hits"].asUInt () == 2);
+        expect (json ["misses"].asUInt () == 4);
+        expect (json ["entries"].asUInt () == 2);
+    }
+
+    void run ()
+    {
+        testKeys ();
+        testEviction ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(KeyCache,ripple_rpc,ripple);
+
+//------------------------------------------------------------------------------
+
+/** Reports how many transactions per second can be signed with a secret. */
+class KeyCache_timing_test : public beast::unit_test::suite
+{
+public:
+    typedef std::chrono::steady_clock clock_type;
+
+    enum
+    {
+        signatures = 1000
+    };
+
+    template <class Keys>
+    void timeSigning (std::string const& name, Keys getKeys)
+    {
+        Serializer s;
+        s.add32 (0);
+        Blob sig;
+        clock_type::time_point const start (clock_type::now ());
+        for (int i = 0; i < signatures; ++i)
+        {
+            RippleAddress generator, accountPublic, accountPrivate;
+            getKeys ("masterpassphrase", generator,
+                accountPublic, accountPrivate);
+            s.add32 (i);
+            accountPrivate.accountPrivateSign (s.getSHA512Half (), sig);
+        }
+        double const seconds (std::chrono::duration <double> (
+            clock_type::now () - start).count ());
+        log << name << ": " << (signatures / seconds) << " signatures/sec";
+        pass ();
+    }
+
+    void run ()
+    {
+        timeSigning ("derived",
+            [](std::string const& secret, RippleAddress& generator,
+                RippleAddress& accountPublic, RippleAddress& accountPrivate)
+            {
+                KeyCache_test::derive (secret,
+                    generator, accountPublic, accountPrivate);
+            });
+
+        std::unique_ptr <KeyCache> cache (make_KeyCache (
+            SIGNING_KEY_CACHE_SIZE));
+        timeSigning ("cached",
+            [&cache](std::string const& secret, RippleAddress& generator,
+                RippleAddress& accountPublic, RippleAddress& accountPrivate)
+            {
+                cache->getKeys (secret,
+                    generator, accountPublic, accountPrivate);
+            });
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(KeyCache_timing,ripple_rpc,ripple);
+
+}
+}
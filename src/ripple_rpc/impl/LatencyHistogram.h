@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_LATENCYHISTOGRAM_H_INCLUDED
+#define RIPPLE_RPC_LATENCYHISTOGRAM_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace ripple {
+namespace RPC {
+
+/** A histogram of durations in microseconds with bounded relative error.
+
+    Buckets are log-linear in the manner of HdrHistogram: each power of two
+    is split into 16 equal sub-buckets, so any reported value is within
+    6.25% of the true value from one microsecond up to several hours.
+    Recording is a handful of relaxed atomic increments and takes no lock.
+*/
+class LatencyHistogram
+{
+public:
+    typedef std::uint64_t value_type;
+
+    LatencyHistogram ()
+        : m_count (0)
+        , m_sum (0)
+        , m_max (0)
+    {
+        for (auto& bucket : m_buckets)
+            bucket.store (0, std::memory_order_relaxed);
+    }
+
+    /** Adds a value. */
+    void record (value_type value)
+    {
+        m_buckets [index (value)].fetch_add (1, std::memory_order_relaxed);
+        m_count.fetch_add (1, std::memory_order_relaxed);
+        m_sum.fetch_add (value, std::memory_order_relaxed);
+
+        value_type max (m_max.load (std::memory_order_relaxed));
+        while (value > max && ! m_max.compare_exchange_weak (
+            max, value, std::memory_order_relaxed))
+            ;
+    }
+
+    value_type count () const
+    {
+        return m_count.load (std::memory_order_relaxed);
+    }
+
+    value_type max () const
+    {
+        return m_max.load (std::memory_order_relaxed);
+    }
+
+    double mean () const
+    {
+        value_type const n (count ());
+        if (n == 0)
+            return 0;
+        return double (m_sum.load (std::memory_order_relaxed)) / n;
+    }
+
+    /** Returns the value at or below which the fraction of samples lie.
+        The result is the upper bound of the bucket holding that sample,
+        so it never understates the true value by more than a bucket.
+    */
+    value_type percentile (double fraction) const
+    {
+        value_type const n (count ());
+        if (n == 0)
+            return 0;
+
+        value_type const rank (std::max <value_type> (1,
+            value_type (fraction * n + 0.5)));
+        value_type seen (0);
+        for (std::size_t i = 0; i < bucketCount; ++i)
+        {
+            seen += m_buckets [i].load (std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min (upper (i), max ());
+        }
+        return max ();
+    }
+
+    /** Returns the bucket a value is counted in. */
+    static std::size_t index (value_type value)
+    {
+        if (value < subBuckets)
+            return std::size_t (value);
+
+        int exponent (0);
+        for (value_type v (value); v >= 2 * subBuckets; v >>= 1)
+            ++exponent;
+
+        if (exponent > maxExponent)
+            return bucketCount - 1;
+
+        return std::size_t ((exponent + 1) * subBuckets) +
+            std::size_t ((value >> exponent) - subBuckets);
+    }
+
+    /** Returns the largest value counted in a bucket. */
+    static value_type upper (std::size_t index)
+    {
+        if (index < subBuckets)
+            return value_type (index);
+
+        int const exponent (int (index / subBuckets) - 1);
+        value_type const mantissa (index % subBuckets + subBuckets);
+        return ((mantissa + 1) << exponent) - 1;
+    }
+
+private:
+    enum
+    {
+        subBuckets = 16,
+
+        // Values of 2^(maxExponent + 5) and above share the last bucket
+        maxExponent = 32,
+
+        bucketCount = (maxExponent + 2) * subBuckets
+    };
+
+    std::atomic <value_type> m_buckets [bucketCount];
+    std::atomic <value_type> m_count;
+    std::atomic <value_type> m_sum;
+    std::atomic <value_type> m_max;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,316 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include "../api/LatencyTracker.h"
+
+#include "LatencyHistogram.h"
+
+#include "../../beast/beast/unit_test/suite.h"
+
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+namespace RPC {
+
+class LatencyTrackerImp : public LatencyTracker
+{
+public:
+    enum
+    {
+        // The index of the total time, after the phases
+        total = phaseCount,
+
+        // Number of slow requests remembered
+        slowRequestsKept = 100
+    };
+
+    typedef std::array <clock_type::duration, phaseCount + 1> Times;
+
+    struct Command
+    {
+        Command (beast::insight::Collector::ptr const& collector,
+            std::string const& name)
+        {
+            for (int i = 0; i < phaseCount; ++i)
+                events [i] = collector->make_event (
+                    name + "_" + getPhaseName (Phase (i)));
+            events [total] = collector->make_event (name);
+        }
+
+        LatencyHistogram histograms [phaseCount + 1];
+        beast::insight::Event events [phaseCount + 1];
+    };
+
+    struct SlowRequest
+    {
+        std::string command;
+        char const* transport;
+        boost::posix_time::ptime when;
+        Times times;
+    };
+
+    typedef ripple::unordered_map <std::string,
+        std::unique_ptr <Command>> Commands;
+
+    beast::insight::Collector::ptr m_collector;
+    clock_type::duration const m_slowThreshold;
+
+    std::mutex m_mutex;
+    Commands m_commands;
+
+    std::mutex m_slowMutex;
+    std::vector <SlowRequest> m_slow;
+    std::size_t m_slowNext;
+
+    LatencyTrackerImp (beast::insight::Collector::ptr const& collector,
+        std::chrono::milliseconds slowThreshold)
+        : m_collector (collector)
+        , m_slowThreshold (slowThreshold)
+        , m_slowNext (0)
+    {
+        m_slow.reserve (slowRequestsKept);
+    }
+
+    Command& getCommand (std::string const& name)
+    {
+        std::lock_guard <std::mutex> lock (m_mutex);
+        std::unique_ptr <Command>& command (m_commands [name]);
+        if (! command)
+            command.reset (new Command (m_collector, name));
+        return *command;
+    }
+
+    void record (Timing const& timing)
+    {
+        if (timing.getCommand ().empty ())
+            return;
+
+        Times times;
+        for (int i = 0; i < phaseCount; ++i)
+            times [i] = timing.getPhase (Phase (i));
+        times [total] = clock_type::now () - timing.getReceived ();
+
+        Command& command (getCommand (timing.getCommand ()));
+        for (int i = 0; i <= total; ++i)
+        {
+            command.histograms [i].record (std::chrono::duration_cast <
+                std::chrono::microseconds> (times [i]).count ());
+            command.events [i].notify (times [i]);
+        }
+
+        if (times [total] >= m_slowThreshold)
+        {
+            SlowRequest slow;
+            slow.command = timing.getCommand ();
+            slow.transport = timing.getTransport ();
+            slow.when = boost::posix_time::second_clock::universal_time ();
+            slow.times = times;
+
+            std::lock_guard <std::mutex> lock (m_slowMutex);
+            if (m_slow.size () < slowRequestsKept)
+                m_slow.push_back (std::move (slow));
+            else
+                m_slow [m_slowNext] = std::move (slow);
+            m_slowNext = (m_slowNext + 1) % slowRequestsKept;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+
+    static double toMilliseconds (LatencyHistogram::value_type micros)
+    {
+        return micros / 1000.0;
+    }
+
+    static double toMilliseconds (clock_type::duration d)
+    {
+        return toMilliseconds (std::chrono::duration_cast <
+            std::chrono::microseconds> (d).count ());
+    }
+
+    static Json::Value getJson (LatencyHistogram const& h)
+    {
+        Json::Value ret (Json::objectValue);
+        ret ["mean"] = toMilliseconds (LatencyHistogram::value_type (h.mean ()));
+        ret ["p50"] = toMilliseconds (h.percentile (0.50));
+        ret ["p90"] = toMilliseconds (h.percentile (0.90));
+        ret ["p99"] = toMilliseconds (h.percentile (0.99));
+        ret ["max"] = toMilliseconds (h.max ());
+        return ret;
+    }
+
+    static char const* getName (int i)
+    {
+        return (i == total) ? "total" : getPhaseName (Phase (i));
+    }
+
+    Json::Value getJson ()
+    {
+        Json::Value ret (Json::objectValue);
+
+        ret ["slow_threshold"] = toMilliseconds (m_slowThreshold);
+
+        {
+            Json::Value& commands = (ret ["commands"] = Json::objectValue);
+
+            std::lock_guard <std::mutex> lock (m_mutex);
+            for (auto const& entry : m_commands)
+            {
+                Json::Value& command = (commands [entry.first] = Json::objectValue);
+                command ["count"] = static_cast <Json::UInt> (
+                    entry.second->histograms [total].count ());
+                for (int i = 0; i <= total; ++i)
+                    command [getName (i)] = getJson (entry.second->histograms [i]);
+            }
+        }
+
+        {
+            Json::Value& slow = (ret ["slow"] = Json::arrayValue);
+
+            std::lock_guard <std::mutex> lock (m_slowMutex);
+
+            // Newest first
+            for (std::size_t n = 0; n < m_slow.size (); ++n)
+            {
+                SlowRequest const& request (m_slow [
+                    (m_slowNext + m_slow.size () - 1 - n) % m_slow.size ()]);
+                Json::Value& item = slow.append (Json::objectValue);
+                item ["command"] = request.command;
+                item ["transport"] = request.transport;
+                item ["time"] = boost::posix_time::to_simple_string (request.when);
+                for (int i = 0; i <= total; ++i)
+                    item [getName (i)] = toMilliseconds (request.times [i]);
+            }
+        }
+
+        return ret;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+char const* LatencyTracker::getPhaseName (Phase phase)
+{
+    switch (phase)
+    {
+    case phaseQueue:        return "queue";
+    case phaseLock:         return "lock";
+    case phaseExecute:      return "execute";
+    case phaseSerialize:    return "serialize";
+    default:
+        bassertfalse;
+        break;
+    }
+    return "";
+}
+
+LatencyTracker::~LatencyTracker ()
+{
+}
+
+std::unique_ptr <LatencyTracker> make_LatencyTracker (
+    beast::insight::Collector::ptr const& collector,
+        std::chrono::milliseconds slowThreshold)
+{
+    return std::make_unique <LatencyTrackerImp> (collector, slowThreshold);
+}
+
+//------------------------------------------------------------------------------
+
+class LatencyTracker_test : public beast::unit_test::suite
+{
+public:
+    typedef LatencyTracker::clock_type clock_type;
+    typedef LatencyTracker::Timing Timing;
+
+    void testHistogram ()
+    {
+        testcase ("Histogram");
+
+        bool ordered (true);
+        for (LatencyHistogram::value_type v (0); v < 100000; ++v)
+        {
+            std::size_t const i (LatencyHistogram::index (v));
+            if (v > LatencyHistogram::upper (i) ||
+                (i > 0 && v <= LatencyHistogram::upper (i - 1)))
+                ordered = false;
+        }
+        expect (ordered, "Value outside its bucket");
+
+        LatencyHistogram h;
+        for (LatencyHistogram::value_type v (1); v <= 10000; ++v)
+            h.record (v);
+
+        expect (h.count () == 10000);
+        expect (h.max () == 10000);
+        expect (h.mean () == 5000.5);
+
+        // Within a bucket, 1/16th, of the exact answer
+        LatencyHistogram::value_type const p50 (h.percentile (0.5));
+        LatencyHistogram::value_type const p99 (h.percentile (0.99));
+        expect (p50 >= 5000 && p50 <= 5000 + 5000 / 16, "p50");
+        expect (p99 >= 9900 && p99 <= 10000, "p99");
+        expect (h.percentile (1.0) == 10000);
+    }
+
+    void testSlow ()
+    {
+        testcase ("Slow requests");
+
+        std::unique_ptr <LatencyTracker> tracker (make_LatencyTracker (
+            beast::insight::NullCollector::New (), std::chrono::seconds (1)));
+
+        clock_type::time_point const now (clock_type::now ());
+
+        // Requests without a command are never recorded
+        tracker->record (Timing ("rpc", now - std::chrono::seconds (5)));
+
+        Timing fast ("rpc", now);
+        fast.setCommand ("ping");
+        tracker->record (fast);
+
+        for (int i = 0; i < LatencyTrackerImp::slowRequestsKept + 10; ++i)
+        {
+            Timing slow ("ws", now - std::chrono::seconds (2));
+            slow.setCommand (i % 2 ? "ledger" : "account_tx");
+            slow.add (LatencyTracker::phaseExecute, now - std::chrono::seconds (1));
+            tracker->record (slow);
+        }
+
+        Json::Value const json (tracker->getJson ());
+        expect (json ["commands"].size () == 3);
+        expect (json ["commands"]["ping"]["count"].asUInt () == 1);
+        expect (json ["commands"]["ledger"]["execute"]["p50"].asDouble () >= 1000);
+        expect (json ["slow"].size () == LatencyTrackerImp::slowRequestsKept);
+        expect (json ["slow"][0u]["command"].asString () == "ledger");
+        expect (json ["slow"][0u]["total"].asDouble () >= 2000);
+    }
+
+    void run ()
+    {
+        testHistogram ();
+        testSlow ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LatencyTracker,ripple_rpc,ripple);
+
+}
+}
@@ -191,9 +191,13 @@ Json::Value transactionSign (
     if (! params.isMember ("tx_json"))
         return RPC::missing_field_error ("tx_json");
 
-    RippleAddress naSeed;
+    // Keys derived from recently used secrets are cached
+    RippleAddress naMasterGenerator;
+    RippleAddress masterAccountPublic;
+    RippleAddress naAccountPrivate;
 
-    if (! naSeed.setSeedGeneric (params["secret"].asString ()))
+    if (! getApp().getRPCKeyCache ().getKeys (params["secret"].asString (),
+            naMasterGenerator, masterAccountPublic, naAccountPrivate))
         return RPC::make_error (rpcBAD_SEED,
             RPC::invalid_field_message ("secret"));
 
@@ -276,29 +280,13 @@ Json::Value transactionSign (
     if (!tx_json.isMember ("Flags"))
         tx_json["Flags"] = tfFullyCanonicalSig;
 
-    if (verify)
-    {
-        SLE::pointer sleAccountRoot = netOps.getSLEi (lSnapshot,
-            Ledger::getAccountRootIndex (raSrcAddressID.getAccountID ()));
-
-        if (!sleAccountRoot)
-            // XXX Ignore transactions for accounts not created.
-            return rpcError (rpcSRC_ACT_NOT_FOUND);
-    }
-
-    RippleAddress   naSecret = RippleAddress::createSeedGeneric (
-        params["secret"].asString ());
-    RippleAddress   naMasterGenerator = RippleAddress::createGeneratorPublic (
-        naSecret);
-    RippleAddress masterAccountPublic = RippleAddress::createAccountPublic (
-        naMasterGenerator, 0);
-
+    // asSrc holds the account root, read from the same snapshot above
     if (verify)
     {
         auto account = masterAccountPublic.getAccountID();
         auto const& sle = asSrc->peekSLE();
 
-        WriteLog (lsWARNING, RPCHandler) <<
+        WriteLog (lsTRACE, RPCHandler) <<
                 "verify: " << masterAccountPublic.humanAccountID () <<
                 " : " << raSrcAddressID.humanAccountID ();
         if (raSrcAddressID.getAccountID () == account)
@@ -348,9 +336,6 @@ Json::Value transactionSign (
     }
 
     // FIXME: For performance, transactions should not be signed in this code path.
-    RippleAddress naAccountPrivate = RippleAddress::createAccountPrivate (
-        naMasterGenerator, naSecret, 0);
-
     stpTrans->sign (naAccountPrivate);
 
     Transaction::pointer tpTrans;
@@ -25,6 +25,8 @@
 #include "../ripple_app/ripple_app.h"
 
 #include "impl/ErrorCodes.cpp"
+#include "impl/KeyCache.cpp"
+#include "impl/LatencyTracker.cpp"
 #include "impl/Manager.cpp"
 
 
@@ -23,6 +23,8 @@
 //#include "../beast/modules/beast_core/beast_core.h"
 
 #include "api/ErrorCodes.h"
+#include "api/KeyCache.h"
+#include "api/LatencyTracker.h"
 #include "api/Manager.h"
 #include "api/Request.h"
 
@@ -199,7 +199,7 @@ public:
         m_detached = true;
     }
     
-    void send(const std::string& payload, frame::opcode::value op = frame::opcode::TEXT);
+    void send(const std::string& payload, frame::opcode::value op = frame::opcode::TEXT, bool compressed = false);
     void send(message::data_ptr msg);
     
     /// Close connection
@@ -321,7 +321,8 @@ public:
      * State: Valid from any state.
      * Concurrency: callable from any thread
      * 
-     * @return The current number of bytes in the outgoing send buffer.
+     * @return The current number of bytes in the outgoing send buffer,
+     * including messages passed to send() not yet queued for writing.
      */
     uint64_t buffered_amount() const {
         boost::lock_guard<boost::recursive_mutex> lock(m_lock);
@@ -1174,6 +1175,18 @@ public:
         write();
     }
     
+    /// Push a message from send() to the write queue
+    /** 
+     * Visibility: protected (called only by asio dispatcher)
+     * State: Valid from OPEN and CLOSING, ignored otherwise
+     * Concurrency: Must be called within m_stranded method
+     */
+    void write_queued_message(message::data_ptr msg) {
+        boost::lock_guard<boost::recursive_mutex> lock(m_lock);
+        m_write_buffer -= msg->get_payload().size();
+        write_message(msg);
+    }
+    
     /// Begin async write of next message in list
     /** 
      * Visibility: private
@@ -1551,10 +1564,11 @@ struct connection_traits< connection<endpoint,role,socket> > {
  *
  * @param payload Payload to write_state
  * @param op opcode to send the message as
+ * @param compressed payload is already permessage-deflate compressed
  */
 template <typename endpoint,template <class> class role,template <class> class socket>
 void 
-connection<endpoint,role,socket>::send(const std::string& payload,frame::opcode::value op)
+connection<endpoint,role,socket>::send(const std::string& payload,frame::opcode::value op,bool compressed)
 {
     {
         boost::lock_guard<boost::recursive_mutex> lock(m_lock);
@@ -1571,6 +1585,7 @@ connection<endpoint,role,socket>::send(const std::string& payload,frame::opcode:
     }
     
     msg->reset(op);
+    msg->set_compressed(compressed);
     msg->set_payload(payload);
     send(msg);
 }
@@ -1592,10 +1607,14 @@ void connection<endpoint,role,socket>::send(message::data_ptr msg) {
     
     m_processor->prepare_frame(msg);
     
+    // Counted now so buffered_amount() includes messages still waiting on
+    // the strand, write_queued_message moves them to the write queue.
+    m_write_buffer += msg->get_payload().size();
+    
     // Using strand post here rather than ioservice.post(strand.wrap)
 	// to ensure that messages are sent in order
 	m_strand.post(boost::bind(
-		&type::write_message,
+		&type::write_queued_message,
 		type::shared_from_this(),
 		msg
 	));
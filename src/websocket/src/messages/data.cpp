@@ -37,7 +37,7 @@
 using websocketpp::message::data;
 using websocketpp::processor::hybi_util::circshift_prepared_key;
 
-data::data(data::pool_ptr p, size_t s) : m_prepared(false),m_index(s),m_ref_count(0),m_pool(p),m_live(false) {
+data::data(data::pool_ptr p, size_t s) : m_prepared(false),m_compressed(false),m_index(s),m_ref_count(0),m_pool(p),m_live(false) {
     m_payload.reserve(PAYLOAD_SIZE_INIT);
 }
     
@@ -91,7 +91,7 @@ void data::process_payload(char *input, size_t size) {
         //std::cout << " to " << zsutil::to_hex(reinterpret_cast<char*>(&m_prepared_key),sizeof(size_t)) << std::endl;
     }
     
-    if (m_opcode == frame::opcode::TEXT) {
+    if (m_opcode == frame::opcode::TEXT && !m_compressed) {
         if (!m_validator.decode(input, input+size)) {
             throw processor::exception("Invalid UTF8 data",
                                        processor::error::PAYLOAD_VIOLATION);
@@ -112,10 +112,11 @@ void data::reset(websocketpp::frame::opcode::value opcode) {
     m_payload.clear();
     m_validator.reset();
     m_prepared = false;
+    m_compressed = false;
 }
 
 void data::complete() {
-    if (m_opcode == frame::opcode::TEXT) {
+    if (m_opcode == frame::opcode::TEXT && !m_compressed) {
         if (!m_validator.complete()) {
             throw processor::exception("Invalid UTF8 data",
                                        processor::error::PAYLOAD_VIOLATION);
@@ -124,7 +125,7 @@ void data::complete() {
 }
 
 void data::validate_payload() {
-    if (m_opcode == frame::opcode::TEXT) {
+    if (m_opcode == frame::opcode::TEXT && !m_compressed) {
         if (!m_validator.decode(m_payload.begin(), m_payload.end())) {
             throw exception("Invalid UTF8 data",error::PAYLOAD_VIOLATION);
         }
@@ -149,6 +150,14 @@ bool data::get_prepared() const {
     return m_prepared; 
 }
 
+void data::set_compressed(bool b) {
+    m_compressed = b;
+}
+
+bool data::get_compressed() const {
+    return m_compressed;
+}
+
 // This could be further optimized using methods that write directly into the
 // m_payload buffer
 void data::set_payload(const std::string& payload) {
@@ -197,6 +197,12 @@ public:
     
     void set_header(const std::string& header);
     
+    // Marks the payload as permessage-deflate compressed. The frame is sent
+    // with RSV1 set and UTF8 validation is skipped in both directions since
+    // the bytes are not text until inflated.
+    void set_compressed(bool b);
+    bool get_compressed() const;
+    
     // Performs masking and header generation if it has not been done already.
     void set_prepared(bool b);
     bool get_prepared() const;
@@ -257,6 +263,7 @@ private:
     std::string                 m_payload;
     
     bool                        m_prepared;
+    bool                        m_compressed;
     
     // reference counting
     size_t                              m_index;
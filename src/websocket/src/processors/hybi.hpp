@@ -349,11 +349,17 @@ public:
             }
             
             m_data_message->reset(m_header.get_opcode());
+            m_data_message->set_compressed(m_header.get_rsv1());
         } else {
             // A message has already been started. Continuation frames only!
             if (m_header.get_opcode() != frame::opcode::CONTINUATION) {
                 throw processor::exception("Received new message before the completion of the existing one.",processor::error::PROTOCOL_VIOLATION);
             }
+            
+            // RSV1 marks a whole compressed message, only on its first frame
+            if (m_header.get_rsv1()) {
+                throw processor::exception("RSV1 set on a continuation frame",processor::error::PROTOCOL_VIOLATION);
+            }
         }
         
         m_payload_left = static_cast<size_t>(m_header.get_payload_size());
@@ -442,6 +448,11 @@ public:
         m_header.reset();
     }
     
+    void set_rsv1_allowed(bool b) {
+        m_header.set_rsv1_allowed(b);
+        m_write_header.set_rsv1_allowed(b);
+    }
+    
     uint64_t get_bytes_needed() const {
         switch (m_state) {
             case hybi_state::READ_HEADER:
@@ -567,6 +578,7 @@ public:
         
         m_write_header.reset();
         m_write_header.set_fin(true);
+        m_write_header.set_rsv1(msg->get_compressed());
         m_write_header.set_opcode(msg->get_opcode());
         m_write_header.set_masked(masked,key);
         m_write_header.set_payload_size(msg->get_payload().size());
@@ -31,7 +31,7 @@
 
 using websocketpp::processor::hybi_header;
 
-hybi_header::hybi_header() {
+hybi_header::hybi_header() : m_rsv1_allowed(false) {
     reset();
 }
 void hybi_header::reset() {
@@ -39,6 +39,9 @@ void hybi_header::reset() {
     m_state = STATE_BASIC_HEADER;
     m_bytes_needed = BASIC_HEADER_LENGTH;
 }
+void hybi_header::set_rsv1_allowed(bool b) {
+    m_rsv1_allowed = b;
+}
 
 // Writing interface (parse a byte stream)
 void hybi_header::consume(std::istream& input) {
@@ -220,8 +223,10 @@ void hybi_header::validate_basic_header() const {
         throw processor::exception("Control Frame is too large",processor::error::PROTOCOL_VIOLATION);
     }
     
-    // check for reserved bits
-    if (get_rsv1() || get_rsv2() || get_rsv3()) {
+    // check for reserved bits. RSV1 is only meaningful on data frames once
+    // permessage-deflate has been negotiated.
+    if ((get_rsv1() && (!m_rsv1_allowed || is_control())) ||
+        get_rsv2() || get_rsv3()) {
         throw processor::exception("Reserved bit used",processor::error::PROTOCOL_VIOLATION);
     }
     
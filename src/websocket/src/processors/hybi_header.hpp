@@ -61,6 +61,10 @@ public:
     /// Reset a header processor for writing
     void reset();
     
+    // Permits RSV1 on data frames. An extension that assigns a meaning to the
+    // bit (permessage-deflate) must have been negotiated. Survives reset().
+    void set_rsv1_allowed(bool b);
+    
     // Writing interface (parse a byte stream)
     // valid only if ready() returns false
     // Consume will throw a processor::exception in the case that the bytes it
@@ -139,6 +143,7 @@ private:
     std::streamsize m_bytes_needed;
     uint64_t    m_payload_size;
     char m_header[MAX_HEADER_LENGTH];
+    bool        m_rsv1_allowed;
 };
     
 } // namespace processor
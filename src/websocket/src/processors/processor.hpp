@@ -113,6 +113,11 @@ public:
     
     virtual uint64_t get_bytes_needed() const = 0;
     
+    // Accept RSV1 on incoming data frames and emit it for compressed outgoing
+    // messages. Called once permessage-deflate is negotiated. Processors
+    // without extension support ignore it.
+    virtual void set_rsv1_allowed(bool) {}
+    
     // Get information about the message that is ready
     //virtual frame::opcode::value get_opcode() const = 0;
     
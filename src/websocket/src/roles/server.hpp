@@ -507,17 +507,33 @@ void server<endpoint>::connection<connection_type>::select_extension(
         return;
     }
     
+    // Offers are matched on the extension name alone. The value selected is
+    // what goes in the response, so the server may answer with parameters of
+    // its own.
+    std::string name = value.substr(0,value.find(';'));
+    boost::trim(name);
+    
     std::vector<std::string>::iterator it;
     
-    it = std::find(m_requested_extensions.begin(),
-                   m_requested_extensions.end(),
-                   value);
+    for (it = m_requested_extensions.begin(); it != m_requested_extensions.end(); ++it) {
+        std::string offer = it->substr(0,it->find(';'));
+        boost::trim(offer);
+        
+        if (boost::iequals(offer,name)) {
+            break;
+        }
+    }
     
     if (it == m_requested_extensions.end()) {
         throw std::invalid_argument("Attempted to choose an extension not proposed by the client");
     }
     
     m_extensions.push_back(value);
+    
+    // permessage-deflate claims RSV1 to mark compressed messages
+    if (boost::iequals(name,"permessage-deflate")) {
+        m_connection.m_processor->set_rsv1_allowed(true);
+    }
 }
 
 // Valid if get_version() returns -1 (ie this is an http connection)
@@ -719,6 +735,20 @@ void server<endpoint>::connection<connection_type>::handle_read_request(
                 }
             }
             
+            // Extract extension offers, each with its parameters
+            std::string extensions = m_request.header("Sec-WebSocket-Extensions");
+            if(extensions.length() > 0) {
+                boost::char_separator<char> sep(",");
+                boost::tokenizer< boost::char_separator<char> > tokens(extensions, sep);
+                for(boost::tokenizer< boost::char_separator<char> >::iterator it = tokens.begin(); it != tokens.end(); ++it){
+                    std::string ext = *it;
+                    boost::trim(ext);
+                    if (ext.length() > 0){
+                        m_requested_extensions.push_back(ext);
+                    }
+                }
+            }
+            
             m_origin = m_connection.m_processor->get_origin(m_request);
             m_uri = m_connection.m_processor->get_uri(m_request);
             
@@ -845,7 +875,10 @@ void server<endpoint>::connection<connection_type>::write_response() {
             m_response.replace_header("Sec-WebSocket-Protocol",m_subprotocol);
         }
         
-        // TODO: return negotiated extensions
+        if (!m_extensions.empty()) {
+            m_response.replace_header("Sec-WebSocket-Extensions",
+                                      boost::algorithm::join(m_extensions,", "));
+        }
     } else {
         // TODO: HTTP response
         ws_response = false;